@@ -19,10 +19,13 @@
 #include "../../Source/Core/Audio/Monitoring/AudioMonitor.cpp"
 #include "../../Source/Core/Audio/Monitoring/SpectrumAnalyzer.cpp"
 #include "../../Source/Core/Audio/Transport/MidiRecorder.cpp"
-#include "../../Source/Core/Audio/Transport/PlayerThread.cpp"
+#include "../../Source/Core/Audio/Transport/Player.cpp"
 #include "../../Source/Core/Audio/Transport/RendererThread.cpp"
+#include "../../Source/Core/Audio/Transport/TempoMap.cpp"
 #include "../../Source/Core/Audio/Transport/Transport.cpp"
+#include "../../Source/Core/Audio/Transport/TransportPlaybackCache.cpp"
 #include "../../Source/Core/Audio/AudioCore.cpp"
+#include "../../Source/Core/Audio/ParallelAudioCallback.cpp"
 #include "../../Source/Core/Configuration/Models/Arpeggiator.cpp"
 #include "../../Source/Core/Configuration/Models/Chord.cpp"
 #include "../../Source/Core/Configuration/Models/ColourScheme.cpp"
@@ -54,10 +57,12 @@
 #include "../../Source/Core/Midi/Sequences/Events/AutomationEvent.cpp"
 #include "../../Source/Core/Midi/Sequences/Events/KeySignatureEvent.cpp"
 #include "../../Source/Core/Midi/Sequences/Events/MidiEvent.cpp"
+#include "../../Source/Core/Midi/Sequences/Events/MidiEventPool.cpp"
 #include "../../Source/Core/Midi/Sequences/Events/Note.cpp"
 #include "../../Source/Core/Midi/Sequences/Events/TimeSignatureEvent.cpp"
 #include "../../Source/Core/Midi/Sequences/AnnotationsSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/AutomationSequence.cpp"
+#include "../../Source/Core/Midi/Sequences/IntervalIndex.cpp"
 #include "../../Source/Core/Midi/Sequences/KeySignaturesSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/MidiSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/PianoSequence.cpp"
@@ -78,6 +83,7 @@
 #include "../../Source/Core/Serialization/DocumentHelpers.cpp"
 #include "../../Source/Core/Serialization/SerializedData.cpp"
 #include "../../Source/Core/Serialization/BinarySerializer.cpp"
+#include "../../Source/Core/Serialization/EventColumns.cpp"
 #include "../../Source/Core/Serialization/JsonSerializer.cpp"
 #include "../../Source/Core/Serialization/XmlSerializer.cpp"
 #include "../../Source/Core/Tree/AutomationTrackNode.cpp"
@@ -104,6 +110,7 @@
 #include "../../Source/Core/Undo/Actions/PatternActions.cpp"
 #include "../../Source/Core/Undo/Actions/PianoTrackActions.cpp"
 #include "../../Source/Core/Undo/Actions/ProjectMetadataActions.cpp"
+#include "../../Source/Core/Undo/UndoJournal.cpp"
 #include "../../Source/Core/Undo/Actions/TimeSignatureEventActions.cpp"
 #include "../../Source/Core/Undo/UndoStack.cpp"
 #include "../../Source/Core/VCS/DiffLogic/AutomationTrackDiffLogic.cpp"
@@ -128,6 +135,7 @@
 #include "../../Source/Core/Workspace/UserProfile.cpp"
 #include "../../Source/Core/Workspace/Workspace.cpp"
 #include "../../Source/Core/App.cpp"
+#include "../../Source/UI/Common/AudioMonitors/AudioMonitorSubscription.cpp"
 #include "../../Source/UI/Common/AudioMonitors/SpectrogramAudioMonitorComponent.cpp"
 #include "../../Source/UI/Common/AudioMonitors/WaveformAudioMonitorComponent.cpp"
 #include "../../Source/UI/Common/Origami/Origami.cpp"
@@ -237,6 +245,8 @@
 #include "../../Source/UI/Sequencer/Helpers/TimelineWarningMarker.cpp"
 #include "../../Source/UI/Sequencer/Helpers/PatternOperations.cpp"
 #include "../../Source/UI/Sequencer/Helpers/SequencerOperations.cpp"
+#include "../../Source/UI/Sequencer/Helpers/RollSpatialIndex.cpp"
+#include "../../Source/UI/Sequencer/Helpers/TiledImageCache.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationCurveClip/AutomationCurveClipComponent.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationCurveClip/AutomationCurveHelper.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationCurveClip/AutomationCurveEventComponent.cpp"
@@ -255,6 +265,7 @@
 #include "../../Source/UI/Sequencer/PianoRoll/NoteResizerLeft.cpp"
 #include "../../Source/UI/Sequencer/PianoRoll/NoteResizerRight.cpp"
 #include "../../Source/UI/Sequencer/PianoRoll/PianoRoll.cpp"
+#include "../../Source/UI/Sequencer/PianoRoll/SelectableNote.cpp"
 #include "../../Source/UI/Sequencer/Sidebars/SequencerSidebarLeft.cpp"
 #include "../../Source/UI/Sequencer/Sidebars/SequencerSidebarRight.cpp"
 #include "../../Source/UI/Sequencer/MiniMaps/AnnotationsMap/AnnotationLargeComponent.cpp"
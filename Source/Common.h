@@ -81,6 +81,17 @@ struct IdentifierHash
     }
 };
 
+struct UuidHash
+{
+    inline HashCode operator()(const juce::Uuid &key) const noexcept
+    {
+        // the uuid is random enough, so just mix its halves
+        uint64 halves[2];
+        memcpy(halves, key.getRawData(), sizeof(halves));
+        return static_cast<HashCode>(halves[0] ^ halves[1]);
+    }
+};
+
 //===----------------------------------------------------------------------===//
 // Various helpers
 //===----------------------------------------------------------------------===//
@@ -22,6 +22,7 @@
 #include "BuiltInSynthAudioPlugin.h"
 #include "SerializationKeys.h"
 #include "AudioMonitor.h"
+#include "ParallelAudioCallback.h"
 
 void AudioCore::initAudioFormats(AudioPluginFormatManager &formatManager)
 {
@@ -34,6 +35,14 @@ AudioCore::AudioCore()
 {
     this->audioMonitor = make<AudioMonitor>();
     this->deviceManager.addAudioCallback(this->audioMonitor.get());
+
+    this->parallelCallback = make<ParallelAudioCallback>();
+    this->parallelProcessingEnabled = this->parallelCallback->getNumWorkers() > 0;
+    if (this->parallelProcessingEnabled)
+    {
+        this->deviceManager.addAudioCallback(this->parallelCallback.get());
+    }
+
     AudioCore::initAudioFormats(this->formatManager);
 }
 
@@ -41,7 +50,9 @@ AudioCore::~AudioCore()
 {
     this->deviceManager.removeAudioCallback(this->audioMonitor.get());
     this->audioMonitor = nullptr;
+    this->deviceManager.removeAudioCallback(this->parallelCallback.get());
     this->deviceManager.closeAudioDevice();
+    this->parallelCallback = nullptr;
 }
 
 bool AudioCore::canSleepNow() noexcept
@@ -68,13 +79,15 @@ void AudioCore::disconnectAllAudioCallbacks()
     {
         this->isMuted = true;
 
-        // Audio monitor is especially CPU-hungry, as it does FFT all the time:
+        // no need to feed the audio monitor with silence:
         this->deviceManager.removeAudioCallback(this->audioMonitor.get());
 
         for (auto *instrument : this->instruments)
         {
             this->removeInstrumentFromAudioDevice(instrument);
         }
+
+        this->deviceManager.removeAudioCallback(this->parallelCallback.get());
     }
 }
 
@@ -82,6 +95,11 @@ void AudioCore::reconnectAllAudioCallbacks()
 {
     if (this->isMuted.get())
     {
+        if (this->parallelProcessingEnabled)
+        {
+            this->deviceManager.addAudioCallback(this->parallelCallback.get());
+        }
+
         for (auto *instrument : this->instruments)
         {
             this->addInstrumentToAudioDevice(instrument);
@@ -108,6 +126,30 @@ AudioMonitor *AudioCore::getMonitor() const noexcept
     return this->audioMonitor.get();
 }
 
+bool AudioCore::isParallelProcessingEnabled() const noexcept
+{
+    return this->parallelProcessingEnabled;
+}
+
+void AudioCore::setParallelProcessingEnabled(bool shouldBeEnabled)
+{
+    // with a single core, there are no workers to do the job
+    shouldBeEnabled = shouldBeEnabled && this->parallelCallback->getNumWorkers() > 0;
+
+    if (this->parallelProcessingEnabled == shouldBeEnabled)
+    {
+        return;
+    }
+
+    // instruments can be added while sleeping, so wake up first
+    // to make sure that all of them are connected in the old mode,
+    // then move them all to the new one:
+    this->setAwake();
+    this->disconnectAllAudioCallbacks();
+    this->parallelProcessingEnabled = shouldBeEnabled;
+    this->reconnectAllAudioCallbacks();
+}
+
 //===----------------------------------------------------------------------===//
 // Instruments
 //===----------------------------------------------------------------------===//
@@ -147,7 +189,14 @@ void AudioCore::addInstrumentToMidiDevice(Instrument *instrument)
 
 void AudioCore::addInstrumentToAudioDevice(Instrument *instrument)
 {
-    this->deviceManager.addAudioCallback(&instrument->getProcessorPlayer());
+    if (this->parallelProcessingEnabled)
+    {
+        this->parallelCallback->addCallback(&instrument->getProcessorPlayer());
+    }
+    else
+    {
+        this->deviceManager.addAudioCallback(&instrument->getProcessorPlayer());
+    }
 }
 
 void AudioCore::removeInstrumentFromMidiDevice(Instrument *instrument)
@@ -158,7 +207,14 @@ void AudioCore::removeInstrumentFromMidiDevice(Instrument *instrument)
 
 void AudioCore::removeInstrumentFromAudioDevice(Instrument *instrument)
 {
-    this->deviceManager.removeAudioCallback(&instrument->getProcessorPlayer());
+    if (this->parallelProcessingEnabled)
+    {
+        this->parallelCallback->removeCallback(&instrument->getProcessorPlayer());
+    }
+    else
+    {
+        this->deviceManager.removeAudioCallback(&instrument->getProcessorPlayer());
+    }
 }
 
 void AudioCore::setActiveMidiPlayer(const String &instrumentId, bool forceReconnect)
@@ -330,6 +386,7 @@ SerializedData AudioCore::serializeDeviceManager() const
     tree.setProperty(Audio::audioDeviceType, this->deviceManager.getCurrentAudioDeviceType());
     tree.setProperty(Audio::audioOutputDeviceName, currentSetup.outputDeviceName);
     tree.setProperty(Audio::audioInputDeviceName, currentSetup.inputDeviceName);
+    tree.setProperty(Audio::parallelProcessing, this->parallelProcessingEnabled);
 
     const auto currentAudioDevice = this->deviceManager.getCurrentAudioDevice();
     if (currentAudioDevice != nullptr)
@@ -385,6 +442,10 @@ void AudioCore::deserializeDeviceManager(const SerializedData &tree)
         return;
     }
 
+    // needs to be set before any instruments are added:
+    this->setParallelProcessingEnabled(root.getProperty(Audio::parallelProcessing,
+        this->parallelCallback->getNumWorkers() > 0));
+
     // A hack: this will call scanDevicesIfNeeded():
     const auto &availableDeviceTypes = this->deviceManager.getAvailableDeviceTypes();
 
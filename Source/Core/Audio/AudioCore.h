@@ -18,6 +18,7 @@
 #pragma once
 
 class AudioMonitor;
+class ParallelAudioCallback;
 
 #include "Instrument.h"
 #include "OrchestraPit.h"
@@ -111,6 +112,11 @@ public:
     AudioPluginFormatManager &getFormatManager() noexcept;
     AudioMonitor *getMonitor() const noexcept;
 
+    // in the parallel mode, all instruments are processed by a single
+    // device callback which spreads them across the available cores:
+    bool isParallelProcessingEnabled() const noexcept;
+    void setParallelProcessingEnabled(bool shouldBeEnabled);
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -183,6 +189,9 @@ private:
 
     UniquePointer<AudioMonitor> audioMonitor;
 
+    UniquePointer<ParallelAudioCallback> parallelCallback;
+    bool parallelProcessingEnabled = false;
+
     String lastActiveMidiPlayerId;
 
     AudioPluginFormatManager formatManager;
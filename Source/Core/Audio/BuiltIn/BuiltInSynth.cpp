@@ -25,29 +25,137 @@ struct BuiltInSynthSound final : public SynthesiserSound
     bool appliesToChannel(int midiChannel) override { return true; }
 };
 
-class BuiltInSynthVoice final : public SynthesiserVoice
+// A linear ADSR, which renders the whole segments at once,
+// instead of stepping through its states for every sample
+class BuiltInSynthEnvelope final
 {
 public:
 
-    BuiltInSynthVoice()
+    BuiltInSynthEnvelope() = default;
+
+    void setSampleRate(double sampleRate) noexcept
+    {
+        this->attackRate = float(1.0 / (BuiltInSynthEnvelope::attack * sampleRate));
+        this->decayRate = float((BuiltInSynthEnvelope::sustain - 1.0) /
+            (BuiltInSynthEnvelope::decay * sampleRate));
+        this->releaseSamples = float(BuiltInSynthEnvelope::release * sampleRate);
+    }
+
+    void noteOn() noexcept
+    {
+        this->state = State::Attack;
+    }
+
+    void noteOff() noexcept
+    {
+        if (this->state != State::Idle)
+        {
+            this->releaseRate = -this->level / this->releaseSamples;
+            this->state = State::Release;
+        }
+    }
+
+    void reset() noexcept
+    {
+        this->level = 0.f;
+        this->state = State::Idle;
+    }
+
+    bool isActive() const noexcept
+    {
+        return this->state != State::Idle;
+    }
+
+    void render(float *out, int numSamples) noexcept
+    {
+        int i = 0;
+        while (i < numSamples)
+        {
+            switch (this->state)
+            {
+            case State::Attack:
+                i += this->renderRamp(out + i, numSamples - i,
+                    this->attackRate, 1.f, State::Decay);
+                break;
+            case State::Decay:
+                i += this->renderRamp(out + i, numSamples - i, this->decayRate,
+                    float(BuiltInSynthEnvelope::sustain), State::Sustain);
+                break;
+            case State::Sustain:
+                FloatVectorOperations::fill(out + i, this->level, numSamples - i);
+                return;
+            case State::Release:
+                i += this->renderRamp(out + i, numSamples - i,
+                    this->releaseRate, 0.f, State::Idle);
+                break;
+            case State::Idle:
+                FloatVectorOperations::clear(out + i, numSamples - i);
+                return;
+            }
+        }
+    }
+
+private:
+
+    enum class State : int8
+    {
+        Idle,
+        Attack,
+        Decay,
+        Sustain,
+        Release
+    };
+
+    int renderRamp(float *out, int numSamples,
+        float rate, float target, State nextState) noexcept
     {
-        ADSR::Parameters ap;
-        ap.attack = 0.001f;
-        ap.decay = 1.0f;
-        ap.sustain = 0.2f;
-        ap.release = 0.5f;
-        this->adsr.setParameters(ap);
+        const auto samplesToTarget = (rate == 0.f) ? 1 :
+            jmax(1, int(std::ceil((target - this->level) / rate)));
+
+        const auto numRampSamples = jmin(numSamples, samplesToTarget);
+        const auto start = this->level;
+
+        for (int i = 0; i < numRampSamples; ++i)
+        {
+            out[i] = start + rate * float(i + 1);
+        }
+
+        if (numRampSamples == samplesToTarget)
+        {
+            out[numRampSamples - 1] = target;
+            this->level = target;
+            this->state = nextState;
+        }
+        else
+        {
+            this->level = start + rate * float(numRampSamples);
+        }
 
-        Reverb::Parameters rp;
-        rp.roomSize = 0.0f;
-        rp.damping = 0.0f;
-        rp.wetLevel = 0.23f;
-        rp.dryLevel = 0.73f;
-        rp.width = 0.0f;
-        rp.freezeMode = 0.4f;
-        this->reverb.setParameters(rp);
+        return numRampSamples;
     }
 
+    static constexpr auto attack = 0.001;
+    static constexpr auto decay = 1.0;
+    static constexpr auto sustain = 0.2;
+    static constexpr auto release = 0.5;
+
+    State state = State::Idle;
+    float level = 0.f;
+
+    float attackRate = 0.f;
+    float decayRate = 0.f;
+    float releaseRate = 0.f;
+    float releaseSamples = 1.f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BuiltInSynthEnvelope)
+};
+
+class BuiltInSynthVoice final : public SynthesiserVoice
+{
+public:
+
+    BuiltInSynthVoice() = default;
+
     bool canPlaySound(SynthesiserSound *) override
     {
         return true; // just assume correct usage
@@ -57,8 +165,7 @@ public:
     {
         if (sampleRate > 0)
         {
-            this->adsr.setSampleRate(sampleRate);
-            this->reverb.setSampleRate(sampleRate);
+            this->envelope.setSampleRate(sampleRate);
             SynthesiserVoice::setCurrentPlaybackSampleRate(sampleRate);
         }
     }
@@ -69,52 +176,98 @@ public:
         const int realNoteNumber = midiNoteNumber +
             Globals::twelveToneKeyboardSize * (channel - 1);
 
-        this->currentAngle = 0.0;
-        this->level = velocity * 0.15;
+        this->phase = 0.0;
+        this->level = velocity * 0.15f;
 
         const auto cyclesPerSecond = this->getNoteInHertz(realNoteNumber);
-        const auto cyclesPerSample = cyclesPerSecond / this->getSampleRate();
-
-        this->angleDelta = cyclesPerSample * MathConstants<double>::twoPi;
+        this->phaseDelta = cyclesPerSecond / this->getSampleRate();
 
-        this->adsr.noteOn();
+        this->envelope.noteOn();
     }
 
     void stopNote(float, bool allowTailOff) override
     {
         if (allowTailOff)
         {
-            this->adsr.noteOff();
+            this->envelope.noteOff();
         }
         else
         {
             this->clearCurrentNote();
-            this->adsr.reset();
-            this->reverb.reset();
+            this->envelope.reset();
         }
     }
 
     void pitchWheelMoved(int) override {}
     void controllerMoved(int, int) override {}
 
-    void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
+    // adds the dry signal to the mono mix, using the given scratch buffers,
+    // returns false if the voice is silent; see BuiltInSynth::renderVoices
+    bool renderDry(float *mix, float *oscillator, float *envelope, int numSamples) noexcept
     {
-        if (this->adsr.isActive())
+        if (!this->envelope.isActive())
         {
-            while (--numSamples >= 0)
-            {
-                const auto amplitude = this->adsr.getNextSample();
-                auto currentSample = (float)(std::sin(currentAngle) * level * amplitude);
-                this->reverb.processMono(&currentSample, 1);
+            return false;
+        }
+
+        this->envelope.render(envelope, numSamples);
+
+        // the phase accumulator and the sine approximation below have
+        // no branches or table lookups, so the compiler turns this loop
+        // into SIMD instructions; the max error is ~0.001 of the amplitude
+        const auto startPhase = float(this->phase);
+        const auto delta = float(this->phaseDelta);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto p = startPhase + delta * float(i);
+            p -= float(int(p));
+
+            // sin(2pi * p) == -sin(pi * x), where x = 2p - 1 is within [-1, 1)
+            const auto x = 2.f * p - 1.f;
+            const auto s = 4.f * x * (1.f - std::abs(x));
+            oscillator[i] = -s * (0.775f + 0.225f * std::abs(s));
+        }
+
+        this->phase += this->phaseDelta * numSamples;
+        this->phase -= std::floor(this->phase);
+
+        FloatVectorOperations::multiply(oscillator, envelope, numSamples);
+        FloatVectorOperations::addWithMultiply(mix, oscillator, this->level, numSamples);
+
+        if (!this->envelope.isActive())
+        {
+            this->clearCurrentNote();
+        }
+
+        return true;
+    }
+
+    // not used by BuiltInSynth, which renders all voices at once,
+    // but still works without the reverb, just in case
+    void renderNextBlock(AudioBuffer<float> &outputBuffer, int startSample, int numSamples) override
+    {
+        static constexpr auto chunkSize = 64;
+        float mix[chunkSize];
+        float oscillator[chunkSize];
+        float envelope[chunkSize];
+
+        while (numSamples > 0)
+        {
+            const auto numChunkSamples = jmin(numSamples, chunkSize);
+            FloatVectorOperations::clear(mix, numChunkSamples);
 
-                for (auto i = outputBuffer.getNumChannels(); --i >= 0;)
-                {
-                    outputBuffer.addSample(i, startSample, currentSample);
-                }
+            if (!this->renderDry(mix, oscillator, envelope, numChunkSamples))
+            {
+                return;
+            }
 
-                this->currentAngle += this->angleDelta;
-                ++startSample;
+            for (int i = 0; i < outputBuffer.getNumChannels(); ++i)
+            {
+                outputBuffer.addFrom(i, startSample, mix, numChunkSamples);
             }
+
+            startSample += numChunkSamples;
+            numSamples -= numChunkSamples;
         }
     }
 
@@ -128,15 +281,15 @@ public:
 
 private:
 
-    double currentAngle = 0.0;
-    double angleDelta = 0.0;
-    double level = 0.0;
+    // in cycles, not radians
+    double phase = 0.0;
+    double phaseDelta = 0.0;
+    float level = 0.f;
 
     int periodSize = Globals::twelveTonePeriodSize;
     int middleC = Temperament::periodNumForMiddleC * Globals::twelveTonePeriodSize;
 
-    ADSR adsr;
-    Reverb reverb;
+    BuiltInSynthEnvelope envelope;
 
     double getNoteInHertz(int noteNumber, double frequencyOfA = 440.0) noexcept
     {
@@ -168,6 +321,67 @@ BuiltInSynth::BuiltInSynth()
     }
 
     this->addSound(new BuiltInSynthSound());
+
+    this->mixBuffer.calloc(BuiltInSynth::maxChunkSize);
+    this->oscillatorBuffer.calloc(BuiltInSynth::maxChunkSize);
+    this->envelopeBuffer.calloc(BuiltInSynth::maxChunkSize);
+
+    Reverb::Parameters rp;
+    rp.roomSize = 0.0f;
+    rp.damping = 0.0f;
+    rp.wetLevel = 0.23f;
+    rp.dryLevel = 0.73f;
+    rp.width = 0.0f;
+    rp.freezeMode = 0.4f;
+    this->reverb.setParameters(rp);
+}
+
+void BuiltInSynth::setCurrentPlaybackSampleRate(double sampleRate)
+{
+    Synthesiser::setCurrentPlaybackSampleRate(sampleRate);
+
+    if (sampleRate > 0)
+    {
+        this->reverb.setSampleRate(sampleRate);
+        this->reverb.reset();
+        this->numTailSamples = int(sampleRate * BuiltInSynth::tailLengthSeconds);
+        this->numSilentSamples = this->numTailSamples;
+    }
+}
+
+void BuiltInSynth::renderVoices(AudioBuffer<float> &outputAudio,
+    int startSample, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const auto numChunkSamples = jmin(numSamples, BuiltInSynth::maxChunkSize);
+        FloatVectorOperations::clear(this->mixBuffer, numChunkSamples);
+
+        bool hasSound = false;
+        for (auto *voice : this->voices)
+        {
+            hasSound = static_cast<BuiltInSynthVoice *>(voice)->renderDry(this->mixBuffer,
+                this->oscillatorBuffer, this->envelopeBuffer, numChunkSamples) || hasSound;
+        }
+
+        this->numSilentSamples = hasSound ? 0 :
+            jmin(this->numSilentSamples + numChunkSamples, this->numTailSamples + 1);
+
+        // the reverb is linear, so running it once on the mix sounds the same
+        // as running it for each voice, and it stops once its tail has faded out
+        if (this->numSilentSamples <= this->numTailSamples)
+        {
+            this->reverb.processMono(this->mixBuffer, numChunkSamples);
+
+            for (int i = 0; i < outputAudio.getNumChannels(); ++i)
+            {
+                outputAudio.addFrom(i, startSample, this->mixBuffer, numChunkSamples);
+            }
+        }
+
+        startSample += numChunkSamples;
+        numSamples -= numChunkSamples;
+    }
 }
 
 void BuiltInSynth::setPeriodSize(int periodSize)
@@ -35,12 +35,39 @@ public:
     // a better approach, or just get rid of this hack;
     void setPeriodSize(int periodSize);
 
+    void setCurrentPlaybackSampleRate(double sampleRate) override;
+
+    // how long the reverb keeps ringing after the voices stop
+    static constexpr auto tailLengthSeconds = 3.0;
+
 protected:
 
+    // all voices are mixed into one mono buffer, block by block,
+    // which then goes through the shared reverb and to all channels
+    void renderVoices(AudioBuffer<float> &outputAudio,
+        int startSample, int numSamples) override;
+
+    using Synthesiser::renderVoices;
+
     void handleSustainPedal(int midiChannel, bool isDown) override;
     void handleSostenutoPedal(int midiChannel, bool isDown) override;
 
-    static constexpr auto numVoices = 16;
+    // the idle voices cost nothing, and the active ones
+    // only render a vectorized oscillator and envelope each:
+    static constexpr auto numVoices = 64;
+
+private:
+
+    static constexpr auto maxChunkSize = 512;
+
+    HeapBlock<float> mixBuffer;
+    HeapBlock<float> oscillatorBuffer;
+    HeapBlock<float> envelopeBuffer;
+
+    Reverb reverb;
+
+    int numSilentSamples = 0;
+    int numTailSamples = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BuiltInSynth)
 };
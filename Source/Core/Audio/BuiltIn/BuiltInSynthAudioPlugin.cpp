@@ -69,7 +69,7 @@ void BuiltInSynthAudioPlugin::releaseResources() {}
 
 double BuiltInSynthAudioPlugin::getTailLengthSeconds() const
 {
-    return 3.0;
+    return BuiltInSynth::tailLengthSeconds;
 }
 
 bool BuiltInSynthAudioPlugin::acceptsMidi() const
@@ -24,6 +24,7 @@
 #include "BuiltInSynthAudioPlugin.h"
 #include "BuiltInSynthFormat.h"
 #include "KeyboardMapping.h"
+#include "Player.h"
 
 Instrument::Instrument(AudioPluginFormatManager &formatManager, const String &name) :
     formatManager(formatManager),
@@ -789,6 +790,162 @@ void Instrument::AudioCallback::setProcessor(AudioProcessor *const newOne)
     }
 }
 
+void Instrument::AudioCallback::setPlayer(Player *newPlayer)
+{
+    const ScopedLock sl(this->lock);
+    this->player = newPlayer;
+}
+
+//===----------------------------------------------------------------------===//
+// Note previews
+//===----------------------------------------------------------------------===//
+
+void Instrument::AudioCallback::previewNote(int8 key, int8 channel,
+    float velocity, int delayMs, int lengthMs)
+{
+    this->pushPreviewCommand({ PreviewCommand::Type::Play,
+        key, channel, true, velocity, delayMs, lengthMs });
+}
+
+void Instrument::AudioCallback::stopPreview(int8 key, int8 channel)
+{
+    this->pushPreviewCommand({ PreviewCommand::Type::Stop,
+        key, channel, true, 0.f, 0, 0 });
+}
+
+void Instrument::AudioCallback::stopAllPreviews(bool sendNoteOffs)
+{
+    this->pushPreviewCommand({ PreviewCommand::Type::StopAll,
+        -1, -1, sendNoteOffs, 0.f, 0, 0 });
+}
+
+void Instrument::AudioCallback::pushPreviewCommand(const PreviewCommand &command)
+{
+    int start1, size1, start2, size2;
+    this->previewQueue.prepareToWrite(1, start1, size1, start2, size2);
+
+    // the audio thread takes all commands at every block,
+    // so this only happens when there is no audio device running:
+    if (size1 + size2 == 0)
+    {
+        return;
+    }
+
+    this->previewCommands[size1 > 0 ? start1 : start2] = command;
+    this->previewQueue.finishedWrite(1);
+}
+
+// called from the audio thread, before the processor takes the block
+void Instrument::AudioCallback::renderNotePreviews(MidiBuffer &midiMessages, int numSamples)
+{
+    const auto now = this->previewClock;
+    const auto samplesPerMs = this->sampleRate * 0.001;
+
+    const auto findPreview = [this](int8 key, int8 channel)
+    {
+        for (int i = 0; i < this->numNotePreviews; ++i)
+        {
+            if (this->notePreviews[i].key == key &&
+                this->notePreviews[i].channel == channel)
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    };
+
+    const auto removePreview = [this](int index)
+    {
+        this->numNotePreviews--;
+        this->notePreviews[index] = this->notePreviews[this->numNotePreviews];
+    };
+
+    int start1, size1, start2, size2;
+    this->previewQueue.prepareToRead(this->previewQueue.getNumReady(),
+        start1, size1, start2, size2);
+
+    for (int c = 0; c < size1 + size2; ++c)
+    {
+        const auto &command = this->previewCommands[c < size1 ? start1 + c : start2 + c - size1];
+
+        if (command.type == PreviewCommand::Type::StopAll)
+        {
+            for (int i = 0; i < this->numNotePreviews; ++i)
+            {
+                const auto &preview = this->notePreviews[i];
+                if (command.sendNoteOffs && preview.isSounding)
+                {
+                    midiMessages.addEvent(MidiMessage::noteOff(preview.channel, preview.key), 0);
+                }
+            }
+
+            this->numNotePreviews = 0;
+            continue;
+        }
+
+        const auto existingIndex = findPreview(command.key, command.channel);
+        const bool isSounding = existingIndex >= 0 &&
+            this->notePreviews[existingIndex].isSounding;
+
+        if (isSounding)
+        {
+            midiMessages.addEvent(MidiMessage::noteOff(command.channel, command.key), 0);
+        }
+
+        if (existingIndex >= 0)
+        {
+            removePreview(existingIndex);
+        }
+
+        if (command.type == PreviewCommand::Type::Stop ||
+            this->numNotePreviews == AudioCallback::maxNumNotePreviews)
+        {
+            continue;
+        }
+
+        // a retriggered key gets its note-on a bit later than the note-off,
+        // so that no instrument could ever process them in the wrong order
+        const auto delayMs = command.delayMs + (isSounding ? AudioCallback::retriggerDelayMs : 0);
+        const auto noteOnTime = now + int64(delayMs * samplesPerMs);
+
+        auto &preview = this->notePreviews[this->numNotePreviews++];
+        preview.noteOnTime = noteOnTime;
+        preview.noteOffTime = noteOnTime + jmax(int64(1), int64(command.lengthMs * samplesPerMs));
+        preview.velocity = command.velocity;
+        preview.key = command.key;
+        preview.channel = command.channel;
+        preview.isSounding = false;
+    }
+
+    this->previewQueue.finishedRead(size1 + size2);
+
+    const auto blockEnd = now + numSamples;
+    for (int i = 0; i < this->numNotePreviews;)
+    {
+        auto &preview = this->notePreviews[i];
+
+        if (!preview.isSounding && preview.noteOnTime < blockEnd)
+        {
+            midiMessages.addEvent(MidiMessage::noteOn(preview.channel, preview.key, preview.velocity),
+                int(jmax(int64(0), preview.noteOnTime - now)));
+            preview.isSounding = true;
+        }
+
+        if (preview.isSounding && preview.noteOffTime < blockEnd)
+        {
+            midiMessages.addEvent(MidiMessage::noteOff(preview.channel, preview.key),
+                int(jmax(int64(0), preview.noteOffTime - now)));
+            removePreview(i);
+            continue;
+        }
+
+        ++i;
+    }
+
+    this->previewClock = blockEnd;
+}
+
 void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputChannelData,
     const int numInputChannels, float **const outputChannelData,
     const int numOutputChannels, const int numSamples)
@@ -797,6 +954,7 @@ void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputC
 
     this->incomingMidi.clear();
     this->messageCollector.removeNextBlockOfMessages(this->incomingMidi, numSamples);
+    this->renderNotePreviews(this->incomingMidi, numSamples);
     int totalNumChans = 0;
 
     if (numInputChannels > numOutputChannels)
@@ -839,6 +997,11 @@ void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputC
     {
         const ScopedLock sl(this->lock);
 
+        if (this->player != nullptr)
+        {
+            this->player->renderNextBlock(this, this->incomingMidi, numSamples, this->sampleRate);
+        }
+
         if (this->processor != nullptr)
         {
             const ScopedLock sl2(this->processor->getCallbackLock());
@@ -873,6 +1036,12 @@ void Instrument::AudioCallback::audioDeviceAboutToStart(AudioIODevice *const dev
 
     this->messageCollector.reset(sampleRate);
     this->channels.calloc(jmax(numChansIn, numChansOut) + 2);
+    this->incomingMidi.ensureSize(AudioCallback::maxNumNotePreviews * 2 * 3);
+
+    // the callbacks are not running at this point, so it's safe to drop
+    // the previews which were scheduled while the device was stopped:
+    this->previewQueue.finishedRead(this->previewQueue.getNumReady());
+    this->numNotePreviews = 0;
 
     if (this->processor != nullptr)
     {
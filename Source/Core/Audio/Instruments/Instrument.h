@@ -18,6 +18,7 @@
 #pragma once
 
 class KeyboardMapping;
+class Player;
 
 class Instrument final :
     public Serializable,
@@ -50,6 +51,19 @@ public:
         void setProcessor(AudioProcessor *processor);
         MidiMessageCollector &getMidiMessageCollector() noexcept { return messageCollector; }
 
+        // the transport's player, if any, adds the playback events
+        // into each block right here in the audio callback:
+        void setPlayer(Player *player);
+
+        // the note previews are scheduled through the lock-free queue,
+        // and the audio callback renders them into each block at exact
+        // sample offsets, so their timing doesn't depend on the UI thread;
+        // the key and channel are the mapped ones; these methods
+        // must only be called from one thread, the message thread
+        void previewNote(int8 key, int8 channel, float velocity, int delayMs, int lengthMs);
+        void stopPreview(int8 key, int8 channel);
+        void stopAllPreviews(bool sendNoteOffs);
+
         void audioDeviceIOCallback(const float **, int, float **, int, int) override;
         void audioDeviceAboutToStart(AudioIODevice *) override;
         void audioDeviceStopped() override;
@@ -58,6 +72,7 @@ public:
     private:
 
         AudioProcessor *processor = nullptr;
+        Player *player = nullptr;
         CriticalSection lock;
         double sampleRate = 0;
         int blockSize = 0;
@@ -71,6 +86,50 @@ public:
         MidiBuffer incomingMidi;
         MidiMessageCollector messageCollector;
 
+        struct PreviewCommand final
+        {
+            enum class Type : int8
+            {
+                Play,
+                Stop,
+                StopAll
+            };
+
+            Type type;
+            int8 key;
+            int8 channel;
+            bool sendNoteOffs;
+            float velocity;
+            int delayMs;
+            int lengthMs;
+        };
+
+        // the previews, which the audio thread is playing or about to play,
+        // with the times in samples of the audio thread's own clock:
+        struct NotePreview final
+        {
+            int64 noteOnTime;
+            int64 noteOffTime;
+            float velocity;
+            int8 key;
+            int8 channel;
+            bool isSounding;
+        };
+
+        static constexpr auto previewQueueSize = 512;
+        static constexpr auto maxNumNotePreviews = 256;
+        static constexpr auto retriggerDelayMs = 5;
+
+        AbstractFifo previewQueue { AudioCallback::previewQueueSize };
+        PreviewCommand previewCommands[AudioCallback::previewQueueSize];
+
+        NotePreview notePreviews[AudioCallback::maxNumNotePreviews];
+        int numNotePreviews = 0;
+        int64 previewClock = 0;
+
+        void pushPreviewCommand(const PreviewCommand &command);
+        void renderNotePreviews(MidiBuffer &midiMessages, int numSamples);
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioCallback)
     };
 
@@ -59,10 +59,27 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OversaturationWarningAsyncCallback)
 };
 
-AudioMonitor::AudioMonitor() : fft()
+AudioMonitor::AudioMonitor(int fftOrder, int numOverlaps) :
+    Thread("AudioMonitor"),
+    fft(fftOrder),
+    fftSize(fft.getSize()),
+    hopSize(jmax(1, fft.getSize() / jmax(1, numOverlaps))),
+    inputFifo(fft.getSize() * 4),
+    inputBuffer(AudioMonitor::numChannels, fft.getSize() * 4),
+    history(AudioMonitor::numChannels, fft.getSize())
 {
+    this->history.clear();
+    this->spectrumBuffer.calloc(this->fft.getNumBins());
+
     this->asyncClippingWarning = make<ClippingWarningAsyncCallback>(*this);
     this->asyncOversaturationWarning = make<OversaturationWarningAsyncCallback>(*this);
+
+    this->startThread(3);
+}
+
+AudioMonitor::~AudioMonitor()
+{
+    this->stopThread(1000);
 }
 
 //===----------------------------------------------------------------------===//
@@ -77,45 +94,202 @@ void AudioMonitor::audioDeviceAboutToStart(AudioIODevice *device)
 void AudioMonitor::audioDeviceIOCallback(const float **inputChannelData, int numInputChannels,
     float **outputChannelData, int numOutputChannels, int numSamples)
 {
-    const int minNumChannels = jmin(AudioMonitor::numChannels, numOutputChannels);
-    
-    for (int channel = 0; channel < minNumChannels; ++channel)
+    if (this->isAnalysing.get() && numOutputChannels > 0)
+    {
+        int start1, size1, start2, size2;
+        this->inputFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+        // if the analysis thread falls behind, the rest
+        // of the block is skipped, which is fine for the meters;
+        // a mono output is analysed as both channels:
+        for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+        {
+            const auto *source = outputChannelData[jmin(channel, numOutputChannels - 1)];
+
+            if (size1 > 0)
+            {
+                this->inputBuffer.copyFrom(channel, start1, source, size1);
+            }
+
+            if (size2 > 0)
+            {
+                this->inputBuffer.copyFrom(channel, start2, source + size1, size2);
+            }
+        }
+
+        this->inputFifo.finishedWrite(size1 + size2);
+    }
+
+    for (int i = 0; i < numOutputChannels; ++i)
     {
-        this->fft.computeSpectrum(outputChannelData[channel], 0, numSamples,
-            this->spectrum[channel], AudioMonitor::spectrumSize,
-            channel, numOutputChannels);
+        FloatVectorOperations::clear(outputChannelData[i], numSamples);
     }
-    
-    for (int channel = 0; channel < minNumChannels; ++channel)
+}
+
+//===----------------------------------------------------------------------===//
+// Thread
+//===----------------------------------------------------------------------===//
+
+void AudioMonitor::run()
+{
+    while (!this->threadShouldExit())
+    {
+        if (!this->isAnalysing.get())
+        {
+            this->resetSnapshots();
+            this->wait(-1);
+
+            // whatever was written before the analysis was suspended is stale:
+            this->inputFifo.finishedRead(this->inputFifo.getNumReady());
+            continue;
+        }
+
+        if (this->inputFifo.getNumReady() < this->hopSize)
+        {
+            this->wait(AudioMonitor::analysisIntervalMs);
+            continue;
+        }
+
+        this->analyseNextHop();
+    }
+}
+
+void AudioMonitor::analyseNextHop()
+{
+    const auto historyTail = this->fftSize - this->hopSize;
+
+    int start1, size1, start2, size2;
+    this->inputFifo.prepareToRead(this->hopSize, start1, size1, start2, size2);
+
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+    {
+        auto *history = this->history.getWritePointer(channel);
+        memmove(history, history + this->hopSize, sizeof(float) * size_t(historyTail));
+
+        FloatVectorOperations::copy(history + historyTail,
+            this->inputBuffer.getReadPointer(channel, start1), size1);
+
+        if (size2 > 0)
+        {
+            FloatVectorOperations::copy(history + historyTail + size1,
+                this->inputBuffer.getReadPointer(channel, start2), size2);
+        }
+    }
+
+    this->inputFifo.finishedRead(size1 + size2);
+
+    const auto loudnessSmoothing = float(1.0 - exp(-double(this->hopSize) /
+        (AudioMonitor::loudnessWindowMs * 0.001 * this->sampleRate.get())));
+
+    const bool needsSpectrum = this->numSpectrumSubscribers.get() > 0;
+    auto &snapshot = this->snapshots[1 - this->frontSnapshot.get()];
+
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
     {
+        const auto *history = this->history.getReadPointer(channel);
+        const auto *hop = history + historyTail;
+
+        const auto range = FloatVectorOperations::findMinAndMax(hop, this->hopSize);
+        const auto pcmPeak = jmax(-range.getStart(), range.getEnd());
+
         float pcmSquaresSum = 0.f;
-        float pcmPeak = 0.f;
-        for (int samplePosition = 0; samplePosition < numSamples; ++samplePosition)
+        for (int i = 0; i < this->hopSize; ++i)
         {
-            const float &pcmData = outputChannelData[channel][samplePosition];
-            pcmSquaresSum += (pcmData * pcmData);
-            pcmPeak = jmax(pcmPeak, pcmData);
+            pcmSquaresSum += hop[i] * hop[i];
         }
-        
-        const float rootMeanSquare = sqrtf(pcmSquaresSum / numSamples);
-        this->rms[channel] = rootMeanSquare;
-        this->peak[channel] = pcmPeak;
-        
+
+        const auto meanSquare = pcmSquaresSum / float(this->hopSize);
+        const auto rootMeanSquare = sqrtf(meanSquare);
+
+        this->meanSquares[channel] += loudnessSmoothing *
+            (meanSquare - this->meanSquares[channel]);
+
+        snapshot.peak[channel] = pcmPeak;
+        snapshot.rms[channel] = rootMeanSquare;
+        snapshot.meanSquare[channel] = this->meanSquares[channel];
+
         if (pcmPeak > AudioMonitor::clipThreshold)
         {
             this->asyncClippingWarning->triggerAsyncUpdate();
         }
-        
+
         if (pcmPeak > AudioMonitor::oversaturationThreshold &&
             (pcmPeak / rootMeanSquare) > AudioMonitor::oversaturationRate)
         {
             this->asyncOversaturationWarning->triggerAsyncUpdate();
         }
+
+        if (needsSpectrum)
+        {
+            this->fft.computeSpectrum(history, this->spectrumBuffer);
+            for (int i = 0; i < this->fft.getNumBins(); ++i)
+            {
+                snapshot.spectrum[channel][i] = this->spectrumBuffer[i];
+            }
+        }
     }
 
-    for (int i = 0; i < numOutputChannels; ++i)
+    this->frontSnapshot = 1 - this->frontSnapshot.get();
+}
+
+void AudioMonitor::resetSnapshots()
+{
+    for (auto &snapshot : this->snapshots)
     {
-        FloatVectorOperations::clear(outputChannelData[i], numSamples);
+        for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+        {
+            for (int i = 0; i < this->fft.getNumBins(); ++i)
+            {
+                snapshot.spectrum[channel][i] = 0.f;
+            }
+
+            snapshot.peak[channel] = 0.f;
+            snapshot.rms[channel] = 0.f;
+            snapshot.meanSquare[channel] = 0.f;
+        }
+    }
+
+    this->history.clear();
+    zerostruct(this->meanSquares);
+}
+
+//===----------------------------------------------------------------------===//
+// Subscriptions
+//===----------------------------------------------------------------------===//
+
+void AudioMonitor::subscribe(bool needsSpectrum)
+{
+    this->numSubscribers += 1;
+    if (needsSpectrum)
+    {
+        this->numSpectrumSubscribers += 1;
+    }
+
+    this->updateAnalysisState();
+}
+
+void AudioMonitor::unsubscribe(bool needsSpectrum)
+{
+    jassert(this->numSubscribers.get() > 0);
+    this->numSubscribers -= 1;
+    if (needsSpectrum)
+    {
+        jassert(this->numSpectrumSubscribers.get() > 0);
+        this->numSpectrumSubscribers -= 1;
+    }
+
+    this->updateAnalysisState();
+}
+
+void AudioMonitor::updateAnalysisState()
+{
+    const bool shouldAnalyse = this->numSubscribers.get() > 0 ||
+        !this->clippingListeners.isEmpty();
+
+    if (this->isAnalysing.get() != shouldAnalyse)
+    {
+        this->isAnalysing = shouldAnalyse;
+        this->notify();
     }
 }
 
@@ -125,20 +299,23 @@ void AudioMonitor::audioDeviceIOCallback(const float **inputChannelData, int num
 
 float AudioMonitor::getInterpolatedSpectrumAtFrequency(float frequency) const
 {
-    const float resolution = 
-        float(this->sampleRate.get() / 2.f) / float(AudioMonitor::spectrumSize);
-    
-    const int index1 = roundToInt(frequency / resolution);
-    const int safeIndex1 = jlimit(0, AudioMonitor::spectrumSize, index1);
+    const auto &snapshot = this->snapshots[this->frontSnapshot.get()];
+
+    const float resolution =
+        float(this->sampleRate.get()) / float(this->fftSize);
+
+    // the bins are interpolated on the logarithmic scale,
+    // so the zero frequency bin is never used here:
+    const int lastBin = this->fft.getNumBins() - 1;
+    const int index1 = jlimit(1, lastBin - 1, int(frequency / resolution));
     const float f1 = index1 * resolution;
-    const float y1 = (this->spectrum[0][safeIndex1].get() +
-                      this->spectrum[1][safeIndex1].get()) / 2.f;
+    const float y1 = (snapshot.spectrum[0][index1].get() +
+                      snapshot.spectrum[1][index1].get()) / 2.f;
     
     const int index2 = index1 + 1;
-    const int safeIndex2 = jlimit(0, AudioMonitor::spectrumSize, index2);
     const float f2 = index2 * resolution;
-    const float y2 = (this->spectrum[0][safeIndex2].get() +
-                      this->spectrum[1][safeIndex2].get()) / 2.f;
+    const float y2 = (snapshot.spectrum[0][index2].get() +
+                      snapshot.spectrum[1][index2].get()) / 2.f;
     
     return y1 + ((AudioCore::fastLog10(frequency) - AudioCore::fastLog10(f1)) /
                  (AudioCore::fastLog10(f2) - AudioCore::fastLog10(f1))) * (y2 - y1);
@@ -151,11 +328,13 @@ float AudioMonitor::getInterpolatedSpectrumAtFrequency(float frequency) const
 void AudioMonitor::addClippingListener(ClippingListener *const listener)
 {
     this->clippingListeners.add(listener);
+    this->updateAnalysisState();
 }
 
 void AudioMonitor::removeClippingListener(ClippingListener *const listener)
 {
     this->clippingListeners.remove(listener);
+    this->updateAnalysisState();
 }
 
 ListenerList<AudioMonitor::ClippingListener> &AudioMonitor::getListeners() noexcept
@@ -169,10 +348,16 @@ ListenerList<AudioMonitor::ClippingListener> &AudioMonitor::getListeners() noexc
 
 float AudioMonitor::getPeak(int channel) const
 {
-    return this->peak[channel].get();
+    return this->snapshots[this->frontSnapshot.get()].peak[channel].get();
 }
 
 float AudioMonitor::getRootMeanSquare(int channel) const
 {
-    return this->rms[channel].get();
+    return this->snapshots[this->frontSnapshot.get()].rms[channel].get();
+}
+
+float AudioMonitor::getLoudness(int channel) const
+{
+    const auto meanSquare = this->snapshots[this->frontSnapshot.get()].meanSquare[channel].get();
+    return Decibels::gainToDecibels(sqrtf(meanSquare));
 }
@@ -19,11 +19,19 @@
 
 #include "SpectrumAnalyzer.h"
 
-class AudioMonitor final : public AudioIODeviceCallback
+// The audio thread only copies the output into the lock-free fifo,
+// and all the analysis is done on a separate low-priority thread,
+// which publishes the results through a double buffer of snapshots;
+// the thread sleeps while nobody is subscribed, see subscribe()
+
+class AudioMonitor final : public AudioIODeviceCallback, private Thread
 {
 public:
     
-    AudioMonitor();
+    explicit AudioMonitor(int fftOrder = AudioMonitor::defaultFftOrder,
+        int numOverlaps = AudioMonitor::defaultNumOverlaps);
+
+    ~AudioMonitor() override;
 
     //===------------------------------------------------------------------===//
     // AudioIODeviceCallback
@@ -34,6 +42,16 @@ public:
         float **outputChannelData, int numOutputChannels, int numSamples) override;
     void audioDeviceStopped() override {}
     
+    //===------------------------------------------------------------------===//
+    // Subscriptions
+    //===------------------------------------------------------------------===//
+
+    // the levels are analysed while anyone is subscribed or listens
+    // for the clipping warnings, and the spectrum is only computed
+    // while anyone is subscribed for it; call from the message thread
+    void subscribe(bool needsSpectrum);
+    void unsubscribe(bool needsSpectrum);
+
     //===------------------------------------------------------------------===//
     // Clipping warnings
     //===------------------------------------------------------------------===//
@@ -57,6 +75,10 @@ public:
     
     float getPeak(int channel) const;
     float getRootMeanSquare(int channel) const;
+
+    // the momentary loudness in decibels, i.e. the mean square
+    // averaged over ~400 ms (note there's no K-weighting here)
+    float getLoudness(int channel) const;
     
     //===------------------------------------------------------------------===//
     // Spectrum data
@@ -66,22 +88,62 @@ public:
     
 private:
 
-    SpectrumFFT fft;
+    //===------------------------------------------------------------------===//
+    // Thread
+    //===------------------------------------------------------------------===//
 
-    // 256*2 == we just need quite a small resolution on a spectrum
-    static constexpr auto spectrumSize = 256;
-    static constexpr auto numChannels = 2;
+    void run() override;
+
+    void analyseNextHop();
+    void resetSnapshots();
+    void updateAnalysisState();
 
-    static_assert((numChannels * spectrumSize) <= SpectrumFFT::maxSpectrumSize, "Oh no");
+private:
+
+    // 2048 samples with the hop of 512 give ~21 Hz per bin
+    // and ~86 snapshots per second at 44.1 kHz:
+    static constexpr auto defaultFftOrder = 11;
+    static constexpr auto defaultNumOverlaps = 4;
+
+    static constexpr auto numChannels = 2;
+    static constexpr auto analysisIntervalMs = 5;
+    static constexpr auto loudnessWindowMs = 400.0;
 
     static constexpr auto defaultSampleRate = 44100;
     static constexpr auto clipThreshold = 0.995f;
     static constexpr auto oversaturationThreshold = 0.5f;
     static constexpr auto oversaturationRate = 4.f;
 
-    Atomic<float> spectrum[numChannels][spectrumSize];
-    Atomic<float> peak[numChannels];
-    Atomic<float> rms[numChannels];
+    SpectrumFFT fft;
+
+    const int fftSize;
+    const int hopSize;
+
+    // written on the audio thread, read on the analysis thread:
+    AbstractFifo inputFifo;
+    AudioBuffer<float> inputBuffer;
+
+    // the analysis thread's own data:
+    AudioBuffer<float> history;
+    HeapBlock<float> spectrumBuffer;
+    float meanSquares[numChannels] = {};
+
+    struct Snapshot final
+    {
+        Atomic<float> spectrum[numChannels][SpectrumFFT::maxNumBins];
+        Atomic<float> peak[numChannels];
+        Atomic<float> rms[numChannels];
+        Atomic<float> meanSquare[numChannels];
+    };
+
+    // the analysis thread fills the back snapshot and then flips them,
+    // so the readers always see the complete results of the last hop:
+    Snapshot snapshots[2];
+    Atomic<int> frontSnapshot = 0;
+
+    Atomic<int> numSubscribers = 0;
+    Atomic<int> numSpectrumSubscribers = 0;
+    Atomic<bool> isAnalysing = false;
 
     Atomic<double> sampleRate = defaultSampleRate;
 
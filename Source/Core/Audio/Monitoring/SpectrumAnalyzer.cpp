@@ -18,141 +18,195 @@
 #include "Common.h"
 #include "SpectrumAnalyzer.h"
 
-SpectrumFFT::SpectrumFFT()
+SpectrumFFT::SpectrumFFT(int order) :
+    order(jlimit(SpectrumFFT::minOrder, SpectrumFFT::maxOrder, order)),
+    size(1 << this->order)
 {
-    for (int count = 0; count < SpectrumFFT::cosTableSize; count++)
+    jassert(order == this->order);
+
+    this->window.malloc(this->size);
+    this->reversedIndices.malloc(this->size);
+    this->twiddlesRe.malloc(this->size);
+    this->twiddlesIm.malloc(this->size);
+    this->re.malloc(this->size);
+    this->im.malloc(this->size);
+
+    // the Hann window, also scaled by 1/N, so that
+    // the magnitudes don't depend on the size
+    for (int i = 0; i < this->size; ++i)
     {
-        this->costab[count] = cosf(MathConstants<float>::halfPi *
-            static_cast<float>(count) / static_cast<float>(SpectrumFFT::cosTableSize));
+        const auto phase = MathConstants<double>::twoPi * double(i) / double(this->size);
+        this->window[i] = float(0.5 * (1.0 - cos(phase)) / double(this->size));
     }
-}
 
-inline float SpectrumFFT::cosine(float x) const noexcept
-{
-    int y;
-    
-    x *= SpectrumFFT::tableRange;
-    y = static_cast<int>(x);
-    if (y < 0)
+    for (int i = 0; i < this->size; ++i)
     {
-        y = -y;
+        int reversed = 0;
+        for (int bit = 0; bit < this->order; ++bit)
+        {
+            reversed = (reversed << 1) | ((i >> bit) & 1);
+        }
+
+        this->reversedIndices[i] = reversed;
     }
 
-    y &= SpectrumFFT::tableMask;
-    switch (y >> SpectrumFFT::cosTableBits)
+    for (int span = 1; span < this->size; span <<= 1)
     {
-        case 0 : return  this->costab[y];
-        case 1 : return -this->costab[(SpectrumFFT::cosTableSize - 1) - (y - (SpectrumFFT::cosTableSize * 1))];
-        case 2 : return -this->costab[                                  (y - (SpectrumFFT::cosTableSize * 2))];
-        case 3 : return  this->costab[(SpectrumFFT::cosTableSize - 1) - (y - (SpectrumFFT::cosTableSize * 3))];
+        for (int j = 0; j < span; ++j)
+        {
+            const auto phase = MathConstants<double>::pi * double(j) / double(span);
+            this->twiddlesRe[span - 1 + j] = float(cos(phase));
+            this->twiddlesIm[span - 1 + j] = float(-sin(phase));
+        }
     }
-    
-    return 0.f;
 }
 
-inline float SpectrumFFT::sine(float x) const noexcept
+int SpectrumFFT::getSize() const noexcept
+{
+    return this->size;
+}
+
+int SpectrumFFT::getNumBins() const noexcept
 {
-    return this->cosine(x - 0.25f);
+    return this->size / 2;
 }
 
-inline unsigned int SpectrumFFT::reverse(unsigned int val, int bits) const noexcept
+void SpectrumFFT::computeSpectrum(const float *samples, float *outSpectrum) noexcept
 {
-    unsigned int retn = 0;
-    
-    while (bits--)
+    // the input goes in the bit-reversed order, so the output is in the natural one:
+    for (int i = 0; i < this->size; ++i)
+    {
+        const auto j = this->reversedIndices[i];
+        this->re[j] = samples[i] * this->window[i];
+    }
+
+    FloatVectorOperations::clear(this->im, this->size);
+
+    this->process();
+
+    const auto numBins = this->getNumBins();
+    FloatVectorOperations::multiply(this->re, this->re, numBins);
+    FloatVectorOperations::multiply(this->im, this->im, numBins);
+    FloatVectorOperations::add(this->re, this->im, numBins);
+
+    for (int i = 0; i < numBins; ++i)
     {
-        retn <<= 1;
-        retn |= (val & 1);
-        val >>= 1;
+        outSpectrum[i] = sqrtf(this->re[i]);
     }
-    
-    return (retn);
+
+    // the same scale as the displays have always used:
+    FloatVectorOperations::multiply(outSpectrum, 2.5f, numBins);
+    FloatVectorOperations::min(outSpectrum, outSpectrum, 1.f, numBins);
 }
 
-inline void SpectrumFFT::process(int bits)
+void SpectrumFFT::process() noexcept
 {
-    int count, count2, count3;
-    int fftlen = 1 << bits;
-    unsigned i1 = fftlen / 2;
-    int i2 = 1, i3, i4, y;
-    float a1, a2, b1, b2, z1, z2;
-    float oneOverN = 1.0f / fftlen;
-    
-    for (count = 0; count < bits; count++)
+    float *const real = this->re;
+    float *const imag = this->im;
+
+    for (int span = 1; span < this->size; span <<= 1)
     {
-        i3 = 0;
-        i4 = i1;
-        
-        for (count2 = 0; count2 < i2; count2++)
+        const float *const wRe = this->twiddlesRe + span - 1;
+        const float *const wIm = this->twiddlesIm + span - 1;
+
+        for (int start = 0; start < this->size; start += (span << 1))
         {
-            y  = this->reverse(i3 / static_cast<int>(i1), bits);
-            z1 = this->cosine(static_cast<float>(y) * oneOverN);
-            z2 = -this->sine(static_cast<float>(y) * oneOverN);
+            float *const aRe = real + start;
+            float *const aIm = imag + start;
+            float *const bRe = real + start + span;
+            float *const bIm = imag + start + span;
 
-            for (count3 = i3; count3 < i4; count3++)
+            for (int j = 0; j < span; ++j)
             {
-                a1 = this->buffer[count3].re;
-                a2 = this->buffer[count3].im;
-                
-                b1 = (z1 * this->buffer[count3 + i1].re) - (z2 * this->buffer[count3 + i1].im);
-                b2 = (z2 * this->buffer[count3 + i1].re) + (z1 * this->buffer[count3 + i1].im);
-                
-                this->buffer[count3].re = a1 + b1;
-                this->buffer[count3].im = a2 + b2;
-                
-                this->buffer[count3 + i1].re = a1 - b1;
-                this->buffer[count3 + i1].im = a2 - b2;
+                const auto tRe = bRe[j] * wRe[j] - bIm[j] * wIm[j];
+                const auto tIm = bRe[j] * wIm[j] + bIm[j] * wRe[j];
+                bRe[j] = aRe[j] - tRe;
+                bIm[j] = aIm[j] - tIm;
+                aRe[j] += tRe;
+                aIm[j] += tIm;
             }
-            
-            i3 += (i1 << 1);
-            i4 += (i1 << 1);
         }
-        
-        i1 >>= 1;
-        i2 <<= 1;
     }
 }
 
-void SpectrumFFT::computeSpectrum(float *pcmBuffer,
-    unsigned int pcmPosition, unsigned int pcmLength,
-    Atomic<float> *spectrum, int length,
-    int channel, int numchannels)
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class SpectrumFFTTests final : public UnitTest
 {
-    int count, bits, bitslength, nyquist;
-    
-    bitslength = length;
-    bits = 0;
-    while (bitslength > 1)
-    {
-        bitslength >>= 1;
-        bits++;
-    }
-    
-    // Apply Hanning window
-    for (count = 0; count < length; count++)
+public:
+
+    SpectrumFFTTests() : UnitTest("Spectrum FFT tests", UnitTestCategories::helio) {}
+
+    void runTest() override
     {
-        const float percent = static_cast<float>(count) / static_cast<float>(length);
-        const float window = 0.5f * (1.0f  - this->cosine(percent));
-        
-        this->buffer[count].re = pcmBuffer[pcmPosition] * window;
-        this->buffer[count].re /= static_cast<float>(length);
-        this->buffer[count].im = 0.00000001f;
-        
-        pcmPosition++;
-        if (pcmPosition >= pcmLength)
+        beginTest("Matching the discrete Fourier transform");
+
+        Random random(123);
+        for (int order = SpectrumFFT::minOrder; order <= 9; ++order)
         {
-            pcmPosition = 0;
+            SpectrumFFT fft(order);
+            const auto size = fft.getSize();
+
+            HeapBlock<float> samples(size);
+            for (int i = 0; i < size; ++i)
+            {
+                samples[i] = random.nextFloat() * 2.f - 1.f;
+            }
+
+            HeapBlock<float> spectrum(fft.getNumBins());
+            fft.computeSpectrum(samples, spectrum);
+
+            for (int bin = 0; bin < fft.getNumBins(); ++bin)
+            {
+                double sumRe = 0.0;
+                double sumIm = 0.0;
+                for (int i = 0; i < size; ++i)
+                {
+                    const auto window = 0.5 * (1.0 -
+                        cos(MathConstants<double>::twoPi * i / size)) / size;
+                    const auto phase = MathConstants<double>::twoPi * bin * i / size;
+                    sumRe += samples[i] * window * cos(phase);
+                    sumIm -= samples[i] * window * sin(phase);
+                }
+
+                const auto expected = jmin(1.0, 2.5 * sqrt(sumRe * sumRe + sumIm * sumIm));
+                expectWithinAbsoluteError(double(spectrum[bin]), expected, 0.0001);
+            }
         }
-    }
 
-    this->process(bits);
+        beginTest("Finding the frequency of a sine");
 
-    nyquist = (length / 2);
-    for (count = 0; count < (nyquist - 1); ++count)
-    {
-        const auto n = this->reverse(count, bits);
-        spectrum[count] = jmin(1.0f, 2.5f *
-            (sqrtf((this->buffer[n].re * this->buffer[n].re)
-                + (this->buffer[n].im * this->buffer[n].im))));
+        SpectrumFFT fft(10);
+        HeapBlock<float> samples(fft.getSize());
+        HeapBlock<float> spectrum(fft.getNumBins());
+
+        for (const int bin : { 3, 40, 255, 500 })
+        {
+            for (int i = 0; i < fft.getSize(); ++i)
+            {
+                samples[i] = float(sin(MathConstants<double>::twoPi * bin * i / fft.getSize()));
+            }
+
+            fft.computeSpectrum(samples, spectrum);
+
+            int loudestBin = 0;
+            for (int i = 1; i < fft.getNumBins(); ++i)
+            {
+                if (spectrum[i] > spectrum[loudestBin])
+                {
+                    loudestBin = i;
+                }
+            }
+
+            expectEquals(loudestBin, bin);
+        }
     }
-}
+};
+
+static SpectrumFFTTests spectrumFFTTests;
+
+#endif
@@ -17,40 +17,45 @@
 
 #pragma once
 
+// A radix-2 FFT of a real signal for the spectrum displays, which has
+// all the tables precomputed for the given size; the data is kept in
+// separate real and imaginary arrays, and the twiddle factors of each
+// stage are stored contiguously, so that all the inner loops run over
+// adjacent memory and can be vectorized by the compiler
+
 class SpectrumFFT final
 {
 public:
     
-    SpectrumFFT();
-    
-    void computeSpectrum(float *pcmBuffer,
-        unsigned int pcmPosition, unsigned int pcmLength,
-        Atomic<float> *spectrum, int length,
-        int channel, int numchannels);
+    explicit SpectrumFFT(int order);
+
+    int getSize() const noexcept;
+    int getNumBins() const noexcept;
 
-    // please make sure no consumer ever asks for a spectrum larger than that:
-    static constexpr auto maxSpectrumSize = 512;
+    // applies the Hann window to getSize() samples
+    // and writes getNumBins() magnitudes, clamped to [0, 1]
+    void computeSpectrum(const float *samples, float *outSpectrum) noexcept;
+
+    static constexpr auto minOrder = 6;
+    static constexpr auto maxOrder = 12;
+    static constexpr auto maxNumBins = (1 << SpectrumFFT::maxOrder) / 2;
 
 private:
 
-    static constexpr auto cosTableBits = 13;
-    static constexpr auto cosTableSize = 1 << cosTableBits;
-    static constexpr auto tableRange = cosTableSize * 4;
-    static constexpr auto tableMask = tableRange - 1;
+    void process() noexcept;
+
+    const int order;
+    const int size;
+
+    HeapBlock<float> window;
+    HeapBlock<int> reversedIndices;
+
+    // for the stage with the butterfly span of n, the twiddles start at n - 1:
+    HeapBlock<float> twiddlesRe;
+    HeapBlock<float> twiddlesIm;
+
+    HeapBlock<float> re;
+    HeapBlock<float> im;
 
-    struct FftComplex final
-    {
-        float re = 0.f;
-        float im = 0.f;
-    };
-    
-    FftComplex buffer[maxSpectrumSize];
-    float costab[cosTableSize];
-    
-    inline float cosine(float x) const noexcept;
-    inline float sine(float x) const noexcept;
-    inline unsigned int reverse(unsigned int val, int bits) const noexcept;
-    inline void process(int bits);
-    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumFFT);
 };
@@ -0,0 +1,308 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "ParallelAudioCallback.h"
+
+ParallelAudioCallback::ParallelAudioCallback()
+{
+    // the audio thread processes the jobs as well, so one core is taken
+    const auto numWorkers = jlimit(0, ParallelAudioCallback::maxNumWorkers,
+        SystemStats::getNumCpus() - 1);
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto *worker = this->workers.add(new Worker(*this));
+        worker->startThread(10);
+    }
+}
+
+ParallelAudioCallback::~ParallelAudioCallback()
+{
+    for (auto *worker : this->workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->wakeUp();
+    }
+
+    for (auto *worker : this->workers)
+    {
+        worker->stopThread(1000);
+    }
+
+    this->workers.clear();
+}
+
+int ParallelAudioCallback::getNumWorkers() const noexcept
+{
+    return this->workers.size();
+}
+
+//===----------------------------------------------------------------------===//
+// Callbacks management, called from the message thread
+//===----------------------------------------------------------------------===//
+
+void ParallelAudioCallback::addCallback(AudioIODeviceCallback *callback)
+{
+    jassert(callback != nullptr);
+
+    AudioIODevice *device = nullptr;
+
+    {
+        const ScopedLock sl(this->lock);
+
+        for (const auto *job : this->jobs)
+        {
+            if (job->callback == callback)
+            {
+                return;
+            }
+        }
+
+        device = this->currentDevice;
+    }
+
+    auto job = make<Job>();
+    job->callback = callback;
+
+    // same as AudioDeviceManager does, prepare it before the first block,
+    // and do that outside the lock, since preparing plugins may take a while:
+    if (device != nullptr)
+    {
+        callback->audioDeviceAboutToStart(device);
+    }
+
+    const ScopedLock sl(this->lock);
+    this->prepareJob(*job);
+    this->jobs.add(job.release());
+}
+
+void ParallelAudioCallback::removeCallback(AudioIODeviceCallback *callback)
+{
+    UniquePointer<Job> removedJob;
+    AudioIODevice *device = nullptr;
+
+    {
+        const ScopedLock sl(this->lock);
+
+        for (int i = 0; i < this->jobs.size(); ++i)
+        {
+            if (this->jobs.getUnchecked(i)->callback == callback)
+            {
+                removedJob.reset(this->jobs.removeAndReturn(i));
+                break;
+            }
+        }
+
+        device = this->currentDevice;
+    }
+
+    if (removedJob != nullptr && device != nullptr)
+    {
+        callback->audioDeviceStopped();
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// AudioIODeviceCallback
+//===----------------------------------------------------------------------===//
+
+void ParallelAudioCallback::audioDeviceIOCallback(const float **inputChannelData,
+    int numInputChannels, float **outputChannelData,
+    int numOutputChannels, int numSamples)
+{
+    const ScopedLock sl(this->lock);
+
+    const auto numJobs = this->jobs.size();
+
+    if (numJobs == 0)
+    {
+        for (int i = 0; i < numOutputChannels; ++i)
+        {
+            FloatVectorOperations::clear(outputChannelData[i], numSamples);
+        }
+
+        return;
+    }
+
+    if (numJobs == 1)
+    {
+        // nothing to parallelize
+        this->jobs.getUnchecked(0)->callback->audioDeviceIOCallback(inputChannelData,
+            numInputChannels, outputChannelData, numOutputChannels, numSamples);
+        return;
+    }
+
+    for (auto *job : this->jobs)
+    {
+        // only re-allocates if the device has changed the block size on the fly
+        job->outputBuffer.setSize(numOutputChannels, numSamples, false, false, true);
+    }
+
+    this->blockInputs = inputChannelData;
+    this->blockNumInputs = numInputChannels;
+    this->blockNumOutputs = numOutputChannels;
+    this->blockNumSamples = numSamples;
+    this->blockNumJobs = numJobs;
+    this->numFinishedJobs = 0;
+    this->blockFinished.reset();
+
+    // publishes all of the above to the workers:
+    this->numRemainingJobs = numJobs;
+
+    const auto numWorkersToWakeUp = jmin(numJobs - 1, this->workers.size());
+    for (int i = 0; i < numWorkersToWakeUp; ++i)
+    {
+        this->workers.getUnchecked(i)->wakeUp();
+    }
+
+    this->processPendingJobs();
+
+    // nothing is left in the queue, but the last jobs may still be
+    // processed by the workers, and whoever finishes the last one signals;
+    // the timeout only guards against sleeping through a missed signal
+    while (this->numFinishedJobs.get() < numJobs)
+    {
+        this->blockFinished.wait(1);
+    }
+
+    for (int channel = 0; channel < numOutputChannels; ++channel)
+    {
+        auto *output = outputChannelData[channel];
+        FloatVectorOperations::copy(output,
+            this->jobs.getUnchecked(0)->outputBuffer.getReadPointer(channel), numSamples);
+
+        for (int i = 1; i < numJobs; ++i)
+        {
+            FloatVectorOperations::add(output,
+                this->jobs.getUnchecked(i)->outputBuffer.getReadPointer(channel), numSamples);
+        }
+    }
+}
+
+void ParallelAudioCallback::audioDeviceAboutToStart(AudioIODevice *device)
+{
+    Array<AudioIODeviceCallback *> callbacks;
+
+    {
+        const ScopedLock sl(this->lock);
+
+        this->currentDevice = device;
+        this->numOutputChannels = device->getActiveOutputChannels().countNumberOfSetBits();
+        this->blockSize = device->getCurrentBufferSizeSamples();
+
+        for (auto *job : this->jobs)
+        {
+            this->prepareJob(*job);
+            callbacks.add(job->callback);
+        }
+    }
+
+    // the callbacks added after this point see the new device
+    // and prepare themselves in addCallback()
+    for (auto *callback : callbacks)
+    {
+        callback->audioDeviceAboutToStart(device);
+    }
+}
+
+void ParallelAudioCallback::audioDeviceStopped()
+{
+    Array<AudioIODeviceCallback *> callbacks;
+
+    {
+        const ScopedLock sl(this->lock);
+
+        this->currentDevice = nullptr;
+
+        for (const auto *job : this->jobs)
+        {
+            callbacks.add(job->callback);
+        }
+    }
+
+    for (auto *callback : callbacks)
+    {
+        callback->audioDeviceStopped();
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Jobs
+//===----------------------------------------------------------------------===//
+
+void ParallelAudioCallback::prepareJob(Job &job)
+{
+    job.outputBuffer.setSize(this->numOutputChannels, this->blockSize);
+    job.outputBuffer.clear();
+}
+
+// called by both the audio thread and the workers
+void ParallelAudioCallback::processPendingJobs() noexcept
+{
+    while (true)
+    {
+        // the counter goes below zero when there's nothing left,
+        // and is only reset when the next block starts:
+        const auto jobIndex = --this->numRemainingJobs;
+        if (jobIndex < 0)
+        {
+            return;
+        }
+
+        this->processJob(*this->jobs.getUnchecked(jobIndex));
+
+        if (++this->numFinishedJobs == this->blockNumJobs)
+        {
+            this->blockFinished.signal();
+        }
+    }
+}
+
+void ParallelAudioCallback::processJob(Job &job) noexcept
+{
+    job.callback->audioDeviceIOCallback(this->blockInputs, this->blockNumInputs,
+        job.outputBuffer.getArrayOfWritePointers(), this->blockNumOutputs, this->blockNumSamples);
+}
+
+//===----------------------------------------------------------------------===//
+// Worker
+//===----------------------------------------------------------------------===//
+
+ParallelAudioCallback::Worker::Worker(ParallelAudioCallback &owner) :
+    Thread("ParallelAudioWorker"),
+    owner(owner) {}
+
+void ParallelAudioCallback::Worker::wakeUp() noexcept
+{
+    this->blockStarted.signal();
+}
+
+void ParallelAudioCallback::Worker::run()
+{
+    while (!this->threadShouldExit())
+    {
+        this->blockStarted.wait();
+
+        if (this->threadShouldExit())
+        {
+            return;
+        }
+
+        this->owner.processPendingJobs();
+    }
+}
@@ -0,0 +1,101 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// The single device callback which runs all instruments' callbacks
+// in parallel: each instrument renders into its own buffer, and then
+// all the buffers are summed into the device output, same as
+// AudioDeviceManager does with separately registered callbacks.
+//
+// The pool of worker threads is fixed and started once; for each block,
+// the audio thread wakes up as many workers as needed, and then all of them
+// (including the audio thread itself) keep grabbing the next unprocessed
+// instrument from a shared atomic counter until none are left, so that
+// a thread stuck with a heavy synth never holds up the others, and no locks
+// are taken in between; the audio thread then waits for the last job to finish.
+
+class ParallelAudioCallback final : public AudioIODeviceCallback
+{
+public:
+
+    ParallelAudioCallback();
+    ~ParallelAudioCallback() override;
+
+    void addCallback(AudioIODeviceCallback *callback);
+    void removeCallback(AudioIODeviceCallback *callback);
+
+    void audioDeviceIOCallback(const float **, int, float **, int, int) override;
+    void audioDeviceAboutToStart(AudioIODevice *) override;
+    void audioDeviceStopped() override;
+
+    int getNumWorkers() const noexcept;
+
+    static constexpr auto maxNumWorkers = 16;
+
+private:
+
+    struct Job final
+    {
+        AudioIODeviceCallback *callback = nullptr;
+        AudioBuffer<float> outputBuffer;
+    };
+
+    class Worker final : public Thread
+    {
+    public:
+
+        explicit Worker(ParallelAudioCallback &owner);
+
+        void wakeUp() noexcept;
+        void run() override;
+
+    private:
+
+        ParallelAudioCallback &owner;
+        WaitableEvent blockStarted;
+
+        JUCE_DECLARE_NON_COPYABLE(Worker)
+    };
+
+    void prepareJob(Job &job);
+    void processPendingJobs() noexcept;
+    void processJob(Job &job) noexcept;
+
+    CriticalSection lock;
+    OwnedArray<Job> jobs;
+    OwnedArray<Worker> workers;
+
+    AudioIODevice *currentDevice = nullptr;
+    int numOutputChannels = 0;
+    int blockSize = 0;
+
+    // the current block's parameters, written by the audio thread
+    // before it resets the jobs counter, and only read by the workers
+    // which have grabbed a valid job index after that:
+    const float **blockInputs = nullptr;
+    int blockNumInputs = 0;
+    int blockNumOutputs = 0;
+    int blockNumSamples = 0;
+    int blockNumJobs = 0;
+
+    Atomic<int> numRemainingJobs = 0;
+    Atomic<int> numFinishedJobs = 0;
+    WaitableEvent blockFinished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParallelAudioCallback)
+};
@@ -137,9 +137,10 @@ void MidiRecorder::onStop()
 
         this->isRecording = false;
 
-        // fixme handle buffers?
-        jassert(this->noteOnsBuffer.isEmpty());
-        jassert(this->noteOffsBuffer.isEmpty());
+        // the input callback is removed, so nothing
+        // can be added to the fifo; record the leftovers:
+        this->cancelPendingUpdate();
+        this->handleAsyncUpdate();
 
         this->holdingNotes.clear();
     }
@@ -173,8 +174,7 @@ static SerializedData createPianoTrackTemplate(const String &name,
 // the main recording logic goes here:
 void MidiRecorder::handleAsyncUpdate()
 {
-    if (this->noteOnsBuffer.isEmpty() &&
-        this->noteOffsBuffer.isEmpty())
+    if (this->inputFifo.getNumReady() == 0)
     {
         // nothing to do
         return;
@@ -233,76 +233,97 @@ void MidiRecorder::handleAsyncUpdate()
         this->activeClip = this->activeTrack->getPattern()->getUnchecked(0);
         this->shouldCheckpoint = false;
     }
-    
-    // handle note offs and fill unhandledNoteOffs
-    while (!this->noteOffsBuffer.isEmpty())
+
+    this->recordPendingEvents();
+}
+
+void MidiRecorder::recordPendingEvents()
+{
+    int start1, size1, start2, size2;
+    this->inputFifo.prepareToRead(this->inputFifo.getNumReady(),
+        start1, size1, start2, size2);
+
+    // the events come in the order they were received,
+    // so each note-off always follows its note-on:
+    for (int i = 0; i < size1 + size2; ++i)
     {
-        const auto last = this->noteOffsBuffer.size() - 1;
-        const auto i = this->noteOffsBuffer.removeAndReturn(last);
-        const bool wasHandled = this->finaliseHoldingNote(i.getNoteNumber());
-        if (!wasHandled)
+        const auto &event = this->inputEvents[i < size1 ? start1 + i : start2 + i - size1];
+        if (event.isNoteOn)
+        {
+            this->startHoldingNote(event.key, event.velocity, event.beat);
+        }
+        else
         {
-            this->unhandledNoteOffs.add(i);
+            this->finaliseHoldingNote(event.key, event.beat);
         }
     }
 
-    // handle note ons
-    while (!this->noteOnsBuffer.isEmpty())
-    {
-        const auto last = this->noteOnsBuffer.size() - 1;
-        const auto i = this->noteOnsBuffer.removeAndReturn(last);
-        this->startHoldingNote(i);
-    }
+    this->inputFifo.finishedRead(size1 + size2);
 
-    // handle unhandledNoteOffs and clean
-    for (const auto &i : this->unhandledNoteOffs)
+    const auto numDropped = this->numDroppedEvents.exchange(0);
+    if (numDropped > 0)
     {
-        this->finaliseHoldingNote(i.getNoteNumber());
+        DBG("MidiRecorder: the input fifo is full, dropped " + String(numDropped) + " events");
     }
-
-    this->unhandledNoteOffs.clearQuick();
 }
 
-struct SortMidiMessagesByTimestamp final
-{
-    static int compareElements(const MidiMessage &first, const MidiMessage &second)
-    {
-        return int(first.getTimeStamp() - second.getTimeStamp());
-    }
-};
-
-static SortMidiMessagesByTimestamp tsSort;
-
 // called from the high-priority system thread:
 void MidiRecorder::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
 {
-    if (message.isNoteOn())
+    if (!message.isNoteOnOrOff())
     {
-        this->noteOnsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        return;
     }
-    else if (message.isNoteOff())
+
+    // the drivers stamp the messages with the hi-res counter as they arrive,
+    // which is more accurate than the moment this callback is called:
+    const auto timeMs = message.getTimeStamp() > 0.0 ?
+        message.getTimeStamp() * 1000.0 : Time::getMillisecondCounterHiRes();
+
+    int start1, size1, start2, size2;
+    this->inputFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
     {
-        this->noteOffsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        this->numDroppedEvents += 1;
+        this->triggerAsyncUpdate();
+        return;
     }
 
+    auto &event = this->inputEvents[size1 > 0 ? start1 : start2];
+    event.beat = this->getPositionAt(timeMs);
+    event.key = message.getNoteNumber();
+    event.velocity = float(message.getVelocity()) / 128.f;
+    event.isNoteOn = message.isNoteOn();
+
+    this->inputFifo.finishedWrite(1);
     this->triggerAsyncUpdate();
 }
 
-// current beat, estimated since the last known
-// midi event, including the tempo change events:
 double MidiRecorder::getEstimatedPosition() const
+{
+    return this->getPositionAt(Time::getMillisecondCounterHiRes());
+}
+
+// the beat at the given time, taken from the audio clock while playing,
+// or estimated since the last known position, if the player has not
+// started rendering yet; safe to call from the MIDI input thread
+double MidiRecorder::getPositionAt(double timeMs) const
 {
     if (!this->isPlaying.get())
     {
         return this->lastCorrectPosition.get();
     }
 
-    const double timeOffsetMs = Time::getMillisecondCounterHiRes() - this->lastUpdateTime.get();
+    double beat = 0.0;
+    if (this->getTransport().getBeatAtTime(timeMs, beat))
+    {
+        return beat;
+    }
+
+    const double timeOffsetMs = timeMs - this->lastUpdateTime.get();
     const double positionOffset = timeOffsetMs / this->msPerQuarterNote.get();
-    const double estimatedPosition = this->lastCorrectPosition.get() + positionOffset;
-    return estimatedPosition;
+    return this->lastCorrectPosition.get() + positionOffset;
 }
 
 void MidiRecorder::timerCallback()
@@ -317,24 +338,22 @@ void MidiRecorder::timerCallback()
 // Helpers
 //===----------------------------------------------------------------------===//
 
-void MidiRecorder::startHoldingNote(MidiMessage message)
+void MidiRecorder::startHoldingNote(int key, float velocity, double beat)
 {
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
-    const auto key = message.getNoteNumber();
-    
     if (this->holdingNotes.contains(key))
     {
         DBG("Found weird note-on/note-off order");
-        this->finaliseHoldingNote(key);
+        this->finaliseHoldingNote(key, beat);
     }
 
     const Note noteParams(this->activeTrack->getSequence(),
         key - this->activeClip->getKey(),
-        roundBeat(float(message.getTimeStamp()) - this->activeClip->getBeat()),
+        roundBeat(float(beat) - this->activeClip->getBeat()),
         Globals::minNoteLength,
-        float(message.getVelocity()) / 128.f);
+        velocity);
 
     this->getPianoSequence()->insert(noteParams, true);
     this->holdingNotes[key] = noteParams;
@@ -383,13 +402,12 @@ void MidiRecorder::finaliseAllHoldingNotes()
     this->holdingNotes.clear();
 }
 
-bool MidiRecorder::finaliseHoldingNote(int key)
+bool MidiRecorder::finaliseHoldingNote(int key, double beat)
 {
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
-    const auto currentBeat =
-        float(this->getEstimatedPosition() - this->activeClip->getBeat());
+    const auto currentBeat = float(beat - this->activeClip->getBeat());
 
     if (this->holdingNotes.contains(key))
     {
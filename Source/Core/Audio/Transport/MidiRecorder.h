@@ -85,17 +85,35 @@ private:
 
     PianoSequence *getPianoSequence() const;
 
-    Array<MidiMessage, CriticalSection> noteOnsBuffer;
-    Array<MidiMessage, CriticalSection> noteOffsBuffer;
-    Array<MidiMessage> unhandledNoteOffs;
+    // the events received on the MIDI input thread, which are recorded
+    // later on the message thread; the fifo is wait-free for one writer
+    // and one reader, so the input callback never locks or allocates
+    struct InputEvent final
+    {
+        double beat;
+        int key;
+        float velocity;
+        bool isNoteOn;
+    };
+
+    // enough for a few seconds of the densest input
+    // the message thread may ever need to catch up with:
+    static constexpr auto inputFifoSize = 4096;
+
+    AbstractFifo inputFifo { MidiRecorder::inputFifoSize };
+    HeapBlock<InputEvent> inputEvents { MidiRecorder::inputFifoSize };
+    Atomic<int> numDroppedEvents = 0;
+
+    void recordPendingEvents();
 
     FlatHashMap<int, Note> holdingNotes;
-    void startHoldingNote(MidiMessage message);
+    void startHoldingNote(int key, float velocity, double beat);
     void updateLengthsOfHoldingNotes() const;
     void finaliseAllHoldingNotes();
-    bool finaliseHoldingNote(int key);
+    bool finaliseHoldingNote(int key, double beat);
 
     double getEstimatedPosition() const;
+    double getPositionAt(double timeMs) const;
 
     // no need for updating too often, I guess:
     static constexpr auto updateTimeHz = 15;
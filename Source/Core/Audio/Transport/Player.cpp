@@ -0,0 +1,460 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "Player.h"
+
+Player::Player(Transport &transport) :
+    transport(transport) {}
+
+Player::~Player()
+{
+    this->stopPlayback();
+}
+
+//===----------------------------------------------------------------------===//
+// Playback control, called from the message thread
+//===----------------------------------------------------------------------===//
+
+void Player::startPlayback(float startBeat, float rewindBeat, float endBeat, bool loopMode)
+{
+    this->stopPlayback();
+
+    auto context = this->transport.fillPlaybackContextAt(startBeat);
+    context->endBeat = endBeat;
+    context->rewindBeat = rewindBeat;
+    // a zero-length loop would make the player rewind forever:
+    context->playbackLoopMode = loopMode && (endBeat > rewindBeat);
+
+    auto newState = make<PlaybackState>(this->transport.getPlaybackCache());
+    newState->context = context;
+    newState->currentBeat = startBeat;
+    newState->msPerBeat = context->startBeatTempo;
+
+    newState->sequences.seekToTime(startBeat - context->projectFirstBeat);
+    newState->hasNextMessage = newState->sequences.getNextMessage(newState->nextMessage);
+
+    // all allocations are done here, so that the audio thread doesn't have to:
+    for (auto *instrument : newState->sequences.getUniqueInstruments())
+    {
+        auto *slot = newState->slots.add(new InstrumentSlot());
+        slot->instrument = instrument;
+        slot->midiBuffer.ensureSize(Player::midiBufferPreallocatedSize);
+    }
+
+    // enough for every key on every channel of every instrument to be held at once
+    newState->maxHoldingNotes = newState->slots.size() *
+        Globals::numChannels * Globals::twelveToneKeyboardSize;
+    newState->holdingNotes.malloc(jmax(1, newState->maxHoldingNotes));
+
+    this->currentBeat = startBeat;
+    this->currentTempo = context->startBeatTempo;
+    this->hasReachedEnd = false;
+
+    // no audio thread is running the old state at this point,
+    // so this is the only writer of the clock until the first block:
+    this->publishAudioClock(startBeat, context->startBeatTempo);
+
+    this->lastBroadcastBeat = startBeat;
+    this->lastBroadcastTempo = context->startBeatTempo;
+    this->startBeatTimeMs = context->startBeatTimeMs;
+    this->totalTimeMs = context->totalTimeMs;
+
+    // let listeners know about the tempo before the playback starts
+    this->transport.broadcastTempoChanged(context->startBeatTempo);
+    this->transport.broadcastSeek(startBeat, this->startBeatTimeMs, this->totalTimeMs);
+
+    Array<Instrument *> instruments;
+    for (const auto *slot : newState->slots)
+    {
+        instruments.add(slot->instrument);
+    }
+
+    {
+        const SpinLock::ScopedLockType lock(this->stateLock);
+        this->state = move(newState);
+    }
+
+    for (auto *instrument : instruments)
+    {
+        instrument->getProcessorPlayer().setPlayer(this);
+    }
+
+    this->isPlaybackRunning = true;
+    this->startTimer(Player::timerTickMs);
+}
+
+void Player::stopPlayback()
+{
+    this->stopTimer();
+    this->isPlaybackRunning = false;
+
+    UniquePointer<PlaybackState> oldState;
+
+    {
+        const SpinLock::ScopedLockType lock(this->stateLock);
+        oldState = move(this->state);
+    }
+
+    if (oldState == nullptr)
+    {
+        return;
+    }
+
+    // after this, no audio callback can be in the middle of renderNextBlock,
+    // because setPlayer() waits for the callback lock:
+    for (const auto *slot : oldState->slots)
+    {
+        slot->instrument->getProcessorPlayer().setPlayer(nullptr);
+    }
+
+    if (!oldState->hasFinished)
+    {
+        this->sendHoldingNotesOffAndMidiStopNow(*oldState);
+    }
+}
+
+bool Player::isPlaying() const noexcept
+{
+    return this->isPlaybackRunning.get();
+}
+
+bool Player::getBeatAtTime(double timeMs, double &outBeat) const noexcept
+{
+    if (!this->isPlaybackRunning.get())
+    {
+        return false;
+    }
+
+    uint32 version = 0;
+    double beat = 0.0;
+    double blockTimeMs = 0.0;
+    double msPerBeat = 0.0;
+
+    do
+    {
+        version = this->clockVersion.get();
+        beat = this->clockBeat.get();
+        blockTimeMs = this->clockTimeMs.get();
+        msPerBeat = this->clockMsPerBeat.get();
+    } while ((version & 1) != 0 || version != this->clockVersion.get());
+
+    outBeat = beat + (timeMs - blockTimeMs) / jmax(msPerBeat, 0.01);
+    return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Timer
+//===----------------------------------------------------------------------===//
+
+void Player::timerCallback()
+{
+    if (this->hasReachedEnd.get())
+    {
+        this->stopTimer();
+        this->transport.allNotesControllersAndSoundOff();
+        this->transport.stopRecording();
+        this->transport.stopPlayback();
+        return;
+    }
+
+    const auto tempo = this->currentTempo.get();
+    if (tempo != this->lastBroadcastTempo)
+    {
+        this->lastBroadcastTempo = tempo;
+        this->transport.broadcastTempoChanged(tempo);
+    }
+
+    const auto beat = this->currentBeat.get();
+    if (beat != this->lastBroadcastBeat)
+    {
+        this->lastBroadcastBeat = beat;
+        this->transport.broadcastSeek(beat, this->startBeatTimeMs, this->totalTimeMs);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Rendering, called from the audio thread
+//===----------------------------------------------------------------------===//
+
+void Player::renderNextBlock(const Instrument::AudioCallback *callback,
+    MidiBuffer &midiMessages, int numSamples, double sampleRate)
+{
+    const SpinLock::ScopedLockType lock(this->stateLock);
+
+    if (this->state == nullptr || sampleRate <= 0.0)
+    {
+        return;
+    }
+
+    auto *slot = this->findSlotFor(*this->state, callback);
+    if (slot == nullptr)
+    {
+        return;
+    }
+
+    // all instruments are called one by one for each block of the device,
+    // so if this one has already taken its events, a new block has started,
+    // and we render the events of all instruments at once, then each one
+    // picks its own part of them; this keeps the instruments in sync
+    // regardless of the order in which the device calls them
+    if (!slot->hasPendingBlock)
+    {
+        this->renderBlock(*this->state, numSamples, sampleRate);
+    }
+
+    midiMessages.addEvents(slot->midiBuffer, 0, numSamples, 0);
+    slot->midiBuffer.clear();
+    slot->hasPendingBlock = false;
+}
+
+void Player::renderBlock(PlaybackState &state, int numSamples, double sampleRate)
+{
+    for (auto *slot : state.slots)
+    {
+        slot->midiBuffer.clear();
+        slot->hasPendingBlock = true;
+    }
+
+    if (state.hasFinished)
+    {
+        return;
+    }
+
+    this->publishAudioClock(state.currentBeat, state.msPerBeat);
+
+    const auto &context = *state.context;
+
+    if (!state.hasStarted)
+    {
+        state.hasStarted = true;
+
+        for (auto *slot : state.slots)
+        {
+            slot->midiBuffer.addEvent(MidiMessage::midiStart(), 0);
+
+            for (int cc = 0; cc < Transport::PlaybackContext::numCCs; ++cc)
+            {
+                const auto ccState = context.ccStates[cc];
+                if (ccState < 0) // not present in any track
+                {
+                    continue;
+                }
+
+                for (int channel = 1; channel < Globals::numChannels; ++channel)
+                {
+                    slot->midiBuffer.addEvent(MidiMessage::controllerEvent(channel, cc, ccState), 0);
+                }
+            }
+        }
+    }
+
+    const auto firstBeat = double(context.projectFirstBeat);
+    const auto endBeat = double(context.endBeat);
+    const auto samplesPerMs = sampleRate * 0.001;
+
+    // the position within the current block, in samples
+    double blockPosition = 0.0;
+
+    while (true)
+    {
+        const auto nextMessageBeat = state.hasNextMessage ?
+            state.nextMessage.message.getTimeStamp() + firstBeat : endBeat;
+
+        const bool reachesEnd = !state.hasNextMessage ||
+            (context.playbackLoopMode && nextMessageBeat > endBeat);
+
+        const auto targetBeat = reachesEnd ? endBeat : nextMessageBeat;
+        const auto samplesPerBeat = state.msPerBeat * samplesPerMs;
+        const auto samplesToTarget = jmax(0.0, (targetBeat - state.currentBeat) * samplesPerBeat);
+
+        if (blockPosition + samplesToTarget >= double(numSamples))
+        {
+            state.currentBeat += (double(numSamples) - blockPosition) / samplesPerBeat;
+            break;
+        }
+
+        blockPosition += samplesToTarget;
+        state.currentBeat = jmax(state.currentBeat, targetBeat);
+        const auto sampleOffset = int(blockPosition);
+
+        if (!reachesEnd)
+        {
+            this->sendMessage(state, state.nextMessage, sampleOffset);
+            state.hasNextMessage = state.sequences.getNextMessage(state.nextMessage);
+            continue;
+        }
+
+        if (context.playbackLoopMode)
+        {
+            state.sequences.seekToTime(context.rewindBeat - firstBeat);
+            state.hasNextMessage = state.sequences.getNextMessage(state.nextMessage);
+            state.currentBeat = context.rewindBeat;
+            continue;
+        }
+
+        if (this->transport.isRecording())
+        {
+            // keep the transport running, while there's something to record
+            state.currentBeat += (double(numSamples) - blockPosition) / samplesPerBeat;
+            break;
+        }
+
+        this->sendHoldingNotesOffAndMidiStop(state, sampleOffset);
+        state.hasFinished = true;
+        this->hasReachedEnd = true;
+        break;
+    }
+
+    this->currentBeat = float(state.currentBeat);
+}
+
+void Player::publishAudioClock(double beat, double msPerBeat) noexcept
+{
+    this->clockVersion += 1;
+    this->clockBeat = beat;
+    this->clockTimeMs = Time::getMillisecondCounterHiRes();
+    this->clockMsPerBeat = msPerBeat;
+    this->clockVersion += 1;
+}
+
+void Player::sendMessage(PlaybackState &state,
+    const CachedMidiMessage &cached, int sampleOffset)
+{
+    const auto &message = cached.message;
+
+    // Master tempo event is sent to everybody (need to do that for drum-machines)
+    if (message.isTempoMetaEvent())
+    {
+        state.msPerBeat = message.getTempoSecondsPerQuarterNote() * 1000.0;
+        this->currentTempo = state.msPerBeat;
+
+        for (auto *slot : state.slots)
+        {
+            slot->midiBuffer.addEvent(message, sampleOffset);
+        }
+
+        return;
+    }
+
+    auto *slot = this->findSlotFor(state, cached.instrument);
+    if (slot == nullptr)
+    {
+        jassertfalse;
+        return;
+    }
+
+    if (message.isNoteOn())
+    {
+        // only possible with many overlapping notes of the same key;
+        // such a note is skipped rather than left hanging on stop
+        if (state.numHoldingNotes == state.maxHoldingNotes)
+        {
+            return;
+        }
+
+        state.holdingNotes[state.numHoldingNotes++] =
+            { message.getNoteNumber(), message.getChannel(), slot };
+    }
+    else if (message.isNoteOff())
+    {
+        for (int i = 0; i < state.numHoldingNotes; ++i)
+        {
+            const auto &holding = state.holdingNotes[i];
+            if (holding.key == message.getNoteNumber() &&
+                holding.channel == message.getChannel() &&
+                holding.slot == slot)
+            {
+                state.holdingNotes[i] = state.holdingNotes[--state.numHoldingNotes];
+                break;
+            }
+        }
+    }
+
+    slot->midiBuffer.addEvent(message, sampleOffset);
+}
+
+void Player::sendHoldingNotesOffAndMidiStop(PlaybackState &state, int sampleOffset)
+{
+    for (int i = 0; i < state.numHoldingNotes; ++i)
+    {
+        const auto &holding = state.holdingNotes[i];
+        holding.slot->midiBuffer.addEvent(MidiMessage::noteOff(holding.channel, holding.key, 0.f), sampleOffset);
+    }
+
+    state.numHoldingNotes = 0;
+
+    for (auto *slot : state.slots)
+    {
+        slot->midiBuffer.addEvent(MidiMessage::midiStop(), sampleOffset);
+    }
+}
+
+// when the playback is interrupted from the message thread,
+// the remaining events are sent via the instruments' message collectors
+void Player::sendHoldingNotesOffAndMidiStopNow(PlaybackState &state)
+{
+    const auto timeNow = Time::getMillisecondCounterHiRes() * 0.001;
+
+    for (int i = 0; i < state.numHoldingNotes; ++i)
+    {
+        const auto &holding = state.holdingNotes[i];
+        MidiMessage noteOff(MidiMessage::noteOff(holding.channel, holding.key, 0.f));
+        noteOff.setTimeStamp(timeNow);
+        holding.slot->instrument->getProcessorPlayer()
+            .getMidiMessageCollector().addMessageToQueue(noteOff);
+    }
+
+    state.numHoldingNotes = 0;
+
+    MidiMessage stopPlayback(MidiMessage::midiStop());
+    stopPlayback.setTimeStamp(timeNow);
+
+    for (const auto *slot : state.slots)
+    {
+        slot->instrument->getProcessorPlayer()
+            .getMidiMessageCollector().addMessageToQueue(stopPlayback);
+    }
+}
+
+Player::InstrumentSlot *Player::findSlotFor(const PlaybackState &state,
+    const Instrument::AudioCallback *callback) const noexcept
+{
+    for (auto *slot : state.slots)
+    {
+        if (&slot->instrument->getProcessorPlayer() == callback)
+        {
+            return slot;
+        }
+    }
+
+    return nullptr;
+}
+
+Player::InstrumentSlot *Player::findSlotFor(const PlaybackState &state,
+    const Instrument *instrument) const noexcept
+{
+    for (auto *slot : state.slots)
+    {
+        if (slot->instrument == instrument)
+        {
+            return slot;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,147 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Transport.h"
+
+// The sequencer which runs right inside the instruments' audio callbacks:
+// each instrument asks the player for its MIDI events of the next block,
+// and the player writes them at exact sample offsets computed from the
+// playback cache and the tempo events, so that the timing doesn't depend
+// on the thread scheduling; the transport listeners are notified
+// from the message thread by the timer, see timerCallback()
+
+class Player final : private Timer
+{
+public:
+
+    explicit Player(Transport &transport);
+    ~Player() override;
+
+    void startPlayback(float startBeat, float rewindBeat, float endBeat, bool loopMode);
+    void stopPlayback();
+    bool isPlaying() const noexcept;
+
+    // extrapolates the playback position at the given moment of the hi-res
+    // millisecond counter from the last block rendered by the audio thread;
+    // safe to call from any thread, returns false if not playing
+    bool getBeatAtTime(double timeMs, double &outBeat) const noexcept;
+
+    // called by Instrument::AudioCallback on the audio thread
+    void renderNextBlock(const Instrument::AudioCallback *callback,
+        MidiBuffer &midiMessages, int numSamples, double sampleRate);
+
+private:
+
+    //===------------------------------------------------------------------===//
+    // Timer
+    //===------------------------------------------------------------------===//
+
+    void timerCallback() override;
+
+private:
+
+    struct InstrumentSlot final
+    {
+        Instrument *instrument = nullptr;
+        MidiBuffer midiBuffer;
+        // the slot has the events rendered, but not yet taken by the instrument:
+        bool hasPendingBlock = false;
+    };
+
+    // This hack is here to keep track of still playing events
+    // to be able to send noteOff's when playback interrupts.
+    // (some plugins just don't understand allNotesOff message)
+    struct HoldingNote final
+    {
+        int key;
+        int channel;
+        InstrumentSlot *slot;
+    };
+
+    struct PlaybackState final
+    {
+        explicit PlaybackState(const TransportPlaybackCache &cache) :
+            sequences(cache) {}
+
+        Transport::PlaybackContext::Ptr context;
+        TransportPlaybackCache sequences;
+
+        OwnedArray<InstrumentSlot> slots;
+
+        // a fixed-capacity buffer, allocated once for all slots, so that
+        // the audio thread never reallocates it; the removed notes
+        // are swapped with the last one, the order doesn't matter
+        HeapBlock<HoldingNote> holdingNotes;
+        int numHoldingNotes = 0;
+        int maxHoldingNotes = 0;
+
+        CachedMidiMessage nextMessage;
+        bool hasNextMessage = false;
+
+        double currentBeat = 0.0;
+        double msPerBeat = Globals::Defaults::msPerBeat;
+
+        bool hasStarted = false;
+        bool hasFinished = false;
+    };
+
+    InstrumentSlot *findSlotFor(const PlaybackState &state,
+        const Instrument::AudioCallback *callback) const noexcept;
+    InstrumentSlot *findSlotFor(const PlaybackState &state,
+        const Instrument *instrument) const noexcept;
+
+    void renderBlock(PlaybackState &state, int numSamples, double sampleRate);
+    void sendMessage(PlaybackState &state, const CachedMidiMessage &message, int sampleOffset);
+    void sendHoldingNotesOffAndMidiStop(PlaybackState &state, int sampleOffset);
+    void sendHoldingNotesOffAndMidiStopNow(PlaybackState &state);
+
+    void publishAudioClock(double beat, double msPerBeat) noexcept;
+
+    Transport &transport;
+
+    SpinLock stateLock;
+    UniquePointer<PlaybackState> state;
+
+    Atomic<bool> isPlaybackRunning = false;
+
+    // written on the audio thread, read by the timer:
+    Atomic<float> currentBeat = 0.f;
+    Atomic<double> currentTempo = Globals::Defaults::msPerBeat;
+    Atomic<bool> hasReachedEnd = false;
+
+    // the audio clock: the beat at which the last rendered block starts,
+    // the time when it was rendered and the tempo; the version is odd while
+    // the audio thread is updating them, so that readers never see a mix
+    // of the old and the new values, see getBeatAtTime()
+    Atomic<uint32> clockVersion = 0;
+    Atomic<double> clockBeat = 0.0;
+    Atomic<double> clockTimeMs = 0.0;
+    Atomic<double> clockMsPerBeat = Globals::Defaults::msPerBeat;
+
+    // the last values sent to the transport listeners:
+    float lastBroadcastBeat = 0.f;
+    double lastBroadcastTempo = Globals::Defaults::msPerBeat;
+    double startBeatTimeMs = 0.0;
+    double totalTimeMs = 0.0;
+
+    static constexpr auto timerTickMs = 50;
+    static constexpr auto midiBufferPreallocatedSize = 4096;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Player)
+};
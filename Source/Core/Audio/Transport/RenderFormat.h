@@ -33,3 +33,34 @@ inline String getExtensionForRenderFormat(RenderFormat format) noexcept
 
     return {};
 }
+
+// collected by the renderer, so that it's possible
+// to tell how long the export took and which instruments are the slowest
+struct RenderStatistics final
+{
+    struct InstrumentTiming final
+    {
+        String instrumentName;
+        double processingTimeMs = 0.0;
+    };
+
+    double totalTimeMs = 0.0;
+    int numThreads = 1;
+    int blockSize = 0;
+
+    // sorted by the processing time, the slowest first
+    Array<InstrumentTiming> instruments;
+};
+
+// WAV supports 16 and 24-bit integer and 32-bit float samples,
+// FLAC is integer-only and has no 32-bit mode in the encoder we use
+inline int getSupportedBitDepthForRenderFormat(RenderFormat format, int bitDepth) noexcept
+{
+    switch (format)
+    {
+    case RenderFormat::FLAC: return bitDepth >= 24 ? 24 : 16;
+    case RenderFormat::WAV:  return bitDepth >= 32 ? 32 : (bitDepth >= 24 ? 24 : 16);
+    }
+
+    return 16;
+}
@@ -19,10 +19,12 @@
 #include "RendererThread.h"
 #include "Workspace.h"
 #include "AudioCore.h"
+#include "Config.h"
 
 RendererThread::RendererThread(Transport &parentTransport) :
     Thread("RendererThread"),
-    transport(parentTransport) {}
+    transport(parentTransport),
+    writerThread("RendererWriterThread") {}
 
 RendererThread::~RendererThread()
 {
@@ -34,6 +36,12 @@ float RendererThread::getPercentsComplete() const noexcept
     return this->percentsDone.get();
 }
 
+RenderStatistics RendererThread::getLastRenderStatistics() const
+{
+    const ScopedLock lock(this->statisticsLock);
+    return this->lastStatistics;
+}
+
 bool RendererThread::startRendering(const URL &target, RenderFormat format,
     Transport::PlaybackContext::Ptr playbackContext)
 {
@@ -42,6 +50,19 @@ bool RendererThread::startRendering(const URL &target, RenderFormat format,
     this->format = format;
     this->context = playbackContext;
 
+    // larger blocks mean less overhead per block, and since there's
+    // no real-time constraint here, the latency doesn't matter;
+    // rendering in one thread is for plugins which misbehave otherwise
+    this->blockSize = jlimit(RendererThread::minBlockSize, RendererThread::maxBlockSize,
+        App::Config().getProperty(Serialization::Config::renderBlockSize,
+            String(RendererThread::defaultBlockSize)).getIntValue());
+
+    this->numThreads = App::Config().getProperty(Serialization::Config::renderThreads).getIntValue();
+    if (this->numThreads <= 0)
+    {
+        this->numThreads = SystemStats::getNumCpus();
+    }
+
     // keep the url copy alive while rendering,
     // since on iOS it contains a security bookmark:
     this->renderTarget = target;
@@ -62,26 +83,40 @@ bool RendererThread::startRendering(const URL &target, RenderFormat format,
         
         // 16 bits per sample should be enough for anybody :)
         // ..wanna fight about it? https://people.xiph.org/~xiphmont/demo/neil-young.html
-        const int bitDepth = 16;
+        // (but 24-bit and 32-bit float are there for the audiophiles and for further mastering)
+        const auto bitDepth = getSupportedBitDepthForRenderFormat(this->format,
+            App::Config().getProperty(Serialization::Config::renderBitDepth,
+                String(RendererThread::defaultBitDepth)).getIntValue());
+
+        UniquePointer<AudioFormatWriter> formatWriter;
 
         if (this->format == RenderFormat::WAV)
         {
             WavAudioFormat wavFormat;
-            const ScopedLock sl(this->writerLock);
-            this->writer.reset(wavFormat.createWriterFor(outStream.release(),
+            formatWriter.reset(wavFormat.createWriterFor(outStream.release(),
                 this->context->sampleRate, this->context->numOutputChannels, bitDepth, {}, 0));
         }
         else if (this->format == RenderFormat::FLAC)
         {
             FlacAudioFormat flacFormat;
-            const ScopedLock sl(this->writerLock);
-            this->writer.reset(flacFormat.createWriterFor(outStream.release(),
+            formatWriter.reset(flacFormat.createWriterFor(outStream.release(),
                 this->context->sampleRate, this->context->numOutputChannels, bitDepth, {}, 0));
         }
 
-        if (writer != nullptr)
+        if (formatWriter != nullptr)
         {
             DBG(this->renderTarget.getLocalFile().getFullPathName());
+
+            // encoding and disk i/o happen on the writer thread,
+            // which takes the mixed blocks from the writer's lock-free fifo
+            this->writerThread.startThread(5);
+
+            {
+                const ScopedLock sl(this->writerLock);
+                this->writer = make<AudioFormatWriter::ThreadedWriter>(formatWriter.release(),
+                    this->writerThread, RendererThread::writerFifoSize);
+            }
+
             this->startThread(9);
         }
 
@@ -99,9 +134,12 @@ void RendererThread::stop()
     }
 
     {
+        // this flushes the remaining blocks and finalizes the file
         const ScopedLock lock(this->writerLock);
         this->writer = nullptr;
     }
+
+    this->writerThread.stopThread(500);
 }
 
 bool RendererThread::isRendering() const
@@ -113,19 +151,106 @@ bool RendererThread::isRendering() const
 // Thread
 //===----------------------------------------------------------------------===//
 
-struct RenderBuffer final
+// Each instrument renders into its own buffer, so they are independent
+// until the mixdown step, and can be processed on the worker pool
+struct RenderBuffer final : public ThreadPoolJob
 {
+    RenderBuffer(Instrument *instrument, int numChannels, int blockSize) :
+        ThreadPoolJob(instrument->getName()),
+        instrument(instrument),
+        sampleBuffer(numChannels, blockSize) {}
+
+    void setDoublePrecision(bool shouldUseDoublePrecision)
+    {
+        this->usesDoublePrecision = shouldUseDoublePrecision;
+        if (shouldUseDoublePrecision)
+        {
+            this->doubleSampleBuffer.makeCopyOf(this->sampleBuffer);
+            this->sampleBuffer.setSize(0, 0);
+        }
+    }
+
+    template <typename T>
+    const AudioBuffer<T> &getSampleBuffer() const noexcept;
+
+    JobStatus runJob() override
+    {
+        this->process();
+        return ThreadPoolJob::jobHasFinished;
+    }
+
+    void process()
+    {
+        const auto startTicks = Time::getHighResolutionTicks();
+        auto *graph = this->instrument->getProcessorGraph();
+
+        {
+            const ScopedLock lock(graph->getCallbackLock());
+            if (this->usesDoublePrecision)
+            {
+                graph->processBlock(this->doubleSampleBuffer, this->midiBuffer);
+            }
+            else
+            {
+                graph->processBlock(this->sampleBuffer, this->midiBuffer);
+            }
+            this->midiBuffer.clear();
+        }
+
+        this->processingTicks += (Time::getHighResolutionTicks() - startTicks);
+    }
+
     Instrument *instrument;
+    // the precision the graph had before rendering, restored afterwards
+    AudioProcessor::ProcessingPrecision previousPrecision = AudioProcessor::singlePrecision;
+
     AudioBuffer<float> sampleBuffer;
+    AudioBuffer<double> doubleSampleBuffer;
+    bool usesDoublePrecision = false;
     MidiBuffer midiBuffer;
+
+    int64 processingTicks = 0;
 };
 
+template <>
+const AudioBuffer<float> &RenderBuffer::getSampleBuffer() const noexcept
+{
+    return this->sampleBuffer;
+}
+
+template <>
+const AudioBuffer<double> &RenderBuffer::getSampleBuffer() const noexcept
+{
+    return this->doubleSampleBuffer;
+}
+
+// the mixdown is always done in double precision, even if the instruments aren't
+template <typename T>
+static void mixDown(const OwnedArray<RenderBuffer> &subBuffers, AudioBuffer<double> &mixingBuffer)
+{
+    mixingBuffer.clear();
+
+    for (const auto *subBuffer : subBuffers)
+    {
+        const auto &sampleBuffer = subBuffer->getSampleBuffer<T>();
+        for (int channel = 0; channel < mixingBuffer.getNumChannels(); ++channel)
+        {
+            auto *destination = mixingBuffer.getWritePointer(channel);
+            const auto *source = sampleBuffer.getReadPointer(channel);
+            for (int i = 0; i < mixingBuffer.getNumSamples(); ++i)
+            {
+                destination[i] += double(source[i]);
+            }
+        }
+    }
+}
+
 void RendererThread::run()
 {
     // step 0. init.
     this->transport.recacheIfNeeded();
     auto sequences = this->transport.getPlaybackCache();
-    constexpr auto bufferSize = 512;
+    const auto bufferSize = this->blockSize;
 
     // assuming that number of channels and sample rate is equal for all instruments
     const int numOutChannels = sequences.getNumOutputChannels();
@@ -140,28 +265,43 @@ void RendererThread::run()
 
     // step 1. create a list of unique instruments with audio buffers for them.
     OwnedArray<RenderBuffer> subBuffers;
-    Array<Instrument *> uniqueInstruments;
-    uniqueInstruments.addArray(sequences.getUniqueInstruments());
-
-    for (int i = 0; i < uniqueInstruments.size(); ++i)
+    for (auto *instrument : sequences.getUniqueInstruments())
     {
-        Instrument *instrument = uniqueInstruments[i];
-        auto *subBuffer = new RenderBuffer();
-        subBuffer->instrument = instrument;
-        subBuffer->sampleBuffer = AudioBuffer<float>(numOutChannels, bufferSize);
-        subBuffers.add(subBuffer);
+        subBuffers.add(new RenderBuffer(instrument, numOutChannels, bufferSize));
         //DBG("Adding instrument: " + String(instrument->getName()));
     }
 
+    // the pool is only worth it when there's more than one instrument,
+    // otherwise everything is processed right on this thread
+    const auto numWorkers = jmin(subBuffers.size(), this->numThreads);
+    UniquePointer<ThreadPool> workers;
+    if (numWorkers > 1)
+    {
+        workers = make<ThreadPool>(numWorkers);
+    }
+
+    // process in double precision, only if all instruments can do that,
+    // otherwise, at least mix down in double precision
+    bool useDoublePrecision = true;
+    for (const auto *subBuffer : subBuffers)
+    {
+        useDoublePrecision = useDoublePrecision &&
+            subBuffer->instrument->getProcessorGraph()->supportsDoublePrecisionProcessing();
+    }
+
     // step 2. release resources, prepare to play, etc.
     for (auto *subBuffer : subBuffers)
     {
         AudioProcessorGraph *graph = subBuffer->instrument->getProcessorGraph();
         graph->setPlayConfigDetails(numInChannels, numOutChannels, sampleRate, bufferSize);
         graph->releaseResources();
-        graph->setProcessingPrecision(AudioProcessor::singlePrecision);
+        subBuffer->previousPrecision = graph->getProcessingPrecision();
+        graph->setProcessingPrecision(useDoublePrecision ?
+            AudioProcessor::doublePrecision : AudioProcessor::singlePrecision);
+        subBuffer->setDoublePrecision(useDoublePrecision);
         graph->prepareToPlay(graph->getSampleRate(), bufferSize);
         graph->setNonRealtime(true);
+        subBuffer->midiBuffer.ensureSize(RendererThread::midiBufferPreallocatedSize);
     }
 
     // let the processor graphs handle their async updates
@@ -174,8 +314,8 @@ void RendererThread::run()
     bool hasNextMessage = sequences.getNextMessage(nextMessage);
     jassert(hasNextMessage);
     
-    // TODO: add double precision rendering someday (for processor graphs who support it)
-    AudioBuffer<float> mixingBuffer(numOutChannels, bufferSize);
+    AudioBuffer<double> mixingBuffer(numOutChannels, bufferSize);
+    AudioBuffer<float> outputBuffer(numOutChannels, bufferSize);
     
     double lastEventTick = 0.0;
     double prevEventTimeStamp = 0.0;
@@ -190,6 +330,8 @@ void RendererThread::run()
         subBuffer->midiBuffer.addEvent(MidiMessage::midiStart(), messageFrame);
     }
 
+    const auto renderStartTicks = Time::getHighResolutionTicks();
+
     while (currentFrame < lastFrame)
     {
         if (this->threadShouldExit())
@@ -235,43 +377,50 @@ void RendererThread::run()
         }
 
         // step 3b. call processBlock for every instrument.
-        for (auto *subBuffer : subBuffers)
+        if (workers != nullptr)
         {
-            auto *graph = subBuffer->instrument->getProcessorGraph();
+            for (auto *subBuffer : subBuffers)
             {
-                const ScopedLock lock(graph->getCallbackLock());
-                
-                //DBG("processBlock num midi events: " + String(subBuffer->midiBuffer.getNumEvents()));
-                graph->processBlock(subBuffer->sampleBuffer, subBuffer->midiBuffer);
-                subBuffer->midiBuffer.clear();
+                workers->addJob(subBuffer, false);
+            }
 
-                //Thread::yield();
+            for (auto *subBuffer : subBuffers)
+            {
+                workers->waitForJobToFinish(subBuffer, -1);
             }
         }
-
-        // step 3c. mix them down to the render buffer.
-        mixingBuffer.clear();
-
-        for (auto *subBuffer : subBuffers)
+        else
         {
-            for (int j = 0; j < numOutChannels; ++j)
+            for (auto *subBuffer : subBuffers)
             {
-                mixingBuffer.addFrom(j, 0,
-                    subBuffer->sampleBuffer, j, 0,
-                    bufferSize,
-                    1.0f);
+                subBuffer->process();
             }
         }
 
-        // step 3d. write resulting buffer to disk.
+        // step 3c. mix them down to the render buffer.
+        if (useDoublePrecision)
+        {
+            mixDown<double>(subBuffers, mixingBuffer);
+        }
+        else
+        {
+            mixDown<float>(subBuffers, mixingBuffer);
+        }
+
+        outputBuffer.makeCopyOf(mixingBuffer, true);
+
+        // step 3d. pass the resulting buffer to the writer thread,
+        // waiting only if the encoder can't keep up and its fifo is full
         {
             const ScopedLock lock(this->writerLock);
-            bool writtenSuccessfully = false;
-            
-            while (! writtenSuccessfully)
+            while (!this->writer->write(outputBuffer.getArrayOfReadPointers(), bufferSize))
             {
-                writtenSuccessfully =
-                    this->writer->writeFromAudioSampleBuffer(mixingBuffer, 0, mixingBuffer.getNumSamples());
+                if (this->threadShouldExit())
+                {
+                    break;
+                }
+
+                Thread::sleep(1);
             }
         }
 
@@ -283,12 +432,45 @@ void RendererThread::run()
     }
 
     // step 4. setNonRealtime false.
+    workers = nullptr;
+
+    RenderStatistics statistics;
+    statistics.totalTimeMs = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - renderStartTicks) * 1000.0;
+    statistics.numThreads = jmax(1, numWorkers);
+    statistics.blockSize = bufferSize;
+
+    for (const auto *subBuffer : subBuffers)
+    {
+        statistics.instruments.add({ subBuffer->instrument->getName(),
+            Time::highResolutionTicksToSeconds(subBuffer->processingTicks) * 1000.0 });
+    }
+
+    struct SlowestInstrumentsFirst final
+    {
+        static int compareElements(const RenderStatistics::InstrumentTiming &first,
+            const RenderStatistics::InstrumentTiming &second)
+        {
+            return (second.processingTimeMs > first.processingTimeMs) -
+                (second.processingTimeMs < first.processingTimeMs);
+        }
+    };
+
+    SlowestInstrumentsFirst comparator;
+    statistics.instruments.sort(comparator);
+
+    {
+        const ScopedLock lock(this->statisticsLock);
+        this->lastStatistics = move(statistics);
+    }
+
     for (auto *subBuffer : subBuffers)
     {
         auto *graph = subBuffer->instrument->getProcessorGraph();
         graph->setNonRealtime(false);
         graph->reset();
         graph->releaseResources();
+        // the device will prepare it again when reconnecting
+        graph->setProcessingPrecision(subBuffer->previousPrecision);
     }
     
     {
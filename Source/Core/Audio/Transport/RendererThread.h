@@ -35,6 +35,9 @@ public:
     void stop();
     bool isRendering() const;
 
+    // the timings of the last finished or aborted render
+    RenderStatistics getLastRenderStatistics() const;
+
 private:
 
     //===------------------------------------------------------------------===//
@@ -52,10 +55,27 @@ private:
     // this needs to be kept alive while rendering (why - because iOS)
     URL renderTarget;
 
+    // the mixed blocks are encoded and written to disk on a separate thread,
+    // so that the i/o overlaps with the synthesis instead of stalling it
+    TimeSliceThread writerThread;
     CriticalSection writerLock;
-    UniquePointer<AudioFormatWriter> writer;
+    UniquePointer<AudioFormatWriter::ThreadedWriter> writer;
+
+    // read from the config when the rendering starts
+    int blockSize = RendererThread::defaultBlockSize;
+    int numThreads = 1;
+
+    static constexpr auto defaultBitDepth = 16;
+    static constexpr auto writerFifoSize = 1 << 17;
+    static constexpr auto defaultBlockSize = 512;
+    static constexpr auto minBlockSize = 64;
+    static constexpr auto maxBlockSize = 8192;
+    static constexpr auto midiBufferPreallocatedSize = 4096;
 
     Atomic<float> percentsDone = 0.f;
 
+    CriticalSection statisticsLock;
+    RenderStatistics lastStatistics;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RendererThread)
 };
@@ -0,0 +1,206 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "TempoMap.h"
+
+void TempoMap::clear() noexcept
+{
+    this->tempoChanges.clearQuick();
+
+#if JUCE_DEBUG
+    this->isUpToDate = true;
+#endif
+}
+
+void TempoMap::addTempoChange(double beat, double msPerBeat)
+{
+    this->tempoChanges.add({ beat, msPerBeat, 0.0 });
+
+#if JUCE_DEBUG
+    this->isUpToDate = false;
+#endif
+}
+
+void TempoMap::addTempoChangesFrom(const MidiMessageSequence &sequence)
+{
+    for (int i = 0; i < sequence.getNumEvents(); ++i)
+    {
+        const auto &message = sequence.getEventPointer(i)->message;
+        if (message.isTempoMetaEvent())
+        {
+            this->addTempoChange(message.getTimeStamp(),
+                message.getTempoSecondsPerQuarterNote() * 1000.0);
+        }
+    }
+}
+
+struct TempoChangeComparator final
+{
+    template <typename T>
+    static int compareElements(const T &first, const T &second) noexcept
+    {
+        return (first.beat > second.beat) - (first.beat < second.beat);
+    }
+};
+
+void TempoMap::update()
+{
+    // tempo changes at the same beat will keep their order,
+    // so that the last one wins, like it would in the playback
+    TempoChangeComparator comparator;
+    this->tempoChanges.sort(comparator, true);
+
+    double timeMs = 0.0;
+    double lastBeat = 0.0;
+    double lastTempo = Globals::Defaults::msPerBeat;
+
+    for (auto &tempoChange : this->tempoChanges)
+    {
+        timeMs += (tempoChange.beat - lastBeat) * lastTempo;
+        tempoChange.timeMs = timeMs;
+        lastBeat = tempoChange.beat;
+        lastTempo = tempoChange.msPerBeat;
+    }
+
+#if JUCE_DEBUG
+    this->isUpToDate = true;
+#endif
+}
+
+//===----------------------------------------------------------------------===//
+// Conversions
+//===----------------------------------------------------------------------===//
+
+double TempoMap::beatToMs(double beat) const noexcept
+{
+    const auto index = this->findTempoChangeIndexAtBeat(beat);
+    if (index < 0)
+    {
+        return beat * Globals::Defaults::msPerBeat;
+    }
+
+    const auto &tempoChange = this->tempoChanges.getReference(index);
+    return tempoChange.timeMs + (beat - tempoChange.beat) * tempoChange.msPerBeat;
+}
+
+double TempoMap::msToBeat(double timeMs) const noexcept
+{
+    const auto index = this->findTempoChangeIndexAtTime(timeMs);
+    if (index < 0)
+    {
+        return timeMs / Globals::Defaults::msPerBeat;
+    }
+
+    const auto &tempoChange = this->tempoChanges.getReference(index);
+    return tempoChange.beat + (timeMs - tempoChange.timeMs) / tempoChange.msPerBeat;
+}
+
+double TempoMap::getTempoAt(double beat) const noexcept
+{
+    const auto index = this->findTempoChangeIndexAtBeat(beat);
+    return index < 0 ? Globals::Defaults::msPerBeat :
+        this->tempoChanges.getReference(index).msPerBeat;
+}
+
+int TempoMap::findTempoChangeIndexAtBeat(double beat) const noexcept
+{
+    jassert(this->isUpToDate);
+
+    const auto *found = std::upper_bound(this->tempoChanges.begin(), this->tempoChanges.end(), beat,
+        [](double beat, const TempoChange &tempoChange) { return beat < tempoChange.beat; });
+
+    return int(found - this->tempoChanges.begin()) - 1;
+}
+
+int TempoMap::findTempoChangeIndexAtTime(double timeMs) const noexcept
+{
+    jassert(this->isUpToDate);
+
+    // the time is non-decreasing, since a tempo is never negative:
+    const auto *found = std::upper_bound(this->tempoChanges.begin(), this->tempoChanges.end(), timeMs,
+        [](double timeMs, const TempoChange &tempoChange) { return timeMs < tempoChange.timeMs; });
+
+    return int(found - this->tempoChanges.begin()) - 1;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class TempoMapTests final : public UnitTest
+{
+public:
+    TempoMapTests() : UnitTest("Tempo map tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Beat to time conversions");
+
+        TempoMap map;
+        map.update();
+
+        // no tempo changes means the default tempo everywhere:
+        expectEquals(map.beatToMs(4.0), 4.0 * Globals::Defaults::msPerBeat);
+        expectEquals(map.msToBeat(1000.0), 1000.0 / Globals::Defaults::msPerBeat);
+
+        // added out of order, like they come from different tracks:
+        map.addTempoChange(8.0, 250.0);
+        map.addTempoChange(4.0, 1000.0);
+        map.addTempoChange(4.0, 2000.0); // the last one at the same beat wins
+        map.update();
+
+        expectEquals(map.getTempoAt(0.0), double(Globals::Defaults::msPerBeat));
+        expectEquals(map.getTempoAt(4.0), 2000.0);
+        expectEquals(map.getTempoAt(100.0), 250.0);
+
+        const auto timeAt4 = 4.0 * Globals::Defaults::msPerBeat;
+        const auto timeAt8 = timeAt4 + 4.0 * 2000.0;
+        expectEquals(map.beatToMs(2.0), 2.0 * Globals::Defaults::msPerBeat);
+        expectEquals(map.beatToMs(4.0), timeAt4);
+        expectEquals(map.beatToMs(6.0), timeAt4 + 2.0 * 2000.0);
+        expectEquals(map.beatToMs(8.0), timeAt8);
+        expectEquals(map.beatToMs(10.0), timeAt8 + 2.0 * 250.0);
+
+        for (double beat = 0.0; beat < 16.0; beat += 0.25)
+        {
+            expectWithinAbsoluteError(map.msToBeat(map.beatToMs(beat)), beat, 0.000001);
+        }
+
+        beginTest("Tempo map built from MIDI messages");
+
+        MidiMessageSequence sequence;
+        sequence.addEvent(MidiMessage::tempoMetaEvent(250000).withTimeStamp(2.0));
+        sequence.addEvent(MidiMessage::controllerEvent(1, 1, 64).withTimeStamp(3.0));
+        sequence.addEvent(MidiMessage::tempoMetaEvent(1000000).withTimeStamp(6.0));
+
+        map.clear();
+        map.addTempoChangesFrom(sequence);
+        map.update();
+
+        expectEquals(map.beatToMs(2.0), 2.0 * Globals::Defaults::msPerBeat);
+        expectEquals(map.beatToMs(6.0), map.beatToMs(2.0) + 4.0 * 250.0);
+        expectEquals(map.beatToMs(7.0), map.beatToMs(6.0) + 1000.0);
+        expectEquals(map.msToBeat(map.beatToMs(6.0) + 500.0), 6.5);
+    }
+};
+
+static TempoMapTests tempoMapTests;
+
+#endif
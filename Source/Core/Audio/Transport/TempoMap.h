@@ -0,0 +1,74 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// The precomputed beat-to-time conversion table:
+// keeps all tempo changes sorted by beat, each with the absolute time
+// in milliseconds at which it happens, so that the conversions are
+// a binary search plus a linear remainder instead of walking all events.
+//
+// All beats here are relative to the project's first beat,
+// same as the timestamps in TransportPlaybackCache;
+// before the first tempo event, the default tempo is used.
+
+class TempoMap final
+{
+public:
+
+    TempoMap() = default;
+
+    void clear() noexcept;
+
+    // call these while building the map, then call update() once
+    // to sort the tempo changes and compute the cumulative time:
+    void addTempoChange(double beat, double msPerBeat);
+    void addTempoChangesFrom(const MidiMessageSequence &sequence);
+    void update();
+
+    double beatToMs(double beat) const noexcept;
+    double msToBeat(double timeMs) const noexcept;
+
+    // returns ms per beat (or per quarter-note) at the given beat
+    double getTempoAt(double beat) const noexcept;
+
+    inline bool isEmpty() const noexcept
+    {
+        return this->tempoChanges.isEmpty();
+    }
+
+private:
+
+    struct TempoChange final
+    {
+        double beat;
+        double msPerBeat;
+        double timeMs; // the absolute time at this beat
+    };
+
+    // returns the index of the last tempo change at or before the beat, or -1
+    int findTempoChangeIndexAtBeat(double beat) const noexcept;
+    int findTempoChangeIndexAtTime(double timeMs) const noexcept;
+
+    Array<TempoChange> tempoChanges;
+
+#if JUCE_DEBUG
+    bool isUpToDate = true;
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TempoMap)
+};
@@ -19,9 +19,9 @@
 #include "Transport.h"
 #include "OrchestraPit.h"
 #include "RendererThread.h"
-#include "PlayerThread.h"
-#include "PlayerThreadPool.h"
+#include "Player.h"
 #include "MidiSequence.h"
+#include "AutomationSequence.h"
 #include "MidiTrack.h"
 #include "Pattern.h"
 #include "Workspace.h"
@@ -37,7 +37,7 @@ Transport::Transport(OrchestraPit &orchestraPit, SleepTimer &sleepTimer) :
     orchestra(orchestraPit),
     sleepTimer(sleepTimer)
 {
-    this->player = make<PlayerThreadPool>(*this);
+    this->player = make<Player>(*this);
     this->renderer = make<RendererThread>(*this);
     this->orchestra.addOrchestraListener(this);
 }
@@ -140,24 +140,16 @@ void Transport::probeSoundAtBeat(float beatPosition, const MidiSequence *limitTo
     const auto targetRelBeat = beatPosition - this->projectFirstBeat.get();
     const auto sequencesToProbe(this->playbackCache.getAllFor(limitToLayer));
     
+    Array<int> soundingNotes;
     for (const auto &seq : sequencesToProbe)
     {
-        for (int j = 0; j < seq->midiMessages.getNumEvents(); ++j)
+        seq->notesIndex.findSpansAt(targetRelBeat, soundingNotes);
+
+        for (const auto noteOnIndex : soundingNotes)
         {
-            auto *noteOnHolder = seq->midiMessages.getEventPointer(j);
-            
-            if (auto *noteOffHolder = noteOnHolder->noteOffObject)
-            {
-                const double noteOn(noteOnHolder->message.getTimeStamp());
-                const double noteOff(noteOffHolder->message.getTimeStamp());
-                
-                if (noteOn <= targetRelBeat && noteOff > targetRelBeat)
-                {
-                    MidiMessage messageTimestampedAsNow(noteOnHolder->message);
-                    messageTimestampedAsNow.setTimeStamp(TIME_NOW);
-                    seq->listener->addMessageToQueue(messageTimestampedAsNow);
-                }
-            }
+            MidiMessage messageTimestampedAsNow(seq->midiMessages.getEventPointer(noteOnIndex)->message);
+            messageTimestampedAsNow.setTimeStamp(TIME_NOW);
+            seq->listener->addMessageToQueue(messageTimestampedAsNow);
         }
     }
 
@@ -213,7 +205,7 @@ void Transport::stopPlayback()
     if (this->player->isPlaying())
     {
         this->broadcastStop();
-        this->player->stopPlayback(); // after broadcastStop so that MM can be locked
+        this->player->stopPlayback();
         this->allNotesControllersAndSoundOff();
         this->seekToBeat(this->getSeekBeat());
         this->sleepTimer.setCanSleepAfter(Transport::soundSleepDelayMs);
@@ -230,6 +222,12 @@ bool Transport::isPlaying() const
     return this->player->isPlaying();
 }
 
+// safe to call from any thread, e.g. from the MIDI input callback
+bool Transport::getBeatAtTime(double timeMs, double &outBeat) const noexcept
+{
+    return this->player->getBeatAtTime(timeMs, outBeat);
+}
+
 bool Transport::isPlayingAndRecording() const
 {
     return this->isPlaying() && this->isRecording();
@@ -383,133 +381,82 @@ float Transport::getRenderingPercentsComplete() const
     return this->renderer->getPercentsComplete();
 }
 
+RenderStatistics Transport::getLastRenderStatistics() const
+{
+    return this->renderer->getLastRenderStatistics();
+}
+
 //===----------------------------------------------------------------------===//
 // Sending messages at real-time
 //===----------------------------------------------------------------------===//
 
 /*
     The purpose of this class is to help previewing messages interactively in the sequencer.
-    It will simply send note-on events after a delay, and keep track of note-off events which
-    needs to be sent after a while; all those previews are cancelled by transport on stopSound;
-    The delay before the note-on is needed because some plugins (e.g. Kontakt in my case)
-    are sometimes processing play/stop messages out of order for whatever reason, which is weird -
-    note the word `queue` in addMessageToQueue() method name - but it still happens in some cases,
-    for example, when the user drags some notes around quickly.
+    It only maps the keys and passes the previews to the instruments' audio callbacks
+    through their lock-free queues; the callbacks send the note-ons and note-offs at exact
+    sample offsets, so that the timing doesn't depend on how busy the message thread is;
+    all those previews are cancelled by transport on stopSound.
+    The note-on used to be delayed, because some plugins (e.g. Kontakt in my case)
+    were sometimes processing play/stop messages out of order, when the user dragged
+    some notes around quickly; now the audio callback itself makes sure that
+    a retriggered key gets its note-off strictly before the new note-on.
 */
 
-Transport::NotePreviewTimer::~NotePreviewTimer()
+Transport::NotePreviewScheduler::~NotePreviewScheduler()
 {
     this->cancelAllPendingPreviews(false);
 }
 
-void Transport::NotePreviewTimer::cancelAllPendingPreviews(bool sendRemainingNoteOffs)
+void Transport::NotePreviewScheduler::cancelAllPendingPreviews(bool sendRemainingNoteOffs)
 {
-    if (this->isTimerRunning())
+    Array<Instrument *> instruments;
+
+    for (auto &instrument : this->previewedInstruments)
     {
-        this->stopTimer();
-        for (int key = 0; key < NotePreviewTimer::numPreviewedKeys; ++key)
+        if (instrument != nullptr)
         {
-            auto &preview = this->previews[key];
+            instruments.addIfNotAlreadyThere(instrument.get());
+        }
 
-            if (sendRemainingNoteOffs &&
-                preview.noteOffTimeoutMs > 0 &&
-                preview.instrument != nullptr)
-            {
-                //DBG("noteOff " + String(key));
-                const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
-                MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
-                message.setTimeStamp(TIME_NOW);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
-            }
+        instrument = nullptr;
+    }
 
-            preview.instrument = nullptr;
-            preview.noteOnTimeoutMs = 0;
-            preview.noteOffTimeoutMs = 0;
-            preview.volume = 0;
-        }
+    for (auto *instrument : instruments)
+    {
+        instrument->getProcessorPlayer().stopAllPreviews(sendRemainingNoteOffs);
     }
 }
 
-void Transport::NotePreviewTimer::previewNote(WeakReference<Instrument> instrument,
-    int key, float volume, int16 noteOffTimeoutMs)
+void Transport::NotePreviewScheduler::previewNote(WeakReference<Instrument> instrument,
+    int key, float volume, int noteOffTimeoutMs)
 {
-    jassert(key >= 0 && key < NotePreviewTimer::numPreviewedKeys);
+    jassert(key >= 0 && key < NotePreviewScheduler::numPreviewedKeys);
 
-    auto &preview = this->previews[key];
+    auto &previousInstrument = this->previewedInstruments[key];
 
-    if (preview.noteOffTimeoutMs > 0 &&
-        preview.instrument != instrument &&
-        preview.instrument != nullptr)
+    if (previousInstrument != instrument && previousInstrument != nullptr)
     {
-        //DBG("! noteOff " + String(key));
-        const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
-        MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
-        message.setTimeStamp(TIME_NOW);
-        preview.instrument->getProcessorPlayer()
-            .getMidiMessageCollector().addMessageToQueue(message);
+        const auto mapped = previousInstrument->getKeyboardMapping()->map(key);
+        previousInstrument->getProcessorPlayer().stopPreview(mapped.key, mapped.channel);
     }
 
-    preview.volume = volume;
-    preview.noteOnTimeoutMs = NotePreviewTimer::timerTickMs;
-    preview.noteOffTimeoutMs = noteOffTimeoutMs;
-    preview.instrument = instrument;
+    previousInstrument = instrument;
 
-    if (!this->isTimerRunning())
+    if (instrument == nullptr)
     {
-        this->startTimer(NotePreviewTimer::timerTickMs);
+        return;
     }
-}
 
-void Transport::NotePreviewTimer::timerCallback()
-{
 #if PLATFORM_MOBILE
     // iSEM tends to hang >_< if too many messages are send simultaniously
-    const auto time = TIME_NOW + float(rand() % 50) * 0.01;
+    const auto delayMs = (rand() % 50) * 10;
 #elif PLATFORM_DESKTOP
-    const auto time = TIME_NOW;
+    const auto delayMs = 0;
 #endif
 
-    bool canStop = true;
-    for (int key = 0; key < NotePreviewTimer::numPreviewedKeys; ++key)
-    {
-        auto &preview = this->previews[key];
-        if (preview.noteOnTimeoutMs > 0)
-        {
-            canStop = false;
-            preview.noteOnTimeoutMs -= NotePreviewTimer::timerTickMs;
-
-            if (preview.noteOnTimeoutMs <= 0 && preview.instrument != nullptr)
-            {
-                //DBG("noteOn " + String(key));
-                const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
-                MidiMessage message(MidiMessage::noteOn(mapped.channel, mapped.key, preview.volume));
-                message.setTimeStamp(time);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
-            }
-        }
-        else if (preview.noteOffTimeoutMs > 0)
-        {
-            canStop = false;
-            preview.noteOffTimeoutMs -= NotePreviewTimer::timerTickMs;
-
-            if (preview.noteOffTimeoutMs <= 0 && preview.instrument != nullptr)
-            {
-                //DBG("noteOff " + String(key));
-                const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
-                MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
-                message.setTimeStamp(time);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
-            }
-        }
-    }
-
-    if (canStop)
-    {
-        this->stopTimer();
-    }
+    const auto mapped = instrument->getKeyboardMapping()->map(key);
+    instrument->getProcessorPlayer().previewNote(mapped.key, mapped.channel,
+        volume, delayMs, noteOffTimeoutMs);
 }
 
 void Transport::previewKey(const String &trackId, int key,
@@ -530,8 +477,8 @@ void Transport::previewKey(const String &trackId, int key,
     // to calculate the note-off timeout interval, lets just use
     // the default 120 BPM for simplicity - instead of finding the tempo
     // at the note position, which I think is a bit of an overkill:
-    const auto noteOffTimeoutMs = int16(Globals::Defaults::msPerBeat * lengthInBeats);
-    this->notePreviewTimer.previewNote(instrument, key, volume, noteOffTimeoutMs);
+    const auto noteOffTimeoutMs = int(Globals::Defaults::msPerBeat * lengthInBeats);
+    this->notePreviewScheduler.previewNote(instrument, key, volume, noteOffTimeoutMs);
 
     this->sleepTimer.setCanSleepAfter(Transport::soundSleepDelayMs + noteOffTimeoutMs * 2);
 }
@@ -551,7 +498,7 @@ static void stopSoundForInstrument(Instrument *instrument)
 void Transport::stopSound(const String &trackId) const
 {
     this->sleepTimer.setAwake();
-    this->notePreviewTimer.cancelAllPendingPreviews(true);
+    this->notePreviewScheduler.cancelAllPendingPreviews(true);
 
     if (Instrument *instrument = this->linksCache[trackId])
     {
@@ -574,7 +521,7 @@ void Transport::stopSound(const String &trackId) const
 void Transport::allNotesControllersAndSoundOff() const
 {
     this->sleepTimer.setAwake();
-    this->notePreviewTimer.cancelAllPendingPreviews(true);
+    this->notePreviewScheduler.cancelAllPendingPreviews(true);
 
     for (int i = 1; i < Globals::numChannels; ++i)
     {
@@ -641,7 +588,9 @@ void Transport::instrumentRemovedPostAction()
 // ProjectListener
 //===----------------------------------------------------------------------===//
 
-// FIXME: need to do something more reasonable than this workaround:
+// FIXME: need to do something more reasonable than this workaround;
+// note that the track has to be invalidated before this, so that
+// the tempo map is rebuilt when the new time is calculated:
 #define updateLengthAndTimeIfNeeded(event) \
     if (event->getTrackControllerNumber() == MidiTrack::tempoController) \
     { \
@@ -657,8 +606,8 @@ void Transport::onChangeMidiEvent(const MidiEvent &oldEvent, const MidiEvent &ne
         this->stopPlayback();
     }
 
+    this->invalidateCacheFor(newEvent.getSequence()->getTrack());
     updateLengthAndTimeIfNeeded((&newEvent));
-    this->playbackCacheIsOutdated = true;
 }
 
 void Transport::onAddMidiEvent(const MidiEvent &event)
@@ -668,16 +617,32 @@ void Transport::onAddMidiEvent(const MidiEvent &event)
         this->stopPlayback();
     }
 
+    this->invalidateCacheFor(event.getSequence()->getTrack());
     updateLengthAndTimeIfNeeded((&event));
-    this->playbackCacheIsOutdated = true;
 }
 
 void Transport::onRemoveMidiEvent(const MidiEvent &event) {}
+
+// all events of a group belong to the same sequence,
+// so there's no need to stop and invalidate per each event:
+void Transport::onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+    const Array<const MidiEvent *> &newEvents)
+{
+    this->onChangeMidiEvent(*oldEvents.getFirst(), *newEvents.getFirst());
+}
+
+void Transport::onAddMidiEvents(const Array<const MidiEvent *> &events)
+{
+    this->onAddMidiEvent(*events.getFirst());
+}
+
+void Transport::onRemoveMidiEvents(const Array<const MidiEvent *> &events) {}
+
 void Transport::onPostRemoveMidiEvent(MidiSequence *const sequence)
 {
     this->stopPlaybackAndRecording();
+    this->invalidateCacheFor(sequence->getTrack());
     updateLengthAndTimeIfNeeded(sequence->getTrack());
-    this->playbackCacheIsOutdated = true;
 }
 
 void Transport::onAddClip(const Clip &clip)
@@ -687,23 +652,23 @@ void Transport::onAddClip(const Clip &clip)
         this->stopPlayback();
     }
 
+    this->invalidateCacheFor(clip.getPattern()->getTrack());
     updateLengthAndTimeIfNeeded((&clip));
-    this->playbackCacheIsOutdated = true;
 }
 
 void Transport::onChangeClip(const Clip &oldClip, const Clip &newClip)
 {
     this->stopPlaybackAndRecording();
+    this->invalidateCacheFor(newClip.getPattern()->getTrack());
     updateLengthAndTimeIfNeeded((&newClip));
-    this->playbackCacheIsOutdated = true;
 }
 
 void Transport::onRemoveClip(const Clip &clip) {}
 void Transport::onPostRemoveClip(Pattern *const pattern)
 {
     this->stopPlaybackAndRecording();
+    this->invalidateCacheFor(pattern->getTrack());
     updateLengthAndTimeIfNeeded(pattern->getTrack());
-    this->playbackCacheIsOutdated = true;
 }
 
 void Transport::onChangeTrackProperties(MidiTrack *const track)
@@ -718,8 +683,8 @@ void Transport::onChangeTrackProperties(MidiTrack *const track)
             this->stopPlayback();
         }
 
-        this->playbackCacheIsOutdated = true;
         this->updateLinkForTrack(track);
+        this->invalidateCacheFor(track);
     }
 }
 
@@ -780,18 +745,30 @@ void Transport::onAddTrack(MidiTrack *const track)
         this->stopPlayback();
     }
 
-    this->playbackCacheIsOutdated = true;
     this->tracksCache.addIfNotAlreadyThere(track);
     this->updateLinkForTrack(track);
+    this->invalidateCacheFor(track);
 }
 
 void Transport::onRemoveTrack(MidiTrack *const track)
 {
     this->stopPlaybackAndRecording();
 
-    this->playbackCacheIsOutdated = true;
     this->tracksCache.removeAllInstancesOf(track);
     this->removeLinkForTrack(track);
+
+    this->outdatedTracks.erase(track->getTrackId());
+    this->playbackCache.removeWrapperFor(track->getSequence());
+
+    if (track->isTempoTrack())
+    {
+        this->rebuildTempoMap();
+    }
+
+    if (track->getPattern() != nullptr && track->getPattern()->hasSoloClips())
+    {
+        this->playbackCacheIsOutdated = true;
+    }
 }
 
 void Transport::onChangeProjectBeatRange(float firstBeat, float lastBeat)
@@ -801,6 +778,12 @@ void Transport::onChangeProjectBeatRange(float firstBeat, float lastBeat)
         this->stopPlayback();
     }
 
+    if (this->projectFirstBeat.get() != firstBeat)
+    {
+        // all cached timestamps and the tempo map are relative to the first beat
+        this->playbackCacheIsOutdated = true;
+    }
+
     this->projectFirstBeat = firstBeat;
     this->projectLastBeat = lastBeat;
 
@@ -817,48 +800,13 @@ void Transport::onChangeProjectBeatRange(float firstBeat, float lastBeat)
 
 double Transport::findTimeAt(float beat) const
 {
-    double resultTimeMs = 0.0;
-
     this->recacheIfNeeded();
-    this->playbackCache.seekToZeroIndexes();
-
-    const auto targetRelativeBeat = beat - this->projectFirstBeat.get();
-
-    double tempo = Globals::Defaults::msPerBeat;
-    double prevTimestamp = 0.0;
-
-    CachedMidiMessage cached;
-    while (this->playbackCache.getNextMessage(cached))
-    {
-        const auto nextTimestamp = cached.message.getTimeStamp();
-
-        if (nextTimestamp > targetRelativeBeat)
-        {
-            break;
-        }
-
-        const auto nextEventTimeDelta = tempo * (nextTimestamp - prevTimestamp);
-        resultTimeMs += nextEventTimeDelta;
-        prevTimestamp = nextTimestamp;
-
-        if (cached.message.isTempoMetaEvent())
-        {
-            tempo = cached.message.getTempoSecondsPerQuarterNote() * 1000.f;
-        }
-    }
-
-    // add remainder, the time from the last event to the given beat:
-    resultTimeMs += (tempo * (targetRelativeBeat - prevTimestamp));
-
-    return resultTimeMs;
+    return this->tempoMap.beatToMs(beat - this->projectFirstBeat.get());
 }
 
 Transport::PlaybackContext::Ptr Transport::fillPlaybackContextAt(float beat) const
 {
     this->recacheIfNeeded();
-    this->playbackCache.seekToZeroIndexes();
-
-    double tempo = Globals::Defaults::msPerBeat;
 
     Transport::PlaybackContext::Ptr context(new Transport::PlaybackContext());
     context->projectFirstBeat = this->projectFirstBeat.get();
@@ -866,62 +814,48 @@ Transport::PlaybackContext::Ptr Transport::fillPlaybackContextAt(float beat) con
 
     context->startBeat = beat;
 
-    context->totalTimeMs = 0.0;
-    context->startBeatTimeMs = 0.0;
-    context->startBeatTempo = tempo;
-
     context->sampleRate = this->playbackCache.getSampleRate();
     context->numOutputChannels = this->playbackCache.getNumOutputChannels();
     
     const auto relativeTargetBeat = context->startBeat - context->projectFirstBeat;
     const auto relativeEndBeat = context->projectLastBeat - context->projectFirstBeat;
 
-    double prevTimestamp = 0.0;
-    bool startBeatPassed = false;
+    context->startBeatTempo = this->tempoMap.getTempoAt(relativeTargetBeat);
+    context->startBeatTimeMs = this->tempoMap.beatToMs(relativeTargetBeat);
+    context->totalTimeMs = this->tempoMap.beatToMs(relativeEndBeat);
 
-    CachedMidiMessage cached;
-    while (this->playbackCache.getNextMessage(cached))
+    // each automation track only has the events of its own controller,
+    // so the controller state is the last message before the start beat;
+    // if several tracks have the same controller, the latest message wins
+    double ccTimeStamps[PlaybackContext::numCCs + 1];
+    for (const auto *cached : this->playbackCache.getAllFor(nullptr))
     {
-        const auto nextTimestamp = cached.message.getTimeStamp();
-        const auto nextEventTimeDelta = tempo * (nextTimestamp - prevTimestamp);
-
-        if (nextTimestamp > relativeTargetBeat)
+        if (dynamic_cast<const AutomationSequence *>(cached->track) == nullptr)
         {
-            // the time from the last event to the given beat:
-            context->startBeatTimeMs += (tempo * (relativeTargetBeat - prevTimestamp));
-            startBeatPassed = true;
+            continue;
         }
 
-        if (!startBeatPassed)
+        const auto index = TransportPlaybackCache::findNextIndexAfterTime(cached->midiMessages, relativeTargetBeat) - 1;
+        if (index < 0)
         {
-            context->startBeatTimeMs += nextEventTimeDelta;
+            continue;
         }
 
-        context->totalTimeMs += nextEventTimeDelta;
-        prevTimestamp = nextTimestamp;
-
-        if (cached.message.isTempoMetaEvent())
-        {
-            tempo = cached.message.getTempoSecondsPerQuarterNote() * 1000.f;
-        }
-        else if (!startBeatPassed &&
-            cached.message.isController() &&
-            cached.message.getControllerNumber() <= PlaybackContext::numCCs)
+        const auto &message = cached->midiMessages.getEventPointer(index)->message;
+        if (!message.isController() ||
+            message.getControllerNumber() > PlaybackContext::numCCs)
         {
-            context->ccStates[cached.message.getControllerNumber()] =
-                cached.message.getControllerValue();
+            continue;
         }
 
-        if (!startBeatPassed)
+        const auto cc = message.getControllerNumber();
+        if (context->ccStates[cc] < 0 || ccTimeStamps[cc] <= message.getTimeStamp())
         {
-            context->startBeatTempo = tempo;
+            context->ccStates[cc] = message.getControllerValue();
+            ccTimeStamps[cc] = message.getTimeStamp();
         }
     }
 
-    // the remainder
-    context->totalTimeMs += (tempo * (relativeEndBeat - prevTimestamp));
-    //jassert(context->totalTimeMs == this->findTimeAt(this->projectLastBeat.get()));
-
     return context;
 }
 
@@ -931,51 +865,125 @@ Transport::PlaybackContext::Ptr Transport::fillPlaybackContextAt(float beat) con
 
 void Transport::recacheIfNeeded() const
 {
+    if (!this->playbackCacheIsOutdated.get() && this->outdatedTracks.empty())
+    {
+        return;
+    }
+
+    // soloing a clip changes the export of all other tracks,
+    // so it invalidates the whole cache, not just the clip's track
+    const bool hasSoloClips = this->hasSoloClips();
+    if (hasSoloClips != this->playbackCacheHasSoloClips)
+    {
+        this->playbackCacheIsOutdated = true;
+    }
+
     if (this->playbackCacheIsOutdated.get())
     {
         //DBG("Transport::recache");
         this->playbackCache.clear();
-        static Clip noTransform;
-        const double offset = -this->projectFirstBeat.get();
 
-        // Find solo clips, if any
-        bool hasSoloClips = false;
         for (const auto *track : this->tracksCache)
         {
-            if (track->getPattern() != nullptr &&
-                track->getPattern()->hasSoloClips())
-            {
-                hasSoloClips = true;
-                break;
-            }
+            this->playbackCache.addWrapper(this->exportTrack(track, hasSoloClips));
         }
 
-        for (const auto *track : this->tracksCache)
+        this->rebuildTempoMap();
+
+        this->outdatedTracks.clear();
+        this->playbackCacheHasSoloClips = hasSoloClips;
+        this->playbackCacheIsOutdated = false;
+        return;
+    }
+
+    bool tempoTrackChanged = false;
+    for (const auto *track : this->tracksCache)
+    {
+        if (this->outdatedTracks.contains(track->getTrackId()))
         {
-            const auto instrument = this->linksCache[track->getTrackId()];
-            const auto &keyMap = *instrument->getKeyboardMapping();
+            //DBG("Transport::recache " + track->getTrackName());
+            this->playbackCache.updateWrapperFor(track->getSequence(),
+                this->exportTrack(track, hasSoloClips));
 
-            auto cached = CachedMidiSequence::createFrom(instrument, track->getSequence());
+            tempoTrackChanged = tempoTrackChanged || track->isTempoTrack();
+        }
+    }
 
-            if (track->getPattern() != nullptr)
-            {
-                for (const auto *clip : track->getPattern()->getClips())
-                {
-                    cached->track->exportMidi(cached->midiMessages, *clip,
-                        keyMap, hasSoloClips, offset, 1.0);
-                }
-            }
-            else
-            {
-                cached->track->exportMidi(cached->midiMessages, noTransform,
-                    keyMap, hasSoloClips, offset, 1.0);
-            }
+    if (tempoTrackChanged)
+    {
+        this->rebuildTempoMap();
+    }
+
+    this->outdatedTracks.clear();
+}
 
-            this->playbackCache.addWrapper(cached);
+void Transport::invalidateCacheFor(const MidiTrack *track)
+{
+    if (track == nullptr)
+    {
+        jassertfalse;
+        this->playbackCacheIsOutdated = true;
+        return;
+    }
+
+    this->outdatedTracks.insert(track->getTrackId());
+}
+
+bool Transport::hasSoloClips() const noexcept
+{
+    for (const auto *track : this->tracksCache)
+    {
+        if (track->getPattern() != nullptr &&
+            track->getPattern()->hasSoloClips())
+        {
+            return true;
         }
-        
-        this->playbackCacheIsOutdated = false;
     }
+
+    return false;
+}
+
+CachedMidiSequence::Ptr Transport::exportTrack(const MidiTrack *track, bool hasSoloClips) const
+{
+    static Clip noTransform;
+    const double offset = -this->projectFirstBeat.get();
+
+    const auto instrument = this->linksCache[track->getTrackId()];
+    const auto &keyMap = *instrument->getKeyboardMapping();
+
+    auto cached = CachedMidiSequence::createFrom(instrument, track->getSequence());
+
+    if (track->getPattern() != nullptr)
+    {
+        for (const auto *clip : track->getPattern()->getClips())
+        {
+            cached->track->exportMidi(cached->midiMessages, *clip,
+                keyMap, hasSoloClips, offset, 1.0);
+        }
+    }
+    else
+    {
+        cached->track->exportMidi(cached->midiMessages, noTransform,
+            keyMap, hasSoloClips, offset, 1.0);
+    }
+
+    cached->rebuildNotesIndex();
+    return cached;
+}
+
+void Transport::rebuildTempoMap() const
+{
+    this->tempoMap.clear();
+
+    for (const auto *cached : this->playbackCache.getAllFor(nullptr))
+    {
+        if (cached->track->getTrack()->isTempoTrack())
+        {
+            this->tempoMap.addTempoChangesFrom(cached->midiMessages);
+        }
+    }
+
+    this->tempoMap.update();
 }
 
 TransportPlaybackCache Transport::getPlaybackCache()
@@ -19,12 +19,12 @@
 
 class SleepTimer;
 class OrchestraPit;
-class PlayerThread;
-class PlayerThreadPool;
+class Player;
 class RendererThread;
 
 #include "TransportListener.h"
 #include "TransportPlaybackCache.h"
+#include "TempoMap.h"
 #include "OrchestraListener.h"
 #include "ProjectListener.h"
 #include "RenderFormat.h"
@@ -62,6 +62,7 @@ public:
     void startPlaybackFragment(float startBeat, float endBeat, bool looped);
 
     bool isPlaying() const;
+    bool getBeatAtTime(double timeMs, double &outBeat) const noexcept;
     void stopPlayback();
     void toggleStartStopPlayback();
 
@@ -83,6 +84,7 @@ public:
     float getPlaybackLoopEnd() const noexcept;
 
     float getRenderingPercentsComplete() const;
+    RenderStatistics getLastRenderStatistics() const;
     
     //===------------------------------------------------------------------===//
     // Playback context and caches
@@ -165,6 +167,11 @@ public:
     void onRemoveMidiEvent(const MidiEvent &event) override;
     void onPostRemoveMidiEvent(MidiSequence *const layer) override;
 
+    void onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents) override;
+    void onAddMidiEvents(const Array<const MidiEvent *> &events) override;
+    void onRemoveMidiEvents(const Array<const MidiEvent *> &events) override;
+
     void onAddClip(const Clip &clip) override;
     void onChangeClip(const Clip &oldClip, const Clip &newClip) override;
     void onRemoveClip(const Clip &clip) override;
@@ -212,8 +219,7 @@ private:
     void broadcastLoopModeChanged(bool hasLoop, float startBeat, float endBeat);
     void broadcastSeek(float newBeat, double currentTimeMs, double totalTimeMs);
 
-    friend class PlayerThread;
-    friend class PlayerThreadPool;
+    friend class Player;
     friend class RendererThread;
 
 private:
@@ -222,14 +228,28 @@ private:
     SleepTimer &sleepTimer;
     static constexpr auto soundSleepDelayMs = 60000;
 
-    UniquePointer<PlayerThreadPool> player;
+    UniquePointer<Player> player;
     UniquePointer<RendererThread> renderer;
 
 private:
 
     mutable TransportPlaybackCache playbackCache;
+
+    // the whole cache is rebuilt when this flag is set (e.g. instruments
+    // have changed), otherwise only the outdated tracks are re-exported:
     mutable Atomic<bool> playbackCacheIsOutdated = true;
+    mutable FlatHashSet<String, StringHash> outdatedTracks;
+    mutable bool playbackCacheHasSoloClips = false;
+
     void recacheIfNeeded() const;
+    void invalidateCacheFor(const MidiTrack *track);
+    bool hasSoloClips() const noexcept;
+    CachedMidiSequence::Ptr exportTrack(const MidiTrack *track, bool hasSoloClips) const;
+    void rebuildTempoMap() const;
+
+    // rebuilt together with the playback cache from its tempo events,
+    // used for all beat-to-time conversions:
+    mutable TempoMap tempoMap;
 
     // linksCache is <track id : instrument>
     mutable Array<const MidiTrack *> tracksCache;
@@ -243,39 +263,30 @@ private:
 
 private:
 
-    class NotePreviewTimer final : private Timer
+    class NotePreviewScheduler final
     {
     public:
 
-        NotePreviewTimer() = default;
-        ~NotePreviewTimer();
+        NotePreviewScheduler() = default;
+        ~NotePreviewScheduler();
 
         void cancelAllPendingPreviews(bool sendRemainingNoteOffs);
         void previewNote(WeakReference<Instrument> instrument,
-            int key, float volume, int16 noteOffTimeoutMs);
+            int key, float volume, int noteOffTimeoutMs);
 
     private:
 
-        void timerCallback() override;
-
-        struct KeyPreviewState final
-        {
-            WeakReference<Instrument> instrument;
-            float volume = 0;
-            int16 noteOnTimeoutMs = 0;
-            int16 noteOffTimeoutMs = 0;
-        };
-
-        static constexpr auto timerTickMs = 50;
         static constexpr auto numPreviewedKeys =
             Globals::numChannels * Globals::twelveToneKeyboardSize;
 
-        KeyPreviewState previews[numPreviewedKeys];
+        // the instrument, which each key was last previewed with,
+        // the timing itself is up to the instruments' audio callbacks:
+        WeakReference<Instrument> previewedInstruments[numPreviewedKeys];
 
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NotePreviewTimer)
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NotePreviewScheduler)
     };
 
-    mutable NotePreviewTimer notePreviewTimer;
+    mutable NotePreviewScheduler notePreviewScheduler;
 
 private:
 
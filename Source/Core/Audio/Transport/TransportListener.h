@@ -24,7 +24,8 @@ public:
     virtual ~TransportListener() = default;
 
     // expect that any data in these three methods could come
-    // from a separate thread (PlayerThread most likely)
+    // from a separate thread (the player sends them from its timer
+    // on the message thread, but don't rely on that)
     virtual void onSeek(float beatPosition, double currentTimeMs, double totalTimeMs) = 0;
     virtual void onTempoChanged(double msPerQuarter) = 0;
     virtual void onTotalTimeChanged(double timeMs) = 0;
@@ -0,0 +1,338 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "TransportPlaybackCache.h"
+
+TransportPlaybackCache::TransportPlaybackCache(const TransportPlaybackCache &other)
+{
+    this->sequences.addArray(other.sequences);
+    this->uniqueInstruments.addArray(other.uniqueInstruments);
+    this->cursorsHeap.ensureStorageAllocated(this->sequences.size());
+    this->seekToTime(0.0);
+}
+
+void TransportPlaybackCache::addWrapper(CachedMidiSequence::Ptr newWrapper)
+{
+    if (newWrapper->midiMessages.getNumEvents() > 0)
+    {
+        this->uniqueInstruments.addIfNotAlreadyThere(newWrapper->instrument);
+        this->sequences.add(newWrapper);
+        this->pushCursor(newWrapper.get(), this->sequences.size() - 1, 0);
+    }
+}
+
+void TransportPlaybackCache::clear()
+{
+    this->uniqueInstruments.clearQuick();
+    this->sequences.clearQuick();
+    this->cursorsHeap.clearQuick();
+}
+
+void TransportPlaybackCache::updateWrapperFor(const MidiSequence *track,
+    CachedMidiSequence::Ptr newWrapper)
+{
+    jassert(newWrapper->track == track);
+
+    const auto index = this->indexOfWrapperFor(track);
+    if (index < 0)
+    {
+        this->addWrapper(newWrapper);
+        this->seekToTime(0.0);
+        return;
+    }
+
+    if (newWrapper->midiMessages.getNumEvents() == 0)
+    {
+        this->removeWrapperFor(track);
+        return;
+    }
+
+    // the sequence is fully exported before it gets here,
+    // so that it is replaced with a single pointer swap
+    this->sequences.set(index, newWrapper);
+    this->updateUniqueInstruments();
+    this->seekToTime(0.0);
+}
+
+void TransportPlaybackCache::removeWrapperFor(const MidiSequence *track)
+{
+    const auto index = this->indexOfWrapperFor(track);
+    if (index >= 0)
+    {
+        this->sequences.remove(index);
+        this->updateUniqueInstruments();
+        this->seekToTime(0.0);
+    }
+}
+
+int TransportPlaybackCache::indexOfWrapperFor(const MidiSequence *track) const
+{
+    for (int i = 0; i < this->sequences.size(); ++i)
+    {
+        if (this->sequences.getObjectPointerUnchecked(i)->track == track)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void TransportPlaybackCache::updateUniqueInstruments()
+{
+    this->uniqueInstruments.clearQuick();
+    for (const auto *wrapper : this->sequences)
+    {
+        this->uniqueInstruments.addIfNotAlreadyThere(wrapper->instrument);
+    }
+}
+
+double TransportPlaybackCache::getSampleRate() const
+{
+    if (this->isEmpty())
+    {
+        return 0.0;
+    }
+
+    // TODO: something more reasonable?
+    return this->sequences[0]->instrument->getProcessorGraph()->getSampleRate();
+}
+
+int TransportPlaybackCache::getNumOutputChannels() const
+{
+    if (this->isEmpty())
+    {
+        return 0;
+    }
+
+    // TODO: something more reasonable?
+    return this->sequences[0]->instrument->getProcessorGraph()->getTotalNumOutputChannels();
+}
+
+int TransportPlaybackCache::getNumInputChannels() const
+{
+    if (this->isEmpty())
+    {
+        return 0;
+    }
+
+    // TODO: something more reasonable?
+    return this->sequences[0]->instrument->getProcessorGraph()->getTotalNumInputChannels();
+}
+
+ReferenceCountedArray<CachedMidiSequence> TransportPlaybackCache::getAllFor(const MidiSequence *midiTrack) const
+{
+    ReferenceCountedArray<CachedMidiSequence> result;
+    for (int i = 0; i < this->sequences.size(); ++i)
+    {
+        CachedMidiSequence::Ptr seq(this->sequences[i]);
+        if (midiTrack == nullptr || midiTrack == seq->track)
+        {
+            result.add(seq);
+        }
+    }
+
+    return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Merged iteration
+//===----------------------------------------------------------------------===//
+
+void TransportPlaybackCache::seekToTime(double position)
+{
+    this->cursorsHeap.clearQuick();
+
+    for (int i = 0; i < this->sequences.size(); ++i)
+    {
+        const auto *wrapper = this->sequences.getObjectPointerUnchecked(i);
+        const auto eventIndex = TransportPlaybackCache::findNextIndexAtTime(wrapper->midiMessages, position);
+        this->pushCursor(wrapper, i, eventIndex);
+    }
+}
+
+bool TransportPlaybackCache::getNextMessage(CachedMidiMessage &target)
+{
+    if (this->cursorsHeap.isEmpty())
+    {
+        return false;
+    }
+
+    std::pop_heap(this->cursorsHeap.begin(), this->cursorsHeap.end(),
+        TransportPlaybackCache::isLaterThan);
+
+    const auto cursor = this->cursorsHeap.getLast();
+    this->cursorsHeap.removeLast();
+
+    const auto *wrapper = cursor.sequence;
+    target.message = wrapper->midiMessages.getEventPointer(cursor.eventIndex)->message;
+    target.listener = wrapper->listener;
+    target.instrument = wrapper->instrument;
+
+    this->pushCursor(wrapper, cursor.sequenceIndex, cursor.eventIndex + 1);
+    return true;
+}
+
+bool TransportPlaybackCache::isLaterThan(const Cursor &a, const Cursor &b) noexcept
+{
+    // simultaneous events come in the order of sequences, as they always did
+    return a.timeStamp > b.timeStamp ||
+        (a.timeStamp == b.timeStamp && a.sequenceIndex > b.sequenceIndex);
+}
+
+void TransportPlaybackCache::pushCursor(const CachedMidiSequence *sequence,
+    int sequenceIndex, int eventIndex)
+{
+    if (eventIndex >= sequence->midiMessages.getNumEvents())
+    {
+        return;
+    }
+
+    const auto timeStamp = sequence->midiMessages.getEventPointer(eventIndex)->message.getTimeStamp();
+    this->cursorsHeap.add({ sequence, sequenceIndex, eventIndex, timeStamp });
+    std::push_heap(this->cursorsHeap.begin(), this->cursorsHeap.end(),
+        TransportPlaybackCache::isLaterThan);
+}
+
+int TransportPlaybackCache::findNextIndexAtTime(const MidiMessageSequence &sequence, double timeStamp) noexcept
+{
+    int low = 0;
+    int high = sequence.getNumEvents();
+
+    while (low < high)
+    {
+        const auto middle = (low + high) / 2;
+        if (sequence.getEventPointer(middle)->message.getTimeStamp() < timeStamp)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+int TransportPlaybackCache::findNextIndexAfterTime(const MidiMessageSequence &sequence, double timeStamp) noexcept
+{
+    int low = 0;
+    int high = sequence.getNumEvents();
+
+    while (low < high)
+    {
+        const auto middle = (low + high) / 2;
+        if (sequence.getEventPointer(middle)->message.getTimeStamp() > timeStamp)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+
+    return low;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class TransportPlaybackCacheTests final : public UnitTest
+{
+public:
+    TransportPlaybackCacheTests() : UnitTest("Transport playback cache tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Binary search in sorted sequences");
+
+        MidiMessageSequence sequence;
+        for (const auto beat : { 0.0, 1.0, 1.0, 2.0, 4.0 })
+        {
+            sequence.addEvent(MidiMessage::noteOn(1, 60, 1.f).withTimeStamp(beat));
+        }
+
+        expectEquals(TransportPlaybackCache::findNextIndexAtTime(sequence, -1.0), 0);
+        expectEquals(TransportPlaybackCache::findNextIndexAtTime(sequence, 0.0), 0);
+        expectEquals(TransportPlaybackCache::findNextIndexAtTime(sequence, 1.0), 1);
+        expectEquals(TransportPlaybackCache::findNextIndexAtTime(sequence, 1.5), 3);
+        expectEquals(TransportPlaybackCache::findNextIndexAtTime(sequence, 5.0), 5);
+
+        expectEquals(TransportPlaybackCache::findNextIndexAfterTime(sequence, -1.0), 0);
+        expectEquals(TransportPlaybackCache::findNextIndexAfterTime(sequence, 0.0), 1);
+        expectEquals(TransportPlaybackCache::findNextIndexAfterTime(sequence, 1.0), 3);
+        expectEquals(TransportPlaybackCache::findNextIndexAfterTime(sequence, 4.0), 5);
+        expectEquals(TransportPlaybackCache::findNextIndexAfterTime(MidiMessageSequence(), 1.0), 0);
+
+        beginTest("Merged iteration over multiple sequences");
+
+        TransportPlaybackCache cache;
+        for (int i = 0; i < 3; ++i)
+        {
+            CachedMidiSequence::Ptr wrapper(new CachedMidiSequence());
+            wrapper->instrument = nullptr;
+            wrapper->listener = nullptr;
+            wrapper->track = nullptr;
+            for (int beat = i; beat < 10; beat += 2)
+            {
+                // the key is used to tell the sequences apart
+                wrapper->midiMessages.addEvent(MidiMessage::noteOn(1, i, 1.f).withTimeStamp(beat));
+            }
+            cache.addWrapper(wrapper);
+        }
+
+        // copies have their own read positions
+        TransportPlaybackCache copy(cache);
+
+        CachedMidiMessage next;
+        Array<int> keys;
+        double lastTimeStamp = 0.0;
+        while (cache.getNextMessage(next))
+        {
+            expect(next.message.getTimeStamp() >= lastTimeStamp);
+            lastTimeStamp = next.message.getTimeStamp();
+            keys.add(next.message.getNoteNumber());
+        }
+
+        expectEquals(keys.size(), 14);
+        expectEquals(keys[0], 0);
+        expectEquals(keys[1], 1);
+        // simultaneous events keep the sequences order:
+        expectEquals(keys[2], 0);
+        expectEquals(keys[3], 2);
+
+        expect(copy.getNextMessage(next));
+        expectEquals(next.message.getTimeStamp(), 0.0);
+
+        copy.seekToTime(7.0);
+        expect(copy.getNextMessage(next));
+        expectEquals(next.message.getTimeStamp(), 7.0);
+        expect(copy.getNextMessage(next));
+        expectEquals(next.message.getTimeStamp(), 8.0);
+        expectEquals(next.message.getNoteNumber(), 0);
+    }
+};
+
+static TransportPlaybackCacheTests transportPlaybackCacheTests;
+
+#endif
@@ -18,17 +18,38 @@
 #pragma once
 
 #include "Instrument.h"
+#include "IntervalIndex.h"
 
 class MidiSequence;
 
 struct CachedMidiSequence final : public ReferenceCountedObject
 {
     MidiMessageSequence midiMessages;
-    int currentIndex;
     MidiMessageCollector *listener;
     Instrument *instrument;
     const MidiSequence *track;
 
+    // the spans of the matched note-ons, for finding the notes sounding
+    // at some time without going through the whole sequence
+    IntervalIndex notesIndex;
+
+    void rebuildNotesIndex()
+    {
+        this->notesIndex.clear();
+
+        for (int i = 0; i < this->midiMessages.getNumEvents(); ++i)
+        {
+            const auto *noteOn = this->midiMessages.getEventPointer(i);
+            if (const auto *noteOff = noteOn->noteOffObject)
+            {
+                this->notesIndex.add(noteOn->message.getTimeStamp(),
+                    noteOff->message.getTimeStamp(), i);
+            }
+        }
+
+        this->notesIndex.build();
+    }
+
     using Ptr = ReferenceCountedObjectPtr<CachedMidiSequence>;
 
     static Ptr createFrom(Instrument *instrument, const MidiSequence *track = nullptr)
@@ -36,7 +57,6 @@ struct CachedMidiSequence final : public ReferenceCountedObject
         jassert(instrument != nullptr);
         CachedMidiSequence::Ptr wrapper(new CachedMidiSequence());
         wrapper->track = track;
-        wrapper->currentIndex = 0;
         wrapper->instrument = instrument;
         wrapper->listener = &instrument->getProcessorPlayer().getMidiMessageCollector();
         return wrapper;
@@ -51,165 +71,80 @@ struct CachedMidiMessage final : public ReferenceCountedObject
     using Ptr = ReferenceCountedObjectPtr<CachedMidiMessage>;
 };
 
+// The cached sequences are shared between all copies of the cache,
+// and the read positions are not: each copy merges the sequences
+// with its own min-heap of cursors, so that the player and the renderer
+// can iterate their copies independently; getNextMessage() is O(log tracks),
+// and seekToTime() is a binary search in each sequence.
+// Once the cache is filled up, iterating it doesn't allocate memory.
+
 class TransportPlaybackCache final
 {
-private:
-    
-    Array<Instrument *, CriticalSection> uniqueInstruments;
-    ReferenceCountedArray<CachedMidiSequence, CriticalSection> sequences;
-
 public:
     
     TransportPlaybackCache() = default;
-    TransportPlaybackCache(const TransportPlaybackCache &other)
-    {
-        this->sequences.addArray(other.sequences);
-        this->uniqueInstruments.addArray(other.uniqueInstruments);
-    }
+    TransportPlaybackCache(const TransportPlaybackCache &other);
 
     inline Array<Instrument *, CriticalSection> getUniqueInstruments() const noexcept
     {
         return this->uniqueInstruments;
     }
     
-    void addWrapper(CachedMidiSequence::Ptr newWrapper) noexcept
-    {
-        if (newWrapper->midiMessages.getNumEvents() > 0)
-        {
-            this->uniqueInstruments.addIfNotAlreadyThere(newWrapper->instrument);
-            this->sequences.add(newWrapper);
-        }
-    }
-    
-    inline void clear()
-    {
-        this->uniqueInstruments.clearQuick();
-        this->sequences.clearQuick();
-    }
+    void addWrapper(CachedMidiSequence::Ptr newWrapper);
+    void clear();
+
+    // replaces the cached sequence of the given track, the copies
+    // of this cache made before still hold the old sequence;
+    // this also resets the read position, like seekToTime(0.0)
+    void updateWrapperFor(const MidiSequence *track, CachedMidiSequence::Ptr newWrapper);
+    void removeWrapperFor(const MidiSequence *track);
     
     inline bool isEmpty() const
     {
         return this->sequences.isEmpty();
     }
     
-    double getSampleRate() const
-    {
-        if (this->isEmpty())
-        {
-            return 0.0;
-        }
+    double getSampleRate() const;
+    int getNumOutputChannels() const;
+    int getNumInputChannels() const;
 
-        // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getSampleRate();
-    }
+    ReferenceCountedArray<CachedMidiSequence> getAllFor(const MidiSequence *midiTrack) const;
 
-    int getNumOutputChannels() const
-    {
-        if (this->isEmpty())
-        {
-            return 0;
-        }
+    //===------------------------------------------------------------------===//
+    // Merged iteration
+    //===------------------------------------------------------------------===//
 
-        // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getTotalNumOutputChannels();
-    }
+    void seekToTime(double position);
+    bool getNextMessage(CachedMidiMessage &target);
 
-    int getNumInputChannels() const
-    {
-        if (this->isEmpty())
-        {
-            return 0;
-        }
+    // binary search helpers, the sequences are expected to be sorted:
+    // returns the index of the first event at or after the given time
+    static int findNextIndexAtTime(const MidiMessageSequence &sequence, double timeStamp) noexcept;
+    // returns the index of the first event strictly after the given time
+    static int findNextIndexAfterTime(const MidiMessageSequence &sequence, double timeStamp) noexcept;
 
-        // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getTotalNumInputChannels();
-    }
+private:
 
-    ReferenceCountedArray<CachedMidiSequence> getAllFor(const MidiSequence *midiTrack)
-    {
-        ReferenceCountedArray<CachedMidiSequence> result;
-        for (int i = 0; i < this->sequences.size(); ++i)
-        {
-            CachedMidiSequence::Ptr seq(this->sequences[i]);
-            if (midiTrack == nullptr || midiTrack == seq->track)
-            {
-                result.add(seq);
-            }
-        }
-        
-        return result;
-    }
+    Array<Instrument *, CriticalSection> uniqueInstruments;
+    ReferenceCountedArray<CachedMidiSequence, CriticalSection> sequences;
 
-    void seekToTime(double position)
+    struct Cursor final
     {
-        for (auto *wrapper : this->sequences)
-        {
-            wrapper->currentIndex = this->getNextIndexAtTime(wrapper->midiMessages, (position - DBL_MIN));
-        }
-    }
-    
-    void seekToZeroIndexes()
-    {
-        for (auto *wrapper : this->sequences)
-        {
-            wrapper->currentIndex = 0;
-        }
-    }
-    
-    bool getNextMessage(CachedMidiMessage &target)
-    {
-        double minTimeStamp = DBL_MAX;
-        int targetSequenceIndex = -1;
-
-        for (int i = 0; i < this->sequences.size(); ++i)
-        {
-            const auto *wrapper = this->sequences.getObjectPointer(i);
-            if (wrapper->currentIndex < wrapper->midiMessages.getNumEvents())
-            {
-                const auto &message = wrapper->midiMessages.getEventPointer(wrapper->currentIndex)->message;
-
-                if (message.getTimeStamp() < minTimeStamp)
-                {
-                    minTimeStamp = message.getTimeStamp();
-                    targetSequenceIndex = i;
-                }
-            }
-        }
+        const CachedMidiSequence *sequence;
+        int sequenceIndex;
+        int eventIndex;
+        double timeStamp;
+    };
 
-        if (targetSequenceIndex < 0)
-        {
-            return false;
-        }
-
-        auto *foundWrapper = this->sequences.getObjectPointer(targetSequenceIndex);
-        jassert(foundWrapper->currentIndex < foundWrapper->midiMessages.getNumEvents());
+    // the min-heap of the next events of all non-exhausted sequences,
+    // ordered by timestamp, and by the sequence order for simultaneous events
+    Array<Cursor> cursorsHeap;
 
-        auto &foundMessage = foundWrapper->midiMessages.getEventPointer(foundWrapper->currentIndex)->message;
-        foundWrapper->currentIndex++;
+    int indexOfWrapperFor(const MidiSequence *track) const;
+    void updateUniqueInstruments();
 
-        target.message = foundMessage;
-        target.listener = foundWrapper->listener;
-        target.instrument = foundWrapper->instrument;
-
-        return true;
-    }
-    
-private:
-    
-    int getNextIndexAtTime(const MidiMessageSequence &sequence, double timeStamp) const
-    {
-        int i = 0;
-        for (; i < sequence.getNumEvents(); ++i)
-        {
-            const double eventTs = sequence.getEventPointer(i)->message.getTimeStamp();
-            if (eventTs >= timeStamp)
-            {
-                break;
-            }
-        }
-        
-        return i;
-    }
+    static bool isLaterThan(const Cursor &a, const Cursor &b) noexcept;
+    void pushCursor(const CachedMidiSequence *sequence, int sequenceIndex, int eventIndex);
 
     JUCE_LEAK_DETECTOR(TransportPlaybackCache)
 };
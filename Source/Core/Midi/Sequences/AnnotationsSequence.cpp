@@ -141,14 +141,19 @@ bool AnnotationsSequence::insertGroup(Array<AnnotationEvent> &group, bool undoab
     }
     else
     {
+        Array<const MidiEvent *> addedEvents;
+        addedEvents.ensureStorageAllocated(group.size());
+
         for (int i = 0; i < group.size(); ++i)
         {
             const auto &eventParams = group.getReference(i);
             auto *ownedEvent = new AnnotationEvent(this, eventParams);
             jassert(ownedEvent->isValid());
             this->midiEvents.addSorted(*ownedEvent, ownedEvent);
-            this->eventDispatcher.dispatchAddEvent(*ownedEvent);
+            addedEvents.add(ownedEvent);
         }
+
+        this->eventDispatcher.dispatchAddEvents(addedEvents);
         
         this->updateBeatRange(true);
     }
@@ -166,14 +171,28 @@ bool AnnotationsSequence::removeGroup(Array<AnnotationEvent> &group, bool undoab
     }
     else
     {
+        Array<const MidiEvent *> removedEvents;
+        removedEvents.ensureStorageAllocated(group.size());
+
+        for (int i = 0; i < group.size(); ++i)
+        {
+            const AnnotationEvent &annotation = group.getReference(i);
+            const int index = this->midiEvents.indexOfSorted(annotation, &annotation);
+            if (index >= 0)
+            {
+                removedEvents.add(this->midiEvents.getUnchecked(index));
+            }
+        }
+
+        // all removed events are still valid while listeners are notified:
+        this->eventDispatcher.dispatchRemoveEvents(removedEvents);
+
         for (int i = 0; i < group.size(); ++i)
         {
             const AnnotationEvent &annotation = group.getReference(i);
             const int index = this->midiEvents.indexOfSorted(annotation, &annotation);
             if (index >= 0)
             {
-                auto *removedEvent = this->midiEvents.getUnchecked(index);
-                this->eventDispatcher.dispatchRemoveEvent(*removedEvent);
                 this->midiEvents.remove(index, true);
             }
         }
@@ -198,6 +217,11 @@ bool AnnotationsSequence::changeGroup(Array<AnnotationEvent> &groupBefore,
     }
     else
     {
+        Array<const MidiEvent *> oldEvents;
+        Array<const MidiEvent *> newEvents;
+        oldEvents.ensureStorageAllocated(groupBefore.size());
+        newEvents.ensureStorageAllocated(groupBefore.size());
+
         for (int i = 0; i < groupBefore.size(); ++i)
         {
             const AnnotationEvent &oldParams = groupBefore.getReference(i);
@@ -209,10 +233,13 @@ bool AnnotationsSequence::changeGroup(Array<AnnotationEvent> &groupBefore,
                 changedEvent->applyChanges(newParams);
                 this->midiEvents.remove(index, false);
                 this->midiEvents.addSorted(*changedEvent, changedEvent);
-                this->eventDispatcher.dispatchChangeEvent(oldParams, *changedEvent);
+                oldEvents.add(&oldParams);
+                newEvents.add(changedEvent);
             }
         }
 
+        this->eventDispatcher.dispatchChangeEvents(oldEvents, newEvents);
+
         this->updateBeatRange(true);
     }
 
@@ -265,6 +292,8 @@ void AnnotationsSequence::deserialize(const SerializedData &data)
     float lastBeat = 0.f;
     float firstBeat = 0.f;
 
+    this->midiEvents.ensureStorageAllocated(root.getNumChildren());
+
     forEachChildWithType(root, e, Serialization::Midi::annotation)
     {
         AnnotationEvent *annotation = new AnnotationEvent(this);
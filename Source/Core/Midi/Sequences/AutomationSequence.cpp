@@ -22,6 +22,7 @@
 #include "ProjectNode.h"
 #include "MidiTrackNode.h"
 #include "UndoStack.h"
+#include "EventColumns.h"
 
 AutomationSequence::AutomationSequence(MidiTrack &track,
     ProjectEventDispatcher &dispatcher) noexcept :
@@ -31,13 +32,13 @@ float AutomationSequence::getAverageControllerValue() const
 {
     float result = 0.f;
 
-    for (const auto *event : this->midiEvents)
+    for (const auto *event : *this)
     {
         const auto *cc = static_cast<const AutomationEvent *>(event);
         result += cc->getControllerValue();
     }
 
-    return result / float(this->midiEvents.size());
+    return result / float(this->size());
 }
 
 //===----------------------------------------------------------------------===//
@@ -84,6 +85,7 @@ MidiEvent *AutomationSequence::insert(const AutomationEvent &eventParams, bool u
     }
     else
     {
+        this->ensureLoaded();
         auto *ownedEvent = new AutomationEvent(this, eventParams);
         this->midiEvents.addSorted(*ownedEvent, ownedEvent);
         this->eventDispatcher.dispatchAddEvent(*ownedEvent);
@@ -104,6 +106,7 @@ bool AutomationSequence::remove(const AutomationEvent &eventParams, bool undoabl
     }
     else
     {
+        this->ensureLoaded();
         const int index = this->midiEvents.indexOfSorted(eventParams, &eventParams);
         if (index >= 0)
         {
@@ -132,6 +135,7 @@ bool AutomationSequence::change(const AutomationEvent &oldParams,
     }
     else
     {
+        this->ensureLoaded();
         const int index = this->midiEvents.indexOfSorted(oldParams, &oldParams);
         if (index >= 0)
         {
@@ -160,13 +164,19 @@ bool AutomationSequence::insertGroup(Array<AutomationEvent> &group, bool undoabl
     }
     else
     {
+        this->ensureLoaded();
+        Array<const MidiEvent *> addedEvents;
+        addedEvents.ensureStorageAllocated(group.size());
+
         for (int i = 0; i < group.size(); ++i)
         {
             const auto &eventParams = group.getUnchecked(i);
             auto *ownedEvent = new AutomationEvent(this, eventParams);
             this->midiEvents.addSorted(*ownedEvent, ownedEvent);
-            this->eventDispatcher.dispatchAddEvent(*ownedEvent);
+            addedEvents.add(ownedEvent);
         }
+
+        this->eventDispatcher.dispatchAddEvents(addedEvents);
         
         this->updateBeatRange(true);
     }
@@ -184,14 +194,29 @@ bool AutomationSequence::removeGroup(Array<AutomationEvent> &group, bool undoabl
     }
     else
     {
+        this->ensureLoaded();
+        Array<const MidiEvent *> removedEvents;
+        removedEvents.ensureStorageAllocated(group.size());
+
+        for (int i = 0; i < group.size(); ++i)
+        {
+            const AutomationEvent &autoEvent = group.getUnchecked(i);
+            const int index = this->midiEvents.indexOfSorted(autoEvent, &autoEvent);
+            if (index >= 0)
+            {
+                removedEvents.add(this->midiEvents.getUnchecked(index));
+            }
+        }
+
+        // all removed events are still valid while listeners are notified:
+        this->eventDispatcher.dispatchRemoveEvents(removedEvents);
+
         for (int i = 0; i < group.size(); ++i)
         {
             const AutomationEvent &autoEvent = group.getUnchecked(i);
             const int index = this->midiEvents.indexOfSorted(autoEvent, &autoEvent);
             if (index >= 0)
             {
-                const auto removedEvent = this->midiEvents[index];
-                this->eventDispatcher.dispatchRemoveEvent(*removedEvent);
                 this->midiEvents.remove(index, true);
             }
         }
@@ -216,9 +241,15 @@ bool AutomationSequence::changeGroup(const Array<AutomationEvent> groupBefore,
     }
     else
     {
+        this->ensureLoaded();
+        Array<const MidiEvent *> oldEvents;
+        Array<const MidiEvent *> newEvents;
+        oldEvents.ensureStorageAllocated(groupBefore.size());
+        newEvents.ensureStorageAllocated(groupBefore.size());
+
         for (int i = 0; i < groupBefore.size(); ++i)
         {
-            const AutomationEvent &oldParams = groupBefore.getUnchecked(i);
+            const AutomationEvent &oldParams = groupBefore.getReference(i);
             const AutomationEvent &newParams = groupAfter.getUnchecked(i);
             const int index = this->midiEvents.indexOfSorted(oldParams, &oldParams);
             if (index >= 0)
@@ -227,9 +258,12 @@ bool AutomationSequence::changeGroup(const Array<AutomationEvent> groupBefore,
                 changedEvent->applyChanges(newParams);
                 this->midiEvents.remove(index, false);
                 this->midiEvents.addSorted(*changedEvent, changedEvent);
-                this->eventDispatcher.dispatchChangeEvent(oldParams, *changedEvent);
+                oldEvents.add(&oldParams);
+                newEvents.add(changedEvent);
             }
         }
+
+        this->eventDispatcher.dispatchChangeEvents(oldEvents, newEvents);
         
         this->updateBeatRange(true);
     }
@@ -243,7 +277,13 @@ bool AutomationSequence::changeGroup(const Array<AutomationEvent> groupBefore,
 
 SerializedData AutomationSequence::serialize() const
 {
+    if (!this->isLoaded())
+    {
+        return this->serializePendingContent();
+    }
+
     SerializedData tree(Serialization::Midi::automation);
+    this->serializeHeader(tree);
 
     for (int i = 0; i < this->midiEvents.size(); ++i)
     {
@@ -254,6 +294,31 @@ SerializedData AutomationSequence::serialize() const
     return tree;
 }
 
+SerializedData AutomationSequence::serializeSnapshot() const
+{
+    if (!this->isLoaded())
+    {
+        return this->serializePendingContent();
+    }
+
+    // the same values as AutomationEvent::serialize() writes
+    EventColumns::Ptr columns(new EventColumns(EventColumns::Kind::Automation));
+    columns->ensureStorageAllocated(this->midiEvents.size());
+
+    for (const auto *event : this->midiEvents)
+    {
+        const auto *autoEvent = static_cast<const AutomationEvent *>(event);
+        columns->addAutomationEvent(autoEvent->getId(),
+            int(autoEvent->getBeat() * Globals::ticksPerBeat),
+            autoEvent->getControllerValue(), autoEvent->getCurvature());
+    }
+
+    SerializedData tree(Serialization::Midi::automation);
+    this->serializeHeader(tree);
+    tree.setProperty(Serialization::Midi::columns, var(columns.get()));
+    return tree;
+}
+
 void AutomationSequence::deserialize(const SerializedData &data)
 {
     this->reset();
@@ -265,28 +330,49 @@ void AutomationSequence::deserialize(const SerializedData &data)
     if (!root.isValid())
     { return; }
 
-    float firstBeat = 0;
-    float lastBeat = 0;
+    this->deserializeEvents(root, AutomationSequence::decodeEvents);
+}
+
+void AutomationSequence::decodeEvents(const WeakReference<MidiSequence> &owner,
+    const SerializedData &root, OwnedArray<MidiEvent> &outEvents)
+{
+    // deserialize into the unowned parameters first, so that
+    // the owned events don't generate their ids (see PianoSequence)
+    AutomationEvent parameters;
 
-    forEachChildWithType(root, e, Serialization::Midi::automationEvent)
+    // the binary project format keeps the events in columns instead of nodes
+    EventColumns columns;
+    if (const auto *columnsData = root.getProperty(Serialization::Midi::columns).getBinaryData())
     {
-        auto *event = new AutomationEvent(this, 0, 0);
-        event->deserialize(e);
-        
-        this->midiEvents.add(event); // sorted later
-        
-        lastBeat = jmax(lastBeat, event->getBeat());
-        firstBeat = jmin(firstBeat, event->getBeat());
+        if (columns.readFromData(columnsData->getData(), columnsData->getSize()) &&
+            columns.getKind() == EventColumns::Kind::Automation)
+        {
+            outEvents.ensureStorageAllocated(columns.size());
 
-        this->usedEventIds.insert(event->getId());
+            for (int i = 0; i < columns.size(); ++i)
+            {
+                parameters.deserialize(columns.getIds().getUnchecked(i),
+                    float(columns.getBeats().getUnchecked(i)),
+                    columns.getValues().getUnchecked(i),
+                    columns.getCurves().getUnchecked(i));
+
+                outEvents.add(new AutomationEvent(owner, parameters));
+            }
+        }
     }
 
-    this->sort();
-    this->updateBeatRange(false);
+    outEvents.ensureStorageAllocated(outEvents.size() + root.getNumChildren());
+
+    forEachChildWithType(root, e, Serialization::Midi::automationEvent)
+    {
+        parameters.deserialize(e);
+        outEvents.add(new AutomationEvent(owner, parameters)); // sorted later
+    }
 }
 
 void AutomationSequence::reset()
 {
+    this->resetPendingContent();
     this->midiEvents.clear();
     this->usedEventIds.clear();
 }
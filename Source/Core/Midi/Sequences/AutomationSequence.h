@@ -56,10 +56,14 @@ public:
     //===------------------------------------------------------------------===//
 
     SerializedData serialize() const override;
+    SerializedData serializeSnapshot() const override;
     void deserialize(const SerializedData &data) override;
     void reset() override;
     
 private:
 
+    static void decodeEvents(const WeakReference<MidiSequence> &owner,
+        const SerializedData &root, OwnedArray<MidiEvent> &outEvents);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutomationSequence);
 };
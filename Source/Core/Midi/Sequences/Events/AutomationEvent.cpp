@@ -268,12 +268,20 @@ SerializedData AutomationEvent::serialize() const
 
 void AutomationEvent::deserialize(const SerializedData &data)
 {
-    this->reset();
     using namespace Serialization;
-    this->controllerValue = float(data.getProperty(Midi::value));
-    this->curvature = float(data.getProperty(Midi::curve, Globals::Defaults::automationControllerCurve));
-    this->beat = float(data.getProperty(Midi::timestamp)) / Globals::ticksPerBeat;
-    this->id = unpackId(data.getProperty(Midi::id));
+    this->deserialize(unpackId(data.getProperty(Midi::id)),
+        float(data.getProperty(Midi::timestamp)),
+        float(data.getProperty(Midi::value)),
+        float(data.getProperty(Midi::curve, Globals::Defaults::automationControllerCurve)));
+}
+
+void AutomationEvent::deserialize(Id id, float beatTicks, float value, float curve) noexcept
+{
+    this->reset();
+    this->controllerValue = value;
+    this->curvature = curve;
+    this->beat = beatTicks / Globals::ticksPerBeat;
+    this->id = id;
 }
 
 void AutomationEvent::reset() noexcept {}
@@ -81,6 +81,8 @@ public:
 
     SerializedData serialize() const override;
     void deserialize(const SerializedData &data) override;
+    // Same, but takes the values exactly as they are stored in the tree
+    void deserialize(Id id, float beatTicks, float value, float curve) noexcept;
     void reset() noexcept override;
 
     //===------------------------------------------------------------------===//
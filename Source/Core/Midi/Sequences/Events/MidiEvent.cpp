@@ -19,6 +19,7 @@
 #include "MidiEvent.h"
 #include "MidiSequence.h"
 #include "MidiTrack.h"
+#include "MidiEventPool.h"
 
 MidiEvent::MidiEvent(WeakReference<MidiSequence> owner, const MidiEvent &parameters) noexcept :
     sequence(owner),
@@ -84,6 +85,16 @@ int MidiEvent::compareElements(const MidiEvent *const first, const MidiEvent *co
     return first->getId() - second->getId();
 }
 
+void *MidiEvent::operator new(size_t size)
+{
+    return MidiEventPool::allocate(size);
+}
+
+void MidiEvent::operator delete(void *ptr, size_t size) noexcept
+{
+    MidiEventPool::deallocate(ptr, size);
+}
+
 MidiEvent::Id MidiEvent::createId() const noexcept
 {
     if (this->sequence != nullptr)
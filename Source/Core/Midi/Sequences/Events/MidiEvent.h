@@ -84,6 +84,19 @@ public:
 
     static int compareElements(const MidiEvent *const first, const MidiEvent *const second) noexcept;
 
+    //===------------------------------------------------------------------===//
+    // Allocation
+    //===------------------------------------------------------------------===//
+
+    // All events created on the heap, of any type, come from MidiEventPool;
+    // the sized delete gets the actual event's size via the virtual destructor
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size) noexcept;
+
+    // Arrays of events, e.g. in undo actions, construct them in place
+    static void *operator new(size_t, void *ptr) noexcept { return ptr; }
+    static void operator delete(void *, void *) noexcept {}
+
 protected:
 
     WeakReference<MidiSequence> sequence;
@@ -97,6 +110,7 @@ protected:
     static Id unpackId(const String &str);
 
     friend struct MidiEventHash;
+    friend class EventColumns;
     friend class LegacyEventFormatSupportTests;
 
 };
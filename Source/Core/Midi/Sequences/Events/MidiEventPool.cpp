@@ -0,0 +1,307 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "MidiEventPool.h"
+
+void *MidiEventPool::allocate(size_t size)
+{
+    if (auto *sizeClass = MidiEventPool::getSizeClass(size))
+    {
+        return sizeClass->allocate(MidiEventPool::granularity *
+            size_t(sizeClass - MidiEventPool::getSizeClasses() + 1));
+    }
+
+    return ::operator new(size);
+}
+
+void MidiEventPool::deallocate(void *ptr, size_t size) noexcept
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    if (auto *sizeClass = MidiEventPool::getSizeClass(size))
+    {
+        sizeClass->deallocate(ptr);
+        return;
+    }
+
+    ::operator delete(ptr);
+}
+
+MidiEventPool::SizeClass *MidiEventPool::getSizeClass(size_t size) noexcept
+{
+    if (size == 0 || size > MidiEventPool::maxBlockSize)
+    {
+        return nullptr;
+    }
+
+    return MidiEventPool::getSizeClasses() +
+        (size - 1) / MidiEventPool::granularity;
+}
+
+MidiEventPool::SizeClass *MidiEventPool::getSizeClasses() noexcept
+{
+    // never deleted, since some events may outlive any static object,
+    // and the chunks are freed anyway as soon as they are empty
+    static auto *sizeClasses = new SizeClass[MidiEventPool::numSizeClasses];
+    return sizeClasses;
+}
+
+//===----------------------------------------------------------------------===//
+// SizeClass
+//===----------------------------------------------------------------------===//
+
+void *MidiEventPool::SizeClass::allocate(size_t blockSize)
+{
+    const SpinLock::ScopedLockType sl(this->lock);
+
+    jassert(this->chunkBlockSize == 0 || this->chunkBlockSize == blockSize);
+    this->chunkBlockSize = blockSize;
+
+    if (this->currentChunk == nullptr || this->currentChunk->freeList == nullptr)
+    {
+        this->currentChunk = this->findChunkWithFreeBlocks();
+    }
+
+    if (this->currentChunk == nullptr)
+    {
+        auto newChunk = make<Chunk>(blockSize);
+        this->currentChunk = newChunk.get();
+        this->numEmptyChunks++;
+
+        const auto *address = newChunk->data.get();
+        int index = 0;
+        while (index < this->chunks.size() &&
+            this->chunks.getUnchecked(index)->data.get() < address)
+        {
+            index++;
+        }
+
+        this->chunks.insert(index, newChunk.release());
+    }
+
+    auto *chunk = this->currentChunk;
+    if (chunk->numLiveBlocks == 0)
+    {
+        this->numEmptyChunks--;
+    }
+
+    auto *block = chunk->freeList;
+    chunk->freeList = block->next;
+    chunk->numLiveBlocks++;
+    this->numLiveBlocks++;
+    return block;
+}
+
+void MidiEventPool::SizeClass::deallocate(void *ptr) noexcept
+{
+    const SpinLock::ScopedLockType sl(this->lock);
+
+    const auto chunkIndex = this->indexOfChunkContaining(ptr);
+    jassert(chunkIndex >= 0);
+    auto *chunk = this->chunks.getUnchecked(chunkIndex);
+
+    jassert(chunk->numLiveBlocks > 0);
+    chunk->numLiveBlocks--;
+    this->numLiveBlocks--;
+
+    auto *block = static_cast<FreeBlock *>(ptr);
+    block->next = chunk->freeList;
+    chunk->freeList = block;
+
+    if (chunk->numLiveBlocks > 0)
+    {
+        return;
+    }
+
+    if (this->numEmptyChunks == 0)
+    {
+        this->numEmptyChunks++;
+        return;
+    }
+
+    if (this->currentChunk == chunk)
+    {
+        this->currentChunk = nullptr;
+    }
+
+    this->chunks.remove(chunkIndex);
+}
+
+MidiEventPool::SizeClass::Chunk::Chunk(size_t blockSize) :
+    data(blockSize * MidiEventPool::blocksPerChunk)
+{
+    // in reverse, so that the blocks are handed out in the address order,
+    // which keeps the events created together close to each other
+    for (auto i = MidiEventPool::blocksPerChunk; i > 0; --i)
+    {
+        auto *block = reinterpret_cast<FreeBlock *>(this->data.get() + (i - 1) * blockSize);
+        block->next = this->freeList;
+        this->freeList = block;
+    }
+}
+
+MidiEventPool::SizeClass::Chunk *MidiEventPool::SizeClass::findChunkWithFreeBlocks() noexcept
+{
+    // only scanned when the current chunk is full,
+    // so it's amortized over the chunk's blocks
+    for (auto *chunk : this->chunks)
+    {
+        if (chunk->freeList != nullptr)
+        {
+            return chunk;
+        }
+    }
+
+    return nullptr;
+}
+
+int MidiEventPool::SizeClass::indexOfChunkContaining(void *ptr) const noexcept
+{
+    const auto *address = static_cast<const uint8 *>(ptr);
+    const auto chunkSize = this->chunkBlockSize * MidiEventPool::blocksPerChunk;
+
+    // the last chunk starting at or before the address
+    int first = 0;
+    int last = this->chunks.size();
+    while (first < last)
+    {
+        const int middle = (first + last) / 2;
+        if (this->chunks.getUnchecked(middle)->data.get() <= address)
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+
+    const int index = first - 1;
+    if (index < 0 || address >= this->chunks.getUnchecked(index)->data.get() + chunkSize)
+    {
+        return -1;
+    }
+
+    return index;
+}
+
+int MidiEventPool::SizeClass::getNumChunks() const noexcept
+{
+    const SpinLock::ScopedLockType sl(this->lock);
+    return this->chunks.size();
+}
+
+int MidiEventPool::SizeClass::getNumLiveBlocks() const noexcept
+{
+    const SpinLock::ScopedLockType sl(this->lock);
+    return this->numLiveBlocks;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class MidiEventPoolTests final : public UnitTest
+{
+public:
+    MidiEventPoolTests() : UnitTest("Midi event pool tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Blocks are recycled and chunks are released when empty");
+
+        // larger than any event type, so that nothing interferes:
+        constexpr size_t blockSize = MidiEventPool::maxBlockSize - 1;
+        const auto *sizeClass = MidiEventPool::getSizeClass(blockSize);
+        expect(sizeClass != nullptr);
+        expect(MidiEventPool::getSizeClass(MidiEventPool::maxBlockSize + 1) == nullptr);
+
+        const auto numBlocks = int(MidiEventPool::blocksPerChunk) * 3 + 1;
+        Array<void *> blocks;
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            auto *block = MidiEventPool::allocate(blockSize);
+            expectEquals(int(reinterpret_cast<pointer_sized_uint>(block) % MidiEventPool::granularity), 0);
+            blocks.add(block);
+        }
+
+        expectEquals(sizeClass->getNumLiveBlocks(), numBlocks);
+        expectEquals(sizeClass->getNumChunks(), 4);
+
+        // all blocks are distinct and don't overlap
+        Array<void *> sortedBlocks(blocks);
+        sortedBlocks.sort();
+        for (int i = 1; i < sortedBlocks.size(); ++i)
+        {
+            const auto distance = static_cast<uint8 *>(sortedBlocks[i]) -
+                static_cast<uint8 *>(sortedBlocks[i - 1]);
+            expect(distance >= int(MidiEventPool::maxBlockSize));
+        }
+
+        // the freed block is reused first
+        auto *freed = blocks[numBlocks / 2];
+        MidiEventPool::deallocate(freed, blockSize);
+        auto *reused = MidiEventPool::allocate(blockSize);
+        expect(reused == freed);
+
+        // each chunk is used up before the next one is allocated, so the blocks
+        // are grouped by chunks in the allocation order; the first chunk
+        // to empty is kept as a spare, and the next one is freed
+        const auto chunkSize = int(MidiEventPool::blocksPerChunk);
+
+        for (int i = chunkSize; i < chunkSize * 2; ++i)
+        {
+            MidiEventPool::deallocate(blocks.getUnchecked(i), blockSize);
+        }
+
+        expectEquals(sizeClass->getNumChunks(), 4);
+
+        for (int i = chunkSize * 2; i < chunkSize * 3; ++i)
+        {
+            MidiEventPool::deallocate(blocks.getUnchecked(i), blockSize);
+        }
+
+        expectEquals(sizeClass->getNumChunks(), 3);
+        expectEquals(sizeClass->getNumLiveBlocks(), numBlocks - chunkSize * 2);
+
+        blocks.removeRange(chunkSize, chunkSize * 2);
+        for (auto *block : blocks)
+        {
+            MidiEventPool::deallocate(block, blockSize);
+        }
+
+        expectEquals(sizeClass->getNumLiveBlocks(), 0);
+        expectEquals(sizeClass->getNumChunks(), 1);
+
+        beginTest("Large sizes fall back to the heap");
+
+        auto *large = MidiEventPool::allocate(MidiEventPool::maxBlockSize * 2);
+        expect(large != nullptr);
+        MidiEventPool::deallocate(large, MidiEventPool::maxBlockSize * 2);
+    }
+};
+
+static MidiEventPoolTests midiEventPoolTests;
+
+#endif
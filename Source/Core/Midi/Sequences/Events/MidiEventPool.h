@@ -0,0 +1,99 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// A pool of fixed-size blocks shared by all midi events of all sequences:
+// the events are small and numerous, and they are created and deleted
+// one by one (by OwnedArray in sequences, and by the VCS diff logic,
+// which may run in the thread pool), so instead of hitting the heap
+// for each of them, the blocks are carved out of chunks, grouped
+// by size classes, and recycled through the per-class free lists.
+//
+// Each chunk counts its live blocks and is freed as soon as it empties,
+// e.g. when a sequence created together is reset, or a project is closed;
+// one empty chunk per size class is kept as a spare, so that adding
+// and removing a single event at a chunk boundary doesn't hit the heap.
+
+class MidiEventPool final
+{
+public:
+
+    static void *allocate(size_t size);
+    static void deallocate(void *ptr, size_t size) noexcept;
+
+    static constexpr size_t granularity = 16;
+    static constexpr size_t maxBlockSize = 128;
+    static constexpr size_t blocksPerChunk = 256;
+
+private:
+
+    struct FreeBlock final
+    {
+        FreeBlock *next = nullptr;
+    };
+
+    class SizeClass final
+    {
+    public:
+
+        SizeClass() = default;
+
+        void *allocate(size_t blockSize);
+        void deallocate(void *ptr) noexcept;
+
+        int getNumChunks() const noexcept;
+        int getNumLiveBlocks() const noexcept;
+
+    private:
+
+        struct Chunk final
+        {
+            explicit Chunk(size_t blockSize);
+
+            HeapBlock<uint8> data;
+            FreeBlock *freeList = nullptr;
+            int numLiveBlocks = 0;
+        };
+
+        Chunk *findChunkWithFreeBlocks() noexcept;
+        int indexOfChunkContaining(void *ptr) const noexcept;
+
+        SpinLock lock;
+
+        // sorted by the chunks' addresses, to find a block's chunk quickly
+        OwnedArray<Chunk> chunks;
+
+        // where the blocks are taken from, until it's full
+        Chunk *currentChunk = nullptr;
+
+        size_t chunkBlockSize = 0;
+        int numEmptyChunks = 0;
+        int numLiveBlocks = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(SizeClass)
+    };
+
+    static constexpr int numSizeClasses = int(maxBlockSize / granularity);
+
+    static SizeClass *getSizeClass(size_t size) noexcept;
+    static SizeClass *getSizeClasses() noexcept;
+
+    friend class MidiEventPoolTests;
+
+};
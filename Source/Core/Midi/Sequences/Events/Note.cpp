@@ -229,15 +229,26 @@ SerializedData Note::serialize() const
 
 void Note::deserialize(const SerializedData &data)
 {
-    this->reset();
     using namespace Serialization;
-    this->id = unpackId(data.getProperty(Midi::id));
-    this->key = data.getProperty(Midi::key);
-    this->beat = float(data.getProperty(Midi::timestamp)) / Globals::ticksPerBeat;
-    this->length = float(data.getProperty(Midi::length)) / Globals::ticksPerBeat;
-    const auto vol = float(data.getProperty(Midi::volume)) / Globals::velocitySaveResolution;
+    this->deserialize(unpackId(data.getProperty(Midi::id)),
+        data.getProperty(Midi::key),
+        float(data.getProperty(Midi::timestamp)),
+        float(data.getProperty(Midi::length)),
+        float(data.getProperty(Midi::volume)),
+        data.getProperty(Midi::tuplet, 1));
+}
+
+void Note::deserialize(Id id, Key key, float beatTicks,
+    float lengthTicks, float volume, int tupletValue) noexcept
+{
+    this->reset();
+    this->id = id;
+    this->key = key;
+    this->beat = beatTicks / Globals::ticksPerBeat;
+    this->length = lengthTicks / Globals::ticksPerBeat;
+    const auto vol = volume / Globals::velocitySaveResolution;
     this->velocity = jmax(jmin(vol, 1.f), 0.f);
-    this->tuplet = Tuplet(int(data.getProperty(Midi::tuplet, 1)));
+    this->tuplet = Tuplet(tupletValue);
 }
 
 void Note::reset() noexcept {}
@@ -71,6 +71,9 @@ public:
 
     SerializedData serialize() const override;
     void deserialize(const SerializedData &data) override;
+    // Same, but takes the values exactly as they are stored in the tree
+    void deserialize(Id id, Key key, float beatTicks,
+        float lengthTicks, float volume, int tupletValue) noexcept;
     void reset() noexcept override;
 
     //===------------------------------------------------------------------===//
@@ -0,0 +1,289 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "IntervalIndex.h"
+
+#include "PianoSequence.h"
+#include "ProjectEventDispatcher.h"
+#include "MidiTrack.h"
+
+void IntervalIndex::clear() noexcept
+{
+    this->spans.clearQuick();
+    this->maxLevel = -1;
+}
+
+void IntervalIndex::ensureStorageAllocated(int numSpans)
+{
+    this->spans.ensureStorageAllocated(numSpans);
+}
+
+void IntervalIndex::add(double start, double end, int payload)
+{
+    jassert(start <= end);
+    jassert(this->spans.isEmpty() || this->spans.getLast().start <= start);
+    this->spans.add({ start, end, end, payload });
+}
+
+void IntervalIndex::build() noexcept
+{
+    const auto numSpans = this->spans.size();
+    if (numSpans == 0)
+    {
+        this->maxLevel = -1;
+        return;
+    }
+
+    auto *s = this->spans.getRawDataPointer();
+
+    int lastIndex = 0;
+    double lastMaxEnd = 0.0;
+    for (int i = 0; i < numSpans; i += 2)
+    {
+        s[i].maxEnd = s[i].end;
+        lastIndex = i;
+        lastMaxEnd = s[i].maxEnd;
+    }
+
+    int level = 1;
+    for (; (1 << level) <= numSpans; ++level)
+    {
+        const int halfSize = 1 << (level - 1);
+        const int firstNode = (halfSize << 1) - 1;
+        const int step = halfSize << 2;
+
+        for (int i = firstNode; i < numSpans; i += step)
+        {
+            // the right subtree may be incomplete at the end of the array,
+            // then its maximum end is the one of the last node before it
+            const auto leftMaxEnd = s[i - halfSize].maxEnd;
+            const auto rightMaxEnd = i + halfSize < numSpans ?
+                s[i + halfSize].maxEnd : lastMaxEnd;
+
+            s[i].maxEnd = jmax(s[i].end, leftMaxEnd, rightMaxEnd);
+        }
+
+        lastIndex = ((lastIndex >> level) & 1) ? lastIndex - halfSize : lastIndex + halfSize;
+        if (lastIndex < numSpans && s[lastIndex].maxEnd > lastMaxEnd)
+        {
+            lastMaxEnd = s[lastIndex].maxEnd;
+        }
+    }
+
+    this->maxLevel = level - 1;
+}
+
+void IntervalIndex::findSpansAt(double position, Array<int> &result) const
+{
+    result.clearQuick();
+
+    if (this->maxLevel < 0)
+    {
+        return;
+    }
+
+    struct Visit final
+    {
+        int node;
+        int level;
+        bool isLeftDone;
+    };
+
+    // two entries per level at most
+    Visit stack[64];
+    int stackSize = 0;
+
+    const auto *s = this->spans.getRawDataPointer();
+    const auto numSpans = this->spans.size();
+
+    stack[stackSize++] = { (1 << this->maxLevel) - 1, this->maxLevel, false };
+
+    while (stackSize > 0)
+    {
+        const auto visit = stack[--stackSize];
+
+        if (visit.level <= 3)
+        {
+            // small subtrees are cheaper to scan in order
+            const int first = visit.node >> visit.level << visit.level;
+            const int last = jmin(numSpans, first + (1 << (visit.level + 1)) - 1);
+            for (int i = first; i < last && s[i].start <= position; ++i)
+            {
+                if (position < s[i].end)
+                {
+                    result.add(s[i].payload);
+                }
+            }
+        }
+        else if (!visit.isLeftDone)
+        {
+            // come back to this node after the left subtree
+            stack[stackSize++] = { visit.node, visit.level, true };
+
+            const int left = visit.node - (1 << (visit.level - 1));
+            if (left >= numSpans || s[left].maxEnd > position)
+            {
+                stack[stackSize++] = { left, visit.level - 1, false };
+            }
+        }
+        else if (visit.node < numSpans && s[visit.node].start <= position)
+        {
+            if (position < s[visit.node].end)
+            {
+                result.add(s[visit.node].payload);
+            }
+
+            // the right subtree only has the spans starting later
+            stack[stackSize++] = { visit.node + (1 << (visit.level - 1)), visit.level - 1, false };
+        }
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class IntervalIndexTests final : public UnitTest
+{
+public:
+    IntervalIndexTests() : UnitTest("Interval index tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Finding the spans covering a point");
+
+        IntervalIndex index;
+        Array<int> found;
+
+        index.build();
+        index.findSpansAt(0.0, found);
+        expect(found.isEmpty());
+
+        index.add(0.0, 8.0, 0);
+        index.add(1.0, 2.0, 1);
+        index.add(1.0, 1.0, 2); // empty spans never cover anything
+        index.add(2.0, 3.0, 3);
+        index.add(4.0, 16.0, 4);
+        index.build();
+
+        index.findSpansAt(1.5, found);
+        expect(found == Array<int>(0, 1));
+
+        index.findSpansAt(2.0, found);
+        expect(found == Array<int>(0, 3));
+
+        index.findSpansAt(8.0, found);
+        expect(found == Array<int>(4));
+
+        index.findSpansAt(16.0, found);
+        expect(found.isEmpty());
+
+        index.findSpansAt(-1.0, found);
+        expect(found.isEmpty());
+
+        beginTest("Same results as the linear scan");
+
+        Random random(1);
+        Array<int> expected;
+
+        for (const auto numSpans : { 1, 2, 3, 7, 8, 9, 31, 32, 33, 100, 1000, 5000 })
+        {
+            Array<double> starts;
+            for (int i = 0; i < numSpans; ++i)
+            {
+                starts.add(random.nextDouble() * 1000.0);
+            }
+
+            starts.sort();
+
+            Array<double> ends;
+            index.clear();
+            for (int i = 0; i < numSpans; ++i)
+            {
+                // mostly short notes, and a few long ones
+                const auto length = random.nextInt(10) == 0 ?
+                    random.nextDouble() * 500.0 : random.nextDouble() * 4.0;
+
+                ends.add(starts[i] + length);
+                index.add(starts[i], ends[i], i);
+            }
+
+            index.build();
+
+            for (int q = 0; q < 200; ++q)
+            {
+                const auto position = random.nextDouble() * 1100.0 - 50.0;
+
+                expected.clearQuick();
+                for (int i = 0; i < numSpans; ++i)
+                {
+                    if (starts[i] <= position && position < ends[i])
+                    {
+                        expected.add(i);
+                    }
+                }
+
+                index.findSpansAt(position, found);
+                expect(found == expected);
+            }
+        }
+
+        beginTest("Finding the notes sounding at a beat");
+
+        EmptyMidiTrack track;
+        EmptyEventDispatcher dispatcher;
+        PianoSequence sequence(track, dispatcher);
+        Array<const Note *> notes;
+
+        sequence.findNotesSoundingAt(0.f, notes);
+        expect(notes.isEmpty());
+
+        const auto *longNote = static_cast<const Note *>(
+            sequence.insert(Note(&sequence, 60, 0.f, 8.f), false));
+        const auto *shortNote = static_cast<const Note *>(
+            sequence.insert(Note(&sequence, 64, 2.f, 1.f), false));
+
+        sequence.findNotesSoundingAt(2.5f, notes);
+        expect(notes == Array<const Note *>(longNote, shortNote));
+
+        sequence.findNotesSoundingAt(3.f, notes);
+        expect(notes == Array<const Note *>(longNote));
+
+        // the index is rebuilt after the notes change
+        const Note shortNoteBefore(*shortNote);
+        sequence.change(shortNoteBefore, shortNoteBefore.withLength(4.f), false);
+        sequence.findNotesSoundingAt(5.f, notes);
+        expect(notes == Array<const Note *>(longNote, shortNote));
+
+        const Note longNoteBefore(*longNote);
+        sequence.remove(longNoteBefore, false);
+        sequence.findNotesSoundingAt(5.f, notes);
+        expect(notes == Array<const Note *>(shortNote));
+
+        sequence.reset();
+        sequence.findNotesSoundingAt(5.f, notes);
+        expect(notes.isEmpty());
+    }
+};
+
+static IntervalIndexTests intervalIndexTests;
+
+#endif
@@ -0,0 +1,65 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// An implicit interval tree: the spans are kept in a flat array sorted
+// by their starts, the array indices make up a balanced binary tree
+// (leaves at even indices, the nodes of level k at the indices with
+// k lowest bits set), and each node remembers the maximum end in its
+// subtree, so that finding the spans covering a point is O(log n + k),
+// without any pointers or per-node allocations.
+
+class IntervalIndex final
+{
+public:
+
+    IntervalIndex() = default;
+
+    void clear() noexcept;
+    void ensureStorageAllocated(int numSpans);
+
+    // The spans are expected to be added in the order of their starts,
+    // the payload is whatever the caller needs to find the span's owner,
+    // e.g. an index of the note in its sequence; call build() when done
+    void add(double start, double end, int payload);
+    void build() noexcept;
+
+    inline int size() const noexcept { return this->spans.size(); }
+    inline bool isEmpty() const noexcept { return this->spans.isEmpty(); }
+
+    // Collects the payloads of the spans where start <= position < end,
+    // in the order of their starts; doesn't allocate memory,
+    // if the result array has enough storage already
+    void findSpansAt(double position, Array<int> &result) const;
+
+private:
+
+    struct Span final
+    {
+        double start;
+        double end;
+        double maxEnd;
+        int payload;
+    };
+
+    Array<Span> spans;
+    int maxLevel = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IntervalIndex)
+};
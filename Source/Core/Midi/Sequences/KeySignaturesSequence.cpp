@@ -159,13 +159,18 @@ bool KeySignaturesSequence::insertGroup(Array<KeySignatureEvent> &group, bool un
     }
     else
     {
+        Array<const MidiEvent *> addedEvents;
+        addedEvents.ensureStorageAllocated(group.size());
+
         for (int i = 0; i < group.size(); ++i)
         {
             const KeySignatureEvent &eventParams = group.getReference(i);
             auto *ownedEvent = new KeySignatureEvent(this, eventParams);
             this->midiEvents.addSorted(*ownedEvent, ownedEvent);
-            this->eventDispatcher.dispatchAddEvent(*ownedEvent);
+            addedEvents.add(ownedEvent);
         }
+
+        this->eventDispatcher.dispatchAddEvents(addedEvents);
         
         this->updateBeatRange(true);
     }
@@ -183,14 +188,28 @@ bool KeySignaturesSequence::removeGroup(Array<KeySignatureEvent> &group, bool un
     }
     else
     {
+        Array<const MidiEvent *> removedEvents;
+        removedEvents.ensureStorageAllocated(group.size());
+
+        for (int i = 0; i < group.size(); ++i)
+        {
+            const KeySignatureEvent &signature = group.getReference(i);
+            const int index = this->midiEvents.indexOfSorted(signature, &signature);
+            if (index >= 0)
+            {
+                removedEvents.add(this->midiEvents.getUnchecked(index));
+            }
+        }
+
+        // all removed events are still valid while listeners are notified:
+        this->eventDispatcher.dispatchRemoveEvents(removedEvents);
+
         for (int i = 0; i < group.size(); ++i)
         {
             const KeySignatureEvent &signature = group.getReference(i);
             const int index = this->midiEvents.indexOfSorted(signature, &signature);
             if (index >= 0)
             {
-                auto *removedEvent = this->midiEvents.getUnchecked(index);
-                this->eventDispatcher.dispatchRemoveEvent(*removedEvent);
                 this->midiEvents.remove(index, true);
             }
         }
@@ -215,6 +234,11 @@ bool KeySignaturesSequence::changeGroup(Array<KeySignatureEvent> &groupBefore,
     }
     else
     {
+        Array<const MidiEvent *> oldEvents;
+        Array<const MidiEvent *> newEvents;
+        oldEvents.ensureStorageAllocated(groupBefore.size());
+        newEvents.ensureStorageAllocated(groupBefore.size());
+
         for (int i = 0; i < groupBefore.size(); ++i)
         {
             const KeySignatureEvent &oldParams = groupBefore.getReference(i);
@@ -226,10 +250,13 @@ bool KeySignaturesSequence::changeGroup(Array<KeySignatureEvent> &groupBefore,
                 changedEvent->applyChanges(newParams);
                 this->midiEvents.remove(index, false);
                 this->midiEvents.addSorted(*changedEvent, changedEvent);
-                this->eventDispatcher.dispatchChangeEvent(oldParams, *changedEvent);
+                oldEvents.add(&oldParams);
+                newEvents.add(changedEvent);
             }
         }
 
+        this->eventDispatcher.dispatchChangeEvents(oldEvents, newEvents);
+
         this->updateBeatRange(true);
     }
 
@@ -269,6 +296,8 @@ void KeySignaturesSequence::deserialize(const SerializedData &data)
     float lastBeat = 0;
     float firstBeat = 0;
 
+    this->midiEvents.ensureStorageAllocated(root.getNumChildren());
+
     forEachChildWithType(root, e, Serialization::Midi::keySignature)
     {
         auto *signature = new KeySignatureEvent(this);
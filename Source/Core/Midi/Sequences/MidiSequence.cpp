@@ -21,6 +21,7 @@
 #include "ProjectMetadata.h"
 #include "UndoStack.h"
 #include "MidiTrack.h"
+#include "SerializationKeys.h"
 
 struct EventIdGenerator final
 {
@@ -39,13 +40,91 @@ struct EventIdGenerator final
     }
 };
 
+// The events read from the project file, but not yet decoded:
+// the decoding can start on a worker thread and finish on the message thread,
+// whichever comes first, so it is guarded by the lock
+class MidiSequence::PendingContent final : public ReferenceCountedObject
+{
+public:
+
+    PendingContent(WeakReference<MidiSequence> owner,
+        const SerializedData &data, EventsDecoder decoder) :
+        owner(owner),
+        data(data),
+        decoder(decoder) {}
+
+    // Returns true, if the events have been decoded just now
+    bool decode()
+    {
+        const ScopedLock lock(this->decodingLock);
+        if (this->isDecoded)
+        {
+            return false;
+        }
+
+        this->decodeTo(this->events);
+
+        for (const auto *event : this->events)
+        {
+            this->ids.insert(event->getId());
+        }
+
+        this->isDecoded = true;
+        return true;
+    }
+
+    // Any thread may decode a copy of the events, since the data never changes
+    void decodeTo(OwnedArray<MidiEvent> &outEvents) const
+    {
+        this->decoder(this->owner, this->data, outEvents);
+
+        if (outEvents.size() > 0)
+        {
+            outEvents.sort(*outEvents.getFirst());
+        }
+    }
+
+    // The decoded events are only swapped in on the message thread,
+    // like any other change of the sequence
+    void loadAsync() const
+    {
+        MessageManager::callAsync([owner = this->owner]()
+        {
+            if (owner != nullptr)
+            {
+                owner->ensureLoaded();
+            }
+        });
+    }
+
+    const WeakReference<MidiSequence> owner;
+    const SerializedData data;
+    const EventsDecoder decoder;
+
+    OwnedArray<MidiEvent> events;
+    FlatHashSet<MidiEvent::Id> ids;
+
+    using Ptr = ReferenceCountedObjectPtr<PendingContent>;
+
+private:
+
+    CriticalSection decodingLock;
+    bool isDecoded = false;
+
+    JUCE_DECLARE_NON_COPYABLE(PendingContent)
+};
+
 MidiSequence::MidiSequence(MidiTrack &parentTrack,
     ProjectEventDispatcher &dispatcher) noexcept :
     track(parentTrack),
     eventDispatcher(dispatcher) {}
 
+MidiSequence::~MidiSequence() = default;
+
 void MidiSequence::sort()
 {
+    this->ensureLoaded();
+
     if (this->midiEvents.size() > 0)
     {
         this->midiEvents.sort(*this->midiEvents.getFirst());
@@ -106,7 +185,7 @@ void MidiSequence::exportMidi(MidiMessageSequence &outSequence, const Clip &clip
     // Moreover, for now, only PianoSequence will override this method
     // and make sure it skips a no-solo clip, when soloPlaybackMode is true.
 
-    for (const auto *event : this->midiEvents)
+    for (const auto *event : *this)
     {
         event->exportMessages(outSequence, clip, keyMap, timeAdjustment, timeFactor);
     }
@@ -148,7 +227,7 @@ float MidiSequence::findLastBeat() const noexcept
 
 float MidiSequence::getLengthInBeats() const noexcept
 {
-    if (this->midiEvents.size() == 0)
+    if (this->isEmpty())
     {
         return 0;
     }
@@ -205,9 +284,15 @@ void MidiSequence::updateBeatRange(bool shouldNotifyIfChanged)
 
 MidiEvent::Id MidiSequence::createUniqueEventId() const noexcept
 {
+    // the events not loaded yet have their ids taken as well,
+    // and the new id is kept reserved until they are loaded, see adoptContent()
+    const PendingContent::Ptr pending(this->isLoaded() ?
+        nullptr : this->getDecodedPendingContent());
+
     int length = 2;
     auto eventId = EventIdGenerator::generateId(length);
-    while (this->usedEventIds.contains(eventId))
+    while (this->usedEventIds.contains(eventId) ||
+        (pending != nullptr && pending->ids.contains(eventId)))
     {
         length = jmin(4, length + 1);
         eventId = EventIdGenerator::generateId(length);
@@ -217,10 +302,189 @@ MidiEvent::Id MidiSequence::createUniqueEventId() const noexcept
     return eventId;
 }
 
+//===----------------------------------------------------------------------===//
+// Lazy loading
+//===----------------------------------------------------------------------===//
+
+void MidiSequence::prefetch(ThreadPool &workers)
+{
+    const ScopedLock lock(this->pendingContentLock);
+    if (this->pendingContent == nullptr)
+    {
+        return;
+    }
+
+    PendingContent::Ptr content(this->pendingContent);
+    workers.addJob([content]()
+    {
+        if (content->decode())
+        {
+            content->loadAsync();
+        }
+    });
+}
+
+void MidiSequence::loadPendingContent()
+{
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    PendingContent::Ptr content;
+
+    {
+        const ScopedLock lock(this->pendingContentLock);
+        content = this->pendingContent;
+    }
+
+    if (content == nullptr)
+    {
+        return;
+    }
+
+    content->decode();
+
+    {
+        // the readers on other threads check the pending content
+        // under this lock, and then they either decode a copy of it,
+        // or read the events, which are adopted by then
+        const ScopedLock lock(this->pendingContentLock);
+        this->pendingContent = nullptr;
+        this->hasPendingContent = false;
+        this->adoptContent(*content);
+    }
+
+    MessageManager::callAsync([owner = content->owner]()
+    {
+        if (owner != nullptr)
+        {
+            owner->eventDispatcher.dispatchLoadTrackContent();
+        }
+    });
+}
+
+void MidiSequence::adoptContent(PendingContent &content)
+{
+    // the ids created before the events were loaded stay reserved
+    FlatHashSet<MidiEvent::Id> reservedIds;
+    std::swap(reservedIds, this->usedEventIds);
+    std::swap(this->usedEventIds, content.ids);
+    for (const auto &id : reservedIds)
+    {
+        this->usedEventIds.insert(id);
+    }
+
+    this->midiEvents.swapWith(content.events);
+    this->updateBeatRange(false);
+}
+
+const OwnedArray<MidiEvent> &MidiSequence::getPendingEvents() const noexcept
+{
+    // the pending content is only released on the message thread,
+    // which is the only one allowed here, so the reference stays valid
+    const auto content = this->getDecodedPendingContent();
+    return content != nullptr ? content->events : this->midiEvents;
+}
+
+MidiSequence::PendingContent::Ptr MidiSequence::getDecodedPendingContent() const noexcept
+{
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    PendingContent::Ptr content;
+
+    {
+        const ScopedLock lock(this->pendingContentLock);
+        content = this->pendingContent;
+    }
+
+    if (content != nullptr && content->decode())
+    {
+        content->loadAsync();
+    }
+
+    return content;
+}
+
+void MidiSequence::deserializeEvents(const SerializedData &root, EventsDecoder decoder)
+{
+    using namespace Serialization;
+
+    PendingContent::Ptr content(new PendingContent(this, root, decoder));
+
+    const int numEvents = root.getProperty(Midi::numEvents, 0);
+    if (numEvents > 0)
+    {
+        const ScopedLock lock(this->pendingContentLock);
+        this->pendingNumEvents = numEvents;
+        this->sequenceStartBeat = root.getProperty(Midi::firstBeat, 0.f);
+        this->sequenceEndBeat = root.getProperty(Midi::lastBeat, 0.f);
+        this->pendingContent = content;
+        this->hasPendingContent = true;
+        return;
+    }
+
+    content->decode();
+    this->adoptContent(*content);
+}
+
+void MidiSequence::serializeHeader(SerializedData &tree) const
+{
+    using namespace Serialization;
+    tree.setProperty(Midi::numEvents, this->size());
+    tree.setProperty(Midi::firstBeat, this->getFirstBeat());
+    tree.setProperty(Midi::lastBeat, this->getLastBeat());
+}
+
+void MidiSequence::serializeEvents(SerializedData &tree) const
+{
+    PendingContent::Ptr content;
+
+    {
+        const ScopedLock lock(this->pendingContentLock);
+        content = this->pendingContent;
+    }
+
+    if (content == nullptr)
+    {
+        for (const auto *event : this->midiEvents)
+        {
+            tree.appendChild(event->serialize());
+        }
+
+        return;
+    }
+
+    OwnedArray<MidiEvent> events;
+    content->decodeTo(events);
+
+    for (const auto *event : events)
+    {
+        tree.appendChild(event->serialize());
+    }
+}
+
+SerializedData MidiSequence::serializePendingContent() const
+{
+    const ScopedLock lock(this->pendingContentLock);
+    jassert(this->pendingContent != nullptr);
+    return this->pendingContent->data.createCopy();
+}
+
+void MidiSequence::resetPendingContent() noexcept
+{
+    const ScopedLock lock(this->pendingContentLock);
+    this->pendingContent = nullptr;
+    this->hasPendingContent = false;
+    this->pendingNumEvents = 0;
+}
+
 //===----------------------------------------------------------------------===//
 // Helpers
 //===----------------------------------------------------------------------===//
 
+SerializedData MidiSequence::serializeSnapshot() const
+{
+    return this->serialize();
+}
+
 const String &MidiSequence::getTrackId() const noexcept
 {
     return this->track.getTrackId();
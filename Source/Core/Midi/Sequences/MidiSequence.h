@@ -33,7 +33,9 @@ public:
 
     explicit MidiSequence(MidiTrack &track,
         ProjectEventDispatcher &eventDispatcher) noexcept;
-    
+
+    ~MidiSequence() override;
+
     //===------------------------------------------------------------------===//
     // Undoing
     //===------------------------------------------------------------------===//
@@ -69,6 +71,7 @@ public:
     {
         const auto &event = static_cast<const T &>(eventToImport);
         jassert(event.isValid());
+        this->ensureLoaded();
 
         if (!this->usedEventIds.contains(event.getId()))
         {
@@ -83,6 +86,8 @@ public:
     template<typename T>
     void checkoutEvent(const SerializedData &parameters)
     {
+        this->ensureLoaded();
+
         static T empty;
         UniquePointer<T> event(new T(this, empty));
         event->deserialize(parameters);
@@ -107,6 +112,34 @@ public:
     float getLengthInBeats() const noexcept;
     MidiTrack *getTrack() const noexcept;
 
+    //===------------------------------------------------------------------===//
+    // Lazy loading
+    //===------------------------------------------------------------------===//
+
+    // The sequences deserialized from the project file keep their events
+    // encoded until they are needed, only the header is read right away:
+    // size(), isEmpty() and the beat range don't need the events decoded.
+    // The const accessors never change the sequence: they only decode
+    // the events aside, and it's the message thread that swaps them in,
+    // like any other change; then dispatchLoadTrackContent() is sent
+    // asynchronously, so that the editors could pick them up.
+
+    inline bool isLoaded() const noexcept
+    { return !this->hasPendingContent.get(); }
+
+    // Only called on the message thread
+    inline void ensureLoaded()
+    {
+        if (this->hasPendingContent.get())
+        {
+            this->loadPendingContent();
+        }
+    }
+
+    // Decodes the events in the background, and then loads them
+    // on the message thread, unless someone needs them earlier
+    void prefetch(ThreadPool &workers);
+
     //===------------------------------------------------------------------===//
     // OwnedArray wrapper
     //===------------------------------------------------------------------===//
@@ -114,27 +147,37 @@ public:
     void sort();
 
     inline bool isEmpty() const noexcept
-    { return this->midiEvents.isEmpty(); }
+    { return this->size() == 0; }
 
     inline bool isNotEmpty() const noexcept
-    { return !this->midiEvents.isEmpty(); }
+    { return this->size() != 0; }
 
     inline int size() const noexcept
-    { return this->midiEvents.size(); }
+    {
+        return this->hasPendingContent.get() ?
+            this->pendingNumEvents : this->midiEvents.size();
+    }
 
     inline MidiEvent *const *begin() const noexcept
-    { return this->midiEvents.begin(); }
+    {
+        return this->getEvents().begin();
+    }
     
     inline MidiEvent *const *end() const noexcept
-    { return this->midiEvents.end(); }
+    {
+        return this->getEvents().end();
+    }
     
     inline MidiEvent *getUnchecked(const int index) const noexcept
-    { return this->midiEvents.getUnchecked(index); }
+    {
+        return this->getEvents().getUnchecked(index);
+    }
 
     inline int indexOfSorted(const MidiEvent *const event) const noexcept
     {
-        const auto index = this->midiEvents.indexOfSorted(*event, event);
-        jassert(this->midiEvents[index] == event);
+        const auto &events = this->getEvents();
+        const auto index = events.indexOfSorted(*event, event);
+        jassert(events[index] == event);
         return index;
     }
 
@@ -144,6 +187,15 @@ public:
 
     virtual void updateBeatRange(bool shouldNotifyIfChanged);
 
+    // Same as serialize(), but cheaper, if possible: the events are captured
+    // in a compact form, to be encoded and saved later in the background
+    virtual SerializedData serializeSnapshot() const;
+
+    // For the readers on other threads, like the VCS diff workers:
+    // the events which are not loaded yet are decoded into a temporary copy,
+    // so that neither the sequence nor its pending events are touched
+    void serializeEvents(SerializedData &tree) const;
+
     MidiEvent::Id createUniqueEventId() const noexcept;
     const String &getTrackId() const noexcept;
     int getChannel() const noexcept;
@@ -160,8 +212,43 @@ private:
     float sequenceEndBeat = 0.f;
     float sequenceStartBeat = 0.f;
 
+    class PendingContent;
+    ReferenceCountedObjectPtr<PendingContent> pendingContent;
+    Atomic<bool> hasPendingContent = false;
+    CriticalSection pendingContentLock;
+    int pendingNumEvents = 0;
+
+    void loadPendingContent();
+    void adoptContent(PendingContent &content);
+
+    // The loaded events, or the pending ones, decoded but not adopted yet;
+    // the accessors of the sequences not loaded are for the message thread only
+    inline const OwnedArray<MidiEvent> &getEvents() const noexcept
+    {
+        return this->hasPendingContent.get() ?
+            this->getPendingEvents() : this->midiEvents;
+    }
+
+    const OwnedArray<MidiEvent> &getPendingEvents() const noexcept;
+    ReferenceCountedObjectPtr<PendingContent> getDecodedPendingContent() const noexcept;
+
 protected:
 
+    using EventsDecoder = void (*)(const WeakReference<MidiSequence> &owner,
+        const SerializedData &root, OwnedArray<MidiEvent> &outEvents);
+
+    // Decodes the events right away, unless the data has the header
+    // (see serializeHeader), which means they can wait till they are needed;
+    // the decoder may be called from a worker thread, so it is not supposed
+    // to touch the sequence, it only creates the events owned by it
+    void deserializeEvents(const SerializedData &root, EventsDecoder decoder);
+    void serializeHeader(SerializedData &tree) const;
+
+    // The events which were never loaded haven't changed since deserialization,
+    // so they are saved as they were read, without being decoded
+    SerializedData serializePendingContent() const;
+    void resetPendingContent() noexcept;
+
     virtual float findFirstBeat() const noexcept;
     virtual float findLastBeat() const noexcept;
 
@@ -21,6 +21,7 @@
 #include "PianoRoll.h"
 #include "NoteActions.h"
 #include "SerializationKeys.h"
+#include "EventColumns.h"
 #include "UndoStack.h"
 
 PianoSequence::PianoSequence(MidiTrack &track,
@@ -72,7 +73,7 @@ void PianoSequence::exportMidi(MidiMessageSequence &outSequence, const Clip &cli
         return;
     }
 
-    for (const auto *event : this->midiEvents)
+    for (const auto *event : *this)
     {
         event->exportMessages(outSequence, clip, keyMap, timeAdjustment, timeFactor);
     }
@@ -94,6 +95,7 @@ MidiEvent *PianoSequence::insert(const Note &eventParams, const bool undoable)
     }
     else
     {
+        this->ensureLoaded();
         auto *ownedNote = new Note(this, eventParams);
         this->midiEvents.addSorted(*ownedNote, ownedNote);
         this->eventDispatcher.dispatchAddEvent(*ownedNote);
@@ -114,6 +116,7 @@ bool PianoSequence::remove(const Note &eventParams, const bool undoable)
     }
     else
     {
+        this->ensureLoaded();
         const int index = this->midiEvents.indexOfSorted(eventParams, &eventParams);
         jassert(index >= 0);
         if (index >= 0)
@@ -144,6 +147,7 @@ bool PianoSequence::change(const Note &oldParams,
     }
     else
     {
+        this->ensureLoaded();
         const int index = this->midiEvents.indexOfSorted(oldParams, &oldParams);
         jassert(index >= 0);
         if (index >= 0)
@@ -173,14 +177,21 @@ bool PianoSequence::insertGroup(Array<Note> &group, bool undoable)
     }
     else
     {
+        this->ensureLoaded();
+
+        Array<const MidiEvent *> addedEvents;
+        addedEvents.ensureStorageAllocated(group.size());
+
         for (int i = 0; i < group.size(); ++i)
         {
             const Note &eventParams = group.getUnchecked(i);
             auto *ownedNote = new Note(this, eventParams);
             this->midiEvents.addSorted(*ownedNote, ownedNote);
-            this->eventDispatcher.dispatchAddEvent(*ownedNote);
+            addedEvents.add(ownedNote);
         }
 
+        this->eventDispatcher.dispatchAddEvents(addedEvents);
+
         this->updateBeatRange(true);
     }
 
@@ -197,6 +208,11 @@ bool PianoSequence::removeGroup(Array<Note> &group, bool undoable)
     }
     else
     {
+        this->ensureLoaded();
+
+        Array<const MidiEvent *> removedEvents;
+        removedEvents.ensureStorageAllocated(group.size());
+
         for (int i = 0; i < group.size(); ++i)
         {
             const Note &note = group.getUnchecked(i);
@@ -208,8 +224,19 @@ bool PianoSequence::removeGroup(Array<Note> &group, bool undoable)
             jassert(index >= 0);
             if (index >= 0)
             {
-                auto *removedNote = this->midiEvents.getUnchecked(index);
-                this->eventDispatcher.dispatchRemoveEvent(*removedNote);
+                removedEvents.add(this->midiEvents.getUnchecked(index));
+            }
+        }
+
+        // all removed events are still valid while listeners are notified:
+        this->eventDispatcher.dispatchRemoveEvents(removedEvents);
+
+        for (int i = 0; i < group.size(); ++i)
+        {
+            const Note &note = group.getUnchecked(i);
+            const int index = this->midiEvents.indexOfSorted(note, &note);
+            if (index >= 0)
+            {
                 this->midiEvents.remove(index, true);
             }
         }
@@ -234,6 +261,13 @@ bool PianoSequence::changeGroup(Array<Note> &groupBefore,
     }
     else
     {
+        this->ensureLoaded();
+
+        Array<const MidiEvent *> oldEvents;
+        Array<const MidiEvent *> newEvents;
+        oldEvents.ensureStorageAllocated(groupBefore.size());
+        newEvents.ensureStorageAllocated(groupBefore.size());
+
         for (int i = 0; i < groupBefore.size(); ++i)
         {
             const Note &oldParams = groupBefore.getReference(i);
@@ -251,10 +285,13 @@ bool PianoSequence::changeGroup(Array<Note> &groupBefore,
                 changedNote->applyChanges(newParams);
                 this->midiEvents.remove(index, false);
                 this->midiEvents.addSorted(*changedNote, changedNote);
-                this->eventDispatcher.dispatchChangeEvent(oldParams, *changedNote);
+                oldEvents.add(&oldParams);
+                newEvents.add(changedNote);
             }
         }
 
+        this->eventDispatcher.dispatchChangeEvents(oldEvents, newEvents);
+
         this->updateBeatRange(true);
     }
 
@@ -265,6 +302,46 @@ bool PianoSequence::changeGroup(Array<Note> &groupBefore,
 // Accessors
 //===----------------------------------------------------------------------===//
 
+void PianoSequence::findNotesSoundingAt(float beat, Array<const Note *> &result) const
+{
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    result.clearQuick();
+
+    if (this->soundingNotesIndexOutdated)
+    {
+        this->rebuildSoundingNotesIndex();
+    }
+
+    this->soundingNotesIndex.findSpansAt(beat, this->soundingNotesIndices);
+
+    for (const auto index : this->soundingNotesIndices)
+    {
+        result.add(static_cast<const Note *>(this->getUnchecked(index)));
+    }
+}
+
+void PianoSequence::rebuildSoundingNotesIndex() const
+{
+    this->soundingNotesIndex.clear();
+    this->soundingNotesIndex.ensureStorageAllocated(this->size());
+
+    for (int i = 0; i < this->size(); ++i)
+    {
+        const auto *note = static_cast<const Note *>(this->getUnchecked(i));
+        this->soundingNotesIndex.add(note->getBeat(), note->getBeat() + note->getLength(), i);
+    }
+
+    this->soundingNotesIndex.build();
+    this->soundingNotesIndexOutdated = false;
+}
+
+void PianoSequence::updateBeatRange(bool shouldNotifyIfChanged)
+{
+    this->soundingNotesIndexOutdated = true;
+    MidiSequence::updateBeatRange(shouldNotifyIfChanged);
+}
+
 float PianoSequence::findLastBeat() const noexcept
 {
     if (this->isEmpty())
@@ -295,7 +372,13 @@ float PianoSequence::findLastBeat() const noexcept
 
 SerializedData PianoSequence::serialize() const
 {
+    if (!this->isLoaded())
+    {
+        return this->serializePendingContent();
+    }
+
     SerializedData tree(Serialization::Midi::track);
+    this->serializeHeader(tree);
 
     for (int i = 0; i < this->midiEvents.size(); ++i)
     {
@@ -306,6 +389,34 @@ SerializedData PianoSequence::serialize() const
     return tree;
 }
 
+SerializedData PianoSequence::serializeSnapshot() const
+{
+    if (!this->isLoaded())
+    {
+        return this->serializePendingContent();
+    }
+
+    // the same values as Note::serialize() writes, but without
+    // creating a node for each note, which is what makes saving slow
+    EventColumns::Ptr columns(new EventColumns(EventColumns::Kind::Notes));
+    columns->ensureStorageAllocated(this->midiEvents.size());
+
+    for (const auto *event : this->midiEvents)
+    {
+        const auto *note = static_cast<const Note *>(event);
+        columns->addNote(note->getId(), note->getKey(),
+            int(note->getBeat() * Globals::ticksPerBeat),
+            int(note->getLength() * Globals::ticksPerBeat),
+            int(note->getVelocity() * Globals::velocitySaveResolution),
+            note->getTuplet() > 1 ? note->getTuplet() : 0);
+    }
+
+    SerializedData tree(Serialization::Midi::track);
+    this->serializeHeader(tree);
+    tree.setProperty(Serialization::Midi::columns, var(columns.get()));
+    return tree;
+}
+
 void PianoSequence::deserialize(const SerializedData &data)
 {
     this->reset();
@@ -319,24 +430,53 @@ void PianoSequence::deserialize(const SerializedData &data)
         return;
     }
 
+    this->deserializeEvents(root, PianoSequence::decodeNotes);
+}
+
+void PianoSequence::decodeNotes(const WeakReference<MidiSequence> &owner,
+    const SerializedData &root, OwnedArray<MidiEvent> &outEvents)
+{
     // a hack to avoid generating a unique id each time we create `new Note(this)`:
     // instead, deserialize parameters into this temporary unowned struct,
     // and later create an owned note with known parameters
     Note parameters;
 
+    // the binary project format keeps the notes in columns instead of nodes
+    EventColumns columns;
+    if (const auto *columnsData = root.getProperty(Serialization::Midi::columns).getBinaryData())
+    {
+        if (columns.readFromData(columnsData->getData(), columnsData->getSize()) &&
+            columns.getKind() == EventColumns::Kind::Notes)
+        {
+            outEvents.ensureStorageAllocated(columns.size());
+
+            for (int i = 0; i < columns.size(); ++i)
+            {
+                parameters.deserialize(columns.getIds().getUnchecked(i),
+                    columns.getKeys().getUnchecked(i),
+                    float(columns.getBeats().getUnchecked(i)),
+                    float(columns.getLengths().getUnchecked(i)),
+                    float(columns.getVolumes().getUnchecked(i)),
+                    jmax(1, columns.getTuplets().getUnchecked(i)));
+
+                outEvents.add(new Note(owner, parameters));
+            }
+        }
+    }
+
+    outEvents.ensureStorageAllocated(outEvents.size() + root.getNumChildren());
+
     forEachChildWithType(root, e, Serialization::Midi::note)
     {
         parameters.deserialize(e);
-        this->midiEvents.add(new Note(this, parameters));
-        this->usedEventIds.insert(parameters.getId());
+        outEvents.add(new Note(owner, parameters));
     }
-
-    this->sort();
-    this->updateBeatRange(false);
 }
 
 void PianoSequence::reset()
 {
+    this->resetPendingContent();
     this->midiEvents.clear();
     this->usedEventIds.clear();
+    this->soundingNotesIndexOutdated = true;
 }
@@ -19,6 +19,7 @@
 
 #include "MidiSequence.h"
 #include "Note.h"
+#include "IntervalIndex.h"
 
 class PianoRoll;
 
@@ -51,12 +52,24 @@ public:
     bool removeGroup(Array<Note> &notes, bool undoable);
     bool changeGroup(Array<Note> &eventsBefore,
         Array<Note> &eventsAfter, bool undoable);
+
+    //===------------------------------------------------------------------===//
+    // Accessors
+    //===------------------------------------------------------------------===//
+
+    // Collects the notes where beat <= position < beat + length,
+    // in the order of their start beats; the index it uses is rebuilt
+    // on the first query after the notes have changed
+    void findNotesSoundingAt(float beat, Array<const Note *> &result) const;
+
+    void updateBeatRange(bool shouldNotifyIfChanged) override;
     
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
 
     SerializedData serialize() const override;
+    SerializedData serializeSnapshot() const override;
     void deserialize(const SerializedData &data) override;
     void reset() override;
 
@@ -64,6 +77,17 @@ private:
 
     float findLastBeat() const noexcept override;
 
+    static void decodeNotes(const WeakReference<MidiSequence> &owner,
+        const SerializedData &root, OwnedArray<MidiEvent> &outEvents);
+
+    void rebuildSoundingNotesIndex() const;
+
+    // the payloads are the notes' indices in the sequence,
+    // every change goes through updateBeatRange or reset, which mark it outdated
+    mutable IntervalIndex soundingNotesIndex;
+    mutable Array<int> soundingNotesIndices;
+    mutable bool soundingNotesIndexOutdated = true;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PianoSequence);
     JUCE_DECLARE_WEAK_REFERENCEABLE(PianoSequence);
 };
@@ -142,13 +142,18 @@ bool TimeSignaturesSequence::insertGroup(Array<TimeSignatureEvent> &signatures,
     }
     else
     {
+        Array<const MidiEvent *> addedEvents;
+        addedEvents.ensureStorageAllocated(signatures.size());
+
         for (int i = 0; i < signatures.size(); ++i)
         {
             const TimeSignatureEvent &eventParams = signatures.getReference(i);
             auto *ownedEvent = new TimeSignatureEvent(this, eventParams);
             this->midiEvents.addSorted(*ownedEvent, ownedEvent);
-            this->eventDispatcher.dispatchAddEvent(*ownedEvent);
+            addedEvents.add(ownedEvent);
         }
+
+        this->eventDispatcher.dispatchAddEvents(addedEvents);
         
         this->updateBeatRange(true);
     }
@@ -166,14 +171,28 @@ bool TimeSignaturesSequence::removeGroup(Array<TimeSignatureEvent> &signatures,
     }
     else
     {
+        Array<const MidiEvent *> removedEvents;
+        removedEvents.ensureStorageAllocated(signatures.size());
+
+        for (int i = 0; i < signatures.size(); ++i)
+        {
+            const TimeSignatureEvent &signature = signatures.getReference(i);
+            const int index = this->midiEvents.indexOfSorted(signature, &signature);
+            if (index >= 0)
+            {
+                removedEvents.add(this->midiEvents.getUnchecked(index));
+            }
+        }
+
+        // all removed events are still valid while listeners are notified:
+        this->eventDispatcher.dispatchRemoveEvents(removedEvents);
+
         for (int i = 0; i < signatures.size(); ++i)
         {
             const TimeSignatureEvent &signature = signatures.getReference(i);
             const int index = this->midiEvents.indexOfSorted(signature, &signature);
             if (index >= 0)
             {
-                auto *removedSignature = this->midiEvents.getUnchecked(index);
-                this->eventDispatcher.dispatchRemoveEvent(*removedSignature);
                 this->midiEvents.remove(index, true);
             }
         }
@@ -198,6 +217,11 @@ bool TimeSignaturesSequence::changeGroup(Array<TimeSignatureEvent> &groupBefore,
     }
     else
     {
+        Array<const MidiEvent *> oldEvents;
+        Array<const MidiEvent *> newEvents;
+        oldEvents.ensureStorageAllocated(groupBefore.size());
+        newEvents.ensureStorageAllocated(groupBefore.size());
+
         for (int i = 0; i < groupBefore.size(); ++i)
         {
             const TimeSignatureEvent &oldParams = groupBefore.getReference(i);
@@ -209,10 +233,13 @@ bool TimeSignaturesSequence::changeGroup(Array<TimeSignatureEvent> &groupBefore,
                 changedEvent->applyChanges(newParams);
                 this->midiEvents.remove(index, false);
                 this->midiEvents.addSorted(*changedEvent, changedEvent);
-                this->eventDispatcher.dispatchChangeEvent(oldParams, *changedEvent);
+                oldEvents.add(&oldParams);
+                newEvents.add(changedEvent);
             }
         }
 
+        this->eventDispatcher.dispatchChangeEvents(oldEvents, newEvents);
+
         this->updateBeatRange(true);
     }
 
@@ -270,6 +297,8 @@ void TimeSignaturesSequence::deserialize(const SerializedData &data)
     float lastBeat = 0;
     float firstBeat = 0;
 
+    this->midiEvents.ensureStorageAllocated(root.getNumChildren());
+
     forEachChildWithType(root, e, Serialization::Midi::timeSignature)
     {
         TimeSignatureEvent *signature = new TimeSignatureEvent(this);
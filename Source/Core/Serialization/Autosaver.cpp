@@ -42,5 +42,21 @@ void Autosaver::changeListenerCallback(ChangeBroadcaster *source)
 void Autosaver::timerCallback()
 {
     this->stopTimer();
-    this->documentOwner.getDocument()->save();
+
+    auto *document = this->documentOwner.getDocument();
+
+    // the changes already recorded elsewhere are safe, so the full save
+    // is only needed to keep that record short, and it can wait
+    if (document->canPostponeSave())
+    {
+        this->startTimer(this->delay);
+        return;
+    }
+
+    // only the snapshot is taken here, and it's written in the background
+    if (!document->saveInBackground())
+    {
+        // still writing the previous one, which may take a while for big projects
+        this->startTimer(1000);
+    }
 }
@@ -15,22 +15,68 @@
     along with Helio. If not, see <http://www.gnu.org/licenses/>.
 */
 
+
 #include "Common.h"
 #include "BinarySerializer.h"
+#include "SerializationKeys.h"
+#include "EventColumns.h"
 
 static const char *kHelioHeaderV2String = "Helio2::";
 static const uint64 kHelioHeaderV2 = ByteOrder::littleEndianInt64(kHelioHeaderV2String);
 
+// The version 3 file starts with the section table: the number of sections,
+// and the type, offset and size of each section; the first section is always
+// the tree, same as in version 2, except that the events of piano and automation
+// tracks are moved to the columnar sections, referenced by index from their
+// sequence nodes; the columns are then handed over to the sequences as is.
+static const char *kHelioHeaderV3String = "Helio3::";
+static const uint64 kHelioHeaderV3 = ByteOrder::littleEndianInt64(kHelioHeaderV3String);
+
+static const int32 kTreeSection = int32(ByteOrder::littleEndianInt("tree"));
+static const int32 kColumnsSection = int32(ByteOrder::littleEndianInt("cols"));
+
 Result BinarySerializer::saveToFile(File file, const SerializedData &tree) const
 {
+    // the sections are prepared in memory first to fill the section table
+    MemoryOutputStream treeSection;
+    Array<MemoryBlock> columnSections;
+    BinarySerializer::writeNode(treeSection, tree, SerializedData(), columnSections);
+
     FileOutputStream fileStream(file);
     if (fileStream.openedOk())
     {
         fileStream.setPosition(0);
         fileStream.truncate();
-        fileStream.writeInt64(kHelioHeaderV2);
-        tree.writeToStream(fileStream);
-        return Result::ok();
+        fileStream.writeInt64(kHelioHeaderV3);
+
+        const auto numSections = columnSections.size() + 1;
+        fileStream.writeInt(numSections);
+
+        const auto sectionEntrySize = int64(sizeof(int32) + sizeof(int64) * 2);
+        auto offset = int64(sizeof(kHelioHeaderV3) + sizeof(int32)) + numSections * sectionEntrySize;
+
+        fileStream.writeInt(kTreeSection);
+        fileStream.writeInt64(offset);
+        fileStream.writeInt64(int64(treeSection.getDataSize()));
+        offset += int64(treeSection.getDataSize());
+
+        for (const auto &columns : columnSections)
+        {
+            fileStream.writeInt(kColumnsSection);
+            fileStream.writeInt64(offset);
+            fileStream.writeInt64(int64(columns.getSize()));
+            offset += int64(columns.getSize());
+        }
+
+        fileStream.write(treeSection.getData(), treeSection.getDataSize());
+
+        for (const auto &columns : columnSections)
+        {
+            fileStream.write(columns.getData(), columns.getSize());
+        }
+
+        fileStream.flush();
+        return fileStream.getStatus();
     }
 
     return Result::fail("Failed to save");
@@ -43,22 +89,210 @@ SerializedData BinarySerializer::loadFromFile(const File &file) const
     // ValueTree::readFromStream still calls getTotalLength() quite often, which
     // ends up calling File::getSize(), which, in turn, consumes a lot time.
 
-    // so instead we'll just read the whole file into memory and deserialize from it;
-    // somewhat ugly, but works, and saved files should never be really large anyway.
+    // so instead we'll just map the whole file into memory and deserialize from it,
+    // which also avoids copying it, and the columnar sections are only copied once
+    const MemoryMappedFile mappedFile(file, MemoryMappedFile::readOnly);
+    if (mappedFile.getData() != nullptr)
+    {
+        return BinarySerializer::loadFromData(mappedFile.getData(), mappedFile.getSize());
+    }
+
+    // mapping may fail, e.g. for empty files
     MemoryBlock mb;
     if (file.loadFileAsData(mb))
     {
-        MemoryInputStream inputStream(mb, false);
-        const auto magicNumber = static_cast<uint64>(inputStream.readInt64());
-        if (magicNumber == kHelioHeaderV2)
+        return BinarySerializer::loadFromData(mb.getData(), mb.getSize());
+    }
+
+    return {};
+}
+
+SerializedData BinarySerializer::loadFromData(const void *data, size_t numBytes)
+{
+    if (numBytes < sizeof(uint64))
+    {
+        return {};
+    }
+
+    const auto *bytes = static_cast<const uint8 *>(data);
+    const auto magicNumber = ByteOrder::littleEndianInt64(bytes);
+
+    if (magicNumber == kHelioHeaderV2)
+    {
+        return SerializedData::readFromData(bytes + sizeof(uint64), numBytes - sizeof(uint64));
+    }
+
+    if (magicNumber != kHelioHeaderV3)
+    {
+        return {};
+    }
+
+    MemoryInputStream tableStream(bytes + sizeof(uint64), numBytes - sizeof(uint64), false);
+
+    const auto numSections = tableStream.readInt();
+    const auto sectionEntrySize = int64(sizeof(int32) + sizeof(int64) * 2);
+    if (numSections <= 0 || numSections * sectionEntrySize > tableStream.getNumBytesRemaining())
+    {
+        return {};
+    }
+
+    Array<Section> sections;
+    sections.ensureStorageAllocated(numSections);
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        Section section;
+        section.type = tableStream.readInt();
+        section.offset = tableStream.readInt64();
+        section.size = tableStream.readInt64();
+
+        if (section.offset < 0 || section.size < 0 ||
+            section.offset > int64(numBytes) || section.size > int64(numBytes) - section.offset)
         {
-            return SerializedData::readFromStream(inputStream);
+            jassertfalse;
+            return {};
         }
+
+        sections.add(section);
     }
 
-    return {};
+    const auto &treeSection = sections.getReference(0);
+    if (treeSection.type != kTreeSection)
+    {
+        return {};
+    }
+
+    const auto tree = SerializedData::readFromData(bytes + treeSection.offset, size_t(treeSection.size));
+    BinarySerializer::attachColumns(tree, sections, bytes);
+    return tree;
 }
 
+//===----------------------------------------------------------------------===//
+// Columnar sections
+//===----------------------------------------------------------------------===//
+
+// same as SerializedData::writeToStream, except for the tracks' sequences
+void BinarySerializer::writeNode(OutputStream &output, const SerializedData &node,
+    const SerializedData &parent, Array<MemoryBlock> &columnSections)
+{
+    // the snapshots have their events already captured in columns,
+    // see MidiSequence::serializeSnapshot(), otherwise try to encode them
+    EventColumns encodedColumns;
+    const auto &columnsProperty = node.getProperty(Serialization::Midi::columns);
+    const EventColumns *columns = dynamic_cast<EventColumns *>(columnsProperty.getObject());
+
+    // the sequences which were never loaded keep their columns as they were read,
+    // see MidiSequence::serializePendingContent(), so they are written as is
+    const auto *encodedData = node.getNumChildren() == 0 ?
+        columnsProperty.getBinaryData() : nullptr;
+    const auto hasCapturedColumns = columns != nullptr || encodedData != nullptr;
+
+    if (!hasCapturedColumns && BinarySerializer::isTrackSequence(node, parent) &&
+        !node.hasProperty(Serialization::Midi::columns) && encodedColumns.encode(node))
+    {
+        columns = &encodedColumns;
+    }
+
+    output.writeString(node.getType().toString());
+
+    const auto hasColumnsSection = columns != nullptr || encodedData != nullptr;
+    const auto numProperties = node.getNumProperties();
+    output.writeCompressedInt(numProperties -
+        (hasCapturedColumns ? 1 : 0) + (hasColumnsSection ? 1 : 0));
+
+    for (int i = 0; i < numProperties; ++i)
+    {
+        const auto name = node.getPropertyName(i);
+        if (hasCapturedColumns && name == Serialization::Midi::columns)
+        {
+            continue;
+        }
+
+        output.writeString(name.toString());
+        node.getProperty(name).writeToStream(output);
+    }
+
+    if (hasColumnsSection)
+    {
+        if (encodedData != nullptr)
+        {
+            columnSections.add(*encodedData);
+        }
+        else
+        {
+            MemoryOutputStream columnsStream;
+            columns->writeToStream(columnsStream);
+            columnSections.add(columnsStream.getMemoryBlock());
+        }
+
+        // the tree is always the first section
+        output.writeString(Serialization::Midi::columns.toString());
+        var(columnSections.size()).writeToStream(output);
+        output.writeCompressedInt(0);
+        return;
+    }
+
+    output.writeCompressedInt(node.getNumChildren());
+
+    for (const auto &child : node)
+    {
+        BinarySerializer::writeNode(output, child, node, columnSections);
+    }
+}
+
+// only the sequences which will be deserialized by the sequences themselves
+bool BinarySerializer::isTrackSequence(const SerializedData &node, const SerializedData &parent)
+{
+    using namespace Serialization;
+
+    if (!node.hasType(Midi::track) && !node.hasType(Midi::automation))
+    {
+        return false;
+    }
+
+    if (!parent.hasType(Core::treeNode))
+    {
+        return false;
+    }
+
+    const auto trackType = parent.getProperty(Core::treeNodeType).toString();
+    return (node.hasType(Midi::track) && trackType == Core::pianoTrack.toString()) ||
+        (node.hasType(Midi::automation) && trackType == Core::automationTrack.toString());
+}
+
+void BinarySerializer::attachColumns(const SerializedData &node,
+    const Array<Section> &sections, const uint8 *data)
+{
+    const auto &columnsIndex = node.getProperty(Serialization::Midi::columns);
+    if (columnsIndex.isInt())
+    {
+        const auto index = int(columnsIndex);
+        if (index > 0 && index < sections.size() &&
+            sections.getReference(index).type == kColumnsSection)
+        {
+            const auto &section = sections.getReference(index);
+            auto nodeCopy = node; // shares the data
+            nodeCopy.setProperty(Serialization::Midi::columns,
+                var(data + section.offset, size_t(section.size)));
+        }
+        else
+        {
+            jassertfalse;
+        }
+
+        return;
+    }
+
+    for (const auto &child : node)
+    {
+        BinarySerializer::attachColumns(child, sections, data);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Strings
+//===----------------------------------------------------------------------===//
+
 Result BinarySerializer::saveToString(String &string, const SerializedData &tree) const
 {
     MemoryOutputStream memStream;
@@ -86,5 +320,135 @@ bool BinarySerializer::supportsFileWithExtension(const String &extension) const
 
 bool BinarySerializer::supportsFileWithHeader(const String &header) const
 {
-    return header.startsWith(kHelioHeaderV2String);
+    return header.startsWith(kHelioHeaderV3String) ||
+        header.startsWith(kHelioHeaderV2String);
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class BinarySerializerTests final : public UnitTest
+{
+public:
+    BinarySerializerTests() : UnitTest("Binary serializer tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        using namespace Serialization;
+
+        SerializedData project(Core::project);
+        project.setProperty(Core::projectId, "test");
+
+        SerializedData pianoTrack(Core::treeNode);
+        pianoTrack.setProperty(Core::treeNodeType, Core::pianoTrack.toString());
+        SerializedData notes(Midi::track);
+        for (int i = 0; i < 10; ++i)
+        {
+            SerializedData note(Midi::note);
+            note.setProperty(Midi::id, String("id") + String(i).paddedLeft('0', 2));
+            note.setProperty(Midi::key, 60 + i);
+            note.setProperty(Midi::timestamp, i * 16);
+            note.setProperty(Midi::length, 16);
+            note.setProperty(Midi::volume, 768);
+            notes.appendChild(note);
+        }
+        pianoTrack.appendChild(notes);
+        project.appendChild(pianoTrack);
+
+        // the sequences anywhere else are left as is:
+        SerializedData unrelated(Core::treeNode);
+        unrelated.appendChild(notes.createCopy());
+        project.appendChild(unrelated);
+
+        const auto file = File::createTempFile(".hp");
+        const BinarySerializer serializer;
+
+        beginTest("Saving and loading the columnar format");
+
+        expect(serializer.saveToFile(file, project).wasOk());
+
+        MemoryBlock data;
+        file.loadFileAsData(data);
+        const auto header = String::fromUTF8(static_cast<const char *>(data.getData()), 8);
+        expect(serializer.supportsFileWithHeader(header));
+        expect(header == kHelioHeaderV3String);
+
+        const auto loaded = serializer.loadFromFile(file);
+        expectEquals(loaded.getNumChildren(), 2);
+        expect(loaded.getProperty(Core::projectId).toString() == "test");
+
+        const auto loadedNotes = loaded.getChild(0).getChildWithName(Midi::track);
+        expectEquals(loadedNotes.getNumChildren(), 0);
+
+        const auto *columnsData = loadedNotes.getProperty(Midi::columns).getBinaryData();
+        expect(columnsData != nullptr);
+
+        EventColumns columns;
+        expect(columns.readFromData(columnsData->getData(), columnsData->getSize()));
+        expect(columns.decode().isEquivalentTo(notes));
+
+        expect(loaded.getChild(1).isEquivalentTo(unrelated));
+
+        beginTest("Saving the captured columns");
+
+        EventColumns::Ptr captured(new EventColumns(EventColumns::Kind::Notes));
+        for (int i = 0; i < 10; ++i)
+        {
+            captured->addNote(columns.getIds()[i], 60 + i, i * 16, 16, 768, 0);
+        }
+
+        SerializedData snapshot(Core::project);
+        SerializedData snapshotTrack(Core::treeNode);
+        snapshotTrack.setProperty(Core::treeNodeType, Core::pianoTrack.toString());
+        SerializedData snapshotNotes(Midi::track);
+        snapshotNotes.setProperty(Midi::columns, var(captured.get()));
+        snapshotTrack.appendChild(snapshotNotes);
+        snapshot.appendChild(snapshotTrack);
+
+        expect(serializer.saveToFile(file, snapshot).wasOk());
+
+        const auto loadedSnapshot = serializer.loadFromFile(file);
+        const auto *snapshotData = loadedSnapshot.getChild(0)
+            .getChildWithName(Midi::track).getProperty(Midi::columns).getBinaryData();
+
+        expect(snapshotData != nullptr);
+        expect(columns.readFromData(snapshotData->getData(), snapshotData->getSize()));
+        expect(columns.decode().isEquivalentTo(notes));
+
+        beginTest("Saving the columns as they were read");
+
+        // the sequences which were never loaded are saved
+        // with their columns kept in the binary form
+        expect(serializer.saveToFile(file, loaded.createCopy()).wasOk());
+
+        const auto reloaded = serializer.loadFromFile(file);
+        const auto reloadedNotes = reloaded.getChild(0).getChildWithName(Midi::track);
+        expectEquals(reloadedNotes.getNumProperties(), 1);
+
+        const auto *reloadedData = reloadedNotes.getProperty(Midi::columns).getBinaryData();
+        expect(reloadedData != nullptr);
+        expect(columns.readFromData(reloadedData->getData(), reloadedData->getSize()));
+        expect(columns.decode().isEquivalentTo(notes));
+
+        beginTest("Loading the legacy format");
+
+        {
+            FileOutputStream stream(file);
+            stream.setPosition(0);
+            stream.truncate();
+            stream.writeInt64(kHelioHeaderV2);
+            project.writeToStream(stream);
+        }
+
+        expect(serializer.loadFromFile(file).isEquivalentTo(project));
+
+        file.deleteFile();
+    }
+};
+
+static BinarySerializerTests binarySerializerTests;
+
+#endif
@@ -32,4 +32,23 @@ public:
     bool supportsFileWithExtension(const String &extension) const override;
     bool supportsFileWithHeader(const String &header) const override;
 
+private:
+
+    struct Section final
+    {
+        int32 type;
+        int64 offset;
+        int64 size;
+    };
+
+    static SerializedData loadFromData(const void *data, size_t numBytes);
+
+    // the parent is passed along instead of calling getParent(),
+    // since the trees may be written in the background
+    static void writeNode(OutputStream &output, const SerializedData &node,
+        const SerializedData &parent, Array<MemoryBlock> &columnSections);
+    static bool isTrackSequence(const SerializedData &node, const SerializedData &parent);
+    static void attachColumns(const SerializedData &node,
+        const Array<Section> &sections, const uint8 *data);
+
 };
@@ -24,6 +24,7 @@
 Document::Document(DocumentOwner &documentOwner,
     const String &defaultName,
     const String &defaultExtension) :
+    Thread("Document saver"),
     owner(documentOwner),
     extension(defaultExtension)
 {
@@ -42,6 +43,7 @@ Document::Document(DocumentOwner &documentOwner,
 }
 
 Document::Document(DocumentOwner &documentOwner, const File &existingFile) :
+    Thread("Document saver"),
     owner(documentOwner),
     extension(existingFile.getFileExtension().replace(".", "")),
     workingFile(existingFile)
@@ -52,6 +54,9 @@ Document::Document(DocumentOwner &documentOwner, const File &existingFile) :
 Document::~Document()
 {
     this->owner.removeChangeListener(this);
+
+    // never interrupt writing the file
+    this->waitForThreadToExit(-1);
 }
 
 void Document::changeListenerCallback(ChangeBroadcaster *source)
@@ -97,20 +102,32 @@ void Document::renameFile(const String &newName)
 // Save
 //===----------------------------------------------------------------------===//
 
+bool Document::hasValidFileName() const
+{
+    const String fullPath = this->workingFile.getFullPathName();
+    if (fullPath.isEmpty())
+    {
+        return false;
+    }
+
+    const auto firstCharAfterLastSlash = fullPath.lastIndexOfChar(File::getSeparatorChar()) + 1;
+    const auto lastDot = fullPath.lastIndexOfChar('.');
+    const bool hasEmptyName = (lastDot == firstCharAfterLastSlash);
+    return !hasEmptyName;
+}
+
 void Document::save()
 {
-    if (this->hasChanges &&
-        this->workingFile.getFullPathName().isNotEmpty())
-    {
-        const String fullPath = this->workingFile.getFullPathName();
-        const auto firstCharAfterLastSlash = fullPath.lastIndexOfChar(File::getSeparatorChar()) + 1;
-        const auto lastDot = fullPath.lastIndexOfChar('.');
-        const bool hasEmptyName = (lastDot == firstCharAfterLastSlash);
-        if (hasEmptyName)
-        {
-            return;
-        }
+    // the background save, if any, might otherwise overwrite this one
+    this->waitForThreadToExit(-1);
 
+    if (this->backgroundSaveFailed.compareAndSetBool(0, 1))
+    {
+        this->hasChanges = true;
+    }
+
+    if (this->hasChanges && this->hasValidFileName())
+    {
         const bool savedOk = this->owner.onDocumentSave(this->workingFile);
 
         if (savedOk)
@@ -124,6 +141,72 @@ void Document::save()
     }
 }
 
+bool Document::saveInBackground()
+{
+    if (this->isThreadRunning())
+    {
+        return false;
+    }
+
+    if (this->backgroundSaveFailed.compareAndSetBool(0, 1))
+    {
+        this->hasChanges = true;
+    }
+
+    if (!this->hasChanges || !this->hasValidFileName())
+    {
+        return true;
+    }
+
+    auto snapshot = this->owner.onDocumentSnapshot();
+    if (!snapshot.isValid())
+    {
+        this->save();
+        return true;
+    }
+
+    // any changes made from now on will be saved next time
+    this->hasChanges = false;
+
+    // some nodes of the snapshot may be shared with the live ones,
+    // e.g. the revisions' deltas, so the writer thread gets a deep copy
+    // which nothing else refers to; the captured events are immutable
+    this->backgroundSnapshot = snapshot.createCopy();
+    this->backgroundFile = this->workingFile;
+    this->startThread(3);
+    return true;
+}
+
+bool Document::canPostponeSave() const
+{
+    return this->owner.canPostponeDocumentSave();
+}
+
+void Document::run()
+{
+    const bool savedOk = DocumentHelpers::save(this->backgroundFile, this->backgroundSnapshot);
+    if (savedOk)
+    {
+        DBG("Document saved in background: " + this->backgroundFile.getFullPathName());
+    }
+    else
+    {
+        DBG("Document save failed: " + this->backgroundFile.getFullPathName());
+        this->backgroundSaveFailed = 1;
+    }
+
+    // the snapshot is only handed back to the owner on the message thread
+    SerializedData snapshot(move(this->backgroundSnapshot));
+    WeakReference<Document> document(this);
+    MessageManager::callAsync([document, snapshot, savedOk]()
+    {
+        if (savedOk && document != nullptr)
+        {
+            document->owner.onDocumentSaved(snapshot);
+        }
+    });
+}
+
 void Document::exportAs(const String &exportExtension,
     const String &defaultFilenameWithExtension)
 {
@@ -19,7 +19,7 @@
 
 class DocumentOwner;
 
-class Document : public ChangeListener
+class Document : public ChangeListener, private Thread
 {
 public:
 
@@ -43,6 +43,15 @@ public:
     //===------------------------------------------------------------------===//
 
     void save();
+
+    // Takes the document's snapshot here, and then serializes and writes
+    // it in the background; returns false if the previous snapshot
+    // is still being written, so that the caller may try again later
+    bool saveInBackground();
+
+    // True if the owner says the unsaved changes are safe for now
+    bool canPostponeSave() const;
+
     void exportAs(const String &exportExtension,
         const String &defaultFilename = "");
 
@@ -57,15 +66,25 @@ public:
 
 private:
 
+    bool hasValidFileName() const;
+
+    void run() override;
+
     DocumentOwner &owner;
 
     const String extension;
     bool hasChanges = true;
     File workingFile;
 
+    // only accessed by the background thread while it is running:
+    SerializedData backgroundSnapshot;
+    File backgroundFile;
+    Atomic<int> backgroundSaveFailed = 0;
+
     // async-launched file choosers must have long enough lifetime
     UniquePointer<FileChooser> exportFileChooser;
     UniquePointer<FileChooser> importFileChooser;
 
+    JUCE_DECLARE_WEAK_REFERENCEABLE(Document)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Document)
 };
@@ -144,17 +144,24 @@ File DocumentHelpers::getTempSlot(const String &fileName)
     return getFirstSlot(tempPath, tempPath, fileName);
 }
 
-static const OwnedArray<Serializer> &getSerializers()
+struct DocumentSerializers final
 {
-    static OwnedArray<Serializer> serializers;
-    if (serializers.isEmpty())
+    DocumentSerializers()
     {
-        serializers.add(new XmlSerializer());
-        serializers.add(new JsonSerializer());
-        serializers.add(new BinarySerializer());
+        this->serializers.add(new XmlSerializer());
+        this->serializers.add(new JsonSerializer());
+        this->serializers.add(new BinarySerializer());
     }
 
-    return serializers;
+    OwnedArray<Serializer> serializers;
+};
+
+static const OwnedArray<Serializer> &getSerializers()
+{
+    // initialized once, and in a thread-safe way,
+    // since documents may be saved in the background
+    static const DocumentSerializers documentSerializers;
+    return documentSerializers.serializers;
 }
 
 static const Array<Serializer *> getSerializersForExtension(const String &extension)
@@ -227,6 +234,24 @@ SerializedData DocumentHelpers::load(const File &file)
     return DocumentHelpers::load<BinarySerializer>(file);
 }
 
+bool DocumentHelpers::save(const File &file, const SerializedData &tree)
+{
+    const auto onesThatSupportExtension(getSerializersForExtension(file.getFileExtension()));
+    if (onesThatSupportExtension.size() == 1)
+    {
+        TempDocument tempDoc(file);
+        if (onesThatSupportExtension.getFirst()->saveToFile(tempDoc.getFile(), tree).wasOk())
+        {
+            return tempDoc.overwriteTargetFileWithTemporary();
+        }
+
+        return false;
+    }
+
+    // Default to binary serialization, same as load() does
+    return DocumentHelpers::save<BinarySerializer>(file, tree);
+}
+
 SerializedData DocumentHelpers::load(const String &string)
 {
     const String header(string.substring(0, 8));
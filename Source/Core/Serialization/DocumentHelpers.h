@@ -52,6 +52,10 @@ public:
         return serializer.loadFromStream(stream);
     }
 
+    // This picks the serializer by the file extension,
+    // same as load() does, and is safe to call from any thread
+    static bool save(const File &file, const SerializedData &tree);
+
     template<typename T>
     static bool save(const File &file, const SerializedData &tree)
     {
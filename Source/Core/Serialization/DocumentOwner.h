@@ -38,6 +38,20 @@ protected:
 
     virtual bool onDocumentLoad(const File &file) = 0;
     virtual bool onDocumentSave(const File &file) = 0;
+
+    // Optional, for saving in the background: the snapshot is taken on the
+    // message thread, and then it is written by the serializer matching
+    // the document's extension; by default, the document is saved as usual
+    virtual SerializedData onDocumentSnapshot() { return {}; }
+
+    // Called on the message thread, after the snapshot is written
+    virtual void onDocumentSaved(const SerializedData &snapshot) {}
+
+    // Optional, for the documents recording their changes elsewhere
+    // as they go, like the projects' undo journal, in which case
+    // the autosaver can wait before saving the whole thing again
+    virtual bool canPostponeDocumentSave() const { return false; }
+
     virtual void onDocumentImport(InputStream &stream) = 0;
     virtual bool onDocumentExport(OutputStream &stream) = 0;
 
@@ -0,0 +1,611 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "EventColumns.h"
+#include "MidiEvent.h"
+
+// The variable-length integers, 7 bits per byte, and the signed ones
+// are zigzag-encoded, so that small negative deltas take one byte as well
+class EventColumnsStream final
+{
+public:
+
+    EventColumnsStream(const void *data, size_t numBytes) noexcept :
+        data(static_cast<const uint8 *>(data)),
+        numBytes(numBytes) {}
+
+    static void writeUnsigned(OutputStream &output, uint64 value)
+    {
+        while (value >= 0x80)
+        {
+            output.writeByte(char(uint8(value) | 0x80));
+            value >>= 7;
+        }
+
+        output.writeByte(char(uint8(value)));
+    }
+
+    static void writeSigned(OutputStream &output, int64 value)
+    {
+        writeUnsigned(output, (uint64(value) << 1) ^ uint64(value >> 63));
+    }
+
+    bool readUnsigned(uint64 &result) noexcept
+    {
+        result = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (this->position >= this->numBytes)
+            {
+                return false;
+            }
+
+            const auto byte = this->data[this->position++];
+            result |= uint64(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool readSigned(int64 &result) noexcept
+    {
+        uint64 value = 0;
+        if (!this->readUnsigned(value))
+        {
+            return false;
+        }
+
+        result = int64(value >> 1) ^ -int64(value & 1);
+        return true;
+    }
+
+    bool readFloat(float &result) noexcept
+    {
+        if (this->position + sizeof(float) > this->numBytes)
+        {
+            return false;
+        }
+
+        const auto bits = ByteOrder::littleEndianInt(this->data + this->position);
+        memcpy(&result, &bits, sizeof(float));
+        this->position += sizeof(float);
+        return true;
+    }
+
+    bool readInt(int32 &result) noexcept
+    {
+        if (this->position + sizeof(int32) > this->numBytes)
+        {
+            return false;
+        }
+
+        result = int32(ByteOrder::littleEndianInt(this->data + this->position));
+        this->position += sizeof(int32);
+        return true;
+    }
+
+    size_t getNumBytesRemaining() const noexcept
+    {
+        return this->numBytes - this->position;
+    }
+
+private:
+
+    const uint8 *data = nullptr;
+    size_t numBytes = 0;
+    size_t position = 0;
+
+};
+
+EventColumns::Kind EventColumns::getKind() const noexcept
+{
+    return this->kind;
+}
+
+int EventColumns::size() const noexcept
+{
+    return this->ids.size();
+}
+
+const Array<int32> &EventColumns::getIds() const noexcept { return this->ids; }
+const Array<int> &EventColumns::getBeats() const noexcept { return this->beats; }
+const Array<int> &EventColumns::getKeys() const noexcept { return this->keys; }
+const Array<int> &EventColumns::getLengths() const noexcept { return this->lengths; }
+const Array<int> &EventColumns::getVolumes() const noexcept { return this->volumes; }
+const Array<int> &EventColumns::getTuplets() const noexcept { return this->tuplets; }
+const Array<float> &EventColumns::getValues() const noexcept { return this->values; }
+const Array<float> &EventColumns::getCurves() const noexcept { return this->curves; }
+
+void EventColumns::ensureStorageAllocated(int numEvents)
+{
+    this->ids.ensureStorageAllocated(numEvents);
+    this->beats.ensureStorageAllocated(numEvents);
+
+    if (this->kind == Kind::Notes)
+    {
+        this->keys.ensureStorageAllocated(numEvents);
+        this->lengths.ensureStorageAllocated(numEvents);
+        this->volumes.ensureStorageAllocated(numEvents);
+        this->tuplets.ensureStorageAllocated(numEvents);
+    }
+    else
+    {
+        this->values.ensureStorageAllocated(numEvents);
+        this->curves.ensureStorageAllocated(numEvents);
+    }
+}
+
+void EventColumns::addNote(int32 id, int key, int beatTicks,
+    int lengthTicks, int volume, int tuplet)
+{
+    jassert(this->kind == Kind::Notes);
+    this->ids.add(id);
+    this->keys.add(key);
+    this->beats.add(beatTicks);
+    this->lengths.add(lengthTicks);
+    this->volumes.add(volume);
+    this->tuplets.add(tuplet);
+}
+
+void EventColumns::addAutomationEvent(int32 id, int beatTicks, float value, float curve)
+{
+    jassert(this->kind == Kind::Automation);
+    this->ids.add(id);
+    this->beats.add(beatTicks);
+    this->values.add(value);
+    this->curves.add(curve);
+}
+
+void EventColumns::clear() noexcept
+{
+    this->ids.clearQuick();
+    this->beats.clearQuick();
+    this->keys.clearQuick();
+    this->lengths.clearQuick();
+    this->volumes.clearQuick();
+    this->tuplets.clearQuick();
+    this->values.clearQuick();
+    this->curves.clearQuick();
+}
+
+//===----------------------------------------------------------------------===//
+// Tree conversions
+//===----------------------------------------------------------------------===//
+
+bool EventColumns::encode(const SerializedData &sequence)
+{
+    using namespace Serialization;
+
+    this->clear();
+
+    if (sequence.hasType(Midi::track))
+    {
+        this->kind = Kind::Notes;
+    }
+    else if (sequence.hasType(Midi::automation))
+    {
+        this->kind = Kind::Automation;
+    }
+    else
+    {
+        return false;
+    }
+
+    const auto numEvents = sequence.getNumChildren();
+    this->ids.ensureStorageAllocated(numEvents);
+    this->beats.ensureStorageAllocated(numEvents);
+
+    for (const auto &event : sequence)
+    {
+        const bool encoded = this->kind == Kind::Notes ?
+            this->encodeNote(event) : this->encodeAutomationEvent(event);
+
+        if (!encoded)
+        {
+            this->clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool EventColumns::encodeNote(const SerializedData &note)
+{
+    using namespace Serialization;
+
+    if (!note.hasType(Midi::note) || note.getNumChildren() > 0)
+    {
+        return false;
+    }
+
+    const auto &key = note.getProperty(Midi::key);
+    const auto &beat = note.getProperty(Midi::timestamp);
+    const auto &length = note.getProperty(Midi::length);
+    const auto &volume = note.getProperty(Midi::volume);
+    const auto &tuplet = note.getProperty(Midi::tuplet);
+
+    const auto hasTuplet = note.hasProperty(Midi::tuplet);
+    if (!key.isInt() || !beat.isInt() || !length.isInt() || !volume.isInt() ||
+        (hasTuplet && (!tuplet.isInt() || int(tuplet) <= 0)) ||
+        note.getNumProperties() != (hasTuplet ? 6 : 5))
+    {
+        return false;
+    }
+
+    if (!this->encodeId(note.getProperty(Midi::id)))
+    {
+        return false;
+    }
+
+    this->keys.add(key);
+    this->beats.add(beat);
+    this->lengths.add(length);
+    this->volumes.add(volume);
+    this->tuplets.add(hasTuplet ? int(tuplet) : 0);
+    return true;
+}
+
+bool EventColumns::encodeAutomationEvent(const SerializedData &event)
+{
+    using namespace Serialization;
+
+    if (!event.hasType(Midi::automationEvent) ||
+        event.getNumChildren() > 0 || event.getNumProperties() != 4)
+    {
+        return false;
+    }
+
+    const auto &value = event.getProperty(Midi::value);
+    const auto &curve = event.getProperty(Midi::curve);
+    const auto &beat = event.getProperty(Midi::timestamp);
+
+    // the events keep floats, so these are always exact, unless edited by hand
+    if (!value.isDouble() || !curve.isDouble() || !beat.isInt() ||
+        double(float(value)) != double(value) ||
+        double(float(curve)) != double(curve))
+    {
+        return false;
+    }
+
+    if (!this->encodeId(event.getProperty(Midi::id)))
+    {
+        return false;
+    }
+
+    this->values.add(float(value));
+    this->curves.add(float(curve));
+    this->beats.add(beat);
+    return true;
+}
+
+bool EventColumns::encodeId(const var &packedId)
+{
+    if (!packedId.isString())
+    {
+        return false;
+    }
+
+    const auto idString = packedId.toString();
+    const auto id = MidiEvent::unpackId(idString);
+    if (MidiEvent::packId(id) != idString)
+    {
+        return false;
+    }
+
+    this->ids.add(id);
+    return true;
+}
+
+SerializedData EventColumns::decode() const
+{
+    using namespace Serialization;
+
+    const auto isNotes = this->kind == Kind::Notes;
+    SerializedData sequence(isNotes ? Midi::track : Midi::automation);
+
+    for (int i = 0; i < this->size(); ++i)
+    {
+        if (isNotes)
+        {
+            // in the same order as Note::serialize() does
+            SerializedData note(Midi::note);
+            note.setProperty(Midi::id, MidiEvent::packId(this->ids.getUnchecked(i)));
+            note.setProperty(Midi::key, this->keys.getUnchecked(i));
+            note.setProperty(Midi::timestamp, this->beats.getUnchecked(i));
+            note.setProperty(Midi::length, this->lengths.getUnchecked(i));
+            note.setProperty(Midi::volume, this->volumes.getUnchecked(i));
+            if (this->tuplets.getUnchecked(i) > 0)
+            {
+                note.setProperty(Midi::tuplet, this->tuplets.getUnchecked(i));
+            }
+            sequence.appendChild(note);
+        }
+        else
+        {
+            SerializedData event(Midi::automationEvent);
+            event.setProperty(Midi::id, MidiEvent::packId(this->ids.getUnchecked(i)));
+            event.setProperty(Midi::value, this->values.getUnchecked(i));
+            event.setProperty(Midi::curve, this->curves.getUnchecked(i));
+            event.setProperty(Midi::timestamp, this->beats.getUnchecked(i));
+            sequence.appendChild(event);
+        }
+    }
+
+    return sequence;
+}
+
+//===----------------------------------------------------------------------===//
+// Binary encoding
+//===----------------------------------------------------------------------===//
+
+void EventColumns::writeToStream(OutputStream &output) const
+{
+    const auto numEvents = this->size();
+
+    EventColumnsStream::writeUnsigned(output, uint64(this->kind));
+    EventColumnsStream::writeUnsigned(output, uint64(numEvents));
+
+    int64 previous = 0;
+    for (const auto beat : this->beats)
+    {
+        EventColumnsStream::writeSigned(output, beat - previous);
+        previous = beat;
+    }
+
+    if (this->kind == Kind::Notes)
+    {
+        previous = 0;
+        for (const auto key : this->keys)
+        {
+            EventColumnsStream::writeSigned(output, key - previous);
+            previous = key;
+        }
+
+        for (const auto length : this->lengths)
+        {
+            EventColumnsStream::writeSigned(output, length);
+        }
+
+        for (const auto volume : this->volumes)
+        {
+            EventColumnsStream::writeSigned(output, volume);
+        }
+
+        for (const auto tuplet : this->tuplets)
+        {
+            EventColumnsStream::writeUnsigned(output, uint64(tuplet));
+        }
+    }
+    else
+    {
+        for (const auto value : this->values)
+        {
+            output.writeFloat(value);
+        }
+
+        for (const auto curve : this->curves)
+        {
+            output.writeFloat(curve);
+        }
+    }
+
+    // the packed ids are up to 4 characters, so there's no point in varints
+    for (const auto id : this->ids)
+    {
+        output.writeInt(id);
+    }
+}
+
+bool EventColumns::readFromData(const void *data, size_t numBytes)
+{
+    this->clear();
+
+    EventColumnsStream input(data, numBytes);
+
+    uint64 kindValue = 0;
+    uint64 numEventsValue = 0;
+    if (!input.readUnsigned(kindValue) || !input.readUnsigned(numEventsValue) ||
+        (kindValue != uint64(Kind::Notes) && kindValue != uint64(Kind::Automation)) ||
+        numEventsValue > input.getNumBytesRemaining()) // each value takes at least a byte
+    {
+        return false;
+    }
+
+    this->kind = Kind(kindValue);
+    const auto numEvents = int(numEventsValue);
+
+    const auto readDeltas = [&input, numEvents](Array<int> &column)
+    {
+        column.ensureStorageAllocated(numEvents);
+        int64 value = 0;
+        for (int i = 0; i < numEvents; ++i)
+        {
+            int64 delta = 0;
+            if (!input.readSigned(delta)) { return false; }
+            value += delta;
+            column.add(int(value));
+        }
+        return true;
+    };
+
+    const auto readSigned = [&input, numEvents](Array<int> &column)
+    {
+        column.ensureStorageAllocated(numEvents);
+        for (int i = 0; i < numEvents; ++i)
+        {
+            int64 value = 0;
+            if (!input.readSigned(value)) { return false; }
+            column.add(int(value));
+        }
+        return true;
+    };
+
+    const auto readUnsigned = [&input, numEvents](Array<int> &column)
+    {
+        column.ensureStorageAllocated(numEvents);
+        for (int i = 0; i < numEvents; ++i)
+        {
+            uint64 value = 0;
+            if (!input.readUnsigned(value)) { return false; }
+            column.add(int(value));
+        }
+        return true;
+    };
+
+    const auto readFloats = [&input, numEvents](Array<float> &column)
+    {
+        column.ensureStorageAllocated(numEvents);
+        for (int i = 0; i < numEvents; ++i)
+        {
+            float value = 0.f;
+            if (!input.readFloat(value)) { return false; }
+            column.add(value);
+        }
+        return true;
+    };
+
+    bool isValid = readDeltas(this->beats);
+
+    if (this->kind == Kind::Notes)
+    {
+        isValid = isValid &&
+            readDeltas(this->keys) &&
+            readSigned(this->lengths) &&
+            readSigned(this->volumes) &&
+            readUnsigned(this->tuplets);
+    }
+    else
+    {
+        isValid = isValid &&
+            readFloats(this->values) &&
+            readFloats(this->curves);
+    }
+
+    this->ids.ensureStorageAllocated(numEvents);
+    for (int i = 0; isValid && i < numEvents; ++i)
+    {
+        int32 id = 0;
+        isValid = input.readInt(id);
+        this->ids.add(id);
+    }
+
+    if (!isValid)
+    {
+        this->clear();
+    }
+
+    return isValid;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class EventColumnsTests final : public UnitTest
+{
+public:
+    EventColumnsTests() : UnitTest("Event columns tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        using namespace Serialization;
+
+        beginTest("Notes columns round trip");
+
+        SerializedData track(Midi::track);
+        for (int i = 0; i < 100; ++i)
+        {
+            SerializedData note(Midi::note);
+            note.setProperty(Midi::id, String("n") + String(i).paddedLeft('0', 3));
+            note.setProperty(Midi::key, 60 + (i % 12) - 6);
+            note.setProperty(Midi::timestamp, i * 4);
+            note.setProperty(Midi::length, 4 + i % 3);
+            note.setProperty(Midi::volume, 512 + i);
+            if (i % 10 == 0)
+            {
+                note.setProperty(Midi::tuplet, 3);
+            }
+            track.appendChild(note);
+        }
+
+        EventColumns columns;
+        expect(columns.encode(track));
+        expectEquals(columns.size(), 100);
+
+        MemoryOutputStream stream;
+        columns.writeToStream(stream);
+
+        MemoryOutputStream treeStream;
+        track.writeToStream(treeStream);
+        expect(stream.getDataSize() * 4 < treeStream.getDataSize());
+
+        EventColumns decoded;
+        expect(decoded.readFromData(stream.getData(), stream.getDataSize()));
+        expect(decoded.getKind() == EventColumns::Kind::Notes);
+        expect(decoded.decode().isEquivalentTo(track));
+
+        // truncated data is rejected
+        expect(!decoded.readFromData(stream.getData(), stream.getDataSize() - 1));
+        expectEquals(decoded.size(), 0);
+
+        beginTest("Automation columns round trip");
+
+        SerializedData automation(Midi::automation);
+        for (int i = 0; i < 10; ++i)
+        {
+            SerializedData event(Midi::automationEvent);
+            event.setProperty(Midi::id, String("a") + String(i).paddedLeft('0', 3));
+            event.setProperty(Midi::value, float(i) / 10.f);
+            event.setProperty(Midi::curve, 0.5f);
+            event.setProperty(Midi::timestamp, i * 16);
+            automation.appendChild(event);
+        }
+
+        stream.reset();
+        expect(columns.encode(automation));
+        columns.writeToStream(stream);
+        expect(decoded.readFromData(stream.getData(), stream.getDataSize()));
+        expect(decoded.getKind() == EventColumns::Kind::Automation);
+        expect(decoded.decode().isEquivalentTo(automation));
+
+        beginTest("Sequences which would lose data are not encoded");
+
+        auto unknownProperty = track.createCopy();
+        unknownProperty.getChild(5).setProperty(Midi::text, "hello");
+        expect(!columns.encode(unknownProperty));
+        expectEquals(columns.size(), 0);
+
+        auto fractionalBeat = track.createCopy();
+        fractionalBeat.getChild(5).setProperty(Midi::timestamp, 1.5);
+        expect(!columns.encode(fractionalBeat));
+
+        expect(!columns.encode(SerializedData(Midi::annotations)));
+    }
+};
+
+static EventColumnsTests eventColumnsTests;
+
+#endif
@@ -0,0 +1,100 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// The events of a piano or automation sequence stored column by column,
+// used by the binary project format instead of the generic tree, where each
+// event is a node with string-keyed properties: the events are sorted by beat,
+// so the beats and keys are delta-encoded, and all integers are written
+// as variable-length values, which takes a couple of bytes per value.
+//
+// The columns keep exactly the same values which the events serialize into,
+// so a sequence is either expanded back into the very same tree,
+// or decoded by the sequence itself, bypassing the tree altogether.
+//
+// The sequences also capture their events into the columns for saving
+// in the background, see MidiSequence::serializeSnapshot(): the columns
+// are then kept in the tree as an object, and encoded by BinarySerializer.
+
+class EventColumns final : public ReferenceCountedObject
+{
+public:
+
+    using Ptr = ReferenceCountedObjectPtr<EventColumns>;
+
+    enum class Kind : uint8
+    {
+        Notes = 1,
+        Automation = 2
+    };
+
+    EventColumns() = default;
+    explicit EventColumns(Kind kind) noexcept : kind(kind) {}
+
+    Kind getKind() const noexcept;
+    int size() const noexcept;
+
+    // Returns false if the sequence cannot be stored in columns
+    // without losing anything, e.g. if some events have unknown properties
+    bool encode(const SerializedData &sequence);
+    SerializedData decode() const;
+
+    // For capturing the sequences' events, the values are the same
+    // as the events serialize into, e.g. ticks instead of beats
+    void ensureStorageAllocated(int numEvents);
+    void addNote(int32 id, int key, int beatTicks,
+        int lengthTicks, int volume, int tuplet);
+    void addAutomationEvent(int32 id, int beatTicks, float value, float curve);
+
+    void writeToStream(OutputStream &output) const;
+    bool readFromData(const void *data, size_t numBytes);
+
+    // The values are in the same units as in the serialized events,
+    // i.e. beats and lengths are in ticks, and velocities are scaled
+    // by the save resolution; zero tuplet means it was not serialized
+    const Array<int32> &getIds() const noexcept;
+    const Array<int> &getBeats() const noexcept;
+    const Array<int> &getKeys() const noexcept;
+    const Array<int> &getLengths() const noexcept;
+    const Array<int> &getVolumes() const noexcept;
+    const Array<int> &getTuplets() const noexcept;
+    const Array<float> &getValues() const noexcept;
+    const Array<float> &getCurves() const noexcept;
+
+private:
+
+    void clear() noexcept;
+
+    bool encodeNote(const SerializedData &note);
+    bool encodeAutomationEvent(const SerializedData &event);
+    bool encodeId(const var &packedId);
+
+    Kind kind = Kind::Notes;
+
+    Array<int32> ids;
+    Array<int> beats;
+    Array<int> keys;
+    Array<int> lengths;
+    Array<int> volumes;
+    Array<int> tuplets;
+    Array<float> values;
+    Array<float> curves;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventColumns)
+};
@@ -114,6 +114,16 @@ namespace Serialization
         static const Identifier volume = "vol";
         static const Identifier tuplet = "div";
 
+        // the sequence's events in the binary columnar format,
+        // replacing the events' nodes when loaded from the binary project file
+        static const Identifier columns = "columns";
+
+        // the sequence's header, which allows to open a project
+        // without decoding the events until they are needed
+        static const Identifier numEvents = "numEvents";
+        static const Identifier firstBeat = "firstBeat";
+        static const Identifier lastBeat = "lastBeat";
+
         static const Identifier mute = "mute";
         static const Identifier solo = "solo";
 
@@ -184,6 +194,7 @@ namespace Serialization
         static const Identifier audioDeviceBufferSize = "bufferSize";
         static const Identifier audioDeviceInputChannels = "inputChannels";
         static const Identifier audioDeviceOutputChannels = "outputChannels";
+        static const Identifier parallelProcessing = "parallelProcessing";
     } // namespace Audio
 
     namespace Config
@@ -199,6 +210,10 @@ namespace Serialization
         static const Identifier lastUpdatesInfo = "lastUpdatesInfo";
         static const Identifier lastUsedFont = "lastUsedFont";
         static const Identifier lastSearch = "lastSearch";
+
+        static const Identifier renderBlockSize = "renderBlockSize";
+        static const Identifier renderThreads = "renderThreads";
+        static const Identifier renderBitDepth = "renderBitDepth";
     } // namespace Config
 
     // Available types of dynamically fetched resources/configs
@@ -676,5 +691,14 @@ namespace Serialization
         static const Identifier automationEventsGroupChangeAction = "automationEventsChange";
 
         static const Identifier projectTemperamentChangeAction = "temperamentChange";
+
+        static const Identifier journalPosition = "journalPosition";
+        static const Identifier journalPerform = "journalPerform";
+        static const Identifier journalUndo = "journalUndo";
+        static const Identifier journalRedo = "journalRedo";
+        static const Identifier journalMerge = "journalMerge";
+        static const Identifier journalBarrier = "journalBarrier";
+        static const Identifier transactionId = "transactionId";
+        static const Identifier newTransaction = "newTransaction";
     } // namespace Undo
 }  // namespace Serialization
@@ -164,6 +164,16 @@ void AutomationTrackNode::resetStateTo(const VCS::TrackedItem &newState)
 //===----------------------------------------------------------------------===//
 
 SerializedData AutomationTrackNode::serialize() const
+{
+    return this->serializeWithSequence(this->sequence->serialize());
+}
+
+SerializedData AutomationTrackNode::serializeSnapshot() const
+{
+    return this->serializeWithSequence(this->sequence->serializeSnapshot());
+}
+
+SerializedData AutomationTrackNode::serializeWithSequence(const SerializedData &sequenceTree) const
 {
     SerializedData tree(Serialization::Core::treeNode);
 
@@ -174,7 +184,7 @@ SerializedData AutomationTrackNode::serialize() const
 
     this->serializeTrackProperties(tree);
 
-    tree.appendChild(this->sequence->serialize());
+    tree.appendChild(sequenceTree);
     tree.appendChild(this->pattern->serialize());
 
     TreeNodeSerializer::serializeChildren(*this, tree);
@@ -245,13 +255,8 @@ SerializedData AutomationTrackNode::serializeControllerDelta() const
 SerializedData AutomationTrackNode::serializeEventsDelta() const
 {
     SerializedData tree(Serialization::VCS::AutoSequenceDeltas::eventsAdded);
-
-    for (int i = 0; i < this->getSequence()->size(); ++i)
-    {
-        const MidiEvent *event = this->getSequence()->getUnchecked(i);
-        tree.appendChild(event->serialize());
-    }
-
+    // may be called by the VCS diff workers
+    this->getSequence()->serializeEvents(tree);
     return tree;
 }
 
@@ -43,6 +43,7 @@ public:
     //===------------------------------------------------------------------===//
 
     SerializedData serialize() const override;
+    SerializedData serializeSnapshot() const override;
     void deserialize(const SerializedData &data) override;
 
     //===------------------------------------------------------------------===//
@@ -63,6 +64,8 @@ public:
 
 private:
 
+    SerializedData serializeWithSequence(const SerializedData &sequenceTree) const;
+
     UniquePointer<VCS::AutomationTrackDiffLogic> vcsDiffLogic;
     OwnedArray<VCS::Delta> deltas;
 
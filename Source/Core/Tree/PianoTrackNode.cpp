@@ -160,6 +160,16 @@ void PianoTrackNode::resetStateTo(const VCS::TrackedItem &newState)
 //===----------------------------------------------------------------------===//
 
 SerializedData PianoTrackNode::serialize() const
+{
+    return this->serializeWithSequence(this->sequence->serialize());
+}
+
+SerializedData PianoTrackNode::serializeSnapshot() const
+{
+    return this->serializeWithSequence(this->sequence->serializeSnapshot());
+}
+
+SerializedData PianoTrackNode::serializeWithSequence(const SerializedData &sequenceTree) const
 {
     SerializedData tree(Serialization::Core::treeNode);
 
@@ -170,7 +180,7 @@ SerializedData PianoTrackNode::serialize() const
 
     this->serializeTrackProperties(tree);
 
-    tree.appendChild(this->sequence->serialize());
+    tree.appendChild(sequenceTree);
     tree.appendChild(this->pattern->serialize());
 
     TreeNodeSerializer::serializeChildren(*this, tree);
@@ -231,12 +241,8 @@ SerializedData PianoTrackNode::serializeInstrumentDelta() const
 SerializedData PianoTrackNode::serializeEventsDelta() const
 {
     SerializedData tree(Serialization::VCS::PianoSequenceDeltas::notesAdded);
-    for (int i = 0; i < this->getSequence()->size(); ++i)
-    {
-        const MidiEvent *event = this->getSequence()->getUnchecked(i);
-        tree.appendChild(event->serialize());
-    }
-
+    // may be called by the VCS diff workers
+    this->getSequence()->serializeEvents(tree);
     return tree;
 }
 
@@ -43,6 +43,7 @@ public:
     //===------------------------------------------------------------------===//
 
     SerializedData serialize() const override;
+    SerializedData serializeSnapshot() const override;
     void deserialize(const SerializedData &data) override;
 
     //===------------------------------------------------------------------===//
@@ -61,6 +62,8 @@ public:
 
 private:
 
+    SerializedData serializeWithSequence(const SerializedData &sequenceTree) const;
+
     UniquePointer<VCS::PianoTrackDiffLogic> vcsDiffLogic;
     OwnedArray<VCS::Delta> deltas;
 
@@ -36,6 +36,35 @@ public:
     virtual void onRemoveMidiEvent(const MidiEvent &event) = 0;
     virtual void onPostRemoveMidiEvent(MidiSequence *const layer) {}
 
+    // Sent by group operations, including their undo/redo, once per group
+    // instead of once per event; all events belong to the same sequence,
+    // and the default implementations fall back to per-event callbacks:
+    virtual void onAddMidiEvents(const Array<const MidiEvent *> &events)
+    {
+        for (const auto *event : events)
+        {
+            this->onAddMidiEvent(*event);
+        }
+    }
+
+    virtual void onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents)
+    {
+        jassert(oldEvents.size() == newEvents.size());
+        for (int i = 0; i < oldEvents.size(); ++i)
+        {
+            this->onChangeMidiEvent(*oldEvents.getUnchecked(i), *newEvents.getUnchecked(i));
+        }
+    }
+
+    virtual void onRemoveMidiEvents(const Array<const MidiEvent *> &events)
+    {
+        for (const auto *event : events)
+        {
+            this->onRemoveMidiEvent(*event);
+        }
+    }
+
     virtual void onAddClip(const Clip &clip) = 0;
     virtual void onChangeClip(const Clip &oldClip, const Clip &newClip) = 0;
     virtual void onRemoveClip(const Clip &clip) = 0;
@@ -46,6 +75,11 @@ public:
     virtual void onChangeTrackProperties(MidiTrack *const track) = 0;
     virtual void onChangeTrackBeatRange(MidiTrack *const track) {}
 
+    // The track's events are decoded lazily after the project is opened,
+    // so the editors skip the track's events until this is called
+    // (and may receive it for the tracks they've already loaded)
+    virtual void onLoadTrackContent(MidiTrack *const track) {}
+
     virtual void onChangeProjectInfo(const ProjectMetadata *info) {}
 
     // This will also be called when any track beat range changes (sounds weird, I know)
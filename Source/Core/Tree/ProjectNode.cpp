@@ -107,6 +107,8 @@ ProjectNode::~ProjectNode()
     this->transport->stopPlaybackAndRecording();
     this->transport->stopRender();
 
+    this->prefetchWorkers = nullptr;
+
     // remember as a recent file
     App::Workspace().getUserProfile().onProjectUnloaded(this->getId());
 
@@ -537,6 +539,22 @@ void ProjectNode::reset()
 }
 
 SerializedData ProjectNode::save() const
+{
+    auto tree = this->serializeProjectState();
+    TreeNodeSerializer::serializeChildren(*this, tree);
+    return tree;
+}
+
+// all the same, but the tracks only capture their events,
+// which are then encoded in the background, see Document::saveInBackground()
+SerializedData ProjectNode::saveSnapshot() const
+{
+    auto tree = this->serializeProjectState();
+    TreeNodeSerializer::serializeChildSnapshots(*this, tree);
+    return tree;
+}
+
+SerializedData ProjectNode::serializeProjectState() const
 {
     SerializedData tree(Serialization::Core::project);
 
@@ -549,9 +567,6 @@ SerializedData ProjectNode::save() const
     tree.appendChild(this->undoStack->serialize());
     tree.appendChild(this->transport->serialize());
     tree.appendChild(this->sequencerLayout->serialize());
-
-    TreeNodeSerializer::serializeChildren(*this, tree);
-
     return tree;
 }
 
@@ -586,6 +601,19 @@ void ProjectNode::load(const SerializedData &tree)
     this->broadcastReloadProjectContent();
     const auto range = this->broadcastChangeProjectBeatRange();
 
+    // only the tracks' headers are loaded at this point, so the editors
+    // can show the project right away, while the events are decoded
+    // in the background (or on the first access, if needed earlier)
+    if (this->prefetchWorkers == nullptr)
+    {
+        this->prefetchWorkers = make<ThreadPool>(SystemStats::getNumCpus());
+    }
+
+    for (auto *track : this->getTracks())
+    {
+        track->getSequence()->prefetch(*this->prefetchWorkers);
+    }
+
     // a hack to add some margin to project beat range,
     // then to round beats to nearest bars
     // because rolls' view ranges are rounded to bars
@@ -731,6 +759,7 @@ void ProjectNode::broadcastChangeEvent(const MidiEvent &oldEvent, const MidiEven
 {
     //jassert(oldEvent.isValid()); // old event is allowed to be un-owned
     jassert(newEvent.isValid());
+    this->markTrackAsModified(newEvent.getSequence()->getTrack());
     this->changeListeners.call(&ProjectListener::onChangeMidiEvent, oldEvent, newEvent);
     this->sendChangeMessage();
 }
@@ -738,6 +767,7 @@ void ProjectNode::broadcastChangeEvent(const MidiEvent &oldEvent, const MidiEven
 void ProjectNode::broadcastAddEvent(const MidiEvent &event)
 {
     jassert(event.isValid());
+    this->markTrackAsModified(event.getSequence()->getTrack());
     this->changeListeners.call(&ProjectListener::onAddMidiEvent, event);
     this->sendChangeMessage();
 }
@@ -751,10 +781,51 @@ void ProjectNode::broadcastRemoveEvent(const MidiEvent &event)
 
 void ProjectNode::broadcastPostRemoveEvent(MidiSequence *const layer)
 {
+    this->markTrackAsModified(layer->getTrack());
     this->changeListeners.call(&ProjectListener::onPostRemoveMidiEvent, layer);
     this->sendChangeMessage();
 }
 
+void ProjectNode::broadcastAddEvents(const Array<const MidiEvent *> &events)
+{
+    if (events.isEmpty())
+    {
+        return;
+    }
+
+    jassert(events.getFirst()->isValid());
+    this->markTrackAsModified(events.getFirst()->getSequence()->getTrack());
+    this->changeListeners.call(&ProjectListener::onAddMidiEvents, events);
+    this->sendChangeMessage();
+}
+
+void ProjectNode::broadcastChangeEvents(const Array<const MidiEvent *> &oldEvents,
+    const Array<const MidiEvent *> &newEvents)
+{
+    jassert(oldEvents.size() == newEvents.size());
+    if (newEvents.isEmpty())
+    {
+        return;
+    }
+
+    jassert(newEvents.getFirst()->isValid());
+    this->markTrackAsModified(newEvents.getFirst()->getSequence()->getTrack());
+    this->changeListeners.call(&ProjectListener::onChangeMidiEvents, oldEvents, newEvents);
+    this->sendChangeMessage();
+}
+
+void ProjectNode::broadcastRemoveEvents(const Array<const MidiEvent *> &events)
+{
+    if (events.isEmpty())
+    {
+        return;
+    }
+
+    jassert(events.getFirst()->isValid());
+    this->changeListeners.call(&ProjectListener::onRemoveMidiEvents, events);
+    this->sendChangeMessage();
+}
+
 void ProjectNode::broadcastAddTrack(MidiTrack *const track)
 {
     this->isTracksCacheOutdated = true;
@@ -765,6 +836,7 @@ void ProjectNode::broadcastAddTrack(MidiTrack *const track)
         this->vcsItems.addIfNotAlreadyThere(tracked);
     }
 
+    this->markTrackAsModified(track);
     this->changeListeners.call(&ProjectListener::onAddTrack, track);
     this->sendChangeMessage();
 }
@@ -785,6 +857,7 @@ void ProjectNode::broadcastRemoveTrack(MidiTrack *const track)
 
 void ProjectNode::broadcastChangeTrackProperties(MidiTrack *const track)
 {
+    this->markTrackAsModified(track);
     this->changeListeners.call(&ProjectListener::onChangeTrackProperties, track);
     this->sendChangeMessage();
 }
@@ -795,14 +868,21 @@ void ProjectNode::broadcastChangeTrackBeatRange(MidiTrack *const track)
     this->sendChangeMessage();
 }
 
+void ProjectNode::broadcastLoadTrackContent(MidiTrack *const track)
+{
+    this->changeListeners.call(&ProjectListener::onLoadTrackContent, track);
+}
+
 void ProjectNode::broadcastAddClip(const Clip &clip)
 {
+    this->markTrackAsModified(clip.getPattern()->getTrack());
     this->changeListeners.call(&ProjectListener::onAddClip, clip);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastChangeClip(const Clip &oldClip, const Clip &newClip)
 {
+    this->markTrackAsModified(newClip.getPattern()->getTrack());
     this->changeListeners.call(&ProjectListener::onChangeClip, oldClip, newClip);
     this->sendChangeMessage();
 }
@@ -815,13 +895,16 @@ void ProjectNode::broadcastRemoveClip(const Clip &clip)
 
 void ProjectNode::broadcastPostRemoveClip(Pattern *const pattern)
 {
+    this->markTrackAsModified(pattern->getTrack());
     this->changeListeners.call(&ProjectListener::onPostRemoveClip, pattern);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastChangeProjectInfo(const ProjectMetadata *info)
 {
+    this->metadata->setVCSModified();
     this->changeListeners.call(&ProjectListener::onChangeProjectInfo, info);
+    this->undoStack->requireFullSave(); // most of the metadata is edited directly
     this->sendChangeMessage();
 }
 
@@ -856,6 +939,8 @@ void ProjectNode::broadcastBeforeReloadProjectContent()
 
 void ProjectNode::broadcastReloadProjectContent()
 {
+    this->markAllTrackedItemsAsModified();
+
     this->changeListeners.call(&ProjectListener::onReloadProjectContent,
         this->getTracks(), this->metadata.get());
 
@@ -890,6 +975,9 @@ bool ProjectNode::onDocumentLoad(const File &file)
     {
         this->load(tree);
 
+        // recover the changes made after the last save, if any
+        this->undoStack->openJournal(file);
+
         App::Workspace().getUserProfile()
             .onProjectLocalInfoUpdated(this->getId(), this->getName(),
                 this->getDocument()->getFullPath());
@@ -906,7 +994,28 @@ bool ProjectNode::onDocumentSave(const File &file)
 #if DEBUG
     DocumentHelpers::save<XmlSerializer>(file.withFileExtension("xml"), projectNode);
 #endif
-    return DocumentHelpers::save<BinarySerializer>(file, projectNode);
+    if (DocumentHelpers::save<BinarySerializer>(file, projectNode))
+    {
+        this->undoStack->onProjectSaved(file, projectNode);
+        return true;
+    }
+
+    return false;
+}
+
+SerializedData ProjectNode::onDocumentSnapshot()
+{
+    return this->saveSnapshot();
+}
+
+void ProjectNode::onDocumentSaved(const SerializedData &snapshot)
+{
+    this->undoStack->onProjectSaved(File(this->getDocument()->getFullPath()), snapshot);
+}
+
+bool ProjectNode::canPostponeDocumentSave() const
+{
+    return this->undoStack->canPostponeFullSave();
 }
 
 void ProjectNode::onDocumentImport(InputStream &stream)
@@ -1008,6 +1117,29 @@ MidiSequence *ProjectNode::getSequenceByTrackId(const String &trackId)
 // VCS::TrackedItemsSource
 //===----------------------------------------------------------------------===//
 
+// the version control head only re-diffs the items marked here
+void ProjectNode::markTrackAsModified(MidiTrack *const track)
+{
+    if (auto *tracked = dynamic_cast<VCS::TrackedItem *>(track))
+    {
+        tracked->setVCSModified();
+    }
+    else
+    {
+        // the timeline's tracks are not tracked items themselves
+        this->timeline->setVCSModified();
+    }
+}
+
+void ProjectNode::markAllTrackedItemsAsModified()
+{
+    const ScopedReadLock lock(this->vcsInfoLock);
+    for (auto *item : this->vcsItems)
+    {
+        const_cast<VCS::TrackedItem *>(item)->setVCSModified();
+    }
+}
+
 String ProjectNode::getVCSId() const
 {
     return this->getId();
@@ -1090,6 +1222,9 @@ void ProjectNode::onBeforeResetState()
 
 void ProjectNode::onResetState()
 {
+    // the undo journal can't be replayed over the checked out state
+    this->undoStack->addJournalBarrier();
+
     this->broadcastReloadProjectContent();
     const auto range = this->broadcastChangeProjectBeatRange();
     this->broadcastChangeViewBeatRange(range.getStart() - Globals::beatsPerBar,
@@ -1122,6 +1257,8 @@ void ProjectNode::changeListenerCallback(ChangeBroadcaster *source)
 {
     if (auto *vcs = dynamic_cast<VersionControl *>(source))
     {
+        // the history is not journaled, so it needs the full save
+        this->undoStack->requireFullSave();
         DocumentOwner::sendChangeMessage();
     }
 }
@@ -143,10 +143,16 @@ public:
     void broadcastRemoveEvent(const MidiEvent &event);
     void broadcastPostRemoveEvent(MidiSequence *const layer);
 
+    void broadcastAddEvents(const Array<const MidiEvent *> &events);
+    void broadcastChangeEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents);
+    void broadcastRemoveEvents(const Array<const MidiEvent *> &events);
+
     void broadcastAddTrack(MidiTrack *const track);
     void broadcastRemoveTrack(MidiTrack *const track);
     void broadcastChangeTrackProperties(MidiTrack *const track);
     void broadcastChangeTrackBeatRange(MidiTrack *const track);
+    void broadcastLoadTrackContent(MidiTrack *const track);
 
     void broadcastAddClip(const Clip &clip);
     void broadcastChangeClip(const Clip &oldClip, const Clip &newClip);
@@ -197,6 +203,9 @@ protected:
 
     bool onDocumentLoad(const File &file) override;
     bool onDocumentSave(const File &file) override;
+    SerializedData onDocumentSnapshot() override;
+    void onDocumentSaved(const SerializedData &snapshot) override;
+    bool canPostponeDocumentSave() const override;
     void onDocumentImport(InputStream &stream) override;
     bool onDocumentExport(OutputStream &stream) override;
 
@@ -234,8 +243,13 @@ private:
 
     void initialize();
     SerializedData save() const;
+    SerializedData saveSnapshot() const;
+    SerializedData serializeProjectState() const;
     void load(const SerializedData &tree);
 
+    void markTrackAsModified(MidiTrack *const track);
+    void markAllTrackedItemsAsModified();
+
 private:
 
     String id;
@@ -245,6 +259,9 @@ private:
 
     UniquePointer<UndoStack> undoStack;
 
+    // decodes the tracks' events in the background after loading the project
+    UniquePointer<ThreadPool> prefetchWorkers;
+
     MidiTrack::Grouping trackGroupingMode = MidiTrack::Grouping::GroupByName;
 
     mutable float firstBeatCache = 0.f;
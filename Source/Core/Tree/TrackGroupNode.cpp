@@ -19,6 +19,7 @@
 #include "TrackGroupNode.h"
 #include "ProjectNode.h"
 #include "PianoTrackNode.h"
+#include "TreeNodeSerializer.h"
 #include "Icons.h"
 
 TrackGroupNode::TrackGroupNode(const String &name) :
@@ -141,3 +142,17 @@ UniquePointer<Component> TrackGroupNode::createMenu()
 {
     return nullptr;
 }
+
+//===----------------------------------------------------------------------===//
+// Serializable
+//===----------------------------------------------------------------------===//
+
+SerializedData TrackGroupNode::serializeSnapshot() const
+{
+    // same as TreeNode::serialize(), but for the tracks' snapshots
+    SerializedData tree(Serialization::Core::treeNode);
+    tree.setProperty(Serialization::Core::treeNodeType, this->type);
+    tree.setProperty(Serialization::Core::treeNodeName, this->name);
+    TreeNodeSerializer::serializeChildSnapshots(*this, tree);
+    return tree;
+}
@@ -44,4 +44,10 @@ public:
     bool hasMenu() const noexcept override;
     UniquePointer<Component> createMenu() override;
 
+    //===------------------------------------------------------------------===//
+    // Serializable
+    //===------------------------------------------------------------------===//
+
+    SerializedData serializeSnapshot() const override;
+
 };
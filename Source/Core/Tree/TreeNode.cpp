@@ -299,6 +299,11 @@ SerializedData TreeNode::serialize() const
     return tree;
 }
 
+SerializedData TreeNode::serializeSnapshot() const
+{
+    return this->serialize();
+}
+
 void TreeNode::deserialize(const SerializedData &data)
 {
     // Do not reset here, subclasses may rely
@@ -213,6 +213,10 @@ public:
     SerializedData serialize() const override;
     void deserialize(const SerializedData &data) override;
 
+    // Same as serialize(), but only captures the state to be saved
+    // in the background, which is cheaper for the tracks' sequences
+    virtual SerializedData serializeSnapshot() const;
+
 protected:
 
     void dispatchChangeTreeNodeViews();
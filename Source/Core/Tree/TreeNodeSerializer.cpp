@@ -39,6 +39,18 @@ void TreeNodeSerializer::serializeChildren(const TreeNode &parentItem, Serialize
     }
 }
 
+void TreeNodeSerializer::serializeChildSnapshots(const TreeNode &parentItem, SerializedData &parent)
+{
+    for (int i = 0; i < parentItem.getNumChildren(); ++i)
+    {
+        if (auto *sub = parentItem.getChild(i))
+        {
+            auto *treeItem = static_cast<TreeNode *>(sub);
+            parent.appendChild(treeItem->serializeSnapshot());
+        }
+    }
+}
+
 void TreeNodeSerializer::deserializeChildren(TreeNode &parentItem, const SerializedData &parent)
 {
     using namespace Serialization;
@@ -24,5 +24,6 @@ class TreeNodeSerializer
 public:
 
     static void serializeChildren(const TreeNode &parentItem, SerializedData &parent);
+    static void serializeChildSnapshots(const TreeNode &parentItem, SerializedData &parent);
     static void deserializeChildren(TreeNode &parentItem, const SerializedData &parent);
 };
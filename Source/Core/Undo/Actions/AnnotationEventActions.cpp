@@ -284,6 +284,8 @@ void AnnotationEventsGroupInsertAction::deserialize(const SerializedData &data)
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->annotations.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &params : data)
     {
         AnnotationEvent ae;
@@ -355,6 +357,8 @@ void AnnotationEventsGroupRemoveAction::deserialize(const SerializedData &data)
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->annotations.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &params : data)
     {
         AnnotationEvent ae;
@@ -472,6 +476,8 @@ void AnnotationEventsGroupChangeAction::deserialize(const SerializedData &data)
     const auto groupBeforeChild = data.getChildWithName(Serialization::Undo::groupBefore);
     const auto groupAfterChild = data.getChildWithName(Serialization::Undo::groupAfter);
     
+    this->eventsBefore.ensureStorageAllocated(groupBeforeChild.getNumChildren());
+
     for (const auto &params : groupBeforeChild)
     {
         AnnotationEvent ae;
@@ -479,6 +485,8 @@ void AnnotationEventsGroupChangeAction::deserialize(const SerializedData &data)
         this->eventsBefore.add(ae);
     }
     
+    this->eventsAfter.ensureStorageAllocated(groupAfterChild.getNumChildren());
+
     for (const auto &params : groupAfterChild)
     {
         AnnotationEvent ae;
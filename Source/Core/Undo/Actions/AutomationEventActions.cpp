@@ -284,6 +284,8 @@ void AutomationEventsGroupInsertAction::deserialize(const SerializedData &data)
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->events.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &params : data)
     {
         AutomationEvent ae;
@@ -355,6 +357,8 @@ void AutomationEventsGroupRemoveAction::deserialize(const SerializedData &data)
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->events.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &params : data)
     {
         AutomationEvent ae;
@@ -473,6 +477,8 @@ void AutomationEventsGroupChangeAction::deserialize(const SerializedData &data)
     const auto groupBeforeChild = data.getChildWithName(Serialization::Undo::groupBefore);
     const auto groupAfterChild = data.getChildWithName(Serialization::Undo::groupAfter);
     
+    this->eventsBefore.ensureStorageAllocated(groupBeforeChild.getNumChildren());
+
     for (const auto &params : groupBeforeChild)
     {
         AutomationEvent ae;
@@ -480,6 +486,8 @@ void AutomationEventsGroupChangeAction::deserialize(const SerializedData &data)
         this->eventsBefore.add(ae);
     }
     
+    this->eventsAfter.ensureStorageAllocated(groupAfterChild.getNumChildren());
+
     for (const auto &params : groupAfterChild)
     {
         AutomationEvent ae;
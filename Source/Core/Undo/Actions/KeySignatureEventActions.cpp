@@ -284,6 +284,8 @@ void KeySignatureEventsGroupInsertAction::deserialize(const SerializedData &data
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->signatures.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &params : data)
     {
         KeySignatureEvent ae;
@@ -355,6 +357,8 @@ void KeySignatureEventsGroupRemoveAction::deserialize(const SerializedData &data
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->signatures.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &params : data)
     {
         KeySignatureEvent ae;
@@ -471,6 +475,8 @@ void KeySignatureEventsGroupChangeAction::deserialize(const SerializedData &data
     const auto groupBeforeChild = data.getChildWithName(Serialization::Undo::groupBefore);
     const auto groupAfterChild = data.getChildWithName(Serialization::Undo::groupAfter);
     
+    this->eventsBefore.ensureStorageAllocated(groupBeforeChild.getNumChildren());
+
     for (const auto &params : groupBeforeChild)
     {
         KeySignatureEvent ae;
@@ -478,6 +484,8 @@ void KeySignatureEventsGroupChangeAction::deserialize(const SerializedData &data
         this->eventsBefore.add(ae);
     }
     
+    this->eventsAfter.ensureStorageAllocated(groupAfterChild.getNumChildren());
+
     for (const auto &params : groupAfterChild)
     {
         KeySignatureEvent ae;
@@ -319,6 +319,8 @@ void NotesGroupInsertAction::deserialize(const SerializedData &data)
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->notes.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &props : data)
     {
         Note n;
@@ -421,6 +423,8 @@ void NotesGroupRemoveAction::deserialize(const SerializedData &data)
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->notes.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &props : data)
     {
         Note n;
@@ -545,6 +549,8 @@ void NotesGroupChangeAction::deserialize(const SerializedData &data)
     const auto groupBeforeChild = data.getChildWithName(Serialization::Undo::groupBefore);
     const auto groupAfterChild = data.getChildWithName(Serialization::Undo::groupAfter);
 
+    this->notesBefore.ensureStorageAllocated(groupBeforeChild.getNumChildren());
+
     for (const auto &props : groupBeforeChild)
     {
         Note n;
@@ -552,6 +558,8 @@ void NotesGroupChangeAction::deserialize(const SerializedData &data)
         this->notesBefore.add(n);
     }
 
+    this->notesAfter.ensureStorageAllocated(groupAfterChild.getNumChildren());
+
     for (const auto &props : groupAfterChild)
     {
         Note n;
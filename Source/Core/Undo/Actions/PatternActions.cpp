@@ -278,6 +278,8 @@ void ClipsGroupInsertAction::deserialize(const SerializedData &data)
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
 
+    this->clips.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &props : data)
     {
         Clip n;
@@ -347,6 +349,8 @@ void ClipsGroupRemoveAction::deserialize(const SerializedData &data)
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
 
+    this->clips.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &props : data)
     {
         Clip n;
@@ -464,6 +468,8 @@ void ClipsGroupChangeAction::deserialize(const SerializedData &data)
     const auto groupBeforeChild = data.getChildWithName(Serialization::Undo::groupBefore);
     const auto groupAfterChild = data.getChildWithName(Serialization::Undo::groupAfter);
 
+    this->clipsBefore.ensureStorageAllocated(groupBeforeChild.getNumChildren());
+
     for (const auto &props : groupBeforeChild)
     {
         Clip n;
@@ -471,6 +477,8 @@ void ClipsGroupChangeAction::deserialize(const SerializedData &data)
         this->clipsBefore.add(n);
     }
 
+    this->clipsAfter.ensureStorageAllocated(groupAfterChild.getNumChildren());
+
     for (const auto &props : groupAfterChild)
     {
         Clip n;
@@ -284,6 +284,8 @@ void TimeSignatureEventsGroupInsertAction::deserialize(const SerializedData &dat
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->signatures.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &params : data)
     {
         TimeSignatureEvent ae;
@@ -355,6 +357,8 @@ void TimeSignatureEventsGroupRemoveAction::deserialize(const SerializedData &dat
     this->reset();
     this->trackId = data.getProperty(Serialization::Undo::trackId);
     
+    this->signatures.ensureStorageAllocated(data.getNumChildren());
+
     for (const auto &params : data)
     {
         TimeSignatureEvent ae;
@@ -471,6 +475,8 @@ void TimeSignatureEventsGroupChangeAction::deserialize(const SerializedData &dat
     const auto groupBeforeChild = data.getChildWithName(Serialization::Undo::groupBefore);
     const auto groupAfterChild = data.getChildWithName(Serialization::Undo::groupAfter);
     
+    this->eventsBefore.ensureStorageAllocated(groupBeforeChild.getNumChildren());
+
     for (const auto &params : groupBeforeChild)
     {
         TimeSignatureEvent ae;
@@ -478,6 +484,8 @@ void TimeSignatureEventsGroupChangeAction::deserialize(const SerializedData &dat
         this->eventsBefore.add(ae);
     }
     
+    this->eventsAfter.ensureStorageAllocated(groupAfterChild.getNumChildren());
+
     for (const auto &params : groupAfterChild)
     {
         TimeSignatureEvent ae;
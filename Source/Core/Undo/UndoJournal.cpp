@@ -0,0 +1,482 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "UndoJournal.h"
+#include "SerializationKeys.h"
+
+static const char *kJournalHeaderString = "HelioJ1:";
+static const uint64 kJournalHeader = ByteOrder::littleEndianInt64(kJournalHeaderString);
+
+// each record is the position, the size and the checksum of the data,
+// followed by the data itself, which is a serialized tree
+static constexpr auto kJournalRecordHeaderSize = sizeof(int64) + sizeof(int32) + sizeof(uint32);
+
+// FNV-1a, just to tell the records cut off by a crash
+static uint32 getJournalChecksum(const void *data, size_t numBytes) noexcept
+{
+    uint32 hash = 2166136261u;
+    const auto *bytes = static_cast<const uint8 *>(data);
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+UndoJournal::~UndoJournal()
+{
+    this->flush();
+}
+
+File UndoJournal::getFileFor(const File &projectFile)
+{
+    return projectFile.withFileExtension("journal");
+}
+
+//===----------------------------------------------------------------------===//
+// Open/compact
+//===----------------------------------------------------------------------===//
+
+Array<SerializedData> UndoJournal::open(const File &projectFile,
+    const String &projectId, int64 savedPosition)
+{
+    this->flush();
+    this->stream = nullptr;
+    this->file = UndoJournal::getFileFor(projectFile);
+    this->projectId = projectId;
+    this->position = savedPosition;
+    this->savedPosition = savedPosition;
+    this->requiredSnapshotPosition = 0;
+    this->firstUnsavedRecordTime = 0;
+    this->isBroken = false;
+
+    MemoryBlock data;
+    if (!this->file.existsAsFile() || !this->file.loadFileAsData(data))
+    {
+        return {};
+    }
+
+    int64 lastPosition = savedPosition;
+    size_t validSize = 0;
+    const auto records = UndoJournal::readRecords(data,
+        projectId, savedPosition, lastPosition, validSize);
+
+    if (records.isEmpty())
+    {
+        // the saved project has it all, the next record will start a new file
+        this->file.deleteFile();
+        return {};
+    }
+
+    DBG("Found " + String(records.size()) + " unsaved journal records");
+
+    // whatever is recovered, should be saved in full soon
+    this->position = lastPosition;
+    this->requiredSnapshotPosition = lastPosition;
+    this->firstUnsavedRecordTime = Time::getMillisecondCounter();
+
+    // drop the barrier and the broken tail, if any, and continue from there
+    if (!this->createStream(int64(validSize)))
+    {
+        this->onWriteFailed();
+    }
+
+    return records;
+}
+
+void UndoJournal::compact(const File &projectFile,
+    const String &projectId, int64 savedPosition)
+{
+    // the file may be moved or removed below, so it has to be complete
+    this->flush();
+
+    this->projectId = projectId;
+    this->savedPosition = jmax(this->savedPosition, savedPosition);
+
+    const bool hasUnsavedRecords = this->position > this->savedPosition;
+
+    const auto newFile = UndoJournal::getFileFor(projectFile);
+    if (newFile != this->file)
+    {
+        this->stream = nullptr;
+
+        if (this->file != File() && this->file.existsAsFile())
+        {
+            if (hasUnsavedRecords)
+            {
+                this->file.moveFileTo(newFile);
+            }
+            else
+            {
+                this->file.deleteFile();
+            }
+        }
+
+        this->file = newFile;
+
+        if (hasUnsavedRecords && !this->isBroken &&
+            !this->createStream(this->file.getSize()))
+        {
+            this->onWriteFailed();
+        }
+    }
+
+    if (!hasUnsavedRecords)
+    {
+        this->stream = nullptr;
+        this->file.deleteFile();
+        this->firstUnsavedRecordTime = 0;
+        this->isBroken = false;
+    }
+}
+
+bool UndoJournal::createStream(int64 keepBytes)
+{
+    auto newStream = make<FileOutputStream>(this->file);
+    if (newStream->failedToOpen())
+    {
+        return false;
+    }
+
+    // FileOutputStream is positioned at the end,
+    // so whatever is not needed should be cut off first
+    if (!newStream->setPosition(keepBytes) || newStream->truncate().failed())
+    {
+        return false;
+    }
+
+    if (keepBytes == 0)
+    {
+        newStream->writeInt64(int64(kJournalHeader));
+        newStream->writeString(this->projectId);
+        newStream->flush();
+    }
+
+    if (newStream->getStatus().failed())
+    {
+        return false;
+    }
+
+    this->stream = move(newStream);
+    return true;
+}
+
+void UndoJournal::onWriteFailed()
+{
+    DBG("Failed to write the journal: " + this->file.getFullPathName());
+
+    // the records written so far are still fine to replay,
+    // but nothing can be added to them until the next full save
+    this->stopTimer();
+    this->pendingRecords.reset();
+    this->stream = nullptr;
+    this->isBroken = true;
+    this->requireSnapshot();
+}
+
+//===----------------------------------------------------------------------===//
+// Records
+//===----------------------------------------------------------------------===//
+
+bool UndoJournal::isRecording() const noexcept
+{
+    return this->file != File() && !this->isBroken;
+}
+
+int64 UndoJournal::getPosition() const noexcept
+{
+    return this->position;
+}
+
+void UndoJournal::append(const SerializedData &record)
+{
+    if (!this->isRecording())
+    {
+        return;
+    }
+
+    if (this->stream == nullptr && !this->createStream(0))
+    {
+        this->onWriteFailed();
+        return;
+    }
+
+    MemoryOutputStream data;
+    record.writeToStream(data);
+
+    this->position++;
+    this->pendingRecords.writeInt64(this->position);
+    this->pendingRecords.writeInt(int(data.getDataSize()));
+    this->pendingRecords.writeInt(int(getJournalChecksum(data.getData(), data.getDataSize())));
+    this->pendingRecords.write(data.getData(), data.getDataSize());
+
+    if (!this->isTimerRunning())
+    {
+        this->startTimer(UndoJournal::flushDelayMs);
+    }
+
+    if (this->firstUnsavedRecordTime == 0)
+    {
+        this->firstUnsavedRecordTime = Time::getMillisecondCounter();
+    }
+}
+
+void UndoJournal::flush()
+{
+    this->stopTimer();
+
+    if (this->stream == nullptr || this->pendingRecords.getDataSize() == 0)
+    {
+        return;
+    }
+
+    this->stream->write(this->pendingRecords.getData(), this->pendingRecords.getDataSize());
+    this->stream->flush();
+    this->pendingRecords.reset();
+
+    if (this->stream->getStatus().failed())
+    {
+        this->onWriteFailed();
+    }
+}
+
+void UndoJournal::timerCallback()
+{
+    this->flush();
+}
+
+void UndoJournal::addBarrier()
+{
+    this->append(SerializedData(Serialization::Undo::journalBarrier));
+    this->requireSnapshot();
+}
+
+void UndoJournal::requireSnapshot()
+{
+    // the position is bumped even without a record, so that
+    // any snapshot taken before this moment is not enough
+    this->position++;
+    this->requiredSnapshotPosition = this->position;
+}
+
+bool UndoJournal::canPostponeSnapshot() const noexcept
+{
+    if (!this->isRecording() ||
+        this->requiredSnapshotPosition > this->savedPosition)
+    {
+        return false;
+    }
+
+    if (this->stream != nullptr &&
+        this->stream->getPosition() + int64(this->pendingRecords.getDataSize()) >
+            UndoJournal::maxSizeBeforeSnapshot)
+    {
+        return false;
+    }
+
+    return this->firstUnsavedRecordTime == 0 ||
+        Time::getMillisecondCounter() - this->firstUnsavedRecordTime <
+            uint32(UndoJournal::maxUnsavedTimeMs);
+}
+
+Array<SerializedData> UndoJournal::readRecords(const MemoryBlock &data,
+    const String &projectId, int64 savedPosition,
+    int64 &lastPosition, size_t &validSize)
+{
+    Array<SerializedData> records;
+    MemoryInputStream input(data, false);
+
+    if (input.getTotalLength() < int64(sizeof(kJournalHeader)) ||
+        uint64(input.readInt64()) != kJournalHeader ||
+        input.readString() != projectId)
+    {
+        // not this project's journal
+        return {};
+    }
+
+    validSize = size_t(input.getPosition());
+
+    while (input.getNumBytesRemaining() >= int64(kJournalRecordHeaderSize))
+    {
+        const auto recordPosition = input.readInt64();
+        const auto numBytes = input.readInt();
+        const auto checksum = uint32(input.readInt());
+
+        if (numBytes <= 0 || input.getNumBytesRemaining() < numBytes)
+        {
+            break;
+        }
+
+        const auto *recordData = static_cast<const uint8 *>(data.getData()) + input.getPosition();
+        if (getJournalChecksum(recordData, size_t(numBytes)) != checksum)
+        {
+            break;
+        }
+
+        // the records the saved project already has are skipped,
+        // including the barriers, which only matter after that
+        if (recordPosition > savedPosition)
+        {
+            const auto record = SerializedData::readFromData(recordData, size_t(numBytes));
+            if (!record.isValid() ||
+                record.hasType(Serialization::Undo::journalBarrier))
+            {
+                break;
+            }
+
+            records.add(record);
+            lastPosition = recordPosition;
+        }
+
+        input.skipNextBytes(numBytes);
+        validSize = size_t(input.getPosition());
+    }
+
+    return records;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class UndoJournalTests final : public UnitTest
+{
+public:
+    UndoJournalTests() : UnitTest("Undo journal tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        const auto projectFile = File::getSpecialLocation(File::tempDirectory)
+            .getNonexistentChildFile("UndoJournalTests", ".helio", false);
+        const auto journalFile = UndoJournal::getFileFor(projectFile);
+        const String projectId = "project";
+
+        beginTest("Records made after the saved position are replayed");
+
+        {
+            UndoJournal journal;
+            expect(!journal.isRecording());
+            expect(journal.open(projectFile, projectId, 10).isEmpty());
+            expect(journal.isRecording());
+            expect(journal.canPostponeSnapshot());
+            expect(!journalFile.existsAsFile());
+
+            journal.append(this->makeRecord(1));
+            journal.append(this->makeRecord(2));
+            journal.append(this->makeRecord(3));
+            expectEquals(journal.getPosition(), int64(13));
+            expect(journalFile.existsAsFile());
+
+            // the records are only written in a batch
+            const auto headerSize = journalFile.getSize();
+            journal.flush();
+            expect(journalFile.getSize() > headerSize);
+        }
+
+        {
+            UndoJournal journal;
+            const auto records = journal.open(projectFile, projectId, 11);
+            expectEquals(records.size(), 2);
+            expectEquals(int(records[0].getProperty(Serialization::Undo::name)), 2);
+            expectEquals(int(records[1].getProperty(Serialization::Undo::name)), 3);
+            expectEquals(journal.getPosition(), int64(13));
+
+            // the recovered changes are to be saved soon
+            expect(!journal.canPostponeSnapshot());
+            journal.compact(projectFile, projectId, 13);
+            expect(journal.canPostponeSnapshot());
+            expect(!journalFile.existsAsFile());
+        }
+
+        beginTest("Barriers and broken records stop the replay");
+
+        {
+            UndoJournal journal;
+            expect(journal.open(projectFile, projectId, 20).isEmpty());
+
+            journal.append(this->makeRecord(1));
+            journal.addBarrier();
+            journal.append(this->makeRecord(2));
+            expect(!journal.canPostponeSnapshot());
+        }
+
+        {
+            UndoJournal journal;
+            const auto records = journal.open(projectFile, projectId, 20);
+            expectEquals(records.size(), 1);
+            expectEquals(int(records[0].getProperty(Serialization::Undo::name)), 1);
+
+            // everything after the barrier is dropped from the file
+            journal.append(this->makeRecord(3));
+        }
+
+        {
+            FileOutputStream tail(journalFile);
+            tail.writeInt64(100);
+            tail.writeInt(1000);
+            tail.writeInt(0);
+        }
+
+        {
+            UndoJournal journal;
+            const auto records = journal.open(projectFile, projectId, 20);
+            expectEquals(records.size(), 2);
+            expectEquals(int(records[1].getProperty(Serialization::Undo::name)), 3);
+
+            // the barrier doesn't matter, once the project is saved after it
+            journal.addBarrier();
+            const auto savedPosition = journal.getPosition();
+            journal.append(this->makeRecord(4));
+            journal.compact(projectFile, projectId, savedPosition);
+            expect(journalFile.existsAsFile());
+            expect(journal.canPostponeSnapshot());
+
+            UndoJournal other;
+            const auto otherRecords = other.open(projectFile, projectId, savedPosition);
+            expectEquals(otherRecords.size(), 1);
+            expectEquals(int(otherRecords[0].getProperty(Serialization::Undo::name)), 4);
+        }
+
+        beginTest("Journals of other projects are ignored");
+
+        {
+            UndoJournal journal;
+            expect(journal.open(projectFile, "another project", 0).isEmpty());
+            expect(!journalFile.existsAsFile());
+        }
+
+        journalFile.deleteFile();
+    }
+
+private:
+
+    SerializedData makeRecord(int value) const
+    {
+        SerializedData record(Serialization::Undo::journalPerform);
+        record.setProperty(Serialization::Undo::name, value);
+        return record;
+    }
+};
+
+static UndoJournalTests undoJournalTests;
+
+#endif
@@ -0,0 +1,110 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// An append-only log of what the undo stack has done since the project
+// was saved for the last time, kept in a file next to the project:
+// each edit is recorded as it happens, so that the full saves may be rare,
+// and after a crash the journal is replayed on top of the saved project.
+
+// The records are buffered and written in batches, when a transaction ends
+// or shortly after the last edit, so that dragging things around doesn't
+// hit the disk on every mouse move; each record has its own checksum,
+// so a batch cut off by a crash is still detected on replay.
+
+// Every record gets the next position number, and the saved project
+// remembers the journal's position at the time of its snapshot,
+// so that the records it already contains are skipped on replay.
+
+// The changes made bypassing the undo stack (like VCS checkouts or imports)
+// can't be replayed, so they are marked with a barrier: anything after it
+// only makes sense on top of a newer snapshot, and it is discarded on load.
+
+class UndoJournal final : private Timer
+{
+public:
+
+    UndoJournal() = default;
+    ~UndoJournal() override;
+
+    static File getFileFor(const File &projectFile);
+
+    // Returns the records made after the given position,
+    // and then keeps appending new records to the same file
+    Array<SerializedData> open(const File &projectFile,
+        const String &projectId, int64 savedPosition);
+
+    // Called after the project with the given position is saved,
+    // removes the journal once the project has all its records;
+    // also handles the projects which were renamed or saved for the first time
+    void compact(const File &projectFile,
+        const String &projectId, int64 savedPosition);
+
+    bool isRecording() const noexcept;
+    int64 getPosition() const noexcept;
+
+    void append(const SerializedData &record);
+    void addBarrier();
+
+    // Writes the buffered records to the file
+    void flush();
+
+    // for the changes which don't break replaying
+    // the journal but aren't recorded in it either
+    void requireSnapshot();
+
+    // Whether everything not saved yet is safe in the journal,
+    // and it's not too big or too old, so that the next full save may wait
+    bool canPostponeSnapshot() const noexcept;
+
+private:
+
+    static Array<SerializedData> readRecords(const MemoryBlock &data,
+        const String &projectId, int64 savedPosition,
+        int64 &lastPosition, size_t &validSize);
+
+    void timerCallback() override;
+
+    bool createStream(int64 keepBytes);
+    void onWriteFailed();
+
+    File file;
+    String projectId;
+
+    UniquePointer<FileOutputStream> stream;
+    MemoryOutputStream pendingRecords;
+
+    int64 position = 0;
+    int64 savedPosition = 0;
+    int64 requiredSnapshotPosition = 0;
+
+    // set when the writes fail, the journal is dropped until
+    // the project is saved with everything recorded so far
+    bool isBroken = false;
+
+    uint32 firstUnsavedRecordTime = 0;
+
+    static constexpr auto flushDelayMs = 500;
+    static constexpr auto maxUnsavedTimeMs = 5 * 60 * 1000;
+    static constexpr auto maxSizeBeforeSnapshot = 4 * 1024 * 1024;
+
+    friend class UndoJournalTests;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(UndoJournal)
+};
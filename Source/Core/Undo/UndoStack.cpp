@@ -168,24 +168,23 @@ void UndoStack::clearUndoHistory()
     this->transactions.clear();
     this->totalUnitsStored = 0;
     this->nextIndex = 0;
+    this->numDetachedUndos = 0;
+
+    // whatever made the history useless, it didn't go through the stack
+    this->addJournalBarrier();
+}
+
+bool UndoStack::perform(UndoAction *const newAction)
+{
+    return this->performAction(newAction, UndoActionIDs::None);
 }
 
 bool UndoStack::perform(UndoAction *const newAction, UndoActionId transactionId)
 {
-    if (this->perform(newAction))
-    {
-        if (transactionId != 0)
-        {
-            this->setCurrentUndoActionId(transactionId);
-        }
-        
-        return true;
-    }
-    
-    return false;
+    return this->performAction(newAction, transactionId);
 }
 
-bool UndoStack::perform(UndoAction *const newAction)
+bool UndoStack::performAction(UndoAction *const newAction, UndoActionId transactionId)
 {
     if (newAction != nullptr)
     {
@@ -201,8 +200,19 @@ bool UndoStack::perform(UndoAction *const newAction)
         if (action->perform())
         {
             auto *actionSet = this->getCurrentSet();
-            
-            if (actionSet != nullptr && !this->hasNewEmptyTransaction)
+            const bool startsTransaction = actionSet == nullptr || this->hasNewEmptyTransaction;
+
+            // the action is recorded as is, before coalescing,
+            // which will happen the same way when replaying it
+            SerializedData record;
+            if (this->isJournaling())
+            {
+                record = SerializedData(Serialization::Undo::journalPerform);
+                record.setProperty(Serialization::Undo::newTransaction, startsTransaction);
+                record.appendChild(action->serialize());
+            }
+
+            if (!startsTransaction)
             {
                 if (auto *lastAction = actionSet->actions.getLast())
                 {
@@ -226,6 +236,19 @@ bool UndoStack::perform(UndoAction *const newAction)
             this->hasNewEmptyTransaction = false;
             
             this->clearFutureTransactions();
+            this->numDetachedUndos = 0;
+
+            if (transactionId != 0)
+            {
+                this->setCurrentUndoActionId(transactionId);
+            }
+
+            if (record.isValid())
+            {
+                record.setProperty(Serialization::Undo::transactionId, this->getUndoActionId());
+                this->journal.append(record);
+            }
+
             return true;
         }
     }
@@ -262,6 +285,9 @@ void UndoStack::beginNewTransaction() noexcept
 
 void UndoStack::beginNewTransaction(UndoActionId transactionId) noexcept
 {
+    // the previous transaction is complete, so its records are written at once
+    this->journal.flush();
+
     this->hasNewEmptyTransaction = true;
     this->newUndoActionId = transactionId;
 }
@@ -302,6 +328,14 @@ bool UndoStack::undo()
 {
     if (const auto *s = this->getCurrentSet())
     {
+        if (this->isJournaling())
+        {
+            SerializedData record(Serialization::Undo::journalUndo);
+            record.setProperty(Serialization::Undo::transactionId, s->id);
+            record.appendChild(s->serialize());
+            this->journal.append(record);
+        }
+
         const ScopedValueSetter<bool> setter(this->reentrancyCheck, true);
         
         if (s->undo())
@@ -324,6 +358,14 @@ bool UndoStack::redo()
 {
     if (const auto *s = this->getNextSet())
     {
+        if (this->isJournaling())
+        {
+            SerializedData record(Serialization::Undo::journalRedo);
+            record.setProperty(Serialization::Undo::transactionId, s->id);
+            record.appendChild(s->serialize());
+            this->journal.append(record);
+        }
+
         const ScopedValueSetter<bool> setter(this->reentrancyCheck, true);
         
         if (s->perform())
@@ -401,6 +443,7 @@ int UndoStack::getNumActionsInCurrentTransaction() const
 SerializedData UndoStack::serialize() const
 {
     SerializedData tree(Serialization::Undo::undoStack);
+    tree.setProperty(Serialization::Undo::journalPosition, this->journal.getPosition());
     
     int currentIndex = (this->nextIndex - 1);
     int numStoredTransactions = 0;
@@ -429,6 +472,8 @@ void UndoStack::deserialize(const SerializedData &data)
     { return; }
     
     this->reset();
+
+    this->savedJournalPosition = int64(root.getProperty(Serialization::Undo::journalPosition, 0));
     
     for (const auto &childTransaction : root)
     {
@@ -489,5 +534,138 @@ bool UndoStack::mergeTransactionsUpTo(UndoActionId transactionId)
         this->nextIndex--;
     }
 
+    if (this->isJournaling())
+    {
+        SerializedData record(Serialization::Undo::journalMerge);
+        record.setProperty(Serialization::Undo::transactionId, transactionId);
+        this->journal.append(record);
+    }
+
     return true;
 }
+
+//===----------------------------------------------------------------------===//
+// Journal
+//===----------------------------------------------------------------------===//
+
+void UndoStack::openJournal(const File &projectFile)
+{
+    const auto records = this->journal.open(projectFile,
+        this->project.getId(), this->savedJournalPosition);
+
+    const ScopedValueSetter<bool> replaying(this->isReplayingJournal, true);
+    for (const auto &record : records)
+    {
+        this->replay(record);
+    }
+}
+
+void UndoStack::onProjectSaved(const File &projectFile, const SerializedData &projectTree)
+{
+    const auto root = projectTree.hasType(Serialization::Core::project) ?
+        projectTree : projectTree.getChildWithName(Serialization::Core::project);
+
+    const auto undoStackNode = root.getChildWithName(Serialization::Undo::undoStack);
+    if (!undoStackNode.isValid())
+    {
+        jassertfalse;
+        return;
+    }
+
+    const auto savedPosition = int64(undoStackNode.getProperty(Serialization::Undo::journalPosition, 0));
+    this->journal.compact(projectFile, this->project.getId(), savedPosition);
+}
+
+void UndoStack::addJournalBarrier()
+{
+    if (!this->isReplayingJournal)
+    {
+        this->journal.addBarrier();
+    }
+}
+
+void UndoStack::requireFullSave()
+{
+    this->journal.requireSnapshot();
+}
+
+bool UndoStack::canPostponeFullSave() const noexcept
+{
+    return this->journal.canPostponeSnapshot();
+}
+
+bool UndoStack::isJournaling() const noexcept
+{
+    return !this->isReplayingJournal && this->journal.isRecording();
+}
+
+void UndoStack::replay(const SerializedData &record)
+{
+    using namespace Serialization;
+
+    const auto transactionId = UndoActionId(int64(record.getProperty(Undo::transactionId, 0)));
+
+    if (record.hasType(Undo::journalPerform))
+    {
+        if (bool(record.getProperty(Undo::newTransaction)))
+        {
+            this->beginNewTransaction(transactionId);
+        }
+        else
+        {
+            this->hasNewEmptyTransaction = false;
+        }
+
+        Transaction transaction(this->project, transactionId);
+        transaction.deserialize(record);
+        while (!transaction.actions.isEmpty())
+        {
+            this->performAction(transaction.actions.removeAndReturn(0), transactionId);
+        }
+    }
+    else if (record.hasType(Undo::journalUndo))
+    {
+        if (this->canUndo())
+        {
+            this->undo();
+            return;
+        }
+
+        // undoing further than the saved history goes
+        Transaction transaction(this->project, transactionId);
+        transaction.deserialize(record.getChildWithName(Undo::transaction));
+        transaction.undo();
+        this->numDetachedUndos++;
+        this->beginNewTransaction();
+    }
+    else if (record.hasType(Undo::journalRedo))
+    {
+        if (this->numDetachedUndos == 0 && this->canRedo())
+        {
+            this->redo();
+            return;
+        }
+
+        Transaction transaction(this->project, transactionId);
+        transaction.deserialize(record.getChildWithName(Undo::transaction));
+
+        if (this->numDetachedUndos > 0)
+        {
+            transaction.perform();
+            this->numDetachedUndos--;
+            this->beginNewTransaction();
+            return;
+        }
+
+        // the redo history is never saved, so here it goes as a new transaction
+        this->beginNewTransaction(transactionId);
+        while (!transaction.actions.isEmpty())
+        {
+            this->performAction(transaction.actions.removeAndReturn(0), transactionId);
+        }
+    }
+    else if (record.hasType(Undo::journalMerge))
+    {
+        this->mergeTransactionsUpTo(transactionId);
+    }
+}
@@ -21,6 +21,7 @@ class ProjectNode;
 
 #include "UndoAction.h"
 #include "UndoActionIDs.h"
+#include "UndoJournal.h"
 
 // Basically the same JUCE's UndoManager, but serializable;
 // plus most actions need a reference to project, which it has
@@ -70,7 +71,41 @@ public:
     // for multi-step interactive actions which might involve >1 checkpoints
     bool mergeTransactionsUpTo(UndoActionId transactionId);
 
+    //===------------------------------------------------------------------===//
+    // Journal
+    //===------------------------------------------------------------------===//
+
+    // Replays the changes made after the project was saved
+    // for the last time, then continues recording them
+    void openJournal(const File &projectFile);
+
+    // Called whenever the project is saved, including
+    // the background saves, with the tree that was saved
+    void onProjectSaved(const File &projectFile, const SerializedData &projectTree);
+
+    // For the project changes made bypassing the undo stack:
+    // some can't be replayed on top of the previous snapshot,
+    // some don't matter for replaying, but still need to be saved
+    void addJournalBarrier();
+    void requireFullSave();
+
+    bool canPostponeFullSave() const noexcept;
+
 private:
+
+    bool performAction(UndoAction *action, UndoActionId transactionId);
+
+    bool isJournaling() const noexcept;
+    void replay(const SerializedData &record);
+
+    UndoJournal journal;
+    int64 savedJournalPosition = 0;
+    bool isReplayingJournal = false;
+
+    // when replaying undos beyond the saved history, the transactions
+    // are undone right from the records; this counts them to redo them
+    // the same way, and not by using the ones in the stack instead
+    int numDetachedUndos = 0;
     
     void getActionsInCurrentTransaction(Array<const UndoAction *> &actionsFound) const;
     int getNumActionsInCurrentTransaction() const;
@@ -350,21 +350,17 @@ SerializedData mergeAutoEventsAdded(const SerializedData &state, const Serialize
     result.addArray(stateNotes);
 
     // на всякий пожарный, ищем, нет ли в состоянии нот с теми же id, где нет - добавляем
-    for (int i = 0; i < changesNotes.size(); ++i)
-    {
-        bool foundNoteInState = false;
-        const AutomationEvent *changesNote = static_cast<AutomationEvent *>(changesNotes.getUnchecked(i));
+    FlatHashSet<MidiEvent::Id> stateIDs;
 
-        for (int j = 0; j < stateNotes.size(); ++j)
-        {
-            const AutomationEvent *stateNote = static_cast<AutomationEvent *>(stateNotes.getUnchecked(j));
+    for (int j = 0; j < stateNotes.size(); ++j)
+    {
+        stateIDs.insert(stateNotes.getUnchecked(j)->getId());
+    }
 
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInState = true;
-                break;
-            }
-        }
+    for (int i = 0; i < changesNotes.size(); ++i)
+    {
+        const auto *changesNote = changesNotes.getUnchecked(i);
+        const bool foundNoteInState = stateIDs.contains(changesNote->getId());
 
         if (! foundNoteInState)
         {
@@ -386,21 +382,17 @@ SerializedData mergeAutoEventsRemoved(const SerializedData &state, const Seriali
     Array<const MidiEvent *> result;
 
     // добавляем все ноты из состояния, которых нет в изменениях
-    for (int i = 0; i < stateNotes.size(); ++i)
-    {
-        bool foundNoteInChanges = false;
-        const AutomationEvent *stateNote = static_cast<AutomationEvent *>(stateNotes.getUnchecked(i));
+    FlatHashSet<MidiEvent::Id> changesIDs;
 
-        for (int j = 0; j < changesNotes.size(); ++j)
-        {
-            const AutomationEvent *changesNote = static_cast<AutomationEvent *>(changesNotes.getUnchecked(j));
+    for (int j = 0; j < changesNotes.size(); ++j)
+    {
+        changesIDs.insert(changesNotes.getUnchecked(j)->getId());
+    }
 
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInChanges = true;
-                break;
-            }
-        }
+    for (int i = 0; i < stateNotes.size(); ++i)
+    {
+        const auto *stateNote = stateNotes.getUnchecked(i);
+        const bool foundNoteInChanges = changesIDs.contains(stateNote->getId());
 
         if (! foundNoteInChanges)
         {
@@ -420,31 +412,36 @@ SerializedData mergeAutoEventsChanged(const SerializedData &state, const Seriali
     deserializeAutoTrackChanges(state, changes, stateNotes, changesNotes);
 
     Array<const MidiEvent *> result;
-    result.addArray(stateNotes);
 
     // снова ищем по id и заменяем
-    for (int i = 0; i < stateNotes.size(); ++i)
-    {
-        bool foundNoteInChanges = false;
-        const AutomationEvent *stateNote = static_cast<AutomationEvent *>(stateNotes.getUnchecked(i));
+    FlatHashMap<MidiEvent::Id, const MidiEvent *> changesIDs;
 
-        for (int j = 0; j < changesNotes.size(); ++j)
-        {
-            const AutomationEvent *changesNote = static_cast<AutomationEvent *>(changesNotes.getUnchecked(j));
+    for (int j = 0; j < changesNotes.size(); ++j)
+    {
+        const auto *changesNote = changesNotes.getUnchecked(j);
+        changesIDs.emplace(changesNote->getId(), changesNote);
+    }
 
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInChanges = true;
-                result.removeAllInstancesOf(stateNote);
-                result.addIfNotAlreadyThere(changesNote);
+    // unchanged events keep their order, and the changed ones go after them
+    Array<const MidiEvent *> replacedEvents;
 
-                break;
-            }
+    for (int i = 0; i < stateNotes.size(); ++i)
+    {
+        const auto *stateNote = stateNotes.getUnchecked(i);
+        auto found = changesIDs.find(stateNote->getId());
+        if (found == changesIDs.end())
+        {
+            result.add(stateNote);
+        }
+        else if (found->second != nullptr)
+        {
+            replacedEvents.add(found->second);
+            found.value() = nullptr;
         }
-
-        //jassert(foundNoteInChanges);
     }
 
+    result.addArray(replacedEvents);
+
     return serializeAutoSequence(result, AutoSequenceDeltas::eventsAdded);
 }
 
@@ -508,62 +505,51 @@ Array<DeltaDiff> createAutoEventsDiffs(const SerializedData &state, const Serial
     Array<const MidiEvent *> removedEvents;
     Array<const MidiEvent *> changedEvents;
 
+    FlatHashMap<MidiEvent::Id, const AutomationEvent *> changesIDs;
+    for (int j = 0; j < changesEvents.size(); ++j)
+    {
+        const auto *changesEvent = static_cast<AutomationEvent *>(changesEvents.getUnchecked(j));
+        changesIDs.emplace(changesEvent->getId(), changesEvent);
+    }
+
+    FlatHashSet<MidiEvent::Id> stateIDs;
+
     // собственно, само сравнение
     for (int i = 0; i < stateEvents.size(); ++i)
     {
-        bool foundNoteInChanges = false;
         const AutomationEvent *stateEvent = static_cast<AutomationEvent *>(stateEvents.getUnchecked(i));
+        stateIDs.insert(stateEvent->getId());
 
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const AutomationEvent *changesEvent = static_cast<AutomationEvent *>(changesEvents.getUnchecked(j));
-
-            // нота из состояния - существует в изменениях. добавляем запись changed, если нужно.
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundNoteInChanges = true;
-
-                const bool eventHasChanged = (stateEvent->getBeat() != changesEvent->getBeat() ||
-                                              stateEvent->getCurvature() != changesEvent->getCurvature() ||
-                                              stateEvent->getControllerValue() != changesEvent->getControllerValue());
-
-                if (eventHasChanged)
-                {
-                    changedEvents.add(changesEvent);
-                }
-
-                break;
-            }
-        }
+        const auto found = changesIDs.find(stateEvent->getId());
 
         // нота из состояния - в изменениях не найдена. добавляем запись removed.
-        if (! foundNoteInChanges)
+        if (found == changesIDs.end())
         {
             removedEvents.add(stateEvent);
+            continue;
+        }
+
+        // нота из состояния - существует в изменениях. добавляем запись changed, если нужно.
+        const AutomationEvent *changesEvent = found->second;
+        const bool eventHasChanged = (stateEvent->getBeat() != changesEvent->getBeat() ||
+                                      stateEvent->getCurvature() != changesEvent->getCurvature() ||
+                                      stateEvent->getControllerValue() != changesEvent->getControllerValue());
+
+        if (eventHasChanged)
+        {
+            changedEvents.add(changesEvent);
         }
     }
 
     // теперь ищем в изменениях ноты, которые отсутствуют в состоянии
     for (int i = 0; i < changesEvents.size(); ++i)
     {
-        bool foundNoteInState = false;
-        const AutomationEvent *changesNote = static_cast<AutomationEvent *>(changesEvents.getUnchecked(i));
-
-        for (int j = 0; j < stateEvents.size(); ++j)
-        {
-            const AutomationEvent *stateNote = static_cast<AutomationEvent *>(stateEvents.getUnchecked(j));
-
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInState = true;
-                break;
-            }
-        }
+        const auto *changesEvent = changesEvents.getUnchecked(i);
 
         // и пишем ее в список добавленных
-        if (! foundNoteInState)
+        if (!stateIDs.contains(changesEvent->getId()))
         {
-            addedEvents.add(changesNote);
+            addedEvents.add(changesEvent);
         }
     }
 
@@ -599,14 +585,19 @@ Array<DeltaDiff> createAutoEventsDiffs(const SerializedData &state, const Serial
 void deserializeAutoTrackChanges(const SerializedData &state, const SerializedData &changes,
         OwnedArray<MidiEvent> &stateNotes, OwnedArray<MidiEvent> &changesNotes)
 {
+    // sorting once is much faster than adding them sorted one by one:
+    AutomationEvent comparator;
+
     if (state.isValid())
     {
         forEachChildWithType(state, e, Serialization::Midi::automationEvent)
         {
             auto *event = new AutomationEvent();
             event->deserialize(e);
-            stateNotes.addSorted(*event, event);
+            stateNotes.add(event);
         }
+
+        stateNotes.sort(comparator, true);
     }
 
     if (changes.isValid())
@@ -615,8 +606,10 @@ void deserializeAutoTrackChanges(const SerializedData &state, const SerializedDa
         {
             auto *event = new AutomationEvent();
             event->deserialize(e);
-            changesNotes.addSorted(*event, event);
+            changesNotes.add(event);
         }
+
+        changesNotes.sort(comparator, true);
     }
 }
 
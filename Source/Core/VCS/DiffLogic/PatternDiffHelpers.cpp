@@ -24,14 +24,19 @@ namespace VCS
 void deserializePatternChanges(const SerializedData &state, const SerializedData &changes,
     Array<Clip> &stateClips, Array<Clip> &changesClips)
 {
+    // sorting once is much faster than adding them sorted one by one:
+    Clip comparator;
+
     if (state.isValid())
     {
         forEachChildWithType(state, e, Serialization::Midi::clip)
         {
             Clip clip;
             clip.deserialize(e);
-            stateClips.addSorted(clip, clip);
+            stateClips.add(clip);
         }
+
+        stateClips.sort(comparator, true);
     }
 
     if (changes.isValid())
@@ -40,8 +45,10 @@ void deserializePatternChanges(const SerializedData &state, const SerializedData
         {
             Clip clip;
             clip.deserialize(e);
-            changesClips.addSorted(clip, clip);
+            changesClips.add(clip);
         }
+
+        changesClips.sort(comparator, true);
     }
 }
 
@@ -145,28 +152,35 @@ SerializedData PatternDiffHelpers::mergeClipsChanged(const SerializedData &state
     deserializePatternChanges(state, changes, stateClips, changesClips);
 
     Array<Clip> result;
-    result.addArray(stateClips);
 
-    FlatHashMap<Clip::Id, Clip> changesIDs;
+    FlatHashMap<Clip::Id, const Clip *> changesIDs;
 
     for (int j = 0; j < changesClips.size(); ++j)
     {
-        const Clip changesClip(changesClips.getUnchecked(j));
-        changesIDs[changesClip.getId()] = changesClip;
+        const auto &changesClip = changesClips.getReference(j);
+        changesIDs.emplace(changesClip.getId(), &changesClip);
     }
 
+    // unchanged clips keep their order, and the changed ones go after them
+    Array<Clip> replacedClips;
+
     for (int i = 0; i < stateClips.size(); ++i)
     {
-        const Clip stateClip(stateClips.getUnchecked(i));
-
-        if (changesIDs.contains(stateClip.getId()))
+        const auto &stateClip = stateClips.getReference(i);
+        auto found = changesIDs.find(stateClip.getId());
+        if (found == changesIDs.end())
         {
-            const auto changesClip = changesIDs[stateClip.getId()];
-            result.removeAllInstancesOf(stateClip);
-            result.addIfNotAlreadyThere(changesClip);
+            result.add(stateClip);
+        }
+        else if (found->second != nullptr)
+        {
+            replacedClips.add(*found->second);
+            found.value() = nullptr;
         }
     }
 
+    result.addArray(replacedClips);
+
     return serializePattern(result, PatternDeltas::clipsAdded);
 }
 
@@ -185,53 +199,42 @@ Array<VCS::DeltaDiff> PatternDiffHelpers::createClipsDiffs(const SerializedData
     Array<Clip> removedClips;
     Array<Clip> changedClips;
 
+    FlatHashMap<Clip::Id, const Clip *> changesIDs;
+    for (int j = 0; j < changesClips.size(); ++j)
+    {
+        const auto &changesClip = changesClips.getReference(j);
+        changesIDs.emplace(changesClip.getId(), &changesClip);
+    }
+
+    FlatHashSet<Clip::Id> stateIDs;
+
     for (int i = 0; i < stateClips.size(); ++i)
     {
-        bool foundInChanges = false;
-        const Clip stateClip(stateClips.getUnchecked(i));
+        const auto &stateClip = stateClips.getReference(i);
+        stateIDs.insert(stateClip.getId());
 
-        for (int j = 0; j < changesClips.size(); ++j)
+        const auto found = changesIDs.find(stateClip.getId());
+        if (found == changesIDs.end())
         {
-            const Clip changesClip(changesClips.getUnchecked(j));
-
-            if (stateClip.getId() == changesClip.getId())
-            {
-                foundInChanges = true;
-                if (stateClip.getKey() != changesClip.getKey() ||
-                    stateClip.getBeat() != changesClip.getBeat() ||
-                    stateClip.getVelocity() != changesClip.getVelocity() ||
-                    stateClip.isMuted() != changesClip.isMuted() ||
-                    stateClip.isSoloed() != changesClip.isSoloed())
-                {
-                    changedClips.add(changesClip);
-                }
-
-                break;
-            }
+            removedClips.add(stateClip);
+            continue;
         }
 
-        if (!foundInChanges)
+        const auto &changesClip = *found->second;
+        if (stateClip.getKey() != changesClip.getKey() ||
+            stateClip.getBeat() != changesClip.getBeat() ||
+            stateClip.getVelocity() != changesClip.getVelocity() ||
+            stateClip.isMuted() != changesClip.isMuted() ||
+            stateClip.isSoloed() != changesClip.isSoloed())
         {
-            removedClips.add(stateClip);
+            changedClips.add(changesClip);
         }
     }
 
     for (int i = 0; i < changesClips.size(); ++i)
     {
-        bool foundInState = false;
-        const Clip changesClip(changesClips.getUnchecked(i));
-
-        for (int j = 0; j < stateClips.size(); ++j)
-        {
-            const Clip stateClip(stateClips.getUnchecked(j));
-            if (stateClip.getId() == changesClip.getId())
-            {
-                foundInState = true;
-                break;
-            }
-        }
-
-        if (!foundInState)
+        const auto &changesClip = changesClips.getReference(i);
+        if (!stateIDs.contains(changesClip.getId()))
         {
             addedClips.add(changesClip);
         }
@@ -398,28 +398,36 @@ SerializedData mergeNotesChanged(const SerializedData &state, const SerializedDa
 
     Array<const MidiEvent *> result;
 
-    result.addArray(stateNotes);
-
     // снова ищем по id и заменяем
     FlatHashMap<MidiEvent::Id, const Note *> changesIDs;
-    
+
     for (int j = 0; j < changesNotes.size(); ++j)
     {
         const Note *changesNote = changesNotes.getUnchecked(j);
-        changesIDs[changesNote->getId()] = changesNote;
+        changesIDs.emplace(changesNote->getId(), changesNote);
     }
 
+    // unchanged notes keep their order, and the changed ones go after them;
+    // each changed note is only added once, even if ids are duplicated in the state
+    Array<const MidiEvent *> replacedNotes;
+
     for (int i = 0; i < stateNotes.size(); ++i)
     {
         const auto *stateNote = stateNotes.getUnchecked(i);
-        if (changesIDs.contains(stateNote->getId()))
+        auto found = changesIDs.find(stateNote->getId());
+        if (found == changesIDs.end())
+        {
+            result.add(stateNote);
+        }
+        else if (found->second != nullptr)
         {
-            const auto *changesNote = changesIDs[stateNote->getId()];
-            result.removeAllInstancesOf(stateNote);
-            result.addIfNotAlreadyThere(changesNote);
+            replacedNotes.add(found->second);
+            found.value() = nullptr;
         }
     }
 
+    result.addArray(replacedNotes);
+
     return serializePianoSequence(result, PianoSequenceDeltas::notesAdded);
 }
 
@@ -477,63 +485,53 @@ Array<DeltaDiff> createEventsDiffs(const SerializedData &state, const Serialized
     Array<const MidiEvent *> removedNotes;
     Array<const MidiEvent *> changedNotes;
 
+    // both sides are indexed by id, so that the comparison is linear
+    FlatHashMap<MidiEvent::Id, const Note *> changesIDs;
+    for (int j = 0; j < changesNotes.size(); ++j)
+    {
+        const Note *changesNote = changesNotes.getUnchecked(j);
+        changesIDs.emplace(changesNote->getId(), changesNote);
+    }
+
+    FlatHashSet<MidiEvent::Id> stateIDs;
+
     // собственно, само сравнение
     for (int i = 0; i < stateNotes.size(); ++i)
     {
-        bool foundNoteInChanges = false;
         const Note *stateNote(stateNotes.getUnchecked(i));
+        stateIDs.insert(stateNote->getId());
 
-        for (int j = 0; j < changesNotes.size(); ++j)
-        {
-            const Note *changesNote = changesNotes.getUnchecked(j);
-
-            // нота из состояния - существует в изменениях. добавляем запись changed, если нужно.
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInChanges = true;
-
-                const bool noteHasChanged =
-                    stateNote->getKey() != changesNote->getKey() ||
-                    stateNote->getBeat() != changesNote->getBeat() ||
-                    stateNote->getLength() != changesNote->getLength() ||
-                    stateNote->getVelocity() != changesNote->getVelocity() ||
-                    stateNote->getTuplet() != changesNote->getTuplet();
-
-                if (noteHasChanged)
-                {
-                    changedNotes.add(changesNote);
-                }
-
-                break;
-            }
-        }
+        const auto found = changesIDs.find(stateNote->getId());
 
         // нота из состояния - в изменениях не найдена. добавляем запись removed.
-        if (! foundNoteInChanges)
+        if (found == changesIDs.end())
         {
             removedNotes.add(stateNote);
+            continue;
+        }
+
+        // нота из состояния - существует в изменениях. добавляем запись changed, если нужно.
+        const Note *changesNote = found->second;
+        const bool noteHasChanged =
+            stateNote->getKey() != changesNote->getKey() ||
+            stateNote->getBeat() != changesNote->getBeat() ||
+            stateNote->getLength() != changesNote->getLength() ||
+            stateNote->getVelocity() != changesNote->getVelocity() ||
+            stateNote->getTuplet() != changesNote->getTuplet();
+
+        if (noteHasChanged)
+        {
+            changedNotes.add(changesNote);
         }
     }
 
     // теперь ищем в изменениях ноты, которые отсутствуют в состоянии
     for (int i = 0; i < changesNotes.size(); ++i)
     {
-        bool foundNoteInState = false;
         const Note *changesNote = changesNotes.getUnchecked(i);
 
-        for (int j = 0; j < stateNotes.size(); ++j)
-        {
-            const Note *stateNote(stateNotes.getUnchecked(j));
-
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInState = true;
-                break;
-            }
-        }
-
         // и пишем ее в список добавленных
-        if (! foundNoteInState)
+        if (!stateIDs.contains(changesNote->getId()))
         {
             addedNotes.add(changesNote);
         }
@@ -572,14 +570,19 @@ Array<DeltaDiff> createEventsDiffs(const SerializedData &state, const Serialized
 void deserializeLayerChanges(const SerializedData &state, const SerializedData &changes,
         OwnedArray<Note> &stateNotes, OwnedArray<Note> &changesNotes)
 {
+    // sorting once is much faster than adding them sorted one by one:
+    Note comparator;
+
     if (state.isValid())
     {
         forEachChildWithType(state, e, Serialization::Midi::note)
         {
             auto *note = new Note();
             note->deserialize(e);
-            stateNotes.addSorted(*note, note);
+            stateNotes.add(note);
         }
+
+        stateNotes.sort(comparator, true);
     }
 
     if (changes.isValid())
@@ -588,8 +591,10 @@ void deserializeLayerChanges(const SerializedData &state, const SerializedData &
         {
             auto *note = new Note();
             note->deserialize(e);
-            changesNotes.addSorted(*note, note);
+            changesNotes.add(note);
         }
+
+        changesNotes.sort(comparator, true);
     }
 }
 
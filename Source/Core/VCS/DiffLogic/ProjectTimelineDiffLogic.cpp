@@ -22,7 +22,6 @@
 #include "TimeSignaturesSequence.h"
 #include "KeySignaturesSequence.h"
 
-// TODO refactor, lots of duplicated code
 namespace VCS
 {
 
@@ -42,6 +41,13 @@ static Array<DeltaDiff> createAnnotationsDiffs(const SerializedData &state, cons
 static Array<DeltaDiff> createTimeSignaturesDiffs(const SerializedData &state, const SerializedData &changes);
 static Array<DeltaDiff> createKeySignaturesDiffs(const SerializedData &state, const SerializedData &changes);
 
+static Array<const MidiEvent *> mergeTimelineEventsAdded(const OwnedArray<MidiEvent> &stateEvents,
+    const OwnedArray<MidiEvent> &changesEvents);
+static Array<const MidiEvent *> mergeTimelineEventsRemoved(const OwnedArray<MidiEvent> &stateEvents,
+    const OwnedArray<MidiEvent> &changesEvents);
+static Array<const MidiEvent *> mergeTimelineEventsChanged(const OwnedArray<MidiEvent> &stateEvents,
+    const OwnedArray<MidiEvent> &changesEvents);
+
 static void deserializeTimelineChanges(const SerializedData &state, const SerializedData &changes,
     OwnedArray<MidiEvent> &stateEvents, OwnedArray<MidiEvent> &changesEvents);
 
@@ -374,87 +380,140 @@ Diff *ProjectTimelineDiffLogic::createMergedItem(const TrackedItem &initialState
 }
 
 //===----------------------------------------------------------------------===//
-// Merge annotations
+// Events matching
 //===----------------------------------------------------------------------===//
 
-SerializedData mergeAnnotationsAdded(const SerializedData &state, const SerializedData &changes)
-{
-    using namespace Serialization::VCS;
-
-    OwnedArray<MidiEvent> stateEvents;
-    OwnedArray<MidiEvent> changesEvents;
-    deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
+// all merges and diffs below match the events by id via hash indexes,
+// so that they stay linear in the number of events
 
+Array<const MidiEvent *> mergeTimelineEventsAdded(const OwnedArray<MidiEvent> &stateEvents,
+    const OwnedArray<MidiEvent> &changesEvents)
+{
     Array<const MidiEvent *> result;
-
     result.addArray(stateEvents);
 
-    // check if state doesn't already have events with the same ids, then add
-    for (int i = 0; i < changesEvents.size(); ++i)
+    FlatHashSet<MidiEvent::Id> stateIDs;
+    for (const auto *stateEvent : stateEvents)
     {
-        bool foundEventInState = false;
-        const AnnotationEvent *changesEvent =
-            static_cast<AnnotationEvent *>(changesEvents.getUnchecked(i));
-
-        for (int j = 0; j < stateEvents.size(); ++j)
-        {
-            const AnnotationEvent *stateEvent =
-                static_cast<AnnotationEvent *>(stateEvents.getUnchecked(j));
-
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInState = true;
-                break;
-            }
-        }
+        stateIDs.insert(stateEvent->getId());
+    }
 
-        if (! foundEventInState)
+    // check if state doesn't already have events with the same ids, then add
+    for (const auto *changesEvent : changesEvents)
+    {
+        if (!stateIDs.contains(changesEvent->getId()))
         {
             result.add(changesEvent);
         }
     }
 
-    return serializeTimelineSequence(result, ProjectTimelineDeltas::annotationsAdded);
+    return result;
 }
 
-SerializedData mergeAnnotationsRemoved(const SerializedData &state, const SerializedData &changes)
+Array<const MidiEvent *> mergeTimelineEventsRemoved(const OwnedArray<MidiEvent> &stateEvents,
+    const OwnedArray<MidiEvent> &changesEvents)
 {
-    using namespace Serialization::VCS;
+    Array<const MidiEvent *> result;
 
-    OwnedArray<MidiEvent> stateEvents;
-    OwnedArray<MidiEvent> changesEvents;
-    deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
+    FlatHashSet<MidiEvent::Id> changesIDs;
+    for (const auto *changesEvent : changesEvents)
+    {
+        changesIDs.insert(changesEvent->getId());
+    }
+
+    for (const auto *stateEvent : stateEvents)
+    {
+        if (!changesIDs.contains(stateEvent->getId()))
+        {
+            result.add(stateEvent);
+        }
+    }
 
+    return result;
+}
+
+Array<const MidiEvent *> mergeTimelineEventsChanged(const OwnedArray<MidiEvent> &stateEvents,
+    const OwnedArray<MidiEvent> &changesEvents)
+{
     Array<const MidiEvent *> result;
 
-    for (int i = 0; i < stateEvents.size(); ++i)
+    FlatHashMap<MidiEvent::Id, const MidiEvent *> changesIDs;
+    for (const auto *changesEvent : changesEvents)
     {
-        bool foundEventInChanges = false;
-        const AnnotationEvent *stateEvent =
-            static_cast<AnnotationEvent *>(stateEvents.getUnchecked(i));
+        changesIDs.emplace(changesEvent->getId(), changesEvent);
+    }
 
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const AnnotationEvent *changesEvent =
-                static_cast<AnnotationEvent *>(changesEvents.getUnchecked(j));
+    // unchanged events keep their order, and the changed ones go after them
+    Array<const MidiEvent *> replacedEvents;
 
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-                break;
-            }
+    for (const auto *stateEvent : stateEvents)
+    {
+        auto found = changesIDs.find(stateEvent->getId());
+        if (found == changesIDs.end())
+        {
+            result.add(stateEvent);
+        }
+        else if (found->second != nullptr)
+        {
+            replacedEvents.add(found->second);
+            found.value() = nullptr;
         }
+    }
+
+    result.addArray(replacedEvents);
+    return result;
+}
+
+template <typename EventType, typename HasChangedFn>
+static void findTimelineEventsChanges(const OwnedArray<MidiEvent> &stateEvents,
+    const OwnedArray<MidiEvent> &changesEvents,
+    Array<const MidiEvent *> &addedEvents,
+    Array<const MidiEvent *> &removedEvents,
+    Array<const MidiEvent *> &changedEvents,
+    HasChangedFn eventHasChanged)
+{
+    FlatHashMap<MidiEvent::Id, const EventType *> changesIDs;
+    for (const auto *changesEvent : changesEvents)
+    {
+        changesIDs.emplace(changesEvent->getId(), static_cast<const EventType *>(changesEvent));
+    }
+
+    FlatHashSet<MidiEvent::Id> stateIDs;
+
+    for (const auto *event : stateEvents)
+    {
+        const auto *stateEvent = static_cast<const EventType *>(event);
+        stateIDs.insert(stateEvent->getId());
 
-        if (! foundEventInChanges)
+        const auto found = changesIDs.find(stateEvent->getId());
+
+        // state event was not found in changes, add `removed` record
+        if (found == changesIDs.end())
         {
-            result.add(stateEvent);
+            removedEvents.add(stateEvent);
+        }
+        // state event was found in changes, add `changed` records
+        else if (eventHasChanged(stateEvent, found->second))
+        {
+            changedEvents.add(found->second);
         }
     }
 
-    return serializeTimelineSequence(result, ProjectTimelineDeltas::annotationsAdded);
+    // search for the new events missing in state
+    for (const auto *changesEvent : changesEvents)
+    {
+        if (!stateIDs.contains(changesEvent->getId()))
+        {
+            addedEvents.add(changesEvent);
+        }
+    }
 }
 
-SerializedData mergeAnnotationsChanged(const SerializedData &state, const SerializedData &changes)
+//===----------------------------------------------------------------------===//
+// Merge annotations
+//===----------------------------------------------------------------------===//
+
+SerializedData mergeAnnotationsAdded(const SerializedData &state, const SerializedData &changes)
 {
     using namespace Serialization::VCS;
 
@@ -462,34 +521,31 @@ SerializedData mergeAnnotationsChanged(const SerializedData &state, const Serial
     OwnedArray<MidiEvent> changesEvents;
     deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
 
-    Array<const MidiEvent *> result;
-
-    result.addArray(stateEvents);
+    const auto result = mergeTimelineEventsAdded(stateEvents, changesEvents);
+    return serializeTimelineSequence(result, ProjectTimelineDeltas::annotationsAdded);
+}
 
-    for (int i = 0; i < stateEvents.size(); ++i)
-    {
-        bool foundEventInChanges = false;
-        const AnnotationEvent *stateEvent =
-            static_cast<AnnotationEvent *>(stateEvents.getUnchecked(i));
+SerializedData mergeAnnotationsRemoved(const SerializedData &state, const SerializedData &changes)
+{
+    using namespace Serialization::VCS;
 
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const AnnotationEvent *changesEvent =
-                static_cast<AnnotationEvent *>(changesEvents.getUnchecked(j));
+    OwnedArray<MidiEvent> stateEvents;
+    OwnedArray<MidiEvent> changesEvents;
+    deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
 
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-                result.removeAllInstancesOf(stateEvent);
-                result.addIfNotAlreadyThere(changesEvent);
+    const auto result = mergeTimelineEventsRemoved(stateEvents, changesEvents);
+    return serializeTimelineSequence(result, ProjectTimelineDeltas::annotationsAdded);
+}
 
-                break;
-            }
-        }
+SerializedData mergeAnnotationsChanged(const SerializedData &state, const SerializedData &changes)
+{
+    using namespace Serialization::VCS;
 
-        //jassert(foundEventInChanges);
-    }
+    OwnedArray<MidiEvent> stateEvents;
+    OwnedArray<MidiEvent> changesEvents;
+    deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
 
+    const auto result = mergeTimelineEventsChanged(stateEvents, changesEvents);
     return serializeTimelineSequence(result, ProjectTimelineDeltas::annotationsAdded);
 }
 
@@ -504,36 +560,8 @@ SerializedData mergeTimeSignaturesAdded(const SerializedData &state, const Seria
     OwnedArray<MidiEvent> stateEvents;
     OwnedArray<MidiEvent> changesEvents;
     deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
-    
-    Array<const MidiEvent *> result;
-    
-    result.addArray(stateEvents);
-    
-    // check if state doesn't already have events with the same ids, then add
-    for (int i = 0; i < changesEvents.size(); ++i)
-    {
-        bool foundEventInState = false;
-        const TimeSignatureEvent *changesEvent =
-            static_cast<TimeSignatureEvent *>(changesEvents.getUnchecked(i));
-        
-        for (int j = 0; j < stateEvents.size(); ++j)
-        {
-            const TimeSignatureEvent *stateEvent =
-                static_cast<TimeSignatureEvent *>(stateEvents.getUnchecked(j));
-            
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInState = true;
-                break;
-            }
-        }
-        
-        if (! foundEventInState)
-        {
-            result.add(changesEvent);
-        }
-    }
-    
+
+    const auto result = mergeTimelineEventsAdded(stateEvents, changesEvents);
     return serializeTimelineSequence(result, ProjectTimelineDeltas::timeSignaturesAdded);
 }
 
@@ -544,34 +572,8 @@ SerializedData mergeTimeSignaturesRemoved(const SerializedData &state, const Ser
     OwnedArray<MidiEvent> stateEvents;
     OwnedArray<MidiEvent> changesEvents;
     deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
-    
-    Array<const MidiEvent *> result;
-    
-    // add all events that are missing in changes
-    for (int i = 0; i < stateEvents.size(); ++i)
-    {
-        bool foundEventInChanges = false;
-        const TimeSignatureEvent *stateEvent =
-            static_cast<TimeSignatureEvent *>(stateEvents.getUnchecked(i));
-        
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const TimeSignatureEvent *changesEvent =
-                static_cast<TimeSignatureEvent *>(changesEvents.getUnchecked(j));
-            
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-                break;
-            }
-        }
-        
-        if (! foundEventInChanges)
-        {
-            result.add(stateEvent);
-        }
-    }
-    
+
+    const auto result = mergeTimelineEventsRemoved(stateEvents, changesEvents);
     return serializeTimelineSequence(result, ProjectTimelineDeltas::timeSignaturesAdded);
 }
 
@@ -582,34 +584,8 @@ SerializedData mergeTimeSignaturesChanged(const SerializedData &state, const Ser
     OwnedArray<MidiEvent> stateEvents;
     OwnedArray<MidiEvent> changesEvents;
     deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
-    
-    Array<const MidiEvent *> result;
-    result.addArray(stateEvents);
-    
-    for (int i = 0; i < stateEvents.size(); ++i)
-    {
-        bool foundEventInChanges = false;
-        const TimeSignatureEvent *stateEvent =
-            static_cast<TimeSignatureEvent *>(stateEvents.getUnchecked(i));
-        
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const TimeSignatureEvent *changesEvent =
-                static_cast<TimeSignatureEvent *>(changesEvents.getUnchecked(j));
-            
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-                result.removeAllInstancesOf(stateEvent);
-                result.addIfNotAlreadyThere(changesEvent);
-                
-                break;
-            }
-        }
-        
-        //jassert(foundEventInChanges);
-    }
-    
+
+    const auto result = mergeTimelineEventsChanged(stateEvents, changesEvents);
     return serializeTimelineSequence(result, ProjectTimelineDeltas::timeSignaturesAdded);
 }
 
@@ -625,35 +601,7 @@ SerializedData mergeKeySignaturesAdded(const SerializedData &state, const Serial
     OwnedArray<MidiEvent> changesEvents;
     deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
 
-    Array<const MidiEvent *> result;
-
-    result.addArray(stateEvents);
-
-    // check if state doesn't already have events with the same ids, then add
-    for (int i = 0; i < changesEvents.size(); ++i)
-    {
-        bool foundEventInState = false;
-        const KeySignatureEvent *changesEvent =
-            static_cast<KeySignatureEvent *>(changesEvents.getUnchecked(i));
-
-        for (int j = 0; j < stateEvents.size(); ++j)
-        {
-            const KeySignatureEvent *stateEvent =
-                static_cast<KeySignatureEvent *>(stateEvents.getUnchecked(j));
-
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInState = true;
-                break;
-            }
-        }
-
-        if (!foundEventInState)
-        {
-            result.add(changesEvent);
-        }
-    }
-
+    const auto result = mergeTimelineEventsAdded(stateEvents, changesEvents);
     return serializeTimelineSequence(result, ProjectTimelineDeltas::keySignaturesAdded);
 }
 
@@ -665,33 +613,7 @@ SerializedData mergeKeySignaturesRemoved(const SerializedData &state, const Seri
     OwnedArray<MidiEvent> changesEvents;
     deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
 
-    Array<const MidiEvent *> result;
-
-    // add all events that are missing in changes
-    for (int i = 0; i < stateEvents.size(); ++i)
-    {
-        bool foundEventInChanges = false;
-        const KeySignatureEvent *stateEvent =
-            static_cast<KeySignatureEvent *>(stateEvents.getUnchecked(i));
-
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const KeySignatureEvent *changesEvent =
-                static_cast<KeySignatureEvent *>(changesEvents.getUnchecked(j));
-
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-                break;
-            }
-        }
-
-        if (!foundEventInChanges)
-        {
-            result.add(stateEvent);
-        }
-    }
-
+    const auto result = mergeTimelineEventsRemoved(stateEvents, changesEvents);
     return serializeTimelineSequence(result, ProjectTimelineDeltas::keySignaturesAdded);
 }
 
@@ -703,33 +625,7 @@ SerializedData mergeKeySignaturesChanged(const SerializedData &state, const Seri
     OwnedArray<MidiEvent> changesEvents;
     deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
 
-    Array<const MidiEvent *> result;
-    result.addArray(stateEvents);
-
-    for (int i = 0; i < stateEvents.size(); ++i)
-    {
-        bool foundEventInChanges = false;
-        const KeySignatureEvent *stateEvent =
-            static_cast<KeySignatureEvent *>(stateEvents.getUnchecked(i));
-
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const KeySignatureEvent *changesEvent =
-                static_cast<KeySignatureEvent *>(changesEvents.getUnchecked(j));
-
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-                result.removeAllInstancesOf(stateEvent);
-                result.addIfNotAlreadyThere(changesEvent);
-
-                break;
-            }
-        }
-
-        //jassert(foundEventInChanges);
-    }
-
+    const auto result = mergeTimelineEventsChanged(stateEvents, changesEvents);
     return serializeTimelineSequence(result, ProjectTimelineDeltas::keySignaturesAdded);
 }
 
@@ -751,68 +647,15 @@ Array<DeltaDiff> createAnnotationsDiffs(const SerializedData &state, const Seria
     Array<const MidiEvent *> removedEvents;
     Array<const MidiEvent *> changedEvents;
 
-    for (int i = 0; i < stateEvents.size(); ++i)
-    {
-        bool foundEventInChanges = false;
-        const AnnotationEvent *stateEvent =
-            static_cast<AnnotationEvent *>(stateEvents.getUnchecked(i));
-
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const AnnotationEvent *changesEvent =
-                static_cast<AnnotationEvent *>(changesEvents.getUnchecked(j));
-
-            // state event was found in changes, add `changed` records
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-
-                const bool eventHasChanged =
-                    (stateEvent->getBeat() != changesEvent->getBeat() ||
-                     stateEvent->getLength() != changesEvent->getLength() ||
-                     stateEvent->getColour() != changesEvent->getColour() ||
-                     stateEvent->getDescription() != changesEvent->getDescription());
-
-                if (eventHasChanged)
-                {
-                    changedEvents.add(changesEvent);
-                }
-
-                break;
-            }
-        }
-
-        // state event was not found in changes, add `removed` record
-        if (! foundEventInChanges)
-        {
-            removedEvents.add(stateEvent);
-        }
-    }
-
-    // search for the new events missing in state
-    for (int i = 0; i < changesEvents.size(); ++i)
-    {
-        bool foundEventInState = false;
-        const AnnotationEvent *changesEvent =
-            static_cast<AnnotationEvent *>(changesEvents.getUnchecked(i));
-
-        for (int j = 0; j < stateEvents.size(); ++j)
+    findTimelineEventsChanges<AnnotationEvent>(stateEvents, changesEvents,
+        addedEvents, removedEvents, changedEvents,
+        [](const AnnotationEvent *stateEvent, const AnnotationEvent *changesEvent)
         {
-            const AnnotationEvent *stateEvent =
-                static_cast<AnnotationEvent *>(stateEvents.getUnchecked(j));
-
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInState = true;
-                break;
-            }
-        }
-
-        if (! foundEventInState)
-        {
-            addedEvents.add(changesEvent);
-        }
-    }
+            return stateEvent->getBeat() != changesEvent->getBeat() ||
+                stateEvent->getLength() != changesEvent->getLength() ||
+                stateEvent->getColour() != changesEvent->getColour() ||
+                stateEvent->getDescription() != changesEvent->getDescription();
+        });
 
     // serialize deltas, if any
     if (addedEvents.size() > 0)
@@ -848,76 +691,22 @@ Array<DeltaDiff> createTimeSignaturesDiffs(const SerializedData &state, const Se
 
     OwnedArray<MidiEvent> stateEvents;
     OwnedArray<MidiEvent> changesEvents;
-    
     deserializeTimelineChanges(state, changes, stateEvents, changesEvents);
-    
+
     Array<DeltaDiff> res;
     Array<const MidiEvent *> addedEvents;
     Array<const MidiEvent *> removedEvents;
     Array<const MidiEvent *> changedEvents;
-    
-    for (int i = 0; i < stateEvents.size(); ++i)
-    {
-        bool foundEventInChanges = false;
-        const TimeSignatureEvent *stateEvent =
-            static_cast<TimeSignatureEvent *>(stateEvents.getUnchecked(i));
-        
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const TimeSignatureEvent *changesEvent =
-                static_cast<TimeSignatureEvent *>(changesEvents.getUnchecked(j));
-            
-            // state event was found in changes, add `changed` records
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-                
-                const bool eventHasChanged =
-                    (stateEvent->getBeat() != changesEvent->getBeat() ||
-                     stateEvent->getNumerator() != changesEvent->getNumerator() ||
-                     stateEvent->getDenominator() != changesEvent->getDenominator());
-                
-                if (eventHasChanged)
-                {
-                    changedEvents.add(changesEvent);
-                }
-                
-                break;
-            }
-        }
-        
-        // state event was not found in changes, add `removed` record
-        if (! foundEventInChanges)
-        {
-            removedEvents.add(stateEvent);
-        }
-    }
-    
-    // search for the new events missing in state
-    for (int i = 0; i < changesEvents.size(); ++i)
-    {
-        bool foundEventInState = false;
-        const TimeSignatureEvent *changesEvent =
-            static_cast<TimeSignatureEvent *>(changesEvents.getUnchecked(i));
-        
-        for (int j = 0; j < stateEvents.size(); ++j)
-        {
-            const TimeSignatureEvent *stateEvent =
-                static_cast<TimeSignatureEvent *>(stateEvents.getUnchecked(j));
-            
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInState = true;
-                break;
-            }
-        }
-        
-        if (! foundEventInState)
+
+    findTimelineEventsChanges<TimeSignatureEvent>(stateEvents, changesEvents,
+        addedEvents, removedEvents, changedEvents,
+        [](const TimeSignatureEvent *stateEvent, const TimeSignatureEvent *changesEvent)
         {
-            addedEvents.add(changesEvent);
-        }
-    }
-    
+            return stateEvent->getBeat() != changesEvent->getBeat() ||
+                stateEvent->getNumerator() != changesEvent->getNumerator() ||
+                stateEvent->getDenominator() != changesEvent->getDenominator();
+        });
+
     // serialize deltas, if any
     if (addedEvents.size() > 0)
     {
@@ -959,67 +748,14 @@ Array<DeltaDiff> createKeySignaturesDiffs(const SerializedData &state, const Ser
     Array<const MidiEvent *> removedEvents;
     Array<const MidiEvent *> changedEvents;
 
-    for (int i = 0; i < stateEvents.size(); ++i)
-    {
-        bool foundEventInChanges = false;
-        const KeySignatureEvent *stateEvent =
-            static_cast<KeySignatureEvent *>(stateEvents.getUnchecked(i));
-
-        for (int j = 0; j < changesEvents.size(); ++j)
-        {
-            const KeySignatureEvent *changesEvent =
-                static_cast<KeySignatureEvent *>(changesEvents.getUnchecked(j));
-
-            // state event was found in changes, add `changed` records
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInChanges = true;
-
-                const bool eventHasChanged =
-                    (stateEvent->getBeat() != changesEvent->getBeat() ||
-                        stateEvent->getRootKey() != changesEvent->getRootKey() ||
-                        ! stateEvent->getScale()->isEquivalentTo(changesEvent->getScale()));
-
-                if (eventHasChanged)
-                {
-                    changedEvents.add(changesEvent);
-                }
-
-                break;
-            }
-        }
-
-        // state event was not found in changes, add `removed` record
-        if (!foundEventInChanges)
+    findTimelineEventsChanges<KeySignatureEvent>(stateEvents, changesEvents,
+        addedEvents, removedEvents, changedEvents,
+        [](const KeySignatureEvent *stateEvent, const KeySignatureEvent *changesEvent)
         {
-            removedEvents.add(stateEvent);
-        }
-    }
-
-    // search for the new events missing in state
-    for (int i = 0; i < changesEvents.size(); ++i)
-    {
-        bool foundEventInState = false;
-        const KeySignatureEvent *changesEvent =
-            static_cast<KeySignatureEvent *>(changesEvents.getUnchecked(i));
-
-        for (int j = 0; j < stateEvents.size(); ++j)
-        {
-            const KeySignatureEvent *stateEvent =
-                static_cast<KeySignatureEvent *>(stateEvents.getUnchecked(j));
-
-            if (stateEvent->getId() == changesEvent->getId())
-            {
-                foundEventInState = true;
-                break;
-            }
-        }
-
-        if (!foundEventInState)
-        {
-            addedEvents.add(changesEvent);
-        }
-    }
+            return stateEvent->getBeat() != changesEvent->getBeat() ||
+                stateEvent->getRootKey() != changesEvent->getRootKey() ||
+                !stateEvent->getScale()->isEquivalentTo(changesEvent->getScale());
+        });
 
     // serialize deltas, if any
     if (addedEvents.size() > 0)
@@ -1054,33 +790,46 @@ Array<DeltaDiff> createKeySignaturesDiffs(const SerializedData &state, const Ser
 // Serialization
 //===----------------------------------------------------------------------===//
 
+struct TimelineEventsComparator final
+{
+    static int compareElements(const MidiEvent *const first, const MidiEvent *const second) noexcept
+    {
+        return MidiEvent::compareElements(first, second);
+    }
+};
+
 void deserializeTimelineChanges(const SerializedData &state, const SerializedData &changes,
     OwnedArray<MidiEvent> &stateEvents, OwnedArray<MidiEvent> &changesEvents)
 {
     using namespace Serialization;
 
+    // sorting once is much faster than adding them sorted one by one:
+    TimelineEventsComparator comparator;
+
     if (state.isValid())
     {
         forEachChildWithType(state, e, Midi::annotation)
         {
             AnnotationEvent *event = new AnnotationEvent();
             event->deserialize(e);
-            stateEvents.addSorted(*event, event);
+            stateEvents.add(event);
         }
 
         forEachChildWithType(state, e, Midi::timeSignature)
         {
             TimeSignatureEvent *event = new TimeSignatureEvent();
             event->deserialize(e);
-            stateEvents.addSorted(*event, event);
+            stateEvents.add(event);
         }
 
         forEachChildWithType(state, e, Midi::keySignature)
         {
             KeySignatureEvent *event = new KeySignatureEvent();
             event->deserialize(e);
-            stateEvents.addSorted(*event, event);
+            stateEvents.add(event);
         }
+
+        stateEvents.sort(comparator, true);
     }
 
     if (changes.isValid())
@@ -1089,22 +838,24 @@ void deserializeTimelineChanges(const SerializedData &state, const SerializedDat
         {
             AnnotationEvent *event = new AnnotationEvent();
             event->deserialize(e);
-            changesEvents.addSorted(*event, event);
+            changesEvents.add(event);
         }
         
         forEachChildWithType(changes, e, Midi::timeSignature)
         {
             TimeSignatureEvent *event = new TimeSignatureEvent();
             event->deserialize(e);
-            changesEvents.addSorted(*event, event);
+            changesEvents.add(event);
         }
 
         forEachChildWithType(changes, e, Midi::keySignature)
         {
             KeySignatureEvent *event = new KeySignatureEvent();
             event->deserialize(e);
-            changesEvents.addSorted(*event, event);
+            changesEvents.add(event);
         }
+
+        changesEvents.sort(comparator, true);
     }
 }
 
@@ -135,23 +135,32 @@ bool Head::moveTo(const Revision::Ptr revision)
         this->stopThread(Head::diffRebuildThreadStopTimeoutMs);
     }
 
-    // first, reset the snapshot state
-    {
-        const ScopedWriteLock lock(this->stateLock);
-        this->state = make<Snapshot>();
-    }
-
-    // a path from the root to current revision
+    // a path from the nearest checkpoint (or the root) to the target revision
     ReferenceCountedArray<Revision> treePath;
+    UniquePointer<Snapshot> newState;
     Revision::Ptr currentRevision(revision);
     while (currentRevision != nullptr)
     {
+        if (const auto *checkpoint = currentRevision->getSnapshotCheckpoint())
+        {
+            newState = make<Snapshot>(*checkpoint);
+            break;
+        }
+
         treePath.insert(0, currentRevision);
         currentRevision = currentRevision->getParent();
     }
 
-    // then move from the root back to target revision
-    for (const auto *rev : treePath)
+    if (newState == nullptr)
+    {
+        newState = make<Snapshot>();
+    }
+
+    int numRevisionsSinceCheckpoint = 0;
+    int numItemsSinceCheckpoint = 0;
+
+    // then move from there to the target revision
+    for (auto *rev : treePath)
     {
         DBG("VCS head moved to " + rev->getUuid());
 
@@ -160,21 +169,37 @@ bool Head::moveTo(const Revision::Ptr revision)
         {
             if (item->getType() == RevisionItem::Type::Added)
             {
-                this->state->addItem(item);
+                newState->addItem(item);
             }
             else if (item->getType() == RevisionItem::Type::Removed)
             {
-                this->state->removeItem(item);
+                newState->removeItem(item);
             }
             else if (item->getType() == RevisionItem::Type::Changed)
             {
-                this->state->mergeItem(item);
+                newState->mergeItem(item);
             }
             else
             {
                 jassertfalse;
             }
         }
+
+        numRevisionsSinceCheckpoint++;
+        numItemsSinceCheckpoint += rev->getItems().size();
+
+        if (numRevisionsSinceCheckpoint >= Head::snapshotCheckpointInterval ||
+            numItemsSinceCheckpoint >= Head::snapshotCheckpointMaxItems)
+        {
+            rev->setSnapshotCheckpoint(make<Snapshot>(*newState));
+            numRevisionsSinceCheckpoint = 0;
+            numItemsSinceCheckpoint = 0;
+        }
+    }
+
+    {
+        const ScopedWriteLock lock(this->stateLock);
+        this->state = move(newState);
     }
 
     this->headingAt = revision;
@@ -508,196 +533,399 @@ void Head::run()
     this->setRebuildingDiffMode(true);
     this->sendChangeMessage();
 
+    if (this->rebuildDiff(true))
     {
-        const ScopedWriteLock lock(this->diffLock);
-        this->diff->reset();
+        this->setDiffOutdated(false);
     }
 
-    const ScopedReadLock threadStateLock(this->stateLock);
+    this->setRebuildingDiffMode(false);
+    this->sendChangeMessage();
+}
 
-    for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
+void Head::rebuildDiffSynchronously()
+{
+    if (this->state == nullptr)
+    { return; }
+    
+    if (this->isRebuildingDiff())
+    { return; }
+    
+    this->setRebuildingDiffMode(true);
+
+    this->rebuildDiff(false);
+
+    this->setDiffOutdated(false);
+    this->setRebuildingDiffMode(false);
+    this->sendChangeMessage();
+}
+
+//===----------------------------------------------------------------------===//
+// Diff rebuild
+//===----------------------------------------------------------------------===//
+
+// Computes a single diff record, for any of the three cases:
+// the item exists in both the project and the state, or only in one of them
+class ItemDiffJob final : public ThreadPoolJob
+{
+public:
+
+    ItemDiffJob(TrackedItem *targetItem, RevisionItem::Ptr stateItem) :
+        ThreadPoolJob("ItemDiffJob"),
+        targetItem(targetItem),
+        stateItem(stateItem),
+        // read this before diffing, so that any change made in the meantime
+        // will just make the cached result outdated for the next rebuild
+        modificationCount(targetItem != nullptr ? targetItem->getVCSModificationCount() : 0) {}
+
+    JobStatus runJob() override
     {
-        if (this->threadShouldExit())
+        this->createRecord();
+        return ThreadPoolJob::jobHasFinished;
+    }
+
+    void createRecord()
+    {
+        if (this->targetItem == nullptr)
+        {
+            // state item was not found in project, adding `removed` record
+            auto emptyDiff = make<Diff>(*this->stateItem);
+            this->record = new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get());
+        }
+        else if (this->stateItem == nullptr)
         {
-            this->setRebuildingDiffMode(false);
-            this->sendChangeMessage();
-            return;
+            // copy deltas from targetItem and add `added` record
+            this->record = new RevisionItem(RevisionItem::Type::Added, this->targetItem);
         }
+        else
+        {
+            // state item exists in project, adding `changed` record, if needed
+            UniquePointer<Diff> itemDiff(this->targetItem->getDiffLogic()->createDiff(*this->stateItem));
+            if (itemDiff->hasAnyChanges())
+            {
+                this->record = new RevisionItem(RevisionItem::Type::Changed, itemDiff.get());
+            }
+        }
+    }
+
+    TrackedItem *const targetItem;
+    const RevisionItem::Ptr stateItem;
+    const int modificationCount;
+
+    RevisionItem::Ptr record; // stays empty, if nothing has changed
+    bool isCached = false;
 
-        bool foundItemInTarget = false;
-        const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
+    JUCE_DECLARE_NON_COPYABLE(ItemDiffJob)
+};
 
-        // will check `removed` records later
-        if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
+bool Head::rebuildDiff(bool canBeCancelled)
+{
+    OwnedArray<ItemDiffJob> jobs;
+
+    {
+        const ScopedReadLock rebuildStateLock(this->stateLock);
 
-        for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
+        FlatHashMap<Uuid, TrackedItem *, UuidHash> targetItems;
+        for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
         {
-            if (this->threadShouldExit())
-            {
-                this->setRebuildingDiffMode(false);
-                this->sendChangeMessage();
-                return;
-            }
+            auto *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
+            targetItems[targetItem->getUuid()] = targetItem;
+        }
 
-            TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(j); // i.e. LayerTreeItem
+        FlatHashSet<Uuid, UuidHash> stateItems;
+        for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
+        {
+            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
 
-            // state item exists in project, adding `changed` record, if needed
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInTarget = true;
+            // will check `removed` records later
+            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
 
-                UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
+            stateItems.insert(stateItem->getUuid());
 
-                if (itemDiff->hasAnyChanges())
-                {
-                    RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
-                    const ScopedWriteLock itemDiffLock(this->diffLock);
-                    this->diff->addItem(revisionRecord);
-                }
+            const auto found = targetItems.find(stateItem->getUuid());
+            jobs.add(new ItemDiffJob(found != targetItems.end() ? found->second : nullptr, stateItem));
+        }
 
-                break;
+        // search for project item that are missing (or deleted) in the state
+        for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
+        {
+            auto *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
+            if (stateItems.find(targetItem->getUuid()) == stateItems.end())
+            {
+                jobs.add(new ItemDiffJob(targetItem, nullptr));
             }
         }
+    }
+
+    // only re-diff the items which have changed since the last rebuild,
+    // or whose state has changed, i.e. after commits and checkouts
+    Array<ItemDiffJob *> jobsToRun;
 
-        // state item was not found in project, adding `removed` record
-        if (! foundItemInTarget)
+    {
+        const ScopedLock lock(this->diffCacheLock);
+        for (auto *job : jobs)
         {
-            auto emptyDiff = make<Diff>(*stateItem);
-            RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
-            const ScopedWriteLock emptyDiffLock(this->diffLock);
-            this->diff->addItem(revisionRecord);
+            const auto &uuid = job->stateItem != nullptr ?
+                job->stateItem->getUuid() : job->targetItem->getUuid();
+
+            const auto found = this->diffCache.find(uuid);
+            if (found != this->diffCache.end() &&
+                found->second.targetItem == job->targetItem &&
+                found->second.stateItem == job->stateItem &&
+                found->second.modificationCount == job->modificationCount)
+            {
+                job->record = found->second.record;
+                job->isCached = true;
+            }
+            else
+            {
+                jobsToRun.add(job);
+            }
         }
     }
 
-    // search for project item that are missing (or deleted) in the state
-    for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
+    if (jobsToRun.size() == 1)
+    {
+        jobsToRun.getFirst()->createRecord();
+    }
+    else if (jobsToRun.size() > 1)
     {
-        if (this->threadShouldExit())
+        if (this->diffWorkers == nullptr)
         {
-            this->setRebuildingDiffMode(false);
-            this->sendChangeMessage();
-            return;
+            this->diffWorkers = make<ThreadPool>(SystemStats::getNumCpus());
         }
 
-        bool foundItemInState = false;
-        TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
-
-        for (int j = 0; j < this->state->getNumTrackedItems(); ++j)
+        for (auto *job : jobsToRun)
         {
-            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(j));
+            this->diffWorkers->addJob(job, false);
+        }
 
-            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
+        for (auto *job : jobsToRun)
+        {
+            while (!this->diffWorkers->waitForJobToFinish(job, Head::diffJobWaitTimeoutMs))
+            {
+                if (canBeCancelled && this->threadShouldExit())
+                {
+                    // the jobs don't check for interruption, but are quick enough to wait for them
+                    this->diffWorkers->removeAllJobs(true, -1);
+                    return false;
+                }
+            }
+        }
+    }
 
-            if (stateItem->getUuid() == targetItem->getUuid())
+    // publish all at once, so that the diff is never seen half-built
+    {
+        const ScopedWriteLock lock(this->diffLock);
+        this->diff->reset();
+        for (const auto *job : jobs)
+        {
+            if (job->record != nullptr)
             {
-                foundItemInState = true;
-                break;
+                this->diff->addItem(job->record);
             }
         }
+    }
 
-        // copy deltas from targetItem and add `added` record
-        if (! foundItemInState)
+    {
+        const ScopedLock lock(this->diffCacheLock);
+        this->diffCache.clear();
+        for (const auto *job : jobs)
         {
-            RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Added, targetItem));
-            const ScopedWriteLock lock(this->diffLock);
-            this->diff->addItem(revisionRecord);
+            const auto &uuid = job->stateItem != nullptr ?
+                job->stateItem->getUuid() : job->targetItem->getUuid();
+
+            this->diffCache[uuid] = { job->targetItem, job->stateItem, job->modificationCount, job->record };
         }
     }
 
-    this->setDiffOutdated(false);
-    this->setRebuildingDiffMode(false);
-    this->sendChangeMessage();
+    return true;
 }
 
-// FIXME: lots of duplicate code from Head::run
-void Head::rebuildDiffSynchronously()
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+#include "ProjectInfoDiffLogic.h"
+
+namespace VCS
 {
-    if (this->state == nullptr)
-    { return; }
-    
-    if (this->isRebuildingDiff())
-    { return; }
-    
-    this->setRebuildingDiffMode(true);
-    
-    {
-        const ScopedWriteLock lock(this->diffLock);
-        this->diff->reset();
-    }
-    
-    const ScopedReadLock rebuildStateLock(this->stateLock);
-    
-    for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
+
+class HeadTests final : public UnitTest
+{
+public:
+    HeadTests() : UnitTest("VCS head tests", UnitTestCategories::helio) {}
+
+    void runTest() override
     {
-        bool foundItemInTarget = false;
-        const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-        
-        // will check `removed` records later
-        if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-        
-        for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
+        beginTest("Checking out from a checkpoint gives the same state as a full replay");
+
+        OwnedArray<TestItem> items;
+        for (int i = 0; i < 4; ++i)
         {
-            TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(j); // i.e. LayerTreeItem
-            
-            // state item exists in project, adding `changed` record, if needed
-            if (stateItem->getUuid() == targetItem->getUuid())
+            items.add(new TestItem("0"));
+        }
+
+        ReferenceCountedArray<Revision> revisions;
+        revisions.add(new Revision());
+        for (auto *item : items)
+        {
+            revisions.getFirst()->addItem(new RevisionItem(RevisionItem::Type::Added, item));
+        }
+
+        const auto numRevisions = Head::snapshotCheckpointInterval * 3;
+        for (int i = 1; i < numRevisions; ++i)
+        {
+            Revision::Ptr revision(new Revision());
+            auto *item = items[i % items.size()];
+            item->title = String(i);
+            revision->addItem(new RevisionItem(RevisionItem::Type::Changed, item));
+
+            // one item is removed and then added back
+            if (i == Head::snapshotCheckpointInterval + 1)
             {
-                foundItemInTarget = true;
-                
-                UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
-                
-                if (itemDiff->hasAnyChanges())
-                {
-                    RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
-                    const ScopedWriteLock lock(this->diffLock);
-                    this->diff->addItem(revisionRecord);
-                }
-                
-                break;
+                revision->addItem(new RevisionItem(RevisionItem::Type::Removed, items.getLast()));
             }
+            else if (i == Head::snapshotCheckpointInterval * 2 + 1)
+            {
+                revision->addItem(new RevisionItem(RevisionItem::Type::Added, items.getLast()));
+            }
+
+            revisions.getLast()->addChild(revision);
+            revisions.add(revision);
         }
-        
-        // state item was not found in project, adding `removed` record
-        if (! foundItemInTarget)
+
+        for (const auto *revision : revisions)
+        {
+            expect(revision->getSnapshotCheckpoint() == nullptr);
+        }
+
+        // not the last revision, so that the second checkout has something to replay
+        const auto targetRevision = revisions[numRevisions - 3];
+
+        TestItemsSource fullReplayProject;
+        Head fullReplayHead(fullReplayProject);
+        expect(fullReplayHead.moveTo(targetRevision));
+        fullReplayHead.checkout();
+
+        int numCheckpoints = 0;
+        for (const auto *revision : revisions)
+        {
+            numCheckpoints += (revision->getSnapshotCheckpoint() != nullptr) ? 1 : 0;
+        }
+
+        expectEquals(numCheckpoints, 2);
+        expect(targetRevision->getSnapshotCheckpoint() == nullptr);
+
+        TestItemsSource checkpointProject;
+        Head checkpointHead(checkpointProject);
+        expect(checkpointHead.moveTo(targetRevision));
+        checkpointHead.checkout();
+
+        expect(fullReplayHead.serialize().isEquivalentTo(checkpointHead.serialize()));
+        expectEquals(fullReplayProject.items.size(), items.size());
+        expectEquals(checkpointProject.items.size(), items.size());
+        for (int i = 0; i < items.size(); ++i)
         {
-            auto emptyDiff = make<Diff>(*stateItem);
-            RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
-            const ScopedWriteLock lock(this->diffLock);
-            this->diff->addItem(revisionRecord);
+            // the items keep the order they were first added in
+            expect(fullReplayProject.items[i]->getUuid() == items[i]->getUuid());
+            expect(checkpointProject.items[i]->getUuid() == items[i]->getUuid());
+            expectEquals(checkpointProject.items[i]->title, fullReplayProject.items[i]->title);
         }
+
+        beginTest("Amending a revision invalidates the checkpoints of its children");
+
+        TestItem amendedItem("amended");
+        revisions[1]->addItem(new RevisionItem(RevisionItem::Type::Added, &amendedItem));
+
+        for (int i = 1; i < revisions.size(); ++i)
+        {
+            expect(revisions[i]->getSnapshotCheckpoint() == nullptr);
+        }
+
+        TestItemsSource amendedProject;
+        Head amendedHead(amendedProject);
+        expect(amendedHead.moveTo(revisions.getLast()));
+        amendedHead.checkout();
+
+        // the last revision's state, with all the latest titles
+        expectEquals(amendedProject.items.size(), items.size() + 1);
+        for (int i = 0; i < items.size(); ++i)
+        {
+            expectEquals(amendedProject.items[i]->title, items[i]->title);
+        }
+
+        expect(amendedProject.items.getLast()->getUuid() == amendedItem.getUuid());
+        expectEquals(amendedProject.items.getLast()->title, amendedItem.title);
     }
-    
-    // search for project item that are missing (or deleted) in the state
-    for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
+
+private:
+
+    struct TestItem final : public TrackedItem
     {
-        bool foundItemInState = false;
-        TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
-        
-        for (int j = 0; j < this->state->getNumTrackedItems(); ++j)
+        explicit TestItem(const String &title) : title(title), logic(*this),
+            delta({}, Serialization::VCS::ProjectInfoDeltas::projectTitle) {}
+
+        int getNumDeltas() const override { return 1; }
+        Delta *getDelta(int) const override { return const_cast<Delta *>(&this->delta); }
+
+        SerializedData getDeltaData(int) const override
         {
-            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(j));
-            
-            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-            
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInState = true;
-                break;
-            }
+            using namespace Serialization::VCS;
+            SerializedData data(ProjectInfoDeltas::projectTitle);
+            data.setProperty(ProjectInfoDeltas::projectTitle, this->title);
+            return data;
         }
-        
-        // copy deltas from targetItem and add `added` record
-        if (! foundItemInState)
+
+        String getVCSName() const override { return this->title; }
+        DiffLogic *getDiffLogic() const override { return const_cast<ProjectInfoDiffLogic *>(&this->logic); }
+
+        void resetStateTo(const TrackedItem &newState) override
         {
-            RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Added, targetItem));
-            const ScopedWriteLock lock(this->diffLock);
-            this->diff->addItem(revisionRecord);
+            using namespace Serialization::VCS;
+            this->title = newState.getDeltaData(0).getProperty(ProjectInfoDeltas::projectTitle);
         }
-    }
-    
-    this->setDiffOutdated(false);
-    this->setRebuildingDiffMode(false);
-    this->sendChangeMessage();
-}
+
+        String title;
+        ProjectInfoDiffLogic logic;
+        Delta delta;
+    };
+
+    struct TestItemsSource final : public TrackedItemsSource
+    {
+        String getVCSId() const override { return {}; }
+        String getVCSName() const override { return {}; }
+
+        int getNumTrackedItems() override { return this->items.size(); }
+        TrackedItem *getTrackedItem(int index) override { return this->items[index]; }
+
+        TrackedItem *initTrackedItem(const Identifier &type,
+            const Uuid &id, const TrackedItem &newState) override
+        {
+            auto *item = this->items.add(new TestItem(String()));
+            item->setVCSUuid(id);
+            item->resetStateTo(newState);
+            return item;
+        }
+
+        bool deleteTrackedItem(TrackedItem *item) override
+        {
+            this->items.removeObject(static_cast<TestItem *>(item));
+            return true;
+        }
+
+        void onBeforeResetState() override {}
+        void onResetState() override {}
+
+        OwnedArray<TestItem> items;
+    };
+};
+
+static HeadTests headTests;
 
 }
+
+#endif
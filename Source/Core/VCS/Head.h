@@ -85,7 +85,16 @@ namespace VCS
         void checkoutItem(RevisionItem::Ptr stateItem);
         bool resetChangedItemToState(const RevisionItem::Ptr diffItem);
 
+        // returns false, if cancelled
+        bool rebuildDiff(bool canBeCancelled);
+
         static constexpr auto diffRebuildThreadStopTimeoutMs = 5000;
+        static constexpr auto diffJobWaitTimeoutMs = 50;
+
+        // moving the head saves a snapshot checkpoint in a revision
+        // after replaying this many revisions, or this many items:
+        static constexpr auto snapshotCheckpointInterval = 16;
+        static constexpr auto snapshotCheckpointMaxItems = 256;
 
         ReadWriteLock outdatedMarkerLock;
         bool diffOutdated;
@@ -96,6 +105,21 @@ namespace VCS
         ReadWriteLock rebuildingDiffLock;
         bool rebuildingDiffMode;
 
+        // the diff records from the last rebuild, which are reused
+        // for the items that haven't changed since then
+        struct CachedItemDiff final
+        {
+            const TrackedItem *targetItem = nullptr;
+            RevisionItem::Ptr stateItem;
+            int modificationCount = 0;
+            RevisionItem::Ptr record;
+        };
+
+        CriticalSection diffCacheLock;
+        FlatHashMap<Uuid, CachedItemDiff, UuidHash> diffCache;
+
+        UniquePointer<ThreadPool> diffWorkers;
+
     private:
 
         Revision::Ptr headingAt;
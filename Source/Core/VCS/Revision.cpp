@@ -42,6 +42,8 @@ void Revision::copyDeltasFrom(Revision::Ptr other)
     {
         this->deltas.add(revItem);
     }
+
+    this->resetSnapshotCheckpoints();
 }
 
 bool Revision::isEmpty() const noexcept
@@ -108,11 +110,12 @@ void Revision::removeChild(Revision::Ptr revision)
 void Revision::addItem(RevisionItem *item)
 {
     this->deltas.add(item);
+    this->resetSnapshotCheckpoints();
 }
 
 void Revision::addItem(RevisionItem::Ptr item)
 {
-    this->deltas.add(item);
+    this->addItem(item.get());
 }
 
 WeakReference<Revision> Revision::getParent() const noexcept
@@ -120,6 +123,30 @@ WeakReference<Revision> Revision::getParent() const noexcept
     return this->parent;
 }
 
+//===----------------------------------------------------------------------===//
+// Snapshot checkpoints
+//===----------------------------------------------------------------------===//
+
+const Snapshot *Revision::getSnapshotCheckpoint() const noexcept
+{
+    return this->snapshotCheckpoint.get();
+}
+
+void Revision::setSnapshotCheckpoint(UniquePointer<Snapshot> snapshot) noexcept
+{
+    this->snapshotCheckpoint = move(snapshot);
+}
+
+// the checkpoints of all child revisions depend on this one's deltas
+void Revision::resetSnapshotCheckpoints() noexcept
+{
+    this->snapshotCheckpoint = nullptr;
+    for (auto *child : this->children)
+    {
+        child->resetSnapshotCheckpoints();
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Serializable
 //===----------------------------------------------------------------------===//
@@ -152,8 +179,10 @@ void Revision::deserializeDeltas(SerializedData data)
     {
         RevisionItem::Ptr item(new RevisionItem(RevisionItem::Type::Undefined, nullptr));
         item->deserialize(e);
-        this->addItem(item);
+        this->deltas.add(item);
     }
+
+    this->resetSnapshotCheckpoints();
 }
 
 SerializedData Revision::serialize() const
@@ -215,6 +244,7 @@ void Revision::reset()
     this->timestamp = 0;
     this->deltas.clearQuick();
     this->children.clearQuick();
+    this->snapshotCheckpoint = nullptr;
 }
 
 }
@@ -20,6 +20,7 @@
 #include "Serializable.h"
 #include "RevisionItem.h"
 #include "RevisionDto.h"
+#include "Snapshot.h"
 
 namespace VCS
 {
@@ -64,6 +65,12 @@ namespace VCS
         int64 getTimeStamp() const noexcept;
         bool isEmpty() const noexcept;
 
+        // the head's state at this revision, materialized once in a while,
+        // so that moving the head only replays the revisions after it;
+        // not serialized, and dropped whenever this or any parent revision changes
+        const Snapshot *getSnapshotCheckpoint() const noexcept;
+        void setSnapshotCheckpoint(UniquePointer<Snapshot> snapshot) noexcept;
+
         //===--------------------------------------------------------------===//
         // Serializable
         //===--------------------------------------------------------------===//
@@ -79,6 +86,8 @@ namespace VCS
 
     private:
 
+        void resetSnapshotCheckpoints() noexcept;
+
         WeakReference<Revision> parent;
 
         String id;
@@ -88,6 +97,8 @@ namespace VCS
         ReferenceCountedArray<Revision> children;
         ReferenceCountedArray<RevisionItem> deltas;
 
+        UniquePointer<Snapshot> snapshotCheckpoint;
+
         JUCE_DECLARE_WEAK_REFERENCEABLE(Revision)
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Revision)
     };
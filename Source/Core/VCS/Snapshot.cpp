@@ -23,40 +23,23 @@ namespace VCS
 {
 
 Snapshot::Snapshot(const Snapshot &other) :
-    items(other.items) {}
+    items(other.items),
+    itemsIndex(other.itemsIndex) {}
 
 Snapshot::Snapshot(const Snapshot *other) :
-    items(other->items) {}
+    items(other->items),
+    itemsIndex(other->itemsIndex) {}
 
 void Snapshot::addItem(RevisionItem::Ptr item)
 {
-    RevisionItem::Ptr ownItem = this->getItemWithSameUuid(item);
-
-    if (ownItem == nullptr)
-    {
-        this->items.addIfNotAlreadyThere(item);
-    }
-    else
-    {
-        // ситуация, когда в состоянии есть removed запись, которую нужно заменить на added
-        this->items.removeAllInstancesOf(ownItem);
-        this->items.addIfNotAlreadyThere(item);
-    }
+    // the state might have a removed record, which is replaced with added
+    this->replaceItem(item);
 }
 
 void Snapshot::removeItem(RevisionItem::Ptr item)
 {
-    this->items.removeAllInstancesOf(item);
-
-    RevisionItem::Ptr ownItem = this->getItemWithSameUuid(item);
-
-    if (ownItem != nullptr)
-    {
-        this->items.removeAllInstancesOf(ownItem);
-    }
-
-    // removed-запись
-    this->items.addIfNotAlreadyThere(item);
+    // the removed record replaces the item
+    this->replaceItem(item);
 }
 
 void Snapshot::mergeItem(RevisionItem::Ptr newItem)
@@ -70,8 +53,8 @@ void Snapshot::mergeItem(RevisionItem::Ptr newItem)
         if (diff->hasAnyChanges())
         {
             RevisionItem::Ptr mergedItem(new RevisionItem(stateItem->getType(), diff.get()));
-            this->items.removeAllInstancesOf(stateItem);
-            this->items.add(mergedItem);
+            jassert(mergedItem->getUuid() == stateItem->getUuid());
+            this->replaceItem(mergedItem);
         }
     }
     else
@@ -81,6 +64,19 @@ void Snapshot::mergeItem(RevisionItem::Ptr newItem)
     }
 }
 
+void Snapshot::replaceItem(RevisionItem::Ptr newItem)
+{
+    const auto found = this->itemsIndex.find(newItem->getUuid());
+    if (found != this->itemsIndex.end())
+    {
+        this->items.set(found->second, newItem);
+        return;
+    }
+
+    this->itemsIndex[newItem->getUuid()] = this->items.size();
+    this->items.add(newItem);
+}
+
 //===----------------------------------------------------------------------===//
 // TrackedItemsSource
 //===----------------------------------------------------------------------===//
@@ -102,15 +98,9 @@ RevisionItem::Ptr Snapshot::getItemWithSameUuid(RevisionItem::Ptr item) const
 
 RevisionItem::Ptr Snapshot::getItemWithUuid(const Uuid &uuid) const
 {
-    for (auto &item : this->items)
-    {
-        if (item->getUuid() == uuid)
-        {
-            return item;
-        }
-    }
-
-    return nullptr;
+    const auto found = this->itemsIndex.find(uuid);
+    return found != this->itemsIndex.end() ?
+        this->items.getUnchecked(found->second) : nullptr;
 }
 
 }
@@ -54,8 +54,12 @@ namespace VCS
     private:
 
         RevisionItem::Ptr getItemWithSameUuid(RevisionItem::Ptr item) const;
+        void replaceItem(RevisionItem::Ptr newItem);
 
+        // the items are kept in the order they were first added, for the checkouts;
+        // the index maps uuids to the positions, so that replacing is done in place
         Array<RevisionItem::Ptr> items;
+        FlatHashMap<Uuid, int, UuidHash> itemsIndex;
 
         JUCE_LEAK_DETECTOR(Snapshot);
     };
@@ -32,6 +32,11 @@ namespace VCS
 
         const Uuid &getUuid() const { return this->vcsUuid; }
         void setVCSUuid(Uuid value) { this->vcsUuid = value; }
+
+        // the project bumps this on every change of the item,
+        // so that the head only re-diffs the items that have changed
+        void setVCSModified() noexcept { ++this->vcsModificationCount; }
+        int getVCSModificationCount() const noexcept { return this->vcsModificationCount.get(); }
         
         virtual int getNumDeltas() const = 0;
         virtual Delta *getDelta(int index) const = 0;
@@ -56,5 +61,9 @@ namespace VCS
 
         Uuid vcsUuid; // needs to be serialized by subclasses
 
+    private:
+
+        Atomic<int> vcsModificationCount = 0;
+
     };
 } // namespace VCS
@@ -24,6 +24,7 @@
 #include "App.h"
 #include "Config.h"
 #include "SerializationKeys.h"
+#include "UndoJournal.h"
 
 static RecentProjectInfo kProjectsSort;
 static SyncedConfigurationInfo kResourcesSort;
@@ -240,6 +241,7 @@ void UserProfile::deleteProjectLocally(const String &id)
         if (project->hasLocalCopy())
         {
             project->getLocalFile().deleteFile();
+            UndoJournal::getFileFor(project->getLocalFile()).deleteFile();
             this->onProjectLocalInfoReset(id);
         }
     }
@@ -0,0 +1,75 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "AudioMonitorSubscription.h"
+#include "AudioMonitor.h"
+
+AudioMonitorSubscription::AudioMonitorSubscription(Component &component, bool needsSpectrum) :
+    ComponentMovementWatcher(&component),
+    component(component),
+    needsSpectrum(needsSpectrum) {}
+
+AudioMonitorSubscription::~AudioMonitorSubscription()
+{
+    this->setAudioMonitor(nullptr);
+}
+
+void AudioMonitorSubscription::setAudioMonitor(WeakReference<AudioMonitor> monitor)
+{
+    if (this->isSubscribed && this->audioMonitor != nullptr)
+    {
+        this->audioMonitor->unsubscribe(this->needsSpectrum);
+    }
+
+    this->isSubscribed = false;
+    this->audioMonitor = monitor;
+    this->update();
+}
+
+void AudioMonitorSubscription::update()
+{
+    const bool shouldSubscribe = this->audioMonitor != nullptr &&
+        this->component.isShowing();
+
+    if (shouldSubscribe == this->isSubscribed)
+    {
+        return;
+    }
+
+    if (shouldSubscribe)
+    {
+        this->audioMonitor->subscribe(this->needsSpectrum);
+    }
+    else if (this->audioMonitor != nullptr)
+    {
+        this->audioMonitor->unsubscribe(this->needsSpectrum);
+    }
+
+    this->isSubscribed = shouldSubscribe;
+}
+
+void AudioMonitorSubscription::componentPeerChanged()
+{
+    this->update();
+}
+
+void AudioMonitorSubscription::componentVisibilityChanged()
+{
+    this->update();
+}
@@ -0,0 +1,53 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+class AudioMonitor;
+
+// Keeps the monitor analysing the output while the component is showing,
+// i.e. while it and all its parents are visible and it's on the screen;
+// the watcher keeps track of the component's parents as they change
+class AudioMonitorSubscription final : private ComponentMovementWatcher
+{
+public:
+
+    AudioMonitorSubscription(Component &component, bool needsSpectrum);
+    ~AudioMonitorSubscription() override;
+
+    void setAudioMonitor(WeakReference<AudioMonitor> monitor);
+
+private:
+
+    void update();
+
+    using ComponentMovementWatcher::componentMovedOrResized;
+    using ComponentMovementWatcher::componentVisibilityChanged;
+
+    void componentMovedOrResized(bool, bool) override {}
+    void componentPeerChanged() override;
+    void componentVisibilityChanged() override;
+
+    Component &component;
+    const bool needsSpectrum;
+
+    WeakReference<AudioMonitor> audioMonitor;
+    bool isSubscribed = false;
+
+    JUCE_DECLARE_NON_COPYABLE(AudioMonitorSubscription)
+};
@@ -34,7 +34,8 @@ static const float kPeakSpectrumFrequencies[] =
 SpectrogramAudioMonitorComponent::SpectrogramAudioMonitorComponent(WeakReference<AudioMonitor> monitor)
     : Thread("GenericAudioMonitor"),
     colour(findDefaultColour(ColourIDs::AudioMonitor::foreground)),
-    audioMonitor(monitor)
+    audioMonitor(monitor),
+    subscription(*this, true)
 {
     // (true, false) will enable switching rendering modes on click
     this->setInterceptsMouseClicks(false, false);
@@ -50,6 +51,7 @@ SpectrogramAudioMonitorComponent::SpectrogramAudioMonitorComponent(WeakReference
 
     if (this->audioMonitor != nullptr)
     {
+        this->subscription.setAudioMonitor(this->audioMonitor);
         this->startThread(5);
     }
 }
@@ -59,6 +61,7 @@ void SpectrogramAudioMonitorComponent::setTargetAnalyzer(WeakReference<AudioMoni
     if (monitor != nullptr)
     {
         this->audioMonitor = monitor;
+        this->subscription.setAudioMonitor(this->audioMonitor);
         this->startThread(5);
     }
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "AudioMonitor.h"
+#include "AudioMonitorSubscription.h"
 
 class SpectrogramAudioMonitorComponent final :
     public Component, private Thread, private AsyncUpdater
@@ -68,6 +69,9 @@ private:
     WeakReference<AudioMonitor> audioMonitor;
     OwnedArray<SpectrumBand> bands;
 
+    // the monitor only does the analysis while anyone is watching:
+    AudioMonitorSubscription subscription;
+
     UniquePointer<SpectrumBand> lPeakBand;
     UniquePointer<SpectrumBand> rPeakBand;
 
@@ -24,13 +24,15 @@
 WaveformAudioMonitorComponent::WaveformAudioMonitorComponent(WeakReference<AudioMonitor> targetAnalyzer) :
     Thread("WaveformAudioMonitor"),
     colour(findDefaultColour(ColourIDs::AudioMonitor::foreground)),
-    audioMonitor(targetAnalyzer)
+    audioMonitor(targetAnalyzer),
+    subscription(*this, false)
 {
     this->setInterceptsMouseClicks(false, false);
     this->setPaintingIsUnclipped(true);
 
     if (this->audioMonitor != nullptr)
     {
+        this->subscription.setAudioMonitor(this->audioMonitor);
         this->startThread(6);
     }
 }
@@ -45,6 +47,7 @@ void WaveformAudioMonitorComponent::setTargetAnalyzer(WeakReference<AudioMonitor
     if (targetAnalyzer != nullptr)
     {
         this->audioMonitor = targetAnalyzer;
+        this->subscription.setAudioMonitor(this->audioMonitor);
         this->startThread(6);
     }
 }
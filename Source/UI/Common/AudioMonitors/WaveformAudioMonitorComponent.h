@@ -20,6 +20,7 @@
 class AudioMonitor;
 
 #include "SequencerLayout.h"
+#include "AudioMonitorSubscription.h"
 
 class WaveformAudioMonitorComponent final :
     public Component, private Thread, private AsyncUpdater
@@ -45,6 +46,9 @@ private:
     const Colour colour;
 
     WeakReference<AudioMonitor> audioMonitor;
+
+    // the monitor only does the analysis while anyone is watching:
+    AudioMonitorSubscription subscription;
     
     static constexpr auto bufferSize = Globals::UI::sidebarWidth / 2;
 
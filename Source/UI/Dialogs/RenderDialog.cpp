@@ -233,7 +233,18 @@ void RenderDialog::timerCallback(int timerId)
     {
         this->stopTrackingProgress();
         transport.stopRender();
-        App::Layout().showTooltip({}, MainLayout::TooltipIcon::Success);
+
+        // show how long the export took, and which instruments took most of it:
+        const auto statistics = transport.getLastRenderStatistics();
+        String message = Transport::getTimeString(statistics.totalTimeMs, true);
+        for (int i = 0; i < jmin(statistics.instruments.size(), RenderDialog::numSlowestInstrumentsShown); ++i)
+        {
+            const auto &timing = statistics.instruments.getReference(i);
+            message << newLine << timing.instrumentName << ": " <<
+                Transport::getTimeString(timing.processingTimeMs, true);
+        }
+
+        App::Layout().showTooltip(message, MainLayout::TooltipIcon::Success);
     }
 }
 
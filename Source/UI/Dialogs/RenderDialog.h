@@ -44,6 +44,7 @@ public:
 private:
 
     static constexpr auto renderProgressTimer = 100;
+    static constexpr auto numSlowestInstrumentsShown = 3;
     void timerCallback(int timerId) override;
 
     void startTrackingProgress();
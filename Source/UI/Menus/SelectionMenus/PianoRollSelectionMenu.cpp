@@ -20,7 +20,7 @@
 
 #include "Lasso.h"
 #include "SequencerOperations.h"
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 
 #include "ProjectNode.h"
 #include "ProjectMetadata.h"
@@ -104,7 +104,7 @@ MenuPanel::Menu PianoRollSelectionMenu::createMoveToTrackPanel()
 
     jassert(this->lasso->getNumSelected() > 0);
 
-    const auto *sourceTrack = this->lasso->getFirstAs<NoteComponent>()->getNote().getSequence()->getTrack();
+    const auto *sourceTrack = this->lasso->getFirstAs<SelectableNote>()->getNote().getSequence()->getTrack();
 
     for (auto *targetTrack : this->project.findChildrenOfType<PianoTrackNode>())
     {
@@ -315,7 +315,7 @@ PianoRollSelectionMenu::PianoRollSelectionMenu(ProjectNode &project, WeakReferen
 {
     if (this->lasso->getNumSelected() > 0)
     {
-        const Clip &clip = this->lasso->getFirstAs<NoteComponent>()->getClip();
+        const Clip &clip = this->lasso->getFirstAs<SelectableNote>()->getClip();
         if (!SequencerOperations::findHarmonicContext(*this->lasso.get(), clip,
             this->project.getTimeline()->getKeySignatures(),
             this->harmonicContextScale, this->harmonicContextKey))
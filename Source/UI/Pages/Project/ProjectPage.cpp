@@ -19,7 +19,7 @@
 #include "ProjectPage.h"
 
 #include "VersionControlNode.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "ProjectNode.h"
 #include "ProjectMetadata.h"
 
@@ -20,7 +20,7 @@
 #include "PianoRoll.h"
 #include "SequencerOperations.h"
 #include "PianoSequence.h"
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 #include "CommandIDs.h"
 #include "Config.h"
 
@@ -35,7 +35,7 @@ ArpPreviewTool *ArpPreviewTool::createWithinContext(PianoRoll &roll,
 
         Note::Key key;
         Scale::Ptr scale = nullptr;
-        const Clip &clip = roll.getLassoSelection().getFirstAs<NoteComponent>()->getClip();
+        const Clip &clip = roll.getLassoSelection().getFirstAs<SelectableNote>()->getClip();
         if (!SequencerOperations::findHarmonicContext(roll.getLassoSelection(),
             clip, keySignatures, scale, key))
         {
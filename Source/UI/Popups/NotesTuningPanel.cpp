@@ -24,7 +24,7 @@
 //[MiscUserDefs]
 #include "PianoRoll.h"
 #include "SequencerOperations.h"
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 #include "CommandIDs.h"
 #include "MenuItemComponent.h"
 #include "PopupButton.h"
@@ -43,13 +43,13 @@ public:
 
         for (int i = 0; i < selection.getNumSelected(); ++i)
         {
-            auto *mc = selection.getItemAs<MidiEventComponent>(i);
-            this->sortedSelection.addSorted(*mc, mc);
+            auto *note = selection.getItemAs<SelectableNote>(i);
+            this->sortedSelection.addSorted(*note, note);
 
-            if (!foundColour && dynamic_cast<NoteComponent *>(mc))
+            if (!foundColour)
             {
                 foundColour = true;
-                this->colour = static_cast<NoteComponent *>(mc)->getNote()
+                this->colour = note->getNote()
                     .getSequence()->getTrack()->getTrackColour()
                     .interpolatedWith(baseColour, 0.55f).withAlpha(0.55f);
             }
@@ -96,18 +96,15 @@ private:
     void updateDiagram()
     {
         this->peaks.clearQuick();
-        for (auto *i : this->sortedSelection)
+        for (const auto *nc : this->sortedSelection)
         {
-            if (auto *nc = dynamic_cast<NoteComponent *>(i))
-            {
-                const float absPos = (nc->getBeat() - this->startBeat) / (this->endBeat - this->startBeat);
-                const float absLen = nc->getLength() / (this->endBeat - this->startBeat);
-                const int x = this->proportionOfWidth(absPos);
-                const int w = this->proportionOfWidth(absLen);
-                const int y = this->proportionOfHeight(1.f - nc->getNote().getVelocity());
-                const int h = this->proportionOfHeight(nc->getNote().getVelocity());
-                this->peaks.add({ x, y, w, h });
-            }
+            const float absPos = (nc->getBeat() - this->startBeat) / (this->endBeat - this->startBeat);
+            const float absLen = nc->getLength() / (this->endBeat - this->startBeat);
+            const int x = this->proportionOfWidth(absPos);
+            const int w = this->proportionOfWidth(absLen);
+            const int y = this->proportionOfHeight(1.f - nc->getNote().getVelocity());
+            const int h = this->proportionOfHeight(nc->getNote().getVelocity());
+            this->peaks.add({ x, y, w, h });
         }
     }
 
@@ -118,7 +115,7 @@ private:
     Colour colour;
 
     Array<Rectangle<int>> peaks;
-    Array<MidiEventComponent *> sortedSelection;
+    Array<SelectableNote *> sortedSelection;
 
     SafePointer<NotesTuningPanel> parent;
 };
@@ -418,7 +415,7 @@ float NotesTuningPanel::calcSliderValue()
 
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        NoteComponent *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+        const auto *nc = selection.getItemAs<SelectableNote>(i);
         volumeSum += nc->getVelocity();
     }
 
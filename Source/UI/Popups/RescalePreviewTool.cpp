@@ -21,7 +21,7 @@
 #include "RescalePreviewTool.h"
 #include "PianoRoll.h"
 #include "SequencerOperations.h"
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 #include "PianoSequence.h"
 #include "KeySignaturesSequence.h"
 #include "CommandIDs.h"
@@ -34,7 +34,7 @@ RescalePreviewTool *RescalePreviewTool::createWithinSelectionAndContext(SafePoin
     {
         Note::Key key;
         Scale::Ptr scale = nullptr;
-        const Clip &clip = roll->getLassoSelection().getFirstAs<NoteComponent>()->getClip();
+        const Clip &clip = roll->getLassoSelection().getFirstAs<SelectableNote>()->getClip();
         if (!SequencerOperations::findHarmonicContext(roll->getLassoSelection(), clip, keySignatures, scale, key))
         {
             DBG("Warning: harmonic context could not be detected");
@@ -20,7 +20,6 @@
 #include "Transport.h"
 #include "RollBase.h"
 #include "ColourIDs.h"
-#include "PlayerThread.h"
 
 Playhead::Playhead(RollBase &parentRoll,
     Transport &owner,
@@ -17,14 +17,14 @@
 
 #include "Common.h"
 #include "CutPointMark.h"
+#include "PianoRoll.h"
 
 static inline ComponentAnimator &rootAnimator()
 {
     return Desktop::getInstance().getAnimator();
 }
 
-CutPointMark::CutPointMark(SafePointer<Component> targetComponent, float absPosX) :
-    targetComponent(targetComponent),
+CutPointMark::CutPointMark(float absPosX) :
     absPosX(absPosX)
 {
     this->setAlpha(0.f);
@@ -53,6 +53,8 @@ void CutPointMark::updateBounds(bool forceNoAnimation)
 {
     rootAnimator().cancelAnimation(this, false);
 
+    const auto target = this->getTargetBounds();
+
     if (this->absPosX <= 0.f || this->absPosX >= 1.f)
     {
         if (this->initialized)
@@ -61,12 +63,12 @@ void CutPointMark::updateBounds(bool forceNoAnimation)
             this->initialized = false;
         }
     }
-    else if (this->targetComponent != nullptr)
+    else if (!target.isEmpty())
     {
-        const float wt = float(this->targetComponent->getWidth());
-        const int ht = this->targetComponent->getHeight();
-        const int x = this->targetComponent->getX() + int(wt * this->absPosX);
-        const int y = this->targetComponent->getY();
+        const float wt = float(target.getWidth());
+        const int ht = target.getHeight();
+        const int x = target.getX() + int(wt * this->absPosX);
+        const int y = target.getY();
         const Rectangle<int> newBounds(x - 2, y, 5, ht);
 
         if (!this->initialized || forceNoAnimation)
@@ -88,11 +90,6 @@ void CutPointMark::updatePosition(float pos)
     this->updateBounds();
 }
 
-Component *CutPointMark::getComponent() const noexcept
-{
-    return this->targetComponent.getComponent();
-}
-
 float CutPointMark::getCutPosition() const noexcept
 {
     return this->absPosX;
@@ -102,8 +99,19 @@ float CutPointMark::getCutPosition() const noexcept
 // For the piano roll
 //===----------------------------------------------------------------------===//
 
-NoteCutPointMark::NoteCutPointMark(SafePointer<Component> targetComponent, float absPosX) :
-    CutPointMark(targetComponent, absPosX) {}
+NoteCutPointMark::NoteCutPointMark(const PianoRoll &roll,
+    const Note &note, const Clip &clip, float absPosX) :
+    CutPointMark(absPosX),
+    roll(roll),
+    note(note),
+    clip(clip) {}
+
+Rectangle<int> NoteCutPointMark::getTargetBounds() const
+{
+    return this->roll.getEventBounds(this->note.getKey() + this->clip.getKey(),
+        this->note.getBeat() + this->clip.getBeat(),
+        this->note.getLength()).getSmallestIntegerContainer();
+}
 
 void NoteCutPointMark::paint(Graphics &g)
 {
@@ -132,7 +140,19 @@ void NoteCutPointMark::paint(Graphics &g)
 //===----------------------------------------------------------------------===//
 
 ClipCutPointMark::ClipCutPointMark(SafePointer<Component> targetComponent) :
-    CutPointMark(targetComponent, 0.f) {}
+    CutPointMark(0.f),
+    targetComponent(targetComponent) {}
+
+Rectangle<int> ClipCutPointMark::getTargetBounds() const
+{
+    return this->targetComponent != nullptr ?
+        this->targetComponent->getBounds() : Rectangle<int>();
+}
+
+Component *ClipCutPointMark::getComponent() const noexcept
+{
+    return this->targetComponent.getComponent();
+}
 
 void ClipCutPointMark::paint(Graphics &g)
 {
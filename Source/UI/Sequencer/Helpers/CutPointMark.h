@@ -17,25 +17,28 @@
 
 #pragma once
 
-#include "NoteComponent.h"
+class PianoRoll;
+
+#include "Note.h"
+#include "Clip.h"
 
 class CutPointMark : public Component
 {
 public:
 
-    CutPointMark(SafePointer<Component> targetComponent, float absPosX);
+    explicit CutPointMark(float absPosX);
     ~CutPointMark();
 
     void fadeIn();
     void updatePosition(float pos);
     void updateBounds(bool forceNoAnimation = false);
 
-    Component *getComponent() const noexcept;
     float getCutPosition() const noexcept;
 
 protected:
 
-    SafePointer<Component> targetComponent;
+    // the bounds of the note or the clip being cut, empty if it is gone
+    virtual Rectangle<int> getTargetBounds() const = 0;
 
     bool initialized = false;
     float absPosX = 0.f;
@@ -47,10 +50,21 @@ class NoteCutPointMark final : public CutPointMark
 {
 public:
 
-    NoteCutPointMark(SafePointer<Component> targetComponent, float absPosX);
+    // the notes don't have components, so the mark is positioned by the roll
+    NoteCutPointMark(const PianoRoll &roll, const Note &note, const Clip &clip, float absPosX);
 
     void paint(Graphics &g) override;
 
+protected:
+
+    Rectangle<int> getTargetBounds() const override;
+
+private:
+
+    const PianoRoll &roll;
+    const Note note;
+    const Clip clip;
+
 };
 
 class ClipCutPointMark final : public CutPointMark
@@ -63,4 +77,14 @@ public:
 
     void updatePositionFromMouseEvent(int mouseX, int mouseY);
 
+    Component *getComponent() const noexcept;
+
+protected:
+
+    Rectangle<int> getTargetBounds() const override;
+
+private:
+
+    SafePointer<Component> targetComponent;
+
 };
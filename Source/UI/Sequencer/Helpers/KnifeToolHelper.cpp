@@ -17,11 +17,10 @@
 
 #include "Common.h"
 #include "KnifeToolHelper.h"
-#include "NoteComponent.h"
 #include "CutPointMark.h"
-#include "RollBase.h"
+#include "PianoRoll.h"
 
-KnifeToolHelper::KnifeToolHelper(RollBase &roll) : roll(roll)
+KnifeToolHelper::KnifeToolHelper(PianoRoll &roll) : roll(roll)
 {
     this->setAlpha(0.f);
     this->setWantsKeyboardFocus(false);
@@ -98,20 +97,20 @@ void KnifeToolHelper::setEndPosition(const Point<float> &mousePos)
     this->endPosition = mousePos.toDouble() / this->getParentSize();
 }
 
-void KnifeToolHelper::addOrUpdateCutPoint(NoteComponent *nc, float beat)
+void KnifeToolHelper::addOrUpdateCutPoint(const Note &note, const Clip &clip, float beat)
 {
     jassert(this->getParentComponent() != nullptr);
 
-    if (!this->noteCutMarks.contains(nc->getNote()))
+    if (!this->noteCutMarks.contains(note))
     {
-        this->noteCutMarks[nc->getNote()] = this->createCutPointMark(nc, beat / nc->getLength());
+        this->noteCutMarks[note] = this->createCutPointMark(note, clip, beat / note.getLength());
     }
     else
     {
-        this->noteCutMarks[nc->getNote()].get()->updatePosition(beat / nc->getLength());
+        this->noteCutMarks[note].get()->updatePosition(beat / note.getLength());
     }
 
-    this->cutPoints[nc->getNote()] = beat;
+    this->cutPoints[note] = beat;
 }
 
 void KnifeToolHelper::removeCutPointIfExists(const Note &note)
@@ -127,10 +126,27 @@ void KnifeToolHelper::removeCutPointIfExists(const Note &note)
     }
 }
 
-UniquePointer<NoteCutPointMark> KnifeToolHelper::createCutPointMark(NoteComponent *nc, float pos)
+void KnifeToolHelper::removeCutPointsExcept(const Array<Note> &notesToKeep)
+{
+    Array<Note> notesToRemove;
+    for (const auto &cp : this->cutPoints)
+    {
+        if (!notesToKeep.contains(cp.first))
+        {
+            notesToRemove.add(cp.first);
+        }
+    }
+
+    for (const auto &note : notesToRemove)
+    {
+        this->removeCutPointIfExists(note);
+    }
+}
+
+UniquePointer<NoteCutPointMark> KnifeToolHelper::createCutPointMark(const Note &note, const Clip &clip, float pos)
 {
     jassert(this->getParentComponent() != nullptr);
-    auto mark = make<NoteCutPointMark>(nc, pos);
+    auto mark = make<NoteCutPointMark>(this->roll, note, clip, pos);
     this->getParentComponent()->addAndMakeVisible(mark.get());
     mark->updateBounds();
     mark->fadeIn();
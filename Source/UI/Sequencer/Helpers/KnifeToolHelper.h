@@ -17,17 +17,17 @@
 
 #pragma once
 
-class RollBase;
-class NoteComponent;
+class PianoRoll;
 class NoteCutPointMark;
 
 #include "Note.h"
+#include "Clip.h"
 
 class KnifeToolHelper final : public Component
 {
 public:
 
-    KnifeToolHelper(RollBase &roll);
+    KnifeToolHelper(PianoRoll &roll);
     ~KnifeToolHelper();
 
     Line<float> getLine() const noexcept;
@@ -36,8 +36,9 @@ public:
     void setStartPosition(const Point<float> &mousePos);
     void setEndPosition(const Point<float> &mousePos);
 
-    void addOrUpdateCutPoint(NoteComponent *nc, float beat);
+    void addOrUpdateCutPoint(const Note &note, const Clip &clip, float beat);
     void removeCutPointIfExists(const Note &note);
+    void removeCutPointsExcept(const Array<Note> &notesToKeep);
 
     void paint(Graphics &g) override;
 
@@ -47,7 +48,7 @@ public:
 
 private:
 
-    RollBase &roll;
+    PianoRoll &roll;
 
     Point<double> startPosition;
     Point<double> endPosition;
@@ -55,7 +56,7 @@ private:
     Line<float> line;
     Path path;
 
-    UniquePointer<NoteCutPointMark> createCutPointMark(NoteComponent *nc, float beat);
+    UniquePointer<NoteCutPointMark> createCutPointMark(const Note &note, const Clip &clip, float pos);
     const Point<double> getParentSize() const;
 
     FlatHashMap<Note, UniquePointer<NoteCutPointMark>, MidiEventHash> noteCutMarks;
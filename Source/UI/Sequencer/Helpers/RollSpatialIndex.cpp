@@ -0,0 +1,95 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "RollSpatialIndex.h"
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class RollSpatialIndexTests final : public UnitTest
+{
+public:
+    RollSpatialIndexTests() : UnitTest("Roll spatial index tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Range queries report each item once");
+
+        struct Item final { float beat; float length; int key; };
+        const Item items[] = {
+            { 0.f, 1.f, 60 },
+            { 3.5f, 1.f, 60 },  // spans two cells
+            { 2.f, 32.f, 72 },  // spans lots of cells
+            { -8.f, 2.f, 0 },   // negative beats are fine too
+            { 100.f, 1.f, 127 },
+        };
+
+        RollSpatialIndex<Item> index;
+        for (const auto &item : items)
+        {
+            index.insert(&item, item.beat, item.beat + item.length, item.key, item.key);
+        }
+
+        const auto query = [&index](float startBeat, float endBeat, int firstKey, int lastKey)
+        {
+            Array<const Item *> result;
+            index.forEachInRange(startBeat, endBeat, firstKey, lastKey,
+                [&result](const Item *item) { result.add(item); });
+            return result;
+        };
+
+        const auto everything = query(-FLT_MAX, FLT_MAX, 0, 127);
+        expectEquals(everything.size(), 5);
+        for (const auto &item : items)
+        {
+            expect(everything.contains(&item));
+        }
+
+        auto found = query(4.f, 8.f, 60, 72);
+        expectEquals(found.size(), 2);
+        expect(found.contains(&items[1]));
+        expect(found.contains(&items[2]));
+
+        found = query(-10.f, -7.f, 0, 5);
+        expectEquals(found.size(), 1);
+        expect(found.contains(&items[3]));
+
+        expect(query(200.f, 300.f, 0, 127).isEmpty());
+
+        beginTest("Updating and removing items");
+
+        index.update(&items[0], 100.f, 101.f, 127, 127);
+        expect(!query(0.f, 1.f, 60, 60).contains(&items[0]));
+        expectEquals(query(100.f, 101.f, 120, 127).size(), 2);
+
+        index.remove(&items[2]);
+        expect(!index.contains(&items[2]));
+        expect(query(8.f, 30.f, 0, 127).isEmpty());
+
+        index.clear();
+        expect(index.isEmpty());
+        expect(query(-FLT_MAX, FLT_MAX, 0, 127).isEmpty());
+    }
+};
+
+static RollSpatialIndexTests rollSpatialIndexTests;
+
+#endif
@@ -0,0 +1,217 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A coarse spatial index for the rolls' events:
+// the beats axis and the rows (i.e. keys in the piano roll) are split into
+// fixed-size cells, each of which keeps the items overlapping it, so that
+// the queries only visit the cells in range; the items found are just the
+// candidates, which the callers are supposed to test precisely.
+
+template <typename T>
+class RollSpatialIndex final
+{
+public:
+
+    explicit RollSpatialIndex(float beatsPerCell = 4.f, int rowsPerCell = 12) noexcept :
+        beatsPerCell(beatsPerCell),
+        rowsPerCell(rowsPerCell) {}
+
+    void clear()
+    {
+        this->cells.clear();
+        this->itemCells.clear();
+        this->extents = {};
+    }
+
+    bool isEmpty() const noexcept
+    {
+        return this->itemCells.empty();
+    }
+
+    bool contains(const T *item) const
+    {
+        return this->itemCells.find(item) != this->itemCells.end();
+    }
+
+    void insert(const T *item, float startBeat, float endBeat, int firstRow, int lastRow)
+    {
+        jassert(!this->contains(item));
+
+        const auto range = this->getCellRange(startBeat, endBeat, firstRow, lastRow);
+        this->itemCells[item] = range;
+
+        for (int x = range.firstX; x <= range.lastX; ++x)
+        {
+            for (int y = range.firstY; y <= range.lastY; ++y)
+            {
+                this->cells[RollSpatialIndex::getCellKey(x, y)].add({ item, range });
+            }
+        }
+
+        if (this->itemCells.size() == 1)
+        {
+            this->extents = range;
+        }
+        else
+        {
+            // only grows until cleared, which is fine for the queries
+            this->extents.firstX = jmin(this->extents.firstX, range.firstX);
+            this->extents.lastX = jmax(this->extents.lastX, range.lastX);
+            this->extents.firstY = jmin(this->extents.firstY, range.firstY);
+            this->extents.lastY = jmax(this->extents.lastY, range.lastY);
+        }
+    }
+
+    void remove(const T *item)
+    {
+        const auto found = this->itemCells.find(item);
+        if (found == this->itemCells.end())
+        {
+            return;
+        }
+
+        const auto range = found->second;
+        this->itemCells.erase(found);
+
+        for (int x = range.firstX; x <= range.lastX; ++x)
+        {
+            for (int y = range.firstY; y <= range.lastY; ++y)
+            {
+                auto cell = this->cells.find(RollSpatialIndex::getCellKey(x, y));
+                if (cell == this->cells.end())
+                {
+                    jassertfalse;
+                    continue;
+                }
+
+                auto &entries = cell.value();
+                for (int i = 0; i < entries.size(); ++i)
+                {
+                    if (entries.getReference(i).item == item)
+                    {
+                        entries.remove(i);
+                        break;
+                    }
+                }
+
+                if (entries.isEmpty())
+                {
+                    this->cells.erase(cell);
+                }
+            }
+        }
+    }
+
+    void update(const T *item, float startBeat, float endBeat, int firstRow, int lastRow)
+    {
+        this->remove(item);
+        this->insert(item, startBeat, endBeat, firstRow, lastRow);
+    }
+
+    // calls back for each item overlapping the cells in range, exactly once
+    template <typename Callback>
+    void forEachInRange(float startBeat, float endBeat,
+        int firstRow, int lastRow, Callback callback) const
+    {
+        if (this->isEmpty())
+        {
+            return;
+        }
+
+        auto query = this->getCellRange(startBeat, endBeat, firstRow, lastRow);
+        query.firstX = jmax(query.firstX, this->extents.firstX);
+        query.lastX = jmin(query.lastX, this->extents.lastX);
+        query.firstY = jmax(query.firstY, this->extents.firstY);
+        query.lastY = jmin(query.lastY, this->extents.lastY);
+
+        for (int x = query.firstX; x <= query.lastX; ++x)
+        {
+            for (int y = query.firstY; y <= query.lastY; ++y)
+            {
+                const auto cell = this->cells.find(RollSpatialIndex::getCellKey(x, y));
+                if (cell == this->cells.end())
+                {
+                    continue;
+                }
+
+                for (const auto &entry : cell->second)
+                {
+                    // an item overlapping several cells is only reported
+                    // from the first of them which is within the query:
+                    if (x == jmax(entry.cells.firstX, query.firstX) &&
+                        y == jmax(entry.cells.firstY, query.firstY))
+                    {
+                        callback(const_cast<T *>(entry.item));
+                    }
+                }
+            }
+        }
+    }
+
+private:
+
+    struct CellRange final
+    {
+        int firstX = 0;
+        int lastX = 0;
+        int firstY = 0;
+        int lastY = 0;
+    };
+
+    struct Entry final
+    {
+        const T *item = nullptr;
+        CellRange cells;
+    };
+
+    CellRange getCellRange(float startBeat, float endBeat, int firstRow, int lastRow) const noexcept
+    {
+        // the limits keep the cells from overflowing for the open-ended queries
+        static constexpr float maxBeat = float(1 << 24);
+        static constexpr int maxRow = 1 << 24;
+        const auto clampBeat = [](float beat) { return jlimit(-maxBeat, maxBeat, beat); };
+        const auto clampRow = [](int row) { return jlimit(-maxRow, maxRow, row); };
+
+        CellRange range;
+        range.firstX = int(floorf(clampBeat(startBeat) / this->beatsPerCell));
+        range.lastX = jmax(range.firstX, int(floorf(clampBeat(endBeat) / this->beatsPerCell)));
+        range.firstY = RollSpatialIndex::floorDivision(clampRow(firstRow), this->rowsPerCell);
+        range.lastY = jmax(range.firstY, RollSpatialIndex::floorDivision(clampRow(lastRow), this->rowsPerCell));
+        return range;
+    }
+
+    static int floorDivision(int value, int divisor) noexcept
+    {
+        return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+    }
+
+    static int64 getCellKey(int x, int y) noexcept
+    {
+        return (int64(x) << 32) | int64(uint32(y));
+    }
+
+    const float beatsPerCell;
+    const int rowsPerCell;
+
+    FlatHashMap<int64, Array<Entry>> cells;
+    FlatHashMap<const T *, CellRange> itemCells;
+    CellRange extents;
+
+    JUCE_DECLARE_NON_COPYABLE(RollSpatialIndex)
+};
@@ -25,7 +25,7 @@
 #include "AnnotationEvent.h"
 #include "KeySignatureEvent.h"
 
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 #include "ClipComponent.h"
 #include "PianoRoll.h"
 #include "PianoTrackNode.h"
@@ -261,7 +261,7 @@ bool applyAutoInsertions(const AutoChangeGroup &group, bool &didCheckpoint)
 
 PianoSequence *SequencerOperations::getPianoSequence(const SelectionProxyArray::Ptr selection)
 {
-    const auto &firstEvent = selection->getFirstAs<NoteComponent>()->getNote();
+    const auto &firstEvent = selection->getFirstAs<SelectableNote>()->getNote();
     PianoSequence *pianoSequence = static_cast<PianoSequence *>(firstEvent.getSequence());
     return pianoSequence;
 }
@@ -269,7 +269,7 @@ PianoSequence *SequencerOperations::getPianoSequence(const SelectionProxyArray::
 PianoSequence *SequencerOperations::getPianoSequence(const Lasso &selection)
 {
     // assumes all selection only contains notes of a single sequence
-    return static_cast<PianoSequence *>(selection.getFirstAs<NoteComponent>()->getNote().getSequence());
+    return static_cast<PianoSequence *>(selection.getFirstAs<SelectableNote>()->getNote().getSequence());
 }
 
 PianoSequence *SequencerOperations::getPianoSequence(const Clip &targetClip)
@@ -286,7 +286,7 @@ float SequencerOperations::findStartBeat(const Lasso &selection)
     
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *note = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+        const auto *note = static_cast<SelectableNote *>(selection.getSelectedItem(i));
         startBeat = jmin(startBeat, note->getBeat());
     }
     
@@ -302,7 +302,7 @@ float SequencerOperations::findEndBeat(const Lasso &selection)
     
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = static_cast<const NoteComponent *>(selection.getSelectedItem(i));
+        const auto *nc = static_cast<const SelectableNote *>(selection.getSelectedItem(i));
         const float beatPlusLength = nc->getBeat() + nc->getLength();
         endBeat = jmax(endBeat, beatPlusLength);
     }
@@ -387,7 +387,7 @@ void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoin
 
         for (int i = 0; i < selection.getNumSelected(); ++i)
         {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+            const auto *nc = static_cast<SelectableNote *>(selection.getSelectedItem(i));
             
             // для каждой ноты найти ноту, которая полностью перекрывает ее на максимальную длину
             
@@ -396,7 +396,7 @@ void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoin
             
             for (int j = 0; j < selection.getNumSelected(); ++j)
             {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
+                auto *nc2 = static_cast<SelectableNote *>(selection.getSelectedItem(j));
                 
                 if (nc->getKey() == nc2->getKey() &&
                     nc->getBeat() > nc2->getBeat() &&
@@ -440,16 +440,16 @@ void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoin
         
         for (int i = 0; i < selection.getNumSelected(); ++i)
         {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+            const auto *nc = static_cast<SelectableNote *>(selection.getSelectedItem(i));
             
             // для каждой ноты найти ноту, которая полностью перекрывает ее на максимальную длину
             
             float deltaBeats = -FLT_MAX;
-            const NoteComponent *overlappingNote = nullptr;
+            const SelectableNote *overlappingNote = nullptr;
             
             for (int j = 0; j < selection.getNumSelected(); ++j)
             {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
+                auto *nc2 = static_cast<SelectableNote *>(selection.getSelectedItem(j));
                 
                 if (nc->getKey() == nc2->getKey() &&
                     nc->getBeat() > nc2->getBeat() &&
@@ -493,16 +493,16 @@ void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoin
         
         for (int i = 0; i < selection.getNumSelected(); ++i)
         {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+            const auto *nc = static_cast<SelectableNote *>(selection.getSelectedItem(i));
             
             // для каждой ноты найти ноту, которая перекрывает ее максимально
             
             float overlappingBeats = -FLT_MAX;
-            const NoteComponent *overlappingNote = nullptr;
+            const SelectableNote *overlappingNote = nullptr;
             
             for (int j = 0; j < selection.getNumSelected(); ++j)
             {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
+                auto *nc2 = static_cast<SelectableNote *>(selection.getSelectedItem(j));
                 
                 if (nc->getKey() == nc2->getKey() &&
                     nc->getBeat() < nc2->getBeat() &&
@@ -539,7 +539,7 @@ void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoin
     
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+        const auto *nc = static_cast<SelectableNote *>(selection.getSelectedItem(i));
         
         for (int j = 0; j < selection.getNumSelected(); ++j)
         {
@@ -548,7 +548,7 @@ void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoin
                 continue;
             }
             
-            const auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
+            const auto *nc2 = static_cast<SelectableNote *>(selection.getSelectedItem(j));
             
             // full overlap
             //const bool isOverlappingNote = (nc->getKey() == nc2->getKey() &&
@@ -596,7 +596,7 @@ void SequencerOperations::retrograde(Lasso &selection, bool shouldCheckpoint /*=
     Array<Note> sortedSelection;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = selection.getItemAs<NoteComponent>(i);
+        const auto *nc = selection.getItemAs<SelectableNote>(i);
         sortedSelection.addSorted(nc->getNote(), nc->getNote());
     }
 
@@ -639,7 +639,7 @@ void SequencerOperations::melodicInversion(Lasso &selection, bool shouldCheckpoi
     Array<Note> sortedSelection;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = selection.getItemAs<NoteComponent>(i);
+        const auto *nc = selection.getItemAs<SelectableNote>(i);
         sortedSelection.addSorted(nc->getNote(), nc->getNote());
     }
 
@@ -689,7 +689,7 @@ bool SequencerOperations::arpeggiate(Lasso &selection,
     // 1. sort selection
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = selection.getItemAs<NoteComponent>(i);
+        const auto *nc = selection.getItemAs<SelectableNote>(i);
         sortedRemovals.addSorted(nc->getNote(), nc->getNote());
     }
 
@@ -820,7 +820,7 @@ void SequencerOperations::randomizeVolume(Lasso &selection, float factor, bool s
     
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        if (NoteComponent *nc = dynamic_cast<NoteComponent *>(selection.getSelectedItem(i)))
+        if (SelectableNote *nc = dynamic_cast<SelectableNote *>(selection.getSelectedItem(i)))
         {
             const float r = ((random.nextFloat() * 2.f) - 1.f) * factor; // (-1 .. 1) * factor
             const float v = nc->getNote().getVelocity();
@@ -852,7 +852,7 @@ void SequencerOperations::fadeOutVolume(Lasso &selection, float factor, bool sho
     
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        if (NoteComponent *nc = dynamic_cast<NoteComponent *>(selection.getSelectedItem(i)))
+        if (SelectableNote *nc = dynamic_cast<SelectableNote *>(selection.getSelectedItem(i)))
         {
             minBeat = jmin(minBeat, nc->getBeat());
             maxBeat = jmax(maxBeat, nc->getBeat());
@@ -868,7 +868,7 @@ void SequencerOperations::fadeOutVolume(Lasso &selection, float factor, bool sho
     
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        if (NoteComponent *nc = dynamic_cast<NoteComponent *>(selection.getSelectedItem(i)))
+        if (SelectableNote *nc = dynamic_cast<SelectableNote *>(selection.getSelectedItem(i)))
         {
             const float localBeat = nc->getBeat() - minBeat;
             const float localX = (localBeat / selectionBeatLength) + 0.0001f; // not 0
@@ -906,7 +906,7 @@ void SequencerOperations::tuneVolume(Lasso &selection, float delta, bool shouldC
 
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        auto *nc = selection.getItemAs<NoteComponent>(i);
+        auto *nc = selection.getItemAs<SelectableNote>(i);
         groupBefore.add(nc->getNote());
         groupAfter.add(nc->getNote().withDeltaVelocity(delta));
     }
@@ -921,7 +921,7 @@ void SequencerOperations::startTuning(Lasso &selection)
     
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        NoteComponent *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+        SelectableNote *nc = static_cast<SelectableNote *>(selection.getSelectedItem(i));
         nc->startTuning();
     }
 }
@@ -941,7 +941,7 @@ void SequencerOperations::changeVolumeLinear(Lasso &selection, float volumeDelta
 
         for (int i = 0; i < trackSelection->size(); ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(trackSelection->getUnchecked(i));
+            auto *nc = static_cast<SelectableNote *>(trackSelection->getUnchecked(i));
             groupBefore.add(nc->getNote());
             groupAfter.add(nc->continueTuningLinear(volumeDelta));
         }
@@ -967,7 +967,7 @@ void SequencerOperations::changeVolumeMultiplied(Lasso &selection, float volumeF
         
         for (int i = 0; i < trackSelection->size(); ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(trackSelection->getUnchecked(i));
+            auto *nc = static_cast<SelectableNote *>(trackSelection->getUnchecked(i));
             groupBefore.add(nc->getNote());
             groupAfter.add(nc->continueTuningMultiplied(volumeFactor));
         }
@@ -985,7 +985,7 @@ void SequencerOperations::changeVolumeSine(Lasso &selection, float volumeFactor)
     float midline = 0.f;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        NoteComponent *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+        SelectableNote *nc = static_cast<SelectableNote *>(selection.getSelectedItem(i));
         midline += nc->getVelocity();
     }
     midline = midline / float(selection.getNumSelected());
@@ -1003,7 +1003,7 @@ void SequencerOperations::changeVolumeSine(Lasso &selection, float volumeFactor)
         
         for (int i = 0; i < trackSelection->size(); ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(trackSelection->getUnchecked(i));
+            auto *nc = static_cast<SelectableNote *>(trackSelection->getUnchecked(i));
             const float phase = ((nc->getBeat() - startBeat) / (endBeat - startBeat)) * MathConstants<float>::pi * 2.f * numSines;
             groupBefore.add(nc->getNote());
             groupAfter.add(nc->continueTuningSine(volumeFactor, midline, phase));
@@ -1019,7 +1019,7 @@ void SequencerOperations::endTuning(Lasso &selection)
     
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+        auto *nc = static_cast<SelectableNote *>(selection.getSelectedItem(i));
         nc->endTuning();
     }
 }
@@ -1048,11 +1048,11 @@ void SequencerOperations::copyToClipboard(Clipboard &clipboard, const Lasso &sel
         // Just copy all events, no matter what type they are
         for (int i = 0; i < trackSelection->size(); ++i)
         {
-            if (const NoteComponent *noteComponent =
-                dynamic_cast<NoteComponent *>(trackSelection->getUnchecked(i)))
+            if (const SelectableNote *selectableNote =
+                dynamic_cast<SelectableNote *>(trackSelection->getUnchecked(i)))
             {
-                trackRoot.appendChild(noteComponent->getNote().serialize());
-                firstBeat = jmin(firstBeat, noteComponent->getBeat());
+                trackRoot.appendChild(selectableNote->getNote().serialize());
+                firstBeat = jmin(firstBeat, selectableNote->getBeat());
             }
             else if (const ClipComponent *clipComponent =
                 dynamic_cast<ClipComponent *>(trackSelection->getUnchecked(i)))
@@ -1198,7 +1198,7 @@ void SequencerOperations::deleteSelection(const Lasso &selection, bool shouldChe
     OwnedArray<PianoChangeGroup> selectionsByTrack;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const Note &note = selection.getItemAs<NoteComponent>(i)->getNote();
+        const Note &note = selection.getItemAs<SelectableNote>(i)->getNote();
         const MidiSequence *ownerSequence = note.getSequence();
         Array<Note> *arrayToAddTo = nullptr;
 
@@ -1243,7 +1243,7 @@ void SequencerOperations::shiftKeyRelative(Lasso &selection,
 {
     if (selection.getNumSelected() == 0 || deltaKey == 0) { return; }
 
-    auto *sequence = selection.getFirstAs<NoteComponent>()->getNote().getSequence();
+    auto *sequence = selection.getFirstAs<SelectableNote>()->getNote().getSequence();
     const auto operationId = deltaKey > 0 ? UndoActionIDs::KeyShiftUp : UndoActionIDs::KeyShiftDown;
     const auto transactionId = selection.generateLassoTransactionId(operationId);
     const bool repeatsLastAction = sequence->getLastUndoActionId() == transactionId;
@@ -1261,7 +1261,7 @@ void SequencerOperations::shiftKeyRelative(Lasso &selection,
         
         for (int i = 0; i < numSelected; ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(trackSelection->getUnchecked(i));
+            auto *nc = static_cast<SelectableNote *>(trackSelection->getUnchecked(i));
             groupBefore.add(nc->getNote());
             
             Note newNote(nc->getNote().withDeltaKey(deltaKey));
@@ -1293,7 +1293,7 @@ void SequencerOperations::shiftBeatRelative(Lasso &selection, float deltaBeat, b
 {
     if (selection.getNumSelected() == 0 || deltaBeat == 0) { return; }
 
-    auto *sequence = selection.getFirstAs<NoteComponent>()->getNote().getSequence();
+    auto *sequence = selection.getFirstAs<SelectableNote>()->getNote().getSequence();
     const auto operationId = deltaBeat > 0 ? UndoActionIDs::BeatShiftRight : UndoActionIDs::BeatShiftLeft;
     const auto transactionId = selection.generateLassoTransactionId(operationId);
     const bool repeatsLastAction = sequence->getLastUndoActionId() == transactionId;
@@ -1311,7 +1311,7 @@ void SequencerOperations::shiftBeatRelative(Lasso &selection, float deltaBeat, b
         
         for (int i = 0; i < numSelected; ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(trackSelection->getUnchecked(i));
+            auto *nc = static_cast<SelectableNote *>(trackSelection->getUnchecked(i));
             groupBefore.add(nc->getNote());
             
             Note newNote(nc->getNote().withDeltaBeat(deltaBeat));
@@ -1332,7 +1332,7 @@ void SequencerOperations::shiftLengthRelative(Lasso &selection, float deltaLengt
 {
     if (selection.getNumSelected() == 0 || deltaLength == 0.f) { return; }
 
-    auto *sequence = selection.getFirstAs<NoteComponent>()->getNote().getSequence();
+    auto *sequence = selection.getFirstAs<SelectableNote>()->getNote().getSequence();
     const auto operationId = deltaLength > 0 ? UndoActionIDs::LengthIncrease : UndoActionIDs::LengthDecrease;
     const auto transactionId = selection.generateLassoTransactionId(operationId);
     const bool repeatsLastAction = sequence->getLastUndoActionId() == transactionId;
@@ -1350,7 +1350,7 @@ void SequencerOperations::shiftLengthRelative(Lasso &selection, float deltaLengt
 
         for (int i = 0; i < numSelected; ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(trackSelection->getUnchecked(i));
+            auto *nc = static_cast<SelectableNote *>(trackSelection->getUnchecked(i));
             groupBefore.add(nc->getNote());
 
             Note newNote(nc->getNote().withDeltaLength(deltaLength));
@@ -1388,7 +1388,7 @@ void SequencerOperations::invertChord(Lasso &selection,
         
         for (int i = 0; i < numSelected; ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(trackSelection->getUnchecked(i));
+            auto *nc = static_cast<SelectableNote *>(trackSelection->getUnchecked(i));
             selectedNotes.addSorted(nc->getNote(), nc->getNote());
         }
         
@@ -1456,7 +1456,7 @@ void SequencerOperations::invertChord(Lasso &selection,
         {
             for (int i = 0; i < numSelected; ++i)
             {
-                auto *nc = static_cast<NoteComponent *>(trackSelection->getUnchecked(i));
+                auto *nc = static_cast<SelectableNote *>(trackSelection->getUnchecked(i));
                 transport->previewKey(pianoSequence->getTrackId(),
                     nc->getNote().getKey() + nc->getClip().getKey(),
                     nc->getVelocity() * nc->getClip().getVelocity(),
@@ -1479,7 +1479,7 @@ void SequencerOperations::applyTuplets(Lasso &selection, Note::Tuplet tuplet, bo
     PianoChangeGroup groupBefore, groupAfter;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = selection.getItemAs<NoteComponent>(i);
+        const auto *nc = selection.getItemAs<SelectableNote>(i);
         if (nc->getNote().getTuplet() != tuplet)
         {
             groupBefore.add(nc->getNote());
@@ -1531,7 +1531,7 @@ bool SequencerOperations::quantize(const Lasso &selection, float bar, bool shoul
     PianoChangeGroup groupBefore, groupAfter;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = selection.getItemAs<NoteComponent>(i);
+        const auto *nc = selection.getItemAs<SelectableNote>(i);
         float startBeat = nc->getBeat();
         float length = nc->getLength();
 
@@ -1702,7 +1702,7 @@ void SequencerOperations::rescale(Lasso &selection, Note::Key rootKey,
     PianoChangeGroup groupBefore, groupAfter;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = selection.getItemAs<NoteComponent>(i);
+        const auto *nc = selection.getItemAs<SelectableNote>(i);
         // todo clip key offset?
         doRescaleLogic(groupBefore, groupAfter, nc->getNote(), rootKey, scaleA, scaleB);
     }
@@ -2054,7 +2054,7 @@ void SequencerOperations::duplicateSelection(const Lasso &selection, bool should
     OwnedArray<PianoChangeGroup> selectionsByTrack;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const Note &note = selection.getItemAs<NoteComponent>(i)->getNote();
+        const Note &note = selection.getItemAs<SelectableNote>(i)->getNote();
         const MidiSequence *ownerSequence = note.getSequence();
         Array<Note> *arrayToAddTo = nullptr;
 
@@ -2100,12 +2100,12 @@ Clip &SequencerOperations::findClosestClip(Lasso &selection, WeakReference<MidiT
     float selectionLastBeat = -FLT_MAX;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto &note = selection.getItemAs<NoteComponent>(i)->getNote();
+        const auto &note = selection.getItemAs<SelectableNote>(i)->getNote();
         selectionFirstBeat = jmin(note.getBeat(), selectionFirstBeat);
         selectionLastBeat = jmax(note.getBeat(), selectionLastBeat);
     }
 
-    const auto &sourceClip = selection.getFirstAs<NoteComponent>()->getClip();
+    const auto &sourceClip = selection.getFirstAs<SelectableNote>()->getClip();
     const auto selectionStart = selectionFirstBeat + sourceClip.getBeat();
     const auto selectionEnd = selectionLastBeat + sourceClip.getBeat() + 1.f;
 
@@ -2138,14 +2138,14 @@ void SequencerOperations::moveSelection(Lasso &selection,
     auto *sourceSequence = getPianoSequence(selection);
 
     // here we need to calculate offsets so that the content 'stays in place':
-    const auto &sourceClip = selection.getFirstAs<NoteComponent>()->getClip();
+    const auto &sourceClip = selection.getFirstAs<SelectableNote>()->getClip();
     const auto deltaBeat = sourceClip.getBeat() - targetClip.getBeat();
     const auto deltaKey = sourceClip.getKey() - targetClip.getKey();
 
     Array<Note> toRemove, toInsert;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto &note = selection.getItemAs<NoteComponent>(i)->getNote();
+        const auto &note = selection.getItemAs<SelectableNote>(i)->getNote();
         toRemove.add(note);
         toInsert.add(note.withDeltaBeat(deltaBeat).withDeltaKey(deltaKey));
     }
@@ -2374,10 +2374,10 @@ UniquePointer<MidiTrackNode> SequencerOperations::createPianoTrack(const Lasso &
     Array<Note> events;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        events.add(selection.getItemAs<NoteComponent>(i)->getNote());
+        events.add(selection.getItemAs<SelectableNote>(i)->getNote());
     }
 
-    const auto &clip = selection.getFirstAs<NoteComponent>()->getClip();
+    const auto &clip = selection.getFirstAs<SelectableNote>()->getClip();
 
     return createPianoTrack(events, { clip });
 }
@@ -0,0 +1,233 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "TiledImageCache.h"
+
+void TiledImageCache::clear()
+{
+    this->tiles.clear();
+}
+
+void TiledImageCache::invalidate(float startX, float endX)
+{
+    const auto lastTile = TiledImageCache::getTileIndex(endX);
+    for (int i = TiledImageCache::getTileIndex(startX); i <= lastTile; ++i)
+    {
+        this->tiles.erase(i);
+    }
+}
+
+bool TiledImageCache::isEmpty() const noexcept
+{
+    return this->tiles.empty();
+}
+
+int TiledImageCache::getTileIndex(float x) noexcept
+{
+    return int(std::floor(x / float(TiledImageCache::tileWidth)));
+}
+
+void TiledImageCache::updateSize(int newWidth, int newHeight, float newScale)
+{
+    if (this->width != newWidth ||
+        this->height != newHeight ||
+        this->scale != newScale)
+    {
+        this->width = newWidth;
+        this->height = newHeight;
+        this->scale = newScale;
+        this->tiles.clear();
+    }
+}
+
+Range<int> TiledImageCache::getVisibleTiles(const Graphics &g) const
+{
+    const auto visibleArea = g.getClipBounds()
+        .getIntersection({ 0, 0, this->width, this->height });
+
+    if (visibleArea.isEmpty())
+    {
+        return {};
+    }
+
+    return { TiledImageCache::getTileIndex(float(visibleArea.getX())),
+        TiledImageCache::getTileIndex(float(visibleArea.getRight() - 1)) + 1 };
+}
+
+bool TiledImageCache::preparePendingTiles(Rasterizer &rasterizer) const
+{
+    bool hasPendingTiles = false;
+    rasterizer.tileHeight = this->height;
+
+    for (int i = rasterizer.tilesRange.getStart(); i < rasterizer.tilesRange.getEnd(); ++i)
+    {
+        if (this->tiles.find(i) == this->tiles.end())
+        {
+            rasterizer.pendingTiles.add(new Rasterizer::PendingTile());
+            hasPendingTiles = true;
+        }
+        else
+        {
+            rasterizer.pendingTiles.add(nullptr);
+        }
+    }
+
+    return hasPendingTiles;
+}
+
+void TiledImageCache::storePendingTiles(Rasterizer &rasterizer)
+{
+    for (int i = 0; i < rasterizer.pendingTiles.size(); ++i)
+    {
+        if (auto *tile = rasterizer.pendingTiles.getUnchecked(i))
+        {
+            // finish drawing before the image is used
+            tile->graphics = nullptr;
+            this->tiles[rasterizer.tilesRange.getStart() + i] = tile->image;
+        }
+    }
+}
+
+void TiledImageCache::drawTiles(Graphics &g, Range<int> visibleTiles) const
+{
+    for (int i = visibleTiles.getStart(); i < visibleTiles.getEnd(); ++i)
+    {
+        const auto found = this->tiles.find(i);
+        if (found == this->tiles.end() || !found->second.isValid())
+        {
+            continue;
+        }
+
+        const auto &image = found->second;
+        g.drawImage(image,
+            i * TiledImageCache::tileWidth, 0, TiledImageCache::tileWidth, this->height,
+            0, 0, image.getWidth(), image.getHeight(), true);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Rasterizer
+//===----------------------------------------------------------------------===//
+
+TiledImageCache::Rasterizer::Rasterizer(Range<int> tilesRange, float scale) :
+    tilesRange(tilesRange),
+    scale(scale) {}
+
+void TiledImageCache::Rasterizer::fillRect(float x, float y, float w, float h)
+{
+    const auto firstTile = jmax(this->tilesRange.getStart(),
+        TiledImageCache::getTileIndex(x));
+
+    const auto lastTile = jmin(this->tilesRange.getEnd() - 1,
+        TiledImageCache::getTileIndex(x + w));
+
+    for (int i = firstTile; i <= lastTile; ++i)
+    {
+        if (auto *tile = this->pendingTiles.getUnchecked(i - this->tilesRange.getStart()))
+        {
+            this->getGraphicsFor(*tile, i).fillRect(x, y, w, h);
+        }
+    }
+}
+
+Graphics &TiledImageCache::Rasterizer::getGraphicsFor(PendingTile &tile, int tileIndex)
+{
+    if (tile.graphics == nullptr)
+    {
+        // the images are only allocated for the tiles which have something in them
+        tile.image = Image(Image::SingleChannel,
+            roundToInt(float(TiledImageCache::tileWidth) * this->scale),
+            roundToInt(float(this->tileHeight) * this->scale), true);
+
+        tile.graphics = make<Graphics>(tile.image);
+        tile.graphics->addTransform(AffineTransform::translation(float(-tileIndex *
+            TiledImageCache::tileWidth), 0.f).scaled(this->scale));
+    }
+
+    return *tile.graphics;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class TiledImageCacheTests final : public UnitTest
+{
+public:
+    TiledImageCacheTests() : UnitTest("Tiled image cache tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Only missing visible tiles are rasterized");
+
+        constexpr auto width = TiledImageCache::tileWidth * 4;
+        constexpr auto height = 16;
+
+        TiledImageCache cache;
+        Image canvas(Image::ARGB, width, height, true);
+
+        int numRasterizations = 0;
+        const auto drawAll = [&]()
+        {
+            Graphics g(canvas);
+            g.setColour(Colours::white);
+            cache.draw(g, width, height, [&](TiledImageCache::Rasterizer &r)
+            {
+                numRasterizations++;
+                r.fillRect(10.f, 2.f, 4.f, 1.f); // the first tile
+                r.fillRect(float(TiledImageCache::tileWidth) - 2.f, 5.f, 4.f, 1.f); // the 1st and the 2nd
+            });
+        };
+
+        drawAll();
+        expectEquals(numRasterizations, 1);
+        expect(!cache.isEmpty());
+        expectEquals(int(canvas.getPixelAt(11, 2).getAlpha()), 255);
+        expectEquals(int(canvas.getPixelAt(TiledImageCache::tileWidth + 1, 5).getAlpha()), 255);
+        expectEquals(int(canvas.getPixelAt(11, 3).getAlpha()), 0);
+
+        // everything is up to date
+        drawAll();
+        expectEquals(numRasterizations, 1);
+
+        // empty tiles are cached as well, until invalidated
+        cache.invalidate(float(TiledImageCache::tileWidth * 2), float(TiledImageCache::tileWidth * 3));
+        drawAll();
+        expectEquals(numRasterizations, 2);
+
+        cache.invalidate(0.f, 1.f);
+        drawAll();
+        expectEquals(numRasterizations, 3);
+        expectEquals(int(canvas.getPixelAt(11, 2).getAlpha()), 255);
+
+        beginTest("Resizing drops all tiles");
+
+        {
+            Graphics g(canvas);
+            cache.draw(g, width, height + 1, [&](TiledImageCache::Rasterizer &) { numRasterizations++; });
+        }
+
+        expectEquals(numRasterizations, 4);
+    }
+};
+
+static TiledImageCacheTests tiledImageCacheTests;
+
+#endif
@@ -0,0 +1,117 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A cache for the overview maps, which draw lots of tiny note rectangles:
+// the component is split horizontally into fixed-width tiles, each of which
+// is rasterized once into a single-channel image, when it becomes visible,
+// and is then just blitted with the current colour on each repaint;
+// the owner invalidates the tiles affected by the edits, or all of them,
+// when the positions of everything change.
+
+class TiledImageCache final
+{
+public:
+
+    TiledImageCache() = default;
+
+    static constexpr auto tileWidth = 256;
+
+    void clear();
+
+    // The range is in component's pixels
+    void invalidate(float startX, float endX);
+
+    bool isEmpty() const noexcept;
+
+    // Passed to the rasterize callback to fill the rectangles
+    // (in component's coordinates) into all the pending tiles they overlap
+    class Rasterizer final
+    {
+    public:
+
+        void fillRect(float x, float y, float w, float h);
+
+    private:
+
+        Rasterizer(Range<int> tilesRange, float scale);
+
+        struct PendingTile final
+        {
+            Image image;
+            UniquePointer<Graphics> graphics;
+        };
+
+        Graphics &getGraphicsFor(PendingTile &tile, int tileIndex);
+
+        const Range<int> tilesRange;
+        const float scale;
+        int tileHeight = 0;
+
+        // indexed relative to the first visible tile,
+        // and nullptr for the tiles which are up to date:
+        OwnedArray<PendingTile> pendingTiles;
+
+        friend class TiledImageCache;
+        JUCE_DECLARE_NON_COPYABLE(Rasterizer)
+    };
+
+    // Rasterizes the missing visible tiles, if any, by calling
+    // rasterize(Rasterizer &) once for all of them, then draws
+    // all visible tiles with the graphics' current colour or brush
+    template <typename RasterizeCallback>
+    void draw(Graphics &g, int width, int height, RasterizeCallback &&rasterize)
+    {
+        this->updateSize(width, height,
+            g.getInternalContext().getPhysicalPixelScaleFactor());
+
+        const auto visibleTiles = this->getVisibleTiles(g);
+        if (visibleTiles.isEmpty())
+        {
+            return;
+        }
+
+        Rasterizer rasterizer(visibleTiles, this->scale);
+        if (this->preparePendingTiles(rasterizer))
+        {
+            rasterize(rasterizer);
+            this->storePendingTiles(rasterizer);
+        }
+
+        this->drawTiles(g, visibleTiles);
+    }
+
+private:
+
+    void updateSize(int newWidth, int newHeight, float newScale);
+    Range<int> getVisibleTiles(const Graphics &g) const;
+    bool preparePendingTiles(Rasterizer &rasterizer) const;
+    void storePendingTiles(Rasterizer &rasterizer);
+    void drawTiles(Graphics &g, Range<int> visibleTiles) const;
+
+    static int getTileIndex(float x) noexcept;
+
+    // a null image means there's nothing in that tile
+    FlatHashMap<int, Image> tiles;
+
+    int width = 0;
+    int height = 0;
+    float scale = 1.f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TiledImageCache)
+};
@@ -39,13 +39,13 @@ Lasso::Lasso(const SelectedItemSet &other) :
     this->invalidateCacheAndResetId();
 }
 
-void Lasso::itemSelected(SelectableComponent *item)
+void Lasso::itemSelected(SelectableItem *item)
 {
     this->invalidateCacheAndResetId();
     item->setSelected(true);
 }
 
-void Lasso::itemDeselected(SelectableComponent *item)
+void Lasso::itemDeselected(SelectableItem *item)
 {
     this->invalidateCacheAndResetId();
     item->setSelected(false);
@@ -57,7 +57,7 @@ void Lasso::needsToCalculateSelectionBounds() noexcept
 
     for (int i = 0; i < this->getNumSelected(); ++i)
     {
-        this->bounds = this->bounds.getUnion(this->getSelectedItem(i)->getBounds());
+        this->bounds = this->bounds.getUnion(this->getSelectedItem(i)->getSelectionBounds());
     }
 }
 
@@ -96,7 +96,7 @@ void Lasso::rebuildCache() const
 {
     for (int i = 0; i < this->getNumSelected(); ++i)
     {
-        SelectableComponent *item = this->getSelectedItem(i);
+        SelectableItem *item = this->getSelectedItem(i);
         const String &groupId(item->getSelectionGroupId());
 
         SelectionProxyArray::Ptr targetArray;
@@ -17,12 +17,12 @@
 
 #pragma once
 
-#include "SelectableComponent.h"
+#include "SelectableItem.h"
 #include "MidiSequence.h"
 #include "UndoActionIDs.h"
 
 class SelectionProxyArray final :
-    public Array<SelectableComponent *>,
+    public Array<SelectableItem *>,
     public ReferenceCountedObject
 {
 public:
@@ -46,7 +46,7 @@ public:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SelectionProxyArray)
 };
 
-class Lasso final : public SelectedItemSet<SelectableComponent *>
+class Lasso final : public SelectedItemSet<SelectableItem *>
 {
 public:
 
@@ -54,8 +54,8 @@ public:
     explicit Lasso(const ItemArray &items);
     explicit Lasso(const SelectedItemSet &other);
 
-    void itemSelected(SelectableComponent *item) override;
-    void itemDeselected(SelectableComponent *item) override;
+    void itemSelected(SelectableItem *item) override;
+    void itemDeselected(SelectableItem *item) override;
 
     int64 getId() const noexcept;
     bool shouldDisplayGhostNotes() const noexcept;
@@ -72,25 +72,26 @@ void MidiEventComponent::mouseDown(const MouseEvent &e)
 
     // shift-alt-logic
     auto &selection = this->roll.getLassoSelection();
+    auto *item = this->getSelectableItem();
     if (e.mods.isAltDown())
     {
-        this->roll.deselectEvent(this);
+        this->roll.deselectEvent(item);
     }
-    else if (!selection.isSelected(this))
+    else if (!selection.isSelected(item))
     {
         if (e.mods.isShiftDown())
         {
-            this->roll.selectEvent(this, false);
+            this->roll.selectEvent(item, false);
         }
         else
         {
-            this->roll.selectEvent(this, true);
+            this->roll.selectEvent(item, true);
         }
     }
 }
 
 //===----------------------------------------------------------------------===//
-// SelectableComponent
+// SelectableItem
 //===----------------------------------------------------------------------===//
 
 void MidiEventComponent::setSelected(bool selected)
@@ -109,6 +110,11 @@ bool MidiEventComponent::isSelected() const noexcept
     return this->flags.isSelected;
 }
 
+Rectangle<int> MidiEventComponent::getSelectionBounds() const noexcept
+{
+    return this->getBounds();
+}
+
 //===----------------------------------------------------------------------===//
 // Helpers
 //===----------------------------------------------------------------------===//
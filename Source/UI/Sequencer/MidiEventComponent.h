@@ -22,11 +22,11 @@ class RollBase;
 
 #include "MidiEvent.h"
 #include "FloatBoundsComponent.h"
-#include "SelectableComponent.h"
+#include "SelectableItem.h"
 
 class MidiEventComponent :
     public FloatBoundsComponent, 
-    public SelectableComponent
+    public SelectableItem
 {
 public:
 
@@ -48,14 +48,19 @@ public:
     static int compareElements(MidiEventComponent *c1, MidiEventComponent *c2) noexcept;
 
     //===------------------------------------------------------------------===//
-    // SelectableComponent
+    // SelectableItem
     //===------------------------------------------------------------------===//
 
     void setSelected(bool selected) override;
     bool isSelected() const noexcept override;
+    Rectangle<int> getSelectionBounds() const noexcept override;
 
 protected:
 
+    // what gets selected when this component is clicked:
+    // the note components select their notes, see SelectableNote
+    virtual SelectableItem *getSelectableItem() noexcept { return this; }
+
     RollBase &roll;
     ComponentDragger dragger;
 
@@ -19,7 +19,7 @@
 #include "AnnotationsProjectMap.h"
 #include "ProjectNode.h"
 #include "ProjectTimeline.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "RollBase.h"
 #include "AnnotationDialog.h"
 #include "AnnotationLargeComponent.h"
@@ -21,7 +21,7 @@
 #include "MidiSequence.h"
 #include "ProjectTimeline.h"
 #include "ProjectMetadata.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "RollBase.h"
 #include "KeySignatureDialog.h"
 #include "KeySignatureLargeComponent.h"
@@ -17,7 +17,7 @@
 
 #include "Common.h"
 #include "VelocityProjectMap.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "ProjectNode.h"
 #include "MidiTrack.h"
 #include "Pattern.h"
@@ -26,7 +26,7 @@
 #include "RollBase.h"
 #include "Lasso.h"
 #include "ColourIDs.h"
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 #include "FineTuningValueIndicator.h"
 
 #define VELOCITY_MAP_BULK_REPAINT_START \
@@ -602,6 +602,22 @@ void VelocityProjectMap::onAddTrack(MidiTrack *const track)
     VELOCITY_MAP_BULK_REPAINT_END
 }
 
+void VelocityProjectMap::onLoadTrackContent(MidiTrack *const track)
+{
+    if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
+
+    const auto *pattern = track->getPattern();
+    if (pattern == nullptr || pattern->size() == 0 ||
+        this->patternMap.contains(*pattern->getUnchecked(0)))
+    {
+        return; // already loaded in reloadTrackMap
+    }
+
+    VELOCITY_MAP_BULK_REPAINT_START
+    this->loadTrack(track);
+    VELOCITY_MAP_BULK_REPAINT_END
+}
+
 void VelocityProjectMap::onRemoveTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
@@ -696,7 +712,7 @@ void VelocityProjectMap::changeListenerCallback(ChangeBroadcaster *source)
         for (const auto *e : *selection)
         {
             // assuming we've subscribed only on a piano roll's lasso changes
-            const auto *nc = static_cast<const NoteComponent *>(e);
+            const auto *nc = static_cast<const SelectableNote *>(e);
             activeMap->at(nc->getNote())->setEditable(true);
         }
     }
@@ -845,7 +861,9 @@ void VelocityProjectMap::reloadTrackMap()
     const auto &tracks = this->project.getTracks();
     for (const auto *track : tracks)
     {
-        if (dynamic_cast<const PianoSequence *>(track->getSequence()))
+        // the tracks still being loaded will come in onLoadTrackContent
+        if (dynamic_cast<const PianoSequence *>(track->getSequence()) &&
+            track->getSequence()->isLoaded())
         {
             this->loadTrack(track);
         }
@@ -22,7 +22,7 @@
 #include "Pattern.h"
 #include "PianoSequence.h"
 #include "ProjectMetadata.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "RollBase.h"
 #include "AnnotationEvent.h"
 #include "ColourIDs.h"
@@ -60,38 +60,37 @@ void PianoProjectMap::resized()
     this->componentHeight =
         static_cast<float>(this->getHeight()) /
         static_cast<float>(this->keyboardSize);
+
+    // all notes' positions depend on the size and the beat ranges:
+    this->resetAllTiles();
 }
 
 void PianoProjectMap::paint(Graphics &g)
 {
-    const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
-    const float projectLengthInBeats = this->projectLastBeat - this->projectFirstBeat;
-    const float mapWidth = float(this->getWidth()) * (projectLengthInBeats / rollLengthInBeats);
-
+    // the minimap is repainted all the time during playback and scrolling,
+    // so the notes are only rasterized when the tiles are invalidated,
+    // and each repaint just blits the tiles with the clip's colour
     for (const auto &c : this->patternMap)
     {
-        const auto sequenceMap = c.second.get();
-        const bool isActiveClip = this->activeClip == c.first;
+        const auto &clip = c.first;
+        const bool isActiveClip = this->activeClip == clip;
 
-        g.setColour(c.first.getTrackColour()
+        g.setColour(clip.getTrackColour()
             .interpolatedWith(this->baseColour, .4f)
             .withAlpha(isActiveClip ? this->brightnessFactor * .9f : this->brightnessFactor * .65f)
             .withMultipliedBrightness(this->brightnessFactor));
 
-        for (const auto &n : *sequenceMap)
-        {
-            const auto key = jlimit(0, this->keyboardSize, n.getKey() + c.first.getKey());
-            const auto beat = n.getBeat() + c.first.getBeat() - this->rollFirstBeat;
-            const auto length = n.getLength();
-
-            const float x = (mapWidth * (beat / projectLengthInBeats));
-            const float w = (mapWidth * (length / projectLengthInBeats));
-
-            // with rounding, it just looks better:
-            const int y = this->getHeight() - static_cast<int>(key * this->componentHeight);
-
-            g.fillRect(x, static_cast<float>(y), jmax(0.25f, w), 1.0f);
-        }
+        auto &clipMap = *c.second.get();
+        clipMap.tiles.draw(g, this->getWidth(), this->getHeight(),
+            [this, &clip, &clipMap](TiledImageCache::Rasterizer &rasterizer)
+            {
+                for (const auto &note : clipMap.notes)
+                {
+                    const auto bounds = this->getNoteBounds(clip, note);
+                    rasterizer.fillRect(bounds.getX(), bounds.getY(),
+                        bounds.getWidth(), bounds.getHeight());
+                }
+            });
     }
 }
 
@@ -113,11 +112,13 @@ void PianoProjectMap::onChangeMidiEvent(const MidiEvent &e1, const MidiEvent &e2
 
         forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
         {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
+            auto &clipMap = *c.second.get();
+            if (clipMap.notes.contains(note))
             {
-                sequenceMap.erase(note);
-                sequenceMap.insert(newNote);
+                clipMap.notes.erase(note);
+                clipMap.notes.insert(newNote);
+                clipMap.invalidate(this->getNoteBounds(c.first, note));
+                clipMap.invalidate(this->getNoteBounds(c.first, newNote));
             }
         }
 
@@ -134,8 +135,9 @@ void PianoProjectMap::onAddMidiEvent(const MidiEvent &event)
 
         forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
         {
-            auto &sequenceMap = *c.second.get();
-            sequenceMap.insert(note);
+            auto &clipMap = *c.second.get();
+            clipMap.notes.insert(note);
+            clipMap.invalidate(this->getNoteBounds(c.first, note));
         }
 
         this->triggerAsyncUpdate();
@@ -151,10 +153,11 @@ void PianoProjectMap::onRemoveMidiEvent(const MidiEvent &event)
 
         forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
         {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
+            auto &clipMap = *c.second.get();
+            if (clipMap.notes.contains(note))
             {
-                sequenceMap.erase(note);
+                clipMap.notes.erase(note);
+                clipMap.invalidate(this->getNoteBounds(c.first, note));
             }
         }
 
@@ -164,7 +167,7 @@ void PianoProjectMap::onRemoveMidiEvent(const MidiEvent &event)
 
 void PianoProjectMap::onAddClip(const Clip &clip)
 {
-    const SequenceSet *referenceMap = nullptr;
+    const ClipMap *referenceMap = nullptr;
     const auto *track = clip.getPattern()->getTrack();
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
 
@@ -181,12 +184,12 @@ void PianoProjectMap::onAddClip(const Clip &clip)
         return;
     }
 
-    auto *sequenceMap = new SequenceSet();
-    this->patternMap[clip] = UniquePointer<SequenceSet>(sequenceMap);
+    auto *clipMap = new ClipMap();
+    this->patternMap[clip] = UniquePointer<ClipMap>(clipMap);
         
-    for (const auto &note : *referenceMap)
+    for (const auto &note : referenceMap->notes)
     {
-        sequenceMap->insert(note);
+        clipMap->notes.insert(note);
     }
 
     this->triggerAsyncUpdate();
@@ -197,9 +200,11 @@ void PianoProjectMap::onChangeClip(const Clip &clip, const Clip &newClip)
     if (this->patternMap.contains(clip))
     {
         // Set new key for existing sequence map
-        auto *sequenceMap = this->patternMap[clip].release();
+        auto *clipMap = this->patternMap[clip].release();
         this->patternMap.erase(clip);
-        this->patternMap[newClip] = UniquePointer<SequenceSet>(sequenceMap);
+        this->patternMap[newClip] = UniquePointer<ClipMap>(clipMap);
+        // the clip might have been moved or transposed
+        clipMap->tiles.clear();
         this->triggerAsyncUpdate();
     }
 }
@@ -243,6 +248,13 @@ void PianoProjectMap::onAddTrack(MidiTrack *const track)
     this->triggerAsyncUpdate();
 }
 
+void PianoProjectMap::onLoadTrackContent(MidiTrack *const track)
+{
+    if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
+    this->loadTrack(track); // replaces the clips' maps, if any
+    this->triggerAsyncUpdate();
+}
+
 void PianoProjectMap::onRemoveTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
@@ -304,7 +316,9 @@ void PianoProjectMap::reloadTrackMap()
     const auto &tracks = this->project.getTracks();
     for (const auto *track : tracks)
     {
-        if (dynamic_cast<const PianoSequence *>(track->getSequence()))
+        // the tracks still being loaded will come in onLoadTrackContent
+        if (dynamic_cast<const PianoSequence *>(track->getSequence()) &&
+            track->getSequence()->isLoaded())
         {
             this->loadTrack(track);
         }
@@ -324,8 +338,8 @@ void PianoProjectMap::loadTrack(const MidiTrack *const track)
     {
         const Clip *clip = track->getPattern()->getUnchecked(i);
 
-        auto *sequenceMap = new SequenceSet();
-        this->patternMap[*clip] = UniquePointer<SequenceSet>(sequenceMap);
+        auto *clipMap = new ClipMap();
+        this->patternMap[*clip] = UniquePointer<ClipMap>(clipMap);
 
         for (int j = 0; j < track->getSequence()->size(); ++j)
         {
@@ -333,12 +347,39 @@ void PianoProjectMap::loadTrack(const MidiTrack *const track)
             if (event->isTypeOf(MidiEvent::Type::Note))
             {
                 const Note *note = static_cast<const Note *>(event);
-                sequenceMap->insert(*note);
+                clipMap->notes.insert(*note);
             }
         }
     }
 }
 
+Rectangle<float> PianoProjectMap::getNoteBounds(const Clip &clip, const Note &note) const noexcept
+{
+    const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
+    const float projectLengthInBeats = this->projectLastBeat - this->projectFirstBeat;
+    const float mapWidth = float(this->getWidth()) * (projectLengthInBeats / rollLengthInBeats);
+
+    const auto key = jlimit(0, this->keyboardSize, note.getKey() + clip.getKey());
+    const auto beat = note.getBeat() + clip.getBeat() - this->rollFirstBeat;
+    const auto length = note.getLength();
+
+    const float x = (mapWidth * (beat / projectLengthInBeats));
+    const float w = (mapWidth * (length / projectLengthInBeats));
+
+    // with rounding, it just looks better:
+    const int y = this->getHeight() - static_cast<int>(key * this->componentHeight);
+
+    return { x, static_cast<float>(y), jmax(0.25f, w), 1.0f };
+}
+
+void PianoProjectMap::resetAllTiles()
+{
+    for (auto &c : this->patternMap)
+    {
+        c.second->tiles.clear();
+    }
+}
+
 void PianoProjectMap::handleAsyncUpdate()
 {
     this->repaint();
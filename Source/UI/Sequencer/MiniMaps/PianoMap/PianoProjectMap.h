@@ -20,6 +20,7 @@
 #include "Clip.h"
 #include "Note.h"
 #include "ProjectListener.h"
+#include "TiledImageCache.h"
 
 class RollBase;
 class ProjectNode;
@@ -59,6 +60,7 @@ public:
     void onAddTrack(MidiTrack *const track) override;
     void onRemoveTrack(MidiTrack *const track) override;
     void onChangeTrackProperties(MidiTrack *const track) override;
+    void onLoadTrackContent(MidiTrack *const track) override;
 
     void onChangeProjectBeatRange(float firstBeat, float lastBeat) override;
     void onChangeViewBeatRange(float firstBeat, float lastBeat) override;
@@ -73,6 +75,9 @@ private:
     void reloadTrackMap();
     void loadTrack(const MidiTrack *const track);
 
+    Rectangle<float> getNoteBounds(const Clip &clip, const Note &note) const noexcept;
+    void resetAllTiles();
+
     float projectFirstBeat = 0.f;
     float projectLastBeat = Globals::Defaults::projectLength;
 
@@ -92,7 +97,21 @@ private:
     Colour baseColour;
 
     using SequenceSet = FlatHashSet<Note, MidiEventHash>;
-    using PatternMap = FlatHashMap<Clip, UniquePointer<SequenceSet>, ClipHash>;
+
+    // the notes are rasterized into the tiles per clip,
+    // so that an edit only re-renders the tiles it touches
+    struct ClipMap final
+    {
+        SequenceSet notes;
+        TiledImageCache tiles;
+
+        void invalidate(const Rectangle<float> &noteBounds)
+        {
+            this->tiles.invalidate(noteBounds.getX(), noteBounds.getRight());
+        }
+    };
+
+    using PatternMap = FlatHashMap<Clip, UniquePointer<ClipMap>, ClipHash>;
     PatternMap patternMap;
 
     void handleAsyncUpdate() override;
@@ -20,7 +20,7 @@
 #include "ProjectNode.h"
 #include "MidiSequence.h"
 #include "ProjectTimeline.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "RollBase.h"
 #include "TrackStartIndicator.h"
 #include "TrackEndIndicator.h"
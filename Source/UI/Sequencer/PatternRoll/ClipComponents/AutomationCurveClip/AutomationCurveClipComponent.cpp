@@ -23,7 +23,7 @@
 #include "ProjectNode.h"
 #include "MidiSequence.h"
 #include "AutomationSequence.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "RollBase.h"
 #include "MidiTrack.h"
 
@@ -347,6 +347,14 @@ void AutomationCurveClipComponent::onAddTrack(MidiTrack *const track)
     }
 }
 
+void AutomationCurveClipComponent::onLoadTrackContent(MidiTrack *const track)
+{
+    if (this->sequence != nullptr && track->getSequence() == this->sequence)
+    {
+        this->reloadTrack();
+    }
+}
+
 void AutomationCurveClipComponent::onRemoveTrack(MidiTrack *const track)
 {
     if (this->sequence != nullptr && track->getSequence() == this->sequence)
@@ -375,6 +383,12 @@ void AutomationCurveClipComponent::reloadTrack()
     
     this->eventComponents.clear();
     this->eventsHash.clear();
+
+    // the events will come in onLoadTrackContent
+    if (!this->sequence->isLoaded())
+    {
+        return;
+    }
     
     this->setVisible(false);
     
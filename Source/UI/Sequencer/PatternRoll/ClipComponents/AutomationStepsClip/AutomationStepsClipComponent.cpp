@@ -20,7 +20,7 @@
 #include "ProjectNode.h"
 #include "MidiSequence.h"
 #include "AutomationSequence.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "RollBase.h"
 #include "AutomationStepEventComponent.h"
 #include "AutomationStepEventsConnector.h"
@@ -339,6 +339,14 @@ void AutomationStepsClipComponent::onAddTrack(MidiTrack *const track)
     }
 }
 
+void AutomationStepsClipComponent::onLoadTrackContent(MidiTrack *const track)
+{
+    if (this->sequence != nullptr && track->getSequence() == this->sequence)
+    {
+        this->reloadTrack();
+    }
+}
+
 void AutomationStepsClipComponent::onRemoveTrack(MidiTrack *const track)
 {
     if (this->sequence != nullptr && track->getSequence() == this->sequence)
@@ -366,6 +374,12 @@ void AutomationStepsClipComponent::reloadTrack()
     
     this->eventComponents.clear();
     this->eventsHash.clear();
+
+    // the events will come in onLoadTrackContent
+    if (!this->sequence->isLoaded())
+    {
+        return;
+    }
     
     this->setVisible(false);
     
@@ -338,7 +338,7 @@ void ClipComponent::paint(Graphics &g)
 }
 
 //===----------------------------------------------------------------------===//
-// SelectableComponent
+// SelectableItem
 //===----------------------------------------------------------------------===//
 
 void ClipComponent::setSelected(bool selected)
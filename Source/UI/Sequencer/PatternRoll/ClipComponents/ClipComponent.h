@@ -67,7 +67,7 @@ public:
     void paint(Graphics& g) override;
 
     //===------------------------------------------------------------------===//
-    // SelectableComponent
+    // SelectableItem
     //===------------------------------------------------------------------===//
 
     void setSelected(bool selected) override;
@@ -21,7 +21,7 @@
 #include "ProjectMetadata.h"
 #include "MidiSequence.h"
 #include "PianoSequence.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "RollBase.h"
 #include "AnnotationEvent.h"
 #include "MidiTrack.h"
@@ -52,18 +52,30 @@ void PianoClipComponent::paint(Graphics &g)
     // Draw the frame, set the colour, etc:
     ClipComponent::paint(g);
 
-    for (const auto &note : this->displayedNotes)
+    if (this->sequence == nullptr)
     {
-        const auto *ns = note.getSequence();
-        const float sequenceLength = ns->getLengthInBeats();
-        const float beat = note.getBeat() - ns->getFirstBeat();
-        const auto key = jlimit(0, this->keyboardSize, note.getKey() + this->clip.getKey());
-        const float x = static_cast<float>(this->getWidth()) * (beat / sequenceLength);
-        const float w = static_cast<float>(this->getWidth()) * (note.getLength() / sequenceLength);
-        const float h = static_cast<float>(this->getHeight());
-        const int y = static_cast<int>(h - key * h / static_cast<float>(this->keyboardSize));
-        g.fillRect(x, static_cast<float>(y), jmax(0.25f, w), 1.f);
+        return;
     }
+
+    const Range<float> sequenceRange(this->sequence->getFirstBeat(), this->sequence->getLastBeat());
+    if (this->tilesSequenceRange != sequenceRange ||
+        this->tilesKeyboardSize != this->keyboardSize)
+    {
+        this->tilesSequenceRange = sequenceRange;
+        this->tilesKeyboardSize = this->keyboardSize;
+        this->tiles.clear();
+    }
+
+    this->tiles.draw(g, this->getWidth(), this->getHeight(),
+        [this](TiledImageCache::Rasterizer &rasterizer)
+        {
+            for (const auto &note : this->displayedNotes)
+            {
+                const auto bounds = this->getNoteBounds(note);
+                rasterizer.fillRect(bounds.getX(), bounds.getY(),
+                    bounds.getWidth(), bounds.getHeight());
+            }
+        });
 }
 
 //===----------------------------------------------------------------------===//
@@ -82,6 +94,8 @@ void PianoClipComponent::onChangeMidiEvent(const MidiEvent &oldEvent, const Midi
         {
             this->displayedNotes.erase(note);
             this->displayedNotes.insert(newNote);
+            this->invalidateTilesFor(note);
+            this->invalidateTilesFor(newNote);
         }
 
         this->roll.triggerBatchRepaintFor(this);
@@ -96,6 +110,7 @@ void PianoClipComponent::onAddMidiEvent(const MidiEvent &event)
         if (note.getSequence() != this->sequence) { return; }
 
         this->displayedNotes.insert(note);
+        this->invalidateTilesFor(note);
         this->roll.triggerBatchRepaintFor(this);
     }
 }
@@ -110,6 +125,7 @@ void PianoClipComponent::onRemoveMidiEvent(const MidiEvent &event)
         if (this->displayedNotes.contains(note))
         {
             this->displayedNotes.erase(note);
+            this->invalidateTilesFor(note);
         }
 
         this->roll.triggerBatchRepaintFor(this);
@@ -120,6 +136,7 @@ void PianoClipComponent::onChangeClip(const Clip &oldClip, const Clip &newClip)
 {
     if (this->clip == oldClip)
     {
+        this->tiles.clear(); // the key might have changed
         this->updateColours(); // transparency depends on clip velocity
         this->roll.triggerBatchRepaintFor(this);
     }
@@ -159,6 +176,15 @@ void PianoClipComponent::onAddTrack(MidiTrack *const track)
     }
 }
 
+void PianoClipComponent::onLoadTrackContent(MidiTrack *const track)
+{
+    if (track->getSequence() == this->sequence)
+    {
+        this->reloadTrackMap();
+        this->roll.triggerBatchRepaintFor(this);
+    }
+}
+
 void PianoClipComponent::onRemoveTrack(MidiTrack *const track)
 {
     if (track->getSequence() != this->sequence) { return; }
@@ -171,6 +197,8 @@ void PianoClipComponent::onRemoveTrack(MidiTrack *const track)
             this->displayedNotes.erase(note);
         }
     }
+
+    this->tiles.clear();
 }
 
 //===----------------------------------------------------------------------===//
@@ -182,6 +210,13 @@ void PianoClipComponent::reloadTrackMap()
     this->keyboardSize = this->project.getProjectInfo()->getKeyboardSize();
 
     this->displayedNotes.clear();
+    this->tiles.clear();
+
+    // the notes will come in onLoadTrackContent
+    if (!this->sequence->isLoaded())
+    {
+        return;
+    }
 
     for (auto *track : this->project.getTracks())
     {
@@ -199,6 +234,26 @@ void PianoClipComponent::reloadTrackMap()
     }
 }
 
+Rectangle<float> PianoClipComponent::getNoteBounds(const Note &note) const
+{
+    const auto *ns = note.getSequence();
+    const float sequenceLength = ns->getLengthInBeats();
+    const float beat = note.getBeat() - ns->getFirstBeat();
+    const auto key = jlimit(0, this->keyboardSize, note.getKey() + this->clip.getKey());
+    const float x = static_cast<float>(this->getWidth()) * (beat / sequenceLength);
+    const float w = static_cast<float>(this->getWidth()) * (note.getLength() / sequenceLength);
+    const float h = static_cast<float>(this->getHeight());
+    const int y = static_cast<int>(h - key * h / static_cast<float>(this->keyboardSize));
+    return { x, static_cast<float>(y), jmax(0.25f, w), 1.f };
+}
+
+void PianoClipComponent::invalidateTilesFor(const Note &note)
+{
+    // if the sequence's range changes, all tiles will be dropped anyway
+    const auto bounds = this->getNoteBounds(note);
+    this->tiles.invalidate(bounds.getX(), bounds.getRight());
+}
+
 void PianoClipComponent::setShowRecordingMode(bool isRecording)
 {
     this->flags.isRecordingTarget = isRecording;
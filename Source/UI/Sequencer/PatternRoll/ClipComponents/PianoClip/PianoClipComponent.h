@@ -20,6 +20,7 @@
 #include "Note.h"
 #include "ClipComponent.h"
 #include "ProjectListener.h"
+#include "TiledImageCache.h"
 
 class RollBase;
 class MidiSequence;
@@ -57,6 +58,7 @@ public:
     void onAddTrack(MidiTrack *const track) override;
     void onRemoveTrack(MidiTrack *const track) override;
     void onChangeTrackProperties(MidiTrack *const track) override;
+    void onLoadTrackContent(MidiTrack *const track) override;
 
     void onChangeProjectBeatRange(float firstBeat, float lastBeat) override {}
     void onChangeViewBeatRange(float firstBeat, float lastBeat) override {}
@@ -68,11 +70,20 @@ private:
 
     void reloadTrackMap();
 
+    Rectangle<float> getNoteBounds(const Note &note) const;
+    void invalidateTilesFor(const Note &note);
+
     ProjectNode &project;
     WeakReference<MidiSequence> sequence;
     FlatHashSet<Note, MidiEventHash> displayedNotes;
 
     int keyboardSize = Globals::twelveToneKeyboardSize;
 
+    // the notes' positions depend on the sequence's range,
+    // and when it changes, all tiles are re-rendered
+    TiledImageCache tiles;
+    Range<float> tilesSequenceRange;
+    int tilesKeyboardSize = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PianoClipComponent)
 };
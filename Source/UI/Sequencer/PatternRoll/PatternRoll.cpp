@@ -461,7 +461,7 @@ void PatternRoll::selectEventsInRange(float startBeat, float endBeat, bool shoul
     }
 }
 
-void PatternRoll::findLassoItemsInArea(Array<SelectableComponent *> &itemsFound, const Rectangle<int> &rectangle)
+void PatternRoll::findLassoItemsInArea(Array<SelectableItem *> &itemsFound, const Rectangle<int> &rectangle)
 {
     for (const auto &e : this->clipComponents)
     {
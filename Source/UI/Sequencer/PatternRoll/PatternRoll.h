@@ -70,7 +70,7 @@ public:
     void selectEventsInRange(float startBeat,
         float endBeat, bool shouldClearAllOthers) override;
 
-    void findLassoItemsInArea(Array<SelectableComponent *> &itemsFound,
+    void findLassoItemsInArea(Array<SelectableItem *> &itemsFound,
         const Rectangle<int> &rectangle) override;
 
     void updateHighlightedInstances();
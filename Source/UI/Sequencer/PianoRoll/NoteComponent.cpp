@@ -29,14 +29,13 @@
 
 static PianoSequence *getPianoSequence(const Lasso &selection)
 {
-    const auto &firstEvent = selection.getFirstAs<NoteComponent>()->getNote();
+    const auto &firstEvent = selection.getFirstAs<SelectableNote>()->getNote();
     return static_cast<PianoSequence *>(firstEvent.getSequence());
 }
 
-NoteComponent::NoteComponent(PianoRoll &editor, const Note &event, const Clip &clip, bool ghostMode) noexcept :
+NoteComponent::NoteComponent(PianoRoll &editor, SelectableNote &note, bool ghostMode) noexcept :
     MidiEventComponent(editor, ghostMode),
-    note(event),
-    clip(clip)
+    note(note)
 {
     this->setPaintingIsUnclipped(true);
     this->setWantsKeyboardFocus(false);
@@ -56,28 +55,16 @@ PianoRoll &NoteComponent::getRoll() const noexcept
 void NoteComponent::updateColours()
 {
     const bool ghost = this->flags.isGhost || !this->flags.isActive;
-    const auto base = findDefaultColour(ColourIDs::Roll::noteFill);
-
-    this->colour = this->getNote().getTrackColour()
-        .interpolatedWith(base, ghost ? 0.15f : 0.4f)
-        .brighter(this->flags.isSelected ? 1.15f : 0.f)
-        .withMultipliedSaturationHSL(ghost ? 1.5f : 1.f)
-        .withAlpha(ghost ? 0.25f : 0.9f);
-
-    if (ghost)
-    {
-        this->colour = HelioTheme::getCurrentTheme().isDark() ?
-            this->colour.brighter(0.55f) : this->colour.darker(0.45f);
-    }
-
-    this->colourLighter = this->colour.brighter(0.125f).withMultipliedAlpha(1.45f);
-    this->colourDarker = this->colour.darker(0.175f).withMultipliedAlpha(1.45f);
-    this->colourVolume = this->colour.darker(0.8f).withAlpha(ghost ? 0.f : 0.5f);
+    const bool selected = !this->flags.isGhost && this->note.isSelected();
+    this->palette = NoteComponent::makePalette(this->getNote().getTrackColour(), ghost, selected);
 }
 
-bool NoteComponent::shouldGoQuickSelectLayerMode(const ModifierKeys &modifiers) const
+void NoteComponent::getKeyBeatAt(float x, float y, int &key, float &beat) const
 {
-    return (modifiers.isAltDown() || modifiers.isRightButtonDown()) && !this->isActive();
+    this->getRoll().getRowsColsByComponentPosition(
+        this->getX() + this->floatLocalBounds.getX() + x,
+        this->getY() + this->floatLocalBounds.getY() + y,
+        key, beat);
 }
 
 //===----------------------------------------------------------------------===//
@@ -86,7 +73,12 @@ bool NoteComponent::shouldGoQuickSelectLayerMode(const ModifierKeys &modifiers)
 
 const String &NoteComponent::getSelectionGroupId() const noexcept
 {
-    return this->note.getSequence()->getTrackId();
+    return this->note.getSelectionGroupId();
+}
+
+SelectableItem *NoteComponent::getSelectableItem() noexcept
+{
+    return &this->note;
 }
 
 //===----------------------------------------------------------------------===//
@@ -105,19 +97,8 @@ void NoteComponent::modifierKeysChanged(const ModifierKeys &modifiers)
 
 void NoteComponent::mouseMove(const MouseEvent &e)
 {
-    if (this->shouldGoQuickSelectLayerMode(e.mods))
-    {
-        return;
-    }
-
-    if (! this->isActive())
-    {
-        this->roll.mouseMove(e.getEventRelativeTo(&this->roll));
-        return;
-    }
-
     const auto resizeEdge = this->getResizableEdge();
-    if (this->isResizingOrScaling() ||
+    if (this->note.isResizingOrScaling() ||
         (this->canResize() && (e.x >= (this->getWidth() - resizeEdge) || e.x <= resizeEdge)))
     {
         this->setMouseCursor(MouseCursor::LeftRightResizeCursor);
@@ -130,23 +111,10 @@ void NoteComponent::mouseMove(const MouseEvent &e)
 
 #define forEachSelectedNote(lasso, child) \
     for (int _i = 0; _i < lasso.getNumSelected(); _i++) \
-        if (auto *child = dynamic_cast<NoteComponent *>(lasso.getSelectedItem(_i)))
+        if (auto *child = dynamic_cast<SelectableNote *>(lasso.getSelectedItem(_i)))
 
 void NoteComponent::mouseDown(const MouseEvent &e)
 {
-    if (this->shouldGoQuickSelectLayerMode(e.mods))
-    {
-        this->roll.mouseDown(e.getEventRelativeTo(&this->roll));
-        this->switchActiveSegmentToSelected(e.mods.isAnyModifierKeyDown());
-        return;
-    }
-    
-    if (! this->isActive())
-    {
-        this->roll.mouseDown(e.getEventRelativeTo(&this->roll));
-        return;
-    }
-    
     if (e.mods.isRightButtonDown() &&
         this->roll.getEditMode().isMode(RollEditMode::defaultMode))
     {
@@ -165,7 +133,7 @@ void NoteComponent::mouseDown(const MouseEvent &e)
         
         if (shouldSendMidi)
         {
-            this->stopSound();
+            this->note.stopSound();
         }
 
         const auto resizeEdge = this->getResizableEdge();
@@ -178,7 +146,7 @@ void NoteComponent::mouseDown(const MouseEvent &e)
                 {
                     if (selection.shouldDisplayGhostNotes())
                     {
-                        selectedNote->getRoll().showGhostNoteFor(selectedNote);
+                        selectedNote->getRoll().showGhostNoteFor(*selectedNote);
                     }
 
                     selectedNote->startGroupScalingRight(groupStartBeat);
@@ -190,7 +158,7 @@ void NoteComponent::mouseDown(const MouseEvent &e)
                 {
                     if (selection.shouldDisplayGhostNotes())
                     {
-                        selectedNote->getRoll().showGhostNoteFor(selectedNote);
+                        selectedNote->getRoll().showGhostNoteFor(*selectedNote);
                     }
 
                     selectedNote->startResizingRight(shouldSendMidi);
@@ -206,7 +174,7 @@ void NoteComponent::mouseDown(const MouseEvent &e)
                 {
                     if (selection.shouldDisplayGhostNotes())
                     {
-                        selectedNote->getRoll().showGhostNoteFor(selectedNote);
+                        selectedNote->getRoll().showGhostNoteFor(*selectedNote);
                     }
 
                     selectedNote->startGroupScalingLeft(groupEndBeat);
@@ -218,7 +186,7 @@ void NoteComponent::mouseDown(const MouseEvent &e)
                 {
                     if (selection.shouldDisplayGhostNotes())
                     {
-                        selectedNote->getRoll().showGhostNoteFor(selectedNote);
+                        selectedNote->getRoll().showGhostNoteFor(*selectedNote);
                     }
 
                     selectedNote->startResizingLeft(shouldSendMidi);
@@ -232,7 +200,7 @@ void NoteComponent::mouseDown(const MouseEvent &e)
             {
                 if (selection.shouldDisplayGhostNotes())
                 {
-                    selectedNote->getRoll().showGhostNoteFor(selectedNote);
+                    selectedNote->getRoll().showGhostNoteFor(*selectedNote);
                 }
 
                 selectedNote->startDragging(shouldSendMidi);
@@ -253,17 +221,6 @@ static int lastDeltaKey = 0;
 
 void NoteComponent::mouseDrag(const MouseEvent &e)
 {
-    if (this->shouldGoQuickSelectLayerMode(e.mods))
-    {
-        return;
-    }
-    
-    if (!this->isActive())
-    {
-        this->roll.mouseDrag(e.getEventRelativeTo(&this->roll));
-        return;
-    }
-
     if (e.mods.isRightButtonDown() &&
         this->roll.getEditMode().isMode(RollEditMode::defaultMode))
     {
@@ -273,12 +230,20 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
     }
     
     const auto &selection = this->roll.getLassoSelection();
+    const auto state = this->note.getState();
+
+    int newKey = -1;
+    float newBeat = -1;
+    if (this->note.isResizingOrScaling())
+    {
+        this->getKeyBeatAt(float(e.x), float(e.y), newKey, newBeat);
+    }
 
-    if (this->state == State::DraggingResizing)
+    if (state == SelectableNote::State::DraggingResizing)
     {
         int deltaKey = 0;
         float deltaLength = 0.f;
-        const bool eventChanged = this->getDraggingResizingDelta(e, deltaLength, deltaKey);
+        const bool eventChanged = this->note.getDraggingResizingDelta(newKey, newBeat, deltaLength, deltaKey);
 
         const bool shouldSendMidi = (lastDeltaKey != deltaKey) &&
             (selection.getNumSelected() <= NoteComponent::maxDragPolyphony);
@@ -287,17 +252,17 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
 
         if (eventChanged)
         {
-            this->checkpointIfNeeded();
+            this->note.checkpointIfNeeded();
 
             if (shouldSendMidi)
             {
-                this->stopSound();
+                this->note.stopSound();
             }
 
             Array<Note> groupBefore, groupAfter;
             for (int i = 0; i < selection.getNumSelected(); ++i)
             {
-                const auto *nc = selection.getItemAs<NoteComponent>(i);
+                const auto *nc = selection.getItemAs<SelectableNote>(i);
                 groupBefore.add(nc->getNote());
                 groupAfter.add(nc->continueDraggingResizing(deltaLength, deltaKey, shouldSendMidi));
                 this->getRoll().setDefaultNoteLength(groupAfter.getLast().getLength());
@@ -310,19 +275,19 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
             this->setFloatBounds(this->getRoll().getEventBounds(this)); // avoids glitches
         }
     }
-    else if (this->state == State::ResizingRight)
+    else if (state == SelectableNote::State::ResizingRight)
     {
         float deltaLength = 0.f;
-        const bool lengthChanged = this->getResizingRightDelta(e, deltaLength);
+        const bool lengthChanged = this->note.getResizingRightDelta(newBeat, deltaLength);
 
         if (lengthChanged)
         {
-            this->checkpointIfNeeded();
+            this->note.checkpointIfNeeded();
             Array<Note> groupBefore, groupAfter;
 
             for (int i = 0; i < selection.getNumSelected(); ++i)
             {
-                const auto *nc = selection.getItemAs<NoteComponent>(i);
+                const auto *nc = selection.getItemAs<SelectableNote>(i);
                 groupBefore.add(nc->getNote());
                 groupAfter.add(nc->continueResizingRight(deltaLength));
                 this->getRoll().setDefaultNoteLength(groupAfter.getLast().getLength());
@@ -335,19 +300,19 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
             this->setFloatBounds(this->getRoll().getEventBounds(this)); // avoids glitches
         }
     }
-    else if (this->state == State::ResizingLeft)
+    else if (state == SelectableNote::State::ResizingLeft)
     {
         float deltaLength = 0.f;
-        const bool lengthChanged = this->getResizingLeftDelta(e, deltaLength);
+        const bool lengthChanged = this->note.getResizingLeftDelta(newBeat, deltaLength);
         
         if (lengthChanged)
         {
-            this->checkpointIfNeeded();
+            this->note.checkpointIfNeeded();
             Array<Note> groupBefore, groupAfter;
                 
             for (int i = 0; i < selection.getNumSelected(); ++i)
             {
-                const auto *nc = selection.getItemAs<NoteComponent>(i);
+                const auto *nc = selection.getItemAs<SelectableNote>(i);
                 groupBefore.add(nc->getNote());
                 groupAfter.add(nc->continueResizingLeft(deltaLength));
                 this->getRoll().setDefaultNoteLength(groupAfter.getLast().getLength());
@@ -360,19 +325,19 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
             this->setFloatBounds(this->getRoll().getEventBounds(this)); // avoids glitches
         }
     }
-    else if (this->state == State::GroupScalingRight)
+    else if (state == SelectableNote::State::GroupScalingRight)
     {
         float groupScaleFactor = 1.f;
-        const bool scaleFactorChanged = this->getGroupScaleRightFactor(e, groupScaleFactor);
+        const bool scaleFactorChanged = this->note.getGroupScaleRightFactor(newBeat, groupScaleFactor);
         
         if (scaleFactorChanged)
         {
-            this->checkpointIfNeeded();
+            this->note.checkpointIfNeeded();
             Array<Note> groupBefore, groupAfter;
                 
             for (int i = 0; i < selection.getNumSelected(); ++i)
             {
-                const auto *nc = selection.getItemAs<NoteComponent>(i);
+                const auto *nc = selection.getItemAs<SelectableNote>(i);
                 groupBefore.add(nc->getNote());
                 groupAfter.add(nc->continueGroupScalingRight(groupScaleFactor));
             }
@@ -384,19 +349,19 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
             this->setFloatBounds(this->getRoll().getEventBounds(this)); // avoids glitches
         }
     }
-    else if (this->state == State::GroupScalingLeft)
+    else if (state == SelectableNote::State::GroupScalingLeft)
     {
         float groupScaleFactor = 1.f;
-        const bool scaleFactorChanged = this->getGroupScaleLeftFactor(e, groupScaleFactor);
+        const bool scaleFactorChanged = this->note.getGroupScaleLeftFactor(newBeat, groupScaleFactor);
         
         if (scaleFactorChanged)
         {
-            this->checkpointIfNeeded();
+            this->note.checkpointIfNeeded();
             Array<Note> groupBefore, groupAfter;
                 
             for (int i = 0; i < selection.getNumSelected(); ++i)
             {
-                const auto *nc = selection.getItemAs<NoteComponent>(i);
+                const auto *nc = selection.getItemAs<SelectableNote>(i);
                 groupBefore.add(nc->getNote());
                 groupAfter.add(nc->continueGroupScalingLeft(groupScaleFactor));
             }
@@ -408,13 +373,17 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
             this->setFloatBounds(this->getRoll().getEventBounds(this)); // avoids glitches
         }
     }
-    else if (this->state == State::Dragging)
+    else if (state == SelectableNote::State::Dragging)
     {
         this->getRoll().showDragHelpers();
 
+        this->dragger.dragComponent(this, e, nullptr);
+        this->getKeyBeatAt(1.f /*+ this->clickOffset.getX()*/,
+            float(this->clickOffset.getY()), newKey, newBeat);
+
         int deltaKey = 0;
         float deltaBeat = 0.f;
-        const bool eventChanged = this->getDraggingDelta(e, deltaBeat, deltaKey);
+        const bool eventChanged = this->note.getDraggingDelta(newKey, newBeat, deltaBeat, deltaKey);
         
         const bool shouldSendMidi = (lastDeltaKey != deltaKey) &&
             (selection.getNumSelected() <= NoteComponent::maxDragPolyphony);
@@ -425,9 +394,9 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
         
         if (eventChanged)
         {
-            const bool firstChangeIsToCome = !this->firstChangeDone;
+            const bool firstChangeIsToCome = !this->note.firstChangeDone;
 
-            this->checkpointIfNeeded();
+            this->note.checkpointIfNeeded();
             
             // Drag-and-copy logic:
             if (firstChangeIsToCome && e.mods.isAnyModifierKeyDown())
@@ -444,24 +413,22 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
                 // Ghost note markers become useless from now on, as there are duplicates in their places already:
                 this->getRoll().hideAllGhostNotes();
 
-                // Finally, bring selection back to front
-                forEachSelectedNote(selection, noteComponent)
-                {
-                    noteComponent->toFront(false);
-                }
+                // Finally, bring this note back to front,
+                // (the roll paints the rest of the selection above the duplicates)
+                this->toFront(false);
             }
 
             this->getRoll().moveDragHelpers(deltaBeat, deltaKey);
             
             if (shouldSendMidi)
             {
-                this->stopSound();
+                this->note.stopSound();
             }
             
             Array<Note> groupBefore, groupAfter;
             for (int i = 0; i < selection.getNumSelected(); ++i)
             {
-                const auto *nc = selection.getItemAs<NoteComponent>(i);
+                const auto *nc = selection.getItemAs<SelectableNote>(i);
                 groupBefore.add(nc->getNote());
                 groupAfter.add(nc->continueDragging(deltaBeat, deltaKey, shouldSendMidi));
             }
@@ -469,16 +436,18 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
             getPianoSequence(selection)->changeGroup(groupBefore, groupAfter, true);
         }
     }
-    else if (this->state == State::Tuning)
+    else if (state == SelectableNote::State::Tuning)
     {
-        this->checkpointIfNeeded();
+        this->note.checkpointIfNeeded();
         
+        const float delta = e.getDistanceFromDragStartY() / 250.0f;
+
         Array<Note> groupBefore, groupAfter;
         for (int i = 0; i < selection.getNumSelected(); ++i)
         {
-            const auto *nc = selection.getItemAs<NoteComponent>(i);
+            const auto *nc = selection.getItemAs<SelectableNote>(i);
             groupBefore.add(nc->getNote());
-            groupAfter.add(nc->continueTuning(e));
+            groupAfter.add(nc->continueTuningLinear(delta));
             this->getRoll().setDefaultNoteVolume(groupAfter.getLast().getVelocity());
         }
 
@@ -488,17 +457,6 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
 
 void NoteComponent::mouseUp(const MouseEvent &e)
 {
-    if (this->shouldGoQuickSelectLayerMode(e.mods))
-    {
-        return;
-    }
-    
-    if (!this->isActive())
-    {
-        this->roll.mouseUp(e.getEventRelativeTo(&this->roll));
-        return;
-    }
-
     if (e.mods.isRightButtonDown() && this->roll.getEditMode().isMode(RollEditMode::defaultMode))
     {
         this->setMouseCursor(MouseCursor::NormalCursor);
@@ -511,64 +469,58 @@ void NoteComponent::mouseUp(const MouseEvent &e)
     const bool shouldSendMidi = true;
     
     const Lasso &selection = this->roll.getLassoSelection();
+    const auto state = this->note.getState();
 
-    if (this->state == State::DraggingResizing)
+    if (state == SelectableNote::State::DraggingResizing)
     {
         for (int i = 0; i < selection.getNumSelected(); i++)
         {
-            auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            nc->endDraggingResizing();
+            selection.getItemAs<SelectableNote>(i)->endDraggingResizing();
         }
     }
-    else if (this->state == State::ResizingRight)
+    else if (state == SelectableNote::State::ResizingRight)
     {
         for (int i = 0; i < selection.getNumSelected(); i++)
         {
-            auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            nc->endResizingRight();
+            selection.getItemAs<SelectableNote>(i)->endResizingRight();
         }
     }
-    else if (this->state == State::ResizingLeft)
+    else if (state == SelectableNote::State::ResizingLeft)
     {
         for (int i = 0; i < selection.getNumSelected(); i++)
         {
-            auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            nc->endResizingLeft();
+            selection.getItemAs<SelectableNote>(i)->endResizingLeft();
         }
     }
-    else if (this->state == State::GroupScalingRight)
+    else if (state == SelectableNote::State::GroupScalingRight)
     {
         for (int i = 0; i < selection.getNumSelected(); i++)
         {
-            auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            nc->endGroupScalingRight();
+            selection.getItemAs<SelectableNote>(i)->endGroupScalingRight();
         }
     }
-    else if (this->state == State::GroupScalingLeft)
+    else if (state == SelectableNote::State::GroupScalingLeft)
     {
         for (int i = 0; i < selection.getNumSelected(); i++)
         {
-            auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            nc->endGroupScalingLeft();
+            selection.getItemAs<SelectableNote>(i)->endGroupScalingLeft();
         }
     }
-    else if (this->state == State::Dragging)
+    else if (state == SelectableNote::State::Dragging)
     {
         this->getRoll().hideDragHelpers();
         this->setFloatBounds(this->getRoll().getEventBounds(this));
         
         for (int i = 0; i < selection.getNumSelected(); i++)
         {
-            auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            nc->endDragging(shouldSendMidi);
+            selection.getItemAs<SelectableNote>(i)->endDragging(shouldSendMidi);
         }
     }
-    else if (this->state == State::Tuning)
+    else if (state == SelectableNote::State::Tuning)
     {
         for (int i = 0; i < selection.getNumSelected(); i++)
         {
-            auto *note = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            note->endTuning();
+            selection.getItemAs<SelectableNote>(i)->endTuning();
         }
 
         this->setMouseCursor(MouseCursor::NormalCursor);
@@ -579,16 +531,52 @@ void NoteComponent::mouseUp(const MouseEvent &e)
 // Notes painting
 //===----------------------------------------------------------------------===//
 
+void NoteComponent::paint(Graphics &g) noexcept
+{
+    NoteComponent::paintNote(g, this->floatLocalBounds,
+        this->getNote(), this->getClip(), this->palette);
+
+    // debug
+    //g.setColour(Colours::orangered);
+    //const auto edge = this->getResizableEdge();
+    //g.fillRect(0, 0, edge, this->getHeight());
+    //g.fillRect(this->getWidth() - edge, 0, edge, this->getHeight());
+}
+
+NoteComponent::Palette NoteComponent::makePalette(const Colour &trackColour, bool ghost, bool selected)
+{
+    const auto base = findDefaultColour(ColourIDs::Roll::noteFill);
+
+    Palette palette;
+    palette.fill = trackColour
+        .interpolatedWith(base, ghost ? 0.15f : 0.4f)
+        .brighter(selected ? 1.15f : 0.f)
+        .withMultipliedSaturationHSL(ghost ? 1.5f : 1.f)
+        .withAlpha(ghost ? 0.25f : 0.9f);
+
+    if (ghost)
+    {
+        palette.fill = HelioTheme::getCurrentTheme().isDark() ?
+            palette.fill.brighter(0.55f) : palette.fill.darker(0.45f);
+    }
+
+    palette.lighter = palette.fill.brighter(0.125f).withMultipliedAlpha(1.45f);
+    palette.darker = palette.fill.darker(0.175f).withMultipliedAlpha(1.45f);
+    palette.volume = palette.fill.darker(0.8f).withAlpha(ghost ? 0.f : 0.5f);
+    return palette;
+}
+
 // Always use only either drawHorizontalLine/drawVerticalLine,
 // or fillRect - these are the ones with minimal overhead:
-void NoteComponent::paint(Graphics &g) noexcept
+void NoteComponent::paintNote(Graphics &g, const Rectangle<float> &bounds,
+    const Note &note, const Clip &clip, const Palette &palette) noexcept
 {
-    const float w = this->floatLocalBounds.getWidth() - .5f; // a small gap between notes
-    const float h = this->floatLocalBounds.getHeight();
-    const float x = this->floatLocalBounds.getX();
-    const float y = this->floatLocalBounds.getY();
+    const float w = bounds.getWidth() - .5f; // a small gap between notes
+    const float h = bounds.getHeight();
+    const float x = bounds.getX();
+    const float y = bounds.getY();
     
-    g.setColour(this->colour);
+    g.setColour(palette.fill);
     g.fillRect(x + 0.5f, y + h / 6.f, 0.5f, h / 1.5f);
 
     if (w >= 1.25f)
@@ -599,123 +587,39 @@ void NoteComponent::paint(Graphics &g) noexcept
 
     if (w >= 2.25f)
     {
-        g.setColour(this->colourLighter);
+        g.setColour(palette.lighter);
         g.fillRect(x + 1.25f, roundf(y), w - 2.25f, 1.f);
 
-        g.setColour(this->colourDarker);
+        g.setColour(palette.darker);
         g.fillRect(x + 1.25f, roundf(y + h - 1), w - 2.25f, 1.f);
     }
 
     if (w >= 4.f)
     {
-        g.setColour(this->colourVolume);
+        g.setColour(palette.volume);
         const float sx = x + 2.f;
-        const float sy = float(this->getHeight() - 4);
-        const float sw1 = (w - 4.f) * this->note.getVelocity();
-        const float sw2 = (w - 4.f) * this->note.getVelocity() * this->clip.getVelocity();
+        const float sy = floorf(y + h - 4.f);
+        const float sw1 = (w - 4.f) * note.getVelocity();
+        const float sw2 = (w - 4.f) * note.getVelocity() * clip.getVelocity();
         g.fillRect(sx, sy, sw1, 3.f);
         g.fillRect(sx, sy, sw2, 3.f);
     }
 
-    const auto tuplet = this->note.getTuplet();
-    if (tuplet > 1 && this->getWidth() > 25)
+    const auto tuplet = note.getTuplet();
+    if (tuplet > 1 && bounds.getWidth() > 25.f)
     {
-        g.setColour(this->colourLighter);
+        g.setColour(palette.lighter);
         for (int i = 1; i < tuplet; ++i)
         {
             g.fillRect(x + i * (w / tuplet) - 1.f, y, 1.f, h);
         }
 
-        g.setColour(this->colourVolume);
+        g.setColour(palette.volume);
         for (int i = 1; i < tuplet; ++i)
         {
             g.fillRect(x + i * (w / tuplet), y, 1.5f, h);
         }
     }
-
-    // debug
-    //g.setColour(Colours::orangered);
-    //const auto edge = this->getResizableEdge();
-    //g.fillRect(0, 0, edge, this->getHeight());
-    //g.fillRect(this->getWidth() - edge, 0, edge, this->getHeight());
-}
-
-//===----------------------------------------------------------------------===//
-// Helpers
-//===----------------------------------------------------------------------===//
-
-bool NoteComponent::belongsTo(const WeakReference<MidiTrack> &track, const Clip &clip) const noexcept
-{
-    return this->clip == clip && this->note.getSequence()->getTrack() == track;
-}
-
-void NoteComponent::switchActiveSegmentToSelected(bool zoomToScope) const
-{
-    auto *track = this->getNote().getSequence()->getTrack();
-    this->roll.getProject().setEditableScope(track, this->getClip(), zoomToScope);
-    if (zoomToScope)
-    {
-        this->getRoll().zoomOutImpulse(0.5f);
-    }
-}
-
-//===----------------------------------------------------------------------===//
-// Dragging
-//===----------------------------------------------------------------------===//
-
-void NoteComponent::startDragging(const bool sendMidiMessage)
-{
-    this->firstChangeDone = false;
-    this->state = State::Dragging;
-    this->anchor = this->getNote();
-    
-    if (sendMidiMessage)
-    {
-        this->sendNoteOn(this->getKey(), this->getVelocity());
-    }
-}
-
-bool NoteComponent::getDraggingDelta(const MouseEvent &e, float &deltaBeat, int &deltaKey)
-{
-    this->dragger.dragComponent(this, e, nullptr);
-
-    int newKey = -1;
-    float newBeat = -1;
-    this->getRoll().getRowsColsByComponentPosition(
-        this->getX() + this->floatLocalBounds.getX() + 1 /*+ this->clickOffset.getX()*/,
-        this->getY() + this->floatLocalBounds.getY() + this->clickOffset.getY(),
-        newKey, newBeat);
-
-    deltaKey = (newKey - this->anchor.getKey());
-    deltaBeat = (newBeat - this->anchor.getBeat());
-
-    const bool keyChanged = (this->getKey() != newKey);
-    const bool beatChanged = (this->getBeat() != newBeat);
-
-    return (keyChanged || beatChanged);
-}
-
-Note NoteComponent::continueDragging(float deltaBeat, int deltaKey, bool sendMidiMessage) const noexcept
-{
-    const int newKey = this->anchor.getKey() + deltaKey;
-    const float newBeat = this->anchor.getBeat() + deltaBeat;
-
-    if (sendMidiMessage)
-    {
-        this->sendNoteOn(newKey, this->getVelocity());
-    }
-
-    return this->getNote().withKeyBeat(newKey, newBeat);
-}
-
-void NoteComponent::endDragging(bool sendStopSoundMessage)
-{
-    if (sendStopSoundMessage)
-    {
-        this->stopSound();
-    }
-    
-    this->state = State::None;
 }
 
 //===----------------------------------------------------------------------===//
@@ -724,7 +628,7 @@ void NoteComponent::endDragging(bool sendStopSoundMessage)
 
 MouseCursor NoteComponent::startEditingNewNote(const MouseEvent &e)
 {
-    jassert (!this->isInEditMode());
+    jassert (!this->note.isInEditMode());
 
     // always send midi in this mode:
     constexpr bool sendMidi = true;
@@ -737,11 +641,11 @@ MouseCursor NoteComponent::startEditingNewNote(const MouseEvent &e)
     {
         // normally this would have been be set by mouseDown:
         this->dragger.startDraggingComponent(this, e);
-        this->startDragging(sendMidi);
+        this->note.startDragging(sendMidi);
     }
     else
     {
-        this->startDraggingResizing(sendMidi);
+        this->note.startDraggingResizing(sendMidi);
     }
 
     // normally this would have been be set by mouseDown,
@@ -751,339 +655,8 @@ MouseCursor NoteComponent::startEditingNewNote(const MouseEvent &e)
     // hack warning: this note is supposed to be created by roll in two actions,
     // (1) adding one, and (2) dragging it afterwards, so two checkpoints would happen,
     // which we don't want (adding a note should appear as a single transaction to the user):
-    this->firstChangeDone = true;
+    this->note.firstChangeDone = true;
 
-    return (this->state == State::DraggingResizing) ?
+    return (this->note.getState() == SelectableNote::State::DraggingResizing) ?
         MouseCursor::LeftRightResizeCursor : MouseCursor::NormalCursor;
 }
-
-//===----------------------------------------------------------------------===//
-// Dragging + resizing (the default creating note mode)
-//===----------------------------------------------------------------------===//
-
-bool NoteComponent::isInEditMode() const
-{
-    return this->state != State::None;
-}
-
-void NoteComponent::startDraggingResizing(bool sendMidiMessage)
-{
-    this->firstChangeDone = false;
-    this->state = State::DraggingResizing;
-    this->anchor = this->getNote();
-
-    // always send midi in this mode:
-    if (sendMidiMessage)
-    {
-        this->sendNoteOn(this->getKey(), this->getVelocity());
-    }
-}
-
-bool NoteComponent::getDraggingResizingDelta(const MouseEvent &e, float &deltaLength, int &deltaKey) const
-{
-    int newKey = -1;
-    float newBeat = -1;
-
-    this->getRoll().getRowsColsByComponentPosition(
-        this->getX() + this->floatLocalBounds.getX() + e.x,
-        this->getY() + this->floatLocalBounds.getY() + e.y,
-        newKey, newBeat);
-
-    const float newLength = newBeat - this->getBeat();
-    deltaLength = newLength - this->anchor.getLength();
-    deltaKey = newKey - this->anchor.getKey();
-
-    const bool keyChanged = (this->getKey() != newKey);
-    const bool lengthChanged = (this->getLength() != newLength);
-    return (keyChanged || lengthChanged);
-}
-
-Note NoteComponent::continueDraggingResizing(float deltaLength, int deltaKey, bool sendMidi) const noexcept
-{
-    const int newKey = this->anchor.getKey() + deltaKey;
-
-    // the minimal length should depend on the current zoom level:
-    // when zoomed closer, we need to be able to edit shorter lengths,
-    // when zoomed away, the length snaps should be convenient == proportionally larger
-    const float minLength = this->roll.getMinVisibleBeatForCurrentZoomLevel();
-    const float newLength = jmax(this->anchor.getLength() + deltaLength, minLength);
-
-    if (sendMidi)
-    {
-        this->sendNoteOn(newKey, this->getVelocity());
-    }
-
-    return this->getNote().withKeyLength(newKey, newLength);
-}
-
-void NoteComponent::endDraggingResizing()
-{
-    this->stopSound();
-    this->state = State::None;
-}
-
-//===----------------------------------------------------------------------===//
-// Resizing Right
-//===----------------------------------------------------------------------===//
-
-void NoteComponent::startResizingRight(bool sendMidiMessage)
-{
-    this->firstChangeDone = false;
-    this->state = State::ResizingRight;
-    this->anchor = this->getNote();
-    
-    if (sendMidiMessage)
-    {
-        this->sendNoteOn(this->getKey(), this->getVelocity());
-    }
-}
-
-bool NoteComponent::getResizingRightDelta(const MouseEvent &e, float &deltaLength) const
-{
-    int newNote = -1;
-    float newBeat = -1;
-
-    this->getRoll().getRowsColsByComponentPosition(
-        this->getX() + this->floatLocalBounds.getX() + e.x,
-        this->getY() + this->floatLocalBounds.getY() + e.y,
-        newNote, newBeat);
-
-    const float newLength = newBeat - this->getBeat();
-    deltaLength = newLength - this->anchor.getLength();
-
-    const bool lengthChanged = (this->getLength() != newLength);
-    return lengthChanged;
-}
-
-Note NoteComponent::continueResizingRight(float deltaLength) const noexcept
-{
-    // the minimal length should depend on the current zoom level:
-    const float minLength = this->roll.getMinVisibleBeatForCurrentZoomLevel();
-    const float newLength = jmax(this->anchor.getLength() + deltaLength, minLength);
-    return this->getNote().withLength(newLength);
-}
-
-void NoteComponent::endResizingRight()
-{
-    this->stopSound();
-    this->state = State::None;
-}
-
-//===----------------------------------------------------------------------===//
-// Resizing Left
-//===----------------------------------------------------------------------===//
-
-void NoteComponent::startResizingLeft(bool sendMidiMessage)
-{
-    this->firstChangeDone = false;
-    this->state = State::ResizingLeft;
-    this->anchor = this->getNote();
-    
-    if (sendMidiMessage)
-    {
-        this->sendNoteOn(this->getKey(), this->getVelocity());
-    }
-}
-
-bool NoteComponent::getResizingLeftDelta(const MouseEvent &e, float &deltaLength) const
-{
-    int newNote = -1;
-    float newBeat = -1;
-    
-    this->getRoll().getRowsColsByComponentPosition(
-        this->getX() + this->floatLocalBounds.getX() + e.x,
-        this->getY() + this->floatLocalBounds.getY() + e.y,
-        newNote, newBeat);
-    
-    deltaLength = this->anchor.getBeat() - newBeat;
-    const bool lengthChanged = (this->getBeat() != newBeat);
-    return lengthChanged;
-}
-
-Note NoteComponent::continueResizingLeft(float deltaLength) const noexcept
-{
-    // the minimal length should depend on the current zoom level:
-    const float minLength = this->roll.getMinVisibleBeatForCurrentZoomLevel();
-    const float newLength = jmax(this->anchor.getLength() + deltaLength, minLength);
-    const float newBeat = this->anchor.getBeat() + this->anchor.getLength() - newLength;
-    return this->getNote().withBeat(newBeat).withLength(newLength);
-}
-
-void NoteComponent::endResizingLeft()
-{
-    this->stopSound();
-    this->state = State::None;
-}
-
-//===----------------------------------------------------------------------===//
-// Group Scaling Right
-//===----------------------------------------------------------------------===//
-
-void NoteComponent::startGroupScalingRight(float groupStartBeat)
-{
-    this->firstChangeDone = false;
-    this->state = State::GroupScalingRight;
-    const float newLength = this->getLength() + (this->getBeat() - groupStartBeat);
-    this->anchor = this->getNote();
-    this->groupScalingAnchor = { groupStartBeat, newLength };
-}
-
-bool NoteComponent::getGroupScaleRightFactor(const MouseEvent &e, float &absScaleFactor) const
-{
-    int newNote = -1;
-    float newBeat = -1;
-    
-    this->getRoll().getRowsColsByComponentPosition(
-        this->getX() + this->floatLocalBounds.getX() + e.x,
-        this->getY() + this->floatLocalBounds.getY() + e.y,
-        newNote, newBeat);
-    
-    const float minGroupLength = 1.f;
-    const float myEndBeat = this->getBeat() + this->getLength();
-    const float newGroupLength = jmax(minGroupLength, newBeat - this->groupScalingAnchor.getBeat());
-
-    absScaleFactor = newGroupLength / this->groupScalingAnchor.getLength();
-    
-    const bool endBeatChanged = (newBeat != myEndBeat);
-    return endBeatChanged;
-}
-
-Note NoteComponent::continueGroupScalingRight(float absScaleFactor) const noexcept
-{
-    const float anchorBeatDelta = this->anchor.getBeat() - this->groupScalingAnchor.getBeat();
-    const float newLength = this->anchor.getLength() * absScaleFactor;
-    const float newBeat = this->groupScalingAnchor.getBeat() + (anchorBeatDelta * absScaleFactor);
-    return this->getNote().withBeat(newBeat).withLength(newLength);
-}
-
-void NoteComponent::endGroupScalingRight()
-{
-    this->state = State::None;
-}
-
-//===----------------------------------------------------------------------===//
-// Group Scaling Left
-//===----------------------------------------------------------------------===//
-
-void NoteComponent::startGroupScalingLeft(float groupEndBeat)
-{
-    this->firstChangeDone = false;
-    this->state = State::GroupScalingLeft;
-    this->anchor = this->getNote();
-    const float newLength = groupEndBeat - this->getBeat();
-    this->groupScalingAnchor = { this->getNote().getBeat(), newLength };
-}
-
-bool NoteComponent::getGroupScaleLeftFactor(const MouseEvent &e, float &absScaleFactor) const
-{
-    int newNote = -1;
-    float newBeat = -1;
-    
-    this->getRoll().getRowsColsByComponentPosition(
-        this->getX() + this->floatLocalBounds.getX() + e.x,
-        this->getY() + this->floatLocalBounds.getY() + e.y,
-        newNote, newBeat);
-    
-    const float minGroupLength = 1.f;
-    const float groupAnchorEndBeat = this->groupScalingAnchor.getBeat() + this->groupScalingAnchor.getLength();
-
-    const float newGroupLength = jmax(minGroupLength, (groupAnchorEndBeat - newBeat));
-    absScaleFactor = newGroupLength / this->groupScalingAnchor.getLength();
-    
-    const bool endBeatChanged = (newBeat != this->getBeat());
-    return endBeatChanged;
-}
-
-Note NoteComponent::continueGroupScalingLeft(float absScaleFactor) const noexcept
-{
-    const float groupAnchorEndBeat = this->groupScalingAnchor.getBeat() + this->groupScalingAnchor.getLength();
-    const float anchorBeatDelta = groupAnchorEndBeat - this->anchor.getBeat();
-    const float newLength = this->anchor.getLength() * absScaleFactor;
-    const float newBeat = groupAnchorEndBeat - (anchorBeatDelta * absScaleFactor);
-    return this->getNote().withBeat(newBeat).withLength(newLength);
-}
-
-void NoteComponent::endGroupScalingLeft()
-{
-    this->state = State::None;
-}
-
-//===----------------------------------------------------------------------===//
-// Velocity
-//===----------------------------------------------------------------------===//
-
-void NoteComponent::startTuning()
-{
-    this->firstChangeDone = false;
-    this->state = State::Tuning;
-    this->anchor = this->getNote();
-}
-
-Note NoteComponent::continueTuningLinear(float delta) const noexcept
-{
-    const float newVelocity = (this->anchor.getVelocity() - delta);
-    return this->getNote().withVelocity(newVelocity);
-}
-
-Note NoteComponent::continueTuningMultiplied(float factor) const noexcept
-{
-    // -1 .. 0   ->   0 .. anchor
-    // 0 .. 1    ->   anchor .. 1
-    const float av = this->anchor.getVelocity();
-    //const float newVelocity = (factor < 0) ? (av * (factor + 1.f)) : (av + ((1.f - av) * factor));
-    const float newVelocity = (factor < 0) ? (av * (factor + 1.f)) : (av + (av * factor * 2));
-    return this->getNote().withVelocity(newVelocity);
-}
-
-Note NoteComponent::continueTuningSine(float factor, float midline, float phase) const noexcept
-{
-    // -1 .. 0   ->   0 .. anchor
-    // 0 .. 1    ->   anchor .. 1
-    const float amplitude = jmin(midline, (1.f - midline));
-    const float sine = cosf(phase) * amplitude;
-    const float av = this->anchor.getVelocity();
-    const float f = (factor < 0) ? (factor + 1.f) : factor;
-    const float downscale = ((av * f) + (midline * (1.f - f)));
-    const float upscale = ((midline + sine) * f) + (av * (1.f - f));
-    const float newVelocity = (factor < 0) ? downscale : upscale;
-    return this->getNote().withVelocity(newVelocity);
-}
-
-Note NoteComponent::continueTuning(const MouseEvent &e) const noexcept
-{
-    return this->continueTuningLinear(e.getDistanceFromDragStartY() / 250.0f);
-}
-
-void NoteComponent::endTuning()
-{
-    this->state = State::None;
-    this->roll.triggerBatchRepaintFor(this);
-}
-
-//===----------------------------------------------------------------------===//
-// Shorthands
-//===----------------------------------------------------------------------===//
-
-void NoteComponent::checkpointIfNeeded()
-{
-    if (!this->firstChangeDone)
-    {
-        this->note.getSequence()->checkpoint();
-        this->firstChangeDone = true;
-    }
-}
-
-void NoteComponent::stopSound()
-{
-    const auto &trackId = this->getNote().getSequence()->getTrackId();
-    this->getRoll().getTransport().stopSound(trackId);
-}
-
-void NoteComponent::sendNoteOn(int noteKey, float velocity) const
-{
-    const auto &trackId = this->note.getSequence()->getTrackId();
-    this->getRoll().getTransport().previewKey(trackId,
-        noteKey + this->clip.getKey(),
-        velocity * this->clip.getVelocity(),
-        this->note.getLength());
-}
@@ -18,32 +18,18 @@
 #pragma once
 
 class PianoRoll;
-class MidiTrack;
 
 #include "MidiEventComponent.h"
-#include "Note.h"
-#include "Clip.h"
+#include "SelectableNote.h"
 
+// Only exists for the notes being hovered or edited, and for the ghost notes,
+// all other notes are painted by the roll itself with the same paintNote method
 class NoteComponent final : public MidiEventComponent
 {
 public:
 
-    NoteComponent(PianoRoll &gridRef, const Note &note,
-        const Clip &clip, bool ghostMode = false) noexcept;
+    NoteComponent(PianoRoll &gridRef, SelectableNote &note, bool ghostMode = false) noexcept;
 
-    // todo need clearer names for these mode and corresponding methods:
-    enum class State : uint8
-    {
-        None,
-        Dragging,           // changes beat & key
-        DraggingResizing,   // changes length & key
-        ResizingRight,      // changes length
-        ResizingLeft,       // changes beat & length
-        GroupScalingRight,  
-        GroupScalingLeft,
-        Tuning
-    };
-    
     //===------------------------------------------------------------------===//
     // Helpers
     //===------------------------------------------------------------------===//
@@ -51,19 +37,37 @@ public:
     inline int getKey() const noexcept { return this->note.getKey(); }
     inline float getLength() const noexcept { return this->note.getLength(); }
     inline float getVelocity() const noexcept { return this->note.getVelocity(); }
-    inline const Note &getNote() const noexcept { return this->note; }
-    inline const Clip &getClip() const noexcept { return this->clip; }
+    inline const Note &getNote() const noexcept { return this->note.getNote(); }
+    inline const Clip &getClip() const noexcept { return this->note.getClip(); }
+    inline SelectableNote &getSelectableNote() const noexcept { return this->note; }
 
     PianoRoll &getRoll() const noexcept;
 
     void updateColours() override;
 
+    //===------------------------------------------------------------------===//
+    // Painting
+    //===------------------------------------------------------------------===//
+
+    struct Palette final
+    {
+        Colour fill;
+        Colour lighter;
+        Colour darker;
+        Colour volume;
+    };
+
+    static Palette makePalette(const Colour &trackColour, bool ghost, bool selected);
+
+    static void paintNote(Graphics &g, const Rectangle<float> &bounds,
+        const Note &note, const Clip &clip, const Palette &palette) noexcept;
+
     //===------------------------------------------------------------------===//
     // MidiEventComponent
     //===------------------------------------------------------------------===//
 
     const String &getSelectionGroupId() const noexcept override;
-    const MidiEvent::Id getId() const noexcept override { return this->note.getId(); }
+    const MidiEvent::Id getId() const noexcept override { return this->getNote().getId(); }
     float getBeat() const noexcept override { return this->note.getBeat(); }
 
     //===------------------------------------------------------------------===//
@@ -78,94 +82,21 @@ public:
     void mouseUp(const MouseEvent &e) override;
     void paint(Graphics &g) noexcept override;
 
-private:
+protected:
 
-    const Note &note;
-    const Clip &clip;
+    SelectableItem *getSelectableItem() noexcept override;
 
 private:
 
-    struct NoteEditAnchor final
-    {
-        NoteEditAnchor &operator= (const Note &note)
-        {
-            this->key = note.getKey();
-            this->beat = note.getBeat();
-            this->length = note.getLength();
-            this->velocity = note.getVelocity();
-            return *this;
-        }
-
-        inline int getKey() const noexcept { return this->key; }
-        inline float getBeat() const noexcept { return this->beat; }
-        inline float getLength() const noexcept { return this->length; }
-        inline float getVelocity() const noexcept { return this->velocity; }
-
-    private:
-        int key = 0;
-        float beat = 0.f;
-        float length = 0.f;
-        float velocity = 0.f;
-    };
-
-    struct GroupScaleAnchor final
-    {
-        GroupScaleAnchor() = default;
-        GroupScaleAnchor(float beat, float length) : beat(beat), length(length) {}
-        inline float getBeat() const noexcept { return this->beat; }
-        inline float getLength() const noexcept { return this->length; }
-    private:
-        float beat = 0.f;
-        float length = 0.f;
-    };
-
-    NoteEditAnchor anchor;
-    GroupScaleAnchor groupScalingAnchor;
+    SelectableNote &note;
 
-private:
-
-    bool belongsTo(const WeakReference<MidiTrack> &track, const Clip &clip) const noexcept;
-    void switchActiveSegmentToSelected(bool zoomToScope) const;
+    Palette palette;
 
     MouseCursor startEditingNewNote(const MouseEvent &e);
 
-    void startDragging(bool sendMidiMessage);
-    bool getDraggingDelta(const MouseEvent &e, float &deltaBeat, int &deltaKey);
-    Note continueDragging(float deltaBeat, int deltaKey, bool sendMidiMessage) const noexcept;
-    void endDragging(bool sendStopSoundMessage = true);
-
-    void startDraggingResizing(bool sendMidiMessage);
-    bool getDraggingResizingDelta(const MouseEvent &e, float &deltaLength, int &deltaKey) const;
-    Note continueDraggingResizing(float deltaLength, int deltaKey, bool sendMidi) const noexcept;
-    void endDraggingResizing();
+    // the key and the beat under the given point of this component
+    void getKeyBeatAt(float x, float y, int &key, float &beat) const;
 
-    void startResizingRight(bool sendMidiMessage);
-    bool getResizingRightDelta(const MouseEvent &e, float &deltaLength) const;
-    Note continueResizingRight(float deltaLength) const noexcept;
-    void endResizingRight();
-    
-    void startResizingLeft(bool sendMidiMessage);
-    bool getResizingLeftDelta(const MouseEvent &e, float &deltaLength) const;
-    Note continueResizingLeft(float deltaLength) const noexcept;
-    void endResizingLeft();
-    
-    void startTuning();
-    Note continueTuning(const MouseEvent &e) const noexcept;
-    Note continueTuningLinear(float delta) const noexcept;
-    Note continueTuningMultiplied(float factor) const noexcept;
-    Note continueTuningSine(float factor, float midline, float phase) const noexcept;
-    void endTuning();
-    
-    void startGroupScalingRight(float groupStartBeat);
-    bool getGroupScaleRightFactor(const MouseEvent &e, float &absScaleFactor) const;
-    Note continueGroupScalingRight(float absScaleFactor) const noexcept;
-    void endGroupScalingRight();
-    
-    void startGroupScalingLeft(float groupEndBeat);
-    bool getGroupScaleLeftFactor(const MouseEvent &e, float &absScaleFactor) const;
-    Note continueGroupScalingLeft(float absScaleFactor) const noexcept;
-    void endGroupScalingLeft();
-    
 #if PLATFORM_DESKTOP
     static constexpr auto maxDragPolyphony = 6;
 #elif PLATFORM_MOBILE
@@ -186,38 +117,8 @@ private:
             (NoteComponent::maxResizableEdge + NoteComponent::maxResizableEdge);
     }
 
-    inline bool isResizingOrScaling() const noexcept
-    {
-        return this->state == State::DraggingResizing ||
-            this->state == State::GroupScalingLeft ||
-            this->state == State::GroupScalingRight ||
-            this->state == State::ResizingLeft ||
-            this->state == State::ResizingRight;
-    }
-
-private:
-
-    State state = State::None;
-    bool isInEditMode() const;
-
-    Colour colour;
-    Colour colourLighter;
-    Colour colourDarker;
-    Colour colourVolume;
-
     friend class PianoRoll;
-    friend class NoteResizerLeft;
-    friend class NoteResizerRight;
-    friend struct SequencerOperations;
-
-    bool firstChangeDone = false;
-    void checkpointIfNeeded();
 
-    bool shouldGoQuickSelectLayerMode(const ModifierKeys &modifiers) const;
-
-    void stopSound();
-    void sendNoteOn(int noteKey, float velocity) const;
-    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoteComponent)
     
 };
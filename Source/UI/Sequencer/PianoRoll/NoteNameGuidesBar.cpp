@@ -18,7 +18,7 @@
 #include "Common.h"
 #include "NoteNameGuidesBar.h"
 #include "NoteNameGuide.h"
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 #include "PianoRoll.h"
 
 NoteNameGuidesBar::NoteNameGuidesBar(PianoRoll &roll) : roll(roll)
@@ -79,7 +79,7 @@ void NoteNameGuidesBar::syncWithSelection(const Lasso *selection)
     for (const auto *e : *selection)
     {
         // assuming we've subscribed only on a piano roll's lasso changes
-        const auto *nc = static_cast<const NoteComponent *>(e);
+        const auto *nc = static_cast<const SelectableNote *>(e);
         const auto key = jlimit(0, this->roll.getNumKeys(),
             nc->getNote().getKey() + nc->getClip().getKey());
 
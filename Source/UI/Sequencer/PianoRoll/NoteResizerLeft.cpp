@@ -21,10 +21,10 @@
 #include "RollBase.h"
 #include "PianoRoll.h"
 #include "PianoSequence.h"
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 #include "SequencerOperations.h"
 
-NoteResizerLeft::NoteResizerLeft(RollBase &parentRoll) : roll(parentRoll)
+NoteResizerLeft::NoteResizerLeft(PianoRoll &parentRoll) : roll(parentRoll)
 {
     this->resizeIcon = make<IconComponent>(Icons::stretchLeft);
     this->resizeIcon->setIconAlphaMultiplier(NoteResizerLeft::lineAlpha);
@@ -102,10 +102,10 @@ void NoteResizerLeft::mouseDown(const MouseEvent &e)
 
     for (int i = 0; i < selection.getNumSelected(); i++)
     {
-        if (auto *note = dynamic_cast<NoteComponent *>(selection.getSelectedItem(i)))
+        if (auto *note = dynamic_cast<SelectableNote *>(selection.getSelectedItem(i)))
         {
             if (selection.shouldDisplayGhostNotes())
-            { note->getRoll().showGhostNoteFor(note); }
+            { this->roll.showGhostNoteFor(*note); }
 
             note->startGroupScalingLeft(groupEndBeat);
         }
@@ -118,10 +118,14 @@ void NoteResizerLeft::mouseDrag(const MouseEvent &e)
 
     const auto &selection = this->roll.getLassoSelection();
 
+    int newKey = 0;
+    float newBeat = 0.f;
+    this->roll.getRowsColsByComponentPosition(float(this->getRight()),
+        float(this->getY()), newKey, newBeat);
+
     float groupScaleFactor = 1.f;
-    const bool scaleFactorChanged = this->groupResizerNote->getGroupScaleLeftFactor(
-        e.withNewPosition(Point<int>(this->getWidth(), 0))
-            .getEventRelativeTo(this->groupResizerNote), groupScaleFactor);
+    const bool scaleFactorChanged =
+        this->groupResizerNote->getGroupScaleLeftFactor(newBeat, groupScaleFactor);
 
     if (scaleFactorChanged)
     {
@@ -130,12 +134,12 @@ void NoteResizerLeft::mouseDrag(const MouseEvent &e)
         Array<Note> groupDragBefore, groupDragAfter;
         for (int i = 0; i < selection.getNumSelected(); ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+            auto *nc = selection.getItemAs<SelectableNote>(i);
             groupDragBefore.add(nc->getNote());
             groupDragAfter.add(nc->continueGroupScalingLeft(groupScaleFactor));
         }
 
-        const auto &event = selection.getFirstAs<NoteComponent>()->getNote();
+        const auto &event = selection.getFirstAs<SelectableNote>()->getNote();
         auto *sequence = static_cast<PianoSequence *>(event.getSequence());
         sequence->changeGroup(groupDragBefore, groupDragAfter, true);
     }
@@ -149,20 +153,20 @@ void NoteResizerLeft::mouseUp(const MouseEvent &e)
 
     for (int i = 0; i < selection.getNumSelected(); i++)
     {
-        auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-        nc->getRoll().hideAllGhostNotes();
+        auto *nc = selection.getItemAs<SelectableNote>(i);
+        this->roll.hideAllGhostNotes();
         nc->endGroupScalingLeft();
     }
 }
 
-NoteComponent *NoteResizerLeft::findLeftMostEvent(const Lasso &selection)
+SelectableNote *NoteResizerLeft::findLeftMostEvent(const Lasso &selection)
 {
-    MidiEventComponent *mc = nullptr;
+    SelectableNote *mc = nullptr;
     float leftMostBeat = FLT_MAX;
 
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        auto *const e = selection.getItemAs<MidiEventComponent>(i);
+        auto *const e = selection.getItemAs<SelectableNote>(i);
 
         if (leftMostBeat > e->getBeat())
         {
@@ -171,14 +175,14 @@ NoteComponent *NoteResizerLeft::findLeftMostEvent(const Lasso &selection)
         }
     }
 
-    return static_cast<NoteComponent *>(mc);
+    return mc;
 }
 
 void NoteResizerLeft::updateBounds()
 {
     const auto &selection = this->roll.getLassoSelection();
     const float groupStartBeat = SequencerOperations::findStartBeat(selection);
-    const float clipBeat = selection.getFirstAs<NoteComponent>()->getClip().getBeat();
+    const float clipBeat = selection.getFirstAs<SelectableNote>()->getClip().getBeat();
     
     const int xAnchor = this->roll.getXPositionByBeat(groupStartBeat + clipBeat);
     const int yAnchor = this->roll.getViewport().getViewPositionY() + Globals::UI::rollHeaderHeight;
@@ -17,8 +17,8 @@
 
 #pragma once
 
-class RollBase;
-class NoteComponent;
+class PianoRoll;
+class SelectableNote;
 class Lasso;
 
 #include "IconComponent.h"
@@ -29,7 +29,7 @@ class NoteResizerLeft final : public Component
 {
 public:
 
-    explicit NoteResizerLeft(RollBase &parentRoll);
+    explicit NoteResizerLeft(PianoRoll &parentRoll);
     ~NoteResizerLeft();
 
     void updateBounds();
@@ -45,10 +45,10 @@ public:
 
 private:
 
-    NoteComponent *findLeftMostEvent(const Lasso &selection);
+    SelectableNote *findLeftMostEvent(const Lasso &selection);
 
-    RollBase &roll;
-    SafePointer<NoteComponent> groupResizerNote;
+    PianoRoll &roll;
+    SelectableNote *groupResizerNote = nullptr;
 
     ComponentFader fader;
     ComponentDragger dragger;
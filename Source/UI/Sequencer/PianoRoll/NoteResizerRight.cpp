@@ -22,9 +22,9 @@
 #include "PianoRoll.h"
 #include "PianoSequence.h"
 #include "SequencerOperations.h"
-#include "NoteComponent.h"
+#include "SelectableNote.h"
 
-NoteResizerRight::NoteResizerRight(RollBase &parentRoll) : roll(parentRoll)
+NoteResizerRight::NoteResizerRight(PianoRoll &parentRoll) : roll(parentRoll)
 {
     this->resizeIcon = make<IconComponent>(Icons::stretchRight);
     this->resizeIcon->setIconAlphaMultiplier(NoteResizerRight::lineAlpha);
@@ -100,10 +100,10 @@ void NoteResizerRight::mouseDown(const MouseEvent &e)
 
     for (int i = 0; i < selection.getNumSelected(); i++)
     {
-        if (auto *note = dynamic_cast<NoteComponent *>(selection.getSelectedItem(i)))
+        if (auto *note = dynamic_cast<SelectableNote *>(selection.getSelectedItem(i)))
         {
             if (selection.shouldDisplayGhostNotes())
-            { note->getRoll().showGhostNoteFor(note); }
+            { this->roll.showGhostNoteFor(*note); }
 
             note->startGroupScalingRight(groupStartBeat);
         }
@@ -116,11 +116,14 @@ void NoteResizerRight::mouseDrag(const MouseEvent &e)
 
     const auto &selection = this->roll.getLassoSelection();
 
+    int newKey = 0;
+    float newBeat = 0.f;
+    this->roll.getRowsColsByComponentPosition(float(this->getX()),
+        float(this->getY()), newKey, newBeat);
+
     float groupScaleFactor = 1.f;
     const bool scaleFactorChanged =
-        this->groupResizerNote->getGroupScaleRightFactor(
-            e.withNewPosition(Point<int>(0, 0))
-            .getEventRelativeTo(this->groupResizerNote), groupScaleFactor);
+        this->groupResizerNote->getGroupScaleRightFactor(newBeat, groupScaleFactor);
 
     if (scaleFactorChanged)
     {
@@ -129,12 +132,12 @@ void NoteResizerRight::mouseDrag(const MouseEvent &e)
         Array<Note> groupDragBefore, groupDragAfter;
         for (int i = 0; i < selection.getNumSelected(); ++i)
         {
-            auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+            auto *nc = selection.getItemAs<SelectableNote>(i);
             groupDragBefore.add(nc->getNote());
             groupDragAfter.add(nc->continueGroupScalingRight(groupScaleFactor));
         }
 
-        const auto &event = selection.getFirstAs<NoteComponent>()->getNote();
+        const auto &event = selection.getFirstAs<SelectableNote>()->getNote();
         auto *sequence = static_cast<PianoSequence *>(event.getSequence());
         sequence->changeGroup(groupDragBefore, groupDragAfter, true);
     }
@@ -148,20 +151,20 @@ void NoteResizerRight::mouseUp(const MouseEvent &e)
 
     for (int i = 0; i < selection.getNumSelected(); i++)
     {
-        auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-        nc->getRoll().hideAllGhostNotes();
+        auto *nc = selection.getItemAs<SelectableNote>(i);
+        this->roll.hideAllGhostNotes();
         nc->endGroupScalingLeft();
     }
 }
 
-NoteComponent *NoteResizerRight::findRightMostEvent(const Lasso &selection)
+SelectableNote *NoteResizerRight::findRightMostEvent(const Lasso &selection)
 {
-    NoteComponent *mc = nullptr;
+    SelectableNote *mc = nullptr;
     float rightMostBeat = -FLT_MAX;
 
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        auto *currentEvent = static_cast<NoteComponent *>(selection.getSelectedItem(i));
+        auto *currentEvent = selection.getItemAs<SelectableNote>(i);
         const float beatPlusLength = currentEvent->getBeat() + currentEvent->getLength();
 
         if (rightMostBeat < beatPlusLength)
@@ -178,7 +181,7 @@ void NoteResizerRight::updateBounds()
 {
     const auto &selection = this->roll.getLassoSelection();
     const float groupEndBeat = SequencerOperations::findEndBeat(selection);
-    const float clipBeat = selection.getFirstAs<NoteComponent>()->getClip().getBeat();
+    const float clipBeat = selection.getFirstAs<SelectableNote>()->getClip().getBeat();
 
     const int xAnchor = this->roll.getXPositionByBeat(groupEndBeat + clipBeat);
     const int yAnchor = this->roll.getViewport().getViewPositionY() + Globals::UI::rollHeaderHeight;
@@ -17,8 +17,8 @@
 
 #pragma once
 
-class RollBase;
-class NoteComponent;
+class PianoRoll;
+class SelectableNote;
 class Lasso;
 
 #include "IconComponent.h"
@@ -29,7 +29,7 @@ class NoteResizerRight final : public Component
 {
 public:
 
-    explicit NoteResizerRight(RollBase &parentRoll);
+    explicit NoteResizerRight(PianoRoll &parentRoll);
     ~NoteResizerRight();
 
     void updateBounds();
@@ -45,10 +45,10 @@ public:
 
 private:
 
-    NoteComponent *findRightMostEvent(const Lasso &);
+    SelectableNote *findRightMostEvent(const Lasso &);
 
-    RollBase &roll;
-    SafePointer<NoteComponent> groupResizerNote;
+    PianoRoll &roll;
+    SelectableNote *groupResizerNote = nullptr;
 
     ComponentFader fader;
     ComponentDragger dragger;
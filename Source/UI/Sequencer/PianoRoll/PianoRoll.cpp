@@ -29,6 +29,7 @@
 #include "ProjectMetadata.h"
 #include "Note.h"
 #include "NoteComponent.h"
+#include "SelectableNote.h"
 #include "NoteNameGuidesBar.h"
 #include "NotesTuningPanel.h"
 #include "HelperRectangle.h"
@@ -56,18 +57,19 @@
 #include "ComponentIDs.h"
 #include "Config.h"
 
-#define forEachEventOfGivenTrack(map, child, track) \
-    for (const auto &_c : map) \
-        if (_c.first.getPattern()->getTrack() == track) \
-            for (const auto &child : (*_c.second.get()))
-
-#define forEachSequenceMapOfGivenTrack(map, child, track) \
-    for (const auto &child : map) \
-        if (child.first.getPattern()->getTrack() == track)
+// the active clip is kept as a copy of the clip's parameters,
+// but the selectable notes need the clip itself
+static const Clip *findPatternClip(const Clip &clipParams)
+{
+    const auto *pattern = clipParams.getPattern();
+    if (pattern == nullptr)
+    {
+        return nullptr;
+    }
 
-#define forEachEventComponent(map, child) \
-    for (const auto &_c : this->patternMap) \
-        for (const auto &child : (*_c.second.get()))
+    const int index = pattern->indexOfSorted(&clipParams);
+    return index >= 0 ? pattern->getUnchecked(index) : nullptr;
+}
 
 #if PLATFORM_DESKTOP
 #   define PIANOROLL_HAS_NOTE_RESIZERS 0
@@ -101,14 +103,18 @@ PianoRoll::~PianoRoll() = default;
 
 void PianoRoll::reloadRollContent()
 {
-    this->selection.deselectAll();
-    this->patternMap.clear();
+    this->resetSelectableNotes();
+    this->notesIndex.clear();
 
     ROLL_BATCH_REPAINT_START
 
     for (const auto *track : this->project.getTracks())
     {
-        this->loadTrack(track);
+        // the tracks still being loaded will come in onLoadTrackContent
+        if (track->getSequence()->isLoaded())
+        {
+            this->loadTrack(track);
+        }
     }
 
     this->updateBackgroundCachesAndRepaint();
@@ -123,26 +129,13 @@ void PianoRoll::loadTrack(const MidiTrack *const track)
         return;
     }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
+    this->notesIndex[track] = make<RollSpatialIndex<Note>>();
+    for (int j = 0; j < track->getSequence()->size(); ++j)
     {
-        const Clip *clip = track->getPattern()->getUnchecked(i);
-
-        auto *sequenceMap = new SequenceMap();
-        this->patternMap[*clip] = UniquePointer<SequenceMap>(sequenceMap);
-
-        for (int j = 0; j < track->getSequence()->size(); ++j)
+        const MidiEvent *event = track->getSequence()->getUnchecked(j);
+        if (event->isTypeOf(MidiEvent::Type::Note))
         {
-            const MidiEvent *event = track->getSequence()->getUnchecked(j);
-            if (event->isTypeOf(MidiEvent::Type::Note))
-            {
-                const Note *note = static_cast<const Note *>(event);
-                auto *nc = new NoteComponent(*this, *note, *clip);
-                (*sequenceMap)[*note] = UniquePointer<NoteComponent>(nc);
-                const bool isActive = nc->belongsTo(this->activeTrack, this->activeClip);
-                nc->setActive(isActive, true);
-                this->addAndMakeVisible(nc);
-                nc->setFloatBounds(this->getEventBounds(nc));
-            }
+            this->updateIndexFor(*static_cast<const Note *>(event));
         }
     }
 }
@@ -196,21 +189,31 @@ void PianoRoll::updateSize()
 
 void PianoRoll::selectAll()
 {
-    forEachEventComponent(this->patternMap, e)
+    if (findPatternClip(this->activeClip) == nullptr)
+    {
+        return;
+    }
+
+    const auto *sequence = this->activeTrack->getSequence();
+    for (int i = 0; i < sequence->size(); ++i)
     {
-        auto *childComponent = e.second.get();
-        if (childComponent->belongsTo(this->activeTrack, activeClip))
+        const auto *event = sequence->getUnchecked(i);
+        if (event->isTypeOf(MidiEvent::Type::Note))
         {
-            this->selectEvent(childComponent, false);
+            const auto &note = static_cast<const Note &>(*event);
+            if (auto *selectableNote = this->getOrCreateSelectableNote(note))
+            {
+                this->selectEvent(selectableNote, false);
+            }
         }
     }
 }
 
 void PianoRoll::setChildrenInteraction(bool interceptsMouse, MouseCursor cursor)
 {
-    forEachEventComponent(this->patternMap, e)
+    for (const auto &it : this->noteComponents)
     {
-        auto *childComponent = e.second.get();
+        auto *childComponent = it.second.get();
         childComponent->setInterceptsMouseClicks(interceptsMouse, interceptsMouse);
         childComponent->setMouseCursor(cursor);
     }
@@ -252,9 +255,9 @@ float PianoRoll::findPreviousAnchorBeat(float beat) const
 // Ghost notes
 //===----------------------------------------------------------------------===//
 
-void PianoRoll::showGhostNoteFor(NoteComponent *target)
+void PianoRoll::showGhostNoteFor(SelectableNote &target)
 {
-    auto *component = new NoteComponent(*this, target->getNote(), target->getClip());
+    auto *component = new NoteComponent(*this, target);
     component->setEnabled(false);
 
     //component->setAlpha(0.2f); // setAlpha makes everything slower
@@ -287,15 +290,22 @@ void PianoRoll::longTapEvent(const Point<float> &position,
     if (!this->multiTouchController->hasMultitouch() &&
         !this->getEditMode().forbidsSelectionMode())
     {
-        const auto *nc = dynamic_cast<NoteComponent *>(target.get());
-        if (nc != nullptr && !nc->isActive())
+        const Clip *clip = nullptr;
+        const auto *note = (target == this) ? this->findInactiveNoteAt(position, clip) : nullptr;
+        if (note != nullptr)
         {
-            auto *track = nc->getNote().getSequence()->getTrack();
-            this->project.setEditableScope(track, nc->getClip(), false);
+            auto *track = note->getSequence()->getTrack();
+            this->project.setEditableScope(track, *clip, false);
             return;
         }
     }
 
+    // the pressed note is being edited:
+    if (this->pressedNote != nullptr)
+    {
+        return;
+    }
+
     // else - start dragging lasso, if needed:
     RollBase::longTapEvent(position, target);
 }
@@ -457,26 +467,8 @@ void PianoRoll::onChangeMidiEvent(const MidiEvent &oldEvent, const MidiEvent &ne
 {
     if (oldEvent.isTypeOf(MidiEvent::Type::Note))
     {
-        const auto &note = static_cast<const Note &>(oldEvent);
-        const auto &newNote = static_cast<const Note &>(newEvent);
-        const auto *track = newEvent.getSequence()->getTrack();
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-        {
-            auto &sequenceMap = *c.second.get();
-            if (auto *component = sequenceMap[note].release())
-            {
-                // Pass ownership to another key:
-                sequenceMap.erase(note);
-                // Hitting this assert means that a track somehow contains events
-                // with duplicate id's. This should never, ever happen.
-                jassert(!sequenceMap.contains(newNote));
-                // Always erase before updating, as it may happen both events have the same hash code:
-                sequenceMap[newNote] = UniquePointer<NoteComponent>(component);
-                // Schedule to be repainted later:
-                this->triggerBatchRepaintFor(component);
-            }
-        }
+        this->updateNote(static_cast<const Note &>(oldEvent),
+            static_cast<const Note &>(newEvent));
 
         // FIXME someday please: this is a kind of a really nasty hack,
         // and instead the guides bar should subscribe on project changes on its own,
@@ -508,40 +500,29 @@ void PianoRoll::onAddMidiEvent(const MidiEvent &event)
         const Note &note = static_cast<const Note &>(event);
         const auto *track = note.getSequence()->getTrack();
 
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-        {
-            auto &sequenceMap = *c.second.get();
-            const auto *targetParams = &c.first;
-            const int i = track->getPattern()->indexOfSorted(targetParams);
-            jassert(i >= 0);
-            
-            const Clip *realClip = track->getPattern()->getUnchecked(i);
-            auto *component = new NoteComponent(*this, note, *realClip);
-            sequenceMap[note] = UniquePointer<NoteComponent>(component);
-            this->addAndMakeVisible(component);
-
-            this->fader.fadeIn(component, Globals::UI::fadeInLong);
+        this->updateIndexFor(note);
+        this->triggerBatchRepaintForNote(note);
+
+        auto *selectableNote = (track == this->activeTrack.get()) ?
+            this->getOrCreateSelectableNote(note) : nullptr;
 
+        if (selectableNote != nullptr)
+        {
             // TODO check this in a more elegant way
             // (needed not to break shift+drag note copying)
             const bool isCurrentlyDraggingNote = this->draggingHelper->isVisible();
 
-            const bool isActive = component->belongsTo(this->activeTrack, this->activeClip);
-            component->setActive(isActive, true);
-
-            this->triggerBatchRepaintFor(component);
-
             // arpeggiators preview cannot work without that:
-            if (isActive && !isCurrentlyDraggingNote)
+            if (!isCurrentlyDraggingNote)
             {
-                this->selectEvent(component, false);
+                this->selectEvent(selectableNote, false);
             }
 
-            if (this->addNewNoteMode && isActive)
+            if (this->addNewNoteMode)
             {
-                this->newNoteDragging = component;
+                this->newNoteDragging = this->attachNoteComponent(note);
                 this->addNewNoteMode = false;
-                this->selectEvent(this->newNoteDragging, true); // clear prev selection
+                this->selectEvent(selectableNote, true); // clear prev selection
             }
         }
     }
@@ -562,21 +543,7 @@ void PianoRoll::onRemoveMidiEvent(const MidiEvent &event)
     {
         this->hideDragHelpers();
         this->hideAllGhostNotes(); // Avoids crash
-
-        const Note &note = static_cast<const Note &>(event);
-        const auto *track = note.getSequence()->getTrack();
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-        {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
-            {
-                NoteComponent *deletedComponent = sequenceMap[note].get();
-                this->fader.fadeOut(deletedComponent, Globals::UI::fadeOutLong);
-                this->selection.deselect(deletedComponent);
-                sequenceMap.erase(note);
-            }
-        }
+        this->removeNote(static_cast<const Note &>(event));
     }
     else if (event.isTypeOf(MidiEvent::Type::KeySignature))
     {
@@ -588,42 +555,80 @@ void PianoRoll::onRemoveMidiEvent(const MidiEvent &event)
     RollBase::onRemoveMidiEvent(event);
 }
 
-void PianoRoll::onAddClip(const Clip &clip)
+// Group operations always deal with the events of a single sequence,
+// so for notes all the per-event overhead is only done once per group:
+
+void PianoRoll::onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+    const Array<const MidiEvent *> &newEvents)
 {
-    const SequenceMap *referenceMap = nullptr;
-    const auto *track = clip.getPattern()->getTrack();
+    if (!oldEvents.getFirst()->isTypeOf(MidiEvent::Type::Note))
+    {
+        RollBase::onChangeMidiEvents(oldEvents, newEvents);
+        return;
+    }
 
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    for (int i = 0; i < oldEvents.size(); ++i)
     {
-        // Found a sequence map for the same track
-        referenceMap = c.second.get();
-        break;
+        this->updateNote(static_cast<const Note &>(*oldEvents.getUnchecked(i)),
+            static_cast<const Note &>(*newEvents.getUnchecked(i)));
     }
 
-    if (referenceMap == nullptr)
+    this->noteNameGuides->syncWithSelection(&this->selection);
+}
+
+void PianoRoll::onRemoveMidiEvents(const Array<const MidiEvent *> &events)
+{
+    if (!events.getFirst()->isTypeOf(MidiEvent::Type::Note))
     {
-        jassertfalse;
+        RollBase::onRemoveMidiEvents(events);
         return;
     }
 
-    auto *sequenceMap = new SequenceMap();
-    this->patternMap[clip] = UniquePointer<SequenceMap>(sequenceMap);
+    this->hideDragHelpers();
+    this->hideAllGhostNotes();
+
+    for (const auto *event : events)
+    {
+        this->removeNote(static_cast<const Note &>(*event));
+    }
+}
+
+void PianoRoll::updateNote(const Note &oldNote, const Note &newNote)
+{
+    this->updateIndexFor(newNote);
+
+    // the note is painted by the roll, unless it has a component attached
+    this->triggerBatchRepaintForNote(oldNote);
+    this->triggerBatchRepaintForNote(newNote);
 
-    for (const auto &e : *referenceMap)
+    if (auto *component = this->findNoteComponent(newNote))
     {
-        // reference the same note as neighbor components:
-        const auto &note = e.second.get()->getNote();
-        auto *component = new NoteComponent(*this, note, clip);
-        (*sequenceMap)[note] = UniquePointer<NoteComponent>(component);
-        this->addAndMakeVisible(component);
+        this->triggerBatchRepaintFor(component);
+    }
+}
 
-        const bool isActive = component->belongsTo(this->activeTrack, this->activeClip);
-        component->setActive(isActive);
+void PianoRoll::removeNote(const Note &note)
+{
+    this->removeFromIndex(note);
+    this->triggerBatchRepaintForNote(note);
 
-        this->batchRepaintList.add(component);
+    if (this->knifeToolHelper != nullptr)
+    {
+        this->knifeToolHelper->removeCutPointIfExists(note);
     }
 
-    this->triggerAsyncUpdate();
+    this->removeSelectableNote(note);
+}
+
+void PianoRoll::onAddClip(const Clip &clip)
+{
+    const auto *track = clip.getPattern()->getTrack();
+    if (!this->notesIndex.contains(track))
+    {
+        return; // the track is not loaded yet, see onLoadTrackContent
+    }
+
+    this->repaint(this->viewport.getViewArea());
 }
 
 void PianoRoll::onChangeClip(const Clip &clip, const Clip &newClip)
@@ -637,48 +642,48 @@ void PianoRoll::onChangeClip(const Clip &clip, const Clip &newClip)
         this->activeClip = newClip;
     }
 
-    if (auto *sequenceMap = this->patternMap[clip].release())
+    const auto *track = newClip.getPattern()->getTrack();
+    if (!this->notesIndex.contains(track))
     {
-        // Set new key for existing sequence map
-        this->patternMap.erase(clip);
-        this->patternMap[newClip] = UniquePointer<SequenceMap>(sequenceMap);
+        return;
+    }
 
-        // And update all components within it, as their beats should change
-        for (const auto &e : *sequenceMap)
+    if (newClip == this->activeClip)
+    {
+        // the attached components move with the clip
+        for (const auto &it : this->noteComponents)
         {
-            this->batchRepaintList.add(e.second.get());
+            this->batchRepaintList.add(it.second.get());
         }
 
-        if (newClip == this->activeClip)
-        {
-            this->updateActiveRangeIndicator();
-        }
+        this->updateActiveRangeIndicator();
 
         // Schedule batch repaint
         this->triggerAsyncUpdate();
     }
+
+    this->repaint(this->viewport.getViewArea());
 }
 
 void PianoRoll::onRemoveClip(const Clip &clip)
 {
-    ROLL_BATCH_REPAINT_START
-
-    if (this->patternMap.contains(clip))
+    // the notes stay in the index, which doesn't depend on clips,
+    // but the selectable notes refer to the active clip
+    if (clip == this->activeClip)
     {
-        this->patternMap.erase(clip);
+        this->resetSelectableNotes();
     }
 
-    ROLL_BATCH_REPAINT_END
+    this->repaint(this->viewport.getViewArea());
 }
 
 void PianoRoll::onChangeTrackProperties(MidiTrack *const track)
 {
     if (dynamic_cast<const PianoSequence *>(track->getSequence()))
     {
-        forEachEventOfGivenTrack(this->patternMap, e, track)
+        for (const auto &it : this->noteComponents)
         {
-            const auto component = e.second.get();
-            component->updateColours();
+            it.second->updateColours();
         }
 
         this->updateActiveRangeIndicator(); // colour might have changed
@@ -694,6 +699,20 @@ void PianoRoll::onChangeTrackBeatRange(MidiTrack *const track)
     }
 }
 
+void PianoRoll::onLoadTrackContent(MidiTrack *const track)
+{
+    const auto *pattern = track->getPattern();
+    if (pattern == nullptr || pattern->size() == 0 ||
+        this->notesIndex.contains(track))
+    {
+        return; // already loaded in reloadRollContent
+    }
+
+    ROLL_BATCH_REPAINT_START
+    this->loadTrack(track);
+    ROLL_BATCH_REPAINT_END
+}
+
 void PianoRoll::onAddTrack(MidiTrack *const track)
 {
     ROLL_BATCH_REPAINT_START
@@ -723,6 +742,11 @@ void PianoRoll::onRemoveTrack(MidiTrack *const track)
     this->hideDragHelpers();
     this->hideAllGhostNotes(); // Avoids crash
 
+    if (track == this->activeTrack)
+    {
+        this->resetSelectableNotes();
+    }
+
     for (int i = 0; i < track->getSequence()->size(); ++i)
     {
         const auto *event = track->getSequence()->getUnchecked(i);
@@ -733,14 +757,7 @@ void PianoRoll::onRemoveTrack(MidiTrack *const track)
         }
     }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
-    {
-        const auto &clip = *track->getPattern()->getUnchecked(i);
-        if (this->patternMap.contains(clip))
-        {
-            this->patternMap.erase(clip);
-        }
-    }
+    this->notesIndex.erase(track);
 
     this->repaint();
 }
@@ -798,7 +815,15 @@ void PianoRoll::onChangeViewEditableScope(MidiTrack *const newActiveTrack,
         this->lassoComponent->endLasso();
     }
 
-    this->selection.deselectAll();
+    // the selectable notes and their components only exist in the active clip
+    this->resetSelectableNotes();
+
+    // the track being edited can't wait for the background prefetch
+    if (newActiveTrack != nullptr && !newActiveTrack->getSequence()->isLoaded())
+    {
+        newActiveTrack->getSequence()->ensureLoaded();
+        this->onLoadTrackContent(newActiveTrack);
+    }
 
     this->activeTrack = newActiveTrack;
     this->activeClip = newActiveClip;
@@ -807,22 +832,25 @@ void PianoRoll::onChangeViewEditableScope(MidiTrack *const newActiveTrack,
     int focusMaxKey = 0;
     float focusMinBeat = FLT_MAX;
     float focusMaxBeat = -FLT_MAX;
-    bool hasComponentsToFocusOn = false;
+    bool hasNotesToFocusOn = false;
 
-    forEachEventComponent(this->patternMap, e)
+    // the focus area is found from the active track's notes:
+    if (shouldFocus && this->activeTrack != nullptr)
     {
-        auto *nc = e.second.get();
-        const bool isActive = nc->belongsTo(this->activeTrack, this->activeClip);
-        const auto key = nc->getKey() + this->activeClip.getKey();
-        nc->setActive(isActive, true);
-
-        if (shouldFocus && isActive)
+        const auto *sequence = this->activeTrack->getSequence();
+        for (int i = 0; i < sequence->size(); ++i)
         {
-            hasComponentsToFocusOn = true;
-            focusMinKey = jmin(focusMinKey, key);
-            focusMaxKey = jmax(focusMaxKey, key);
-            focusMinBeat = jmin(focusMinBeat, nc->getBeat());
-            focusMaxBeat = jmax(focusMaxBeat, nc->getBeat() + nc->getLength());
+            const auto *event = sequence->getUnchecked(i);
+            if (event->isTypeOf(MidiEvent::Type::Note))
+            {
+                const auto &note = static_cast<const Note &>(*event);
+                const auto key = note.getKey() + this->activeClip.getKey();
+                hasNotesToFocusOn = true;
+                focusMinKey = jmin(focusMinKey, key);
+                focusMaxKey = jmax(focusMaxKey, key);
+                focusMinBeat = jmin(focusMinBeat, note.getBeat());
+                focusMaxBeat = jmax(focusMaxBeat, note.getBeat() + note.getLength());
+            }
         }
     }
 
@@ -830,7 +858,7 @@ void PianoRoll::onChangeViewEditableScope(MidiTrack *const newActiveTrack,
 
     if (shouldFocus)
     {
-        if (!hasComponentsToFocusOn)
+        if (!hasNotesToFocusOn)
         {
             // zoom settings for empty tracks:
             const auto middleC = this->getTemperament()->getMiddleC();
@@ -864,27 +892,45 @@ void PianoRoll::selectEventsInRange(float startBeat, float endBeat, bool shouldC
         this->selection.deselectAll();
     }
 
-    forEachEventComponent(this->patternMap, e)
+    const auto *clip = findPatternClip(this->activeClip);
+    const auto index = this->notesIndex.find(this->activeTrack.get());
+    if (clip == nullptr || index == this->notesIndex.end())
     {
-        auto *component = e.second.get();
-        if (component->isActive() &&
-            (component->getNote().getBeat() + component->getClip().getBeat()) >= startBeat &&
-            (component->getNote().getBeat() + component->getClip().getBeat()) < endBeat)
+        return;
+    }
+
+    Array<const Note *> found;
+    index->second->forEachInRange(startBeat - clip->getBeat(), endBeat - clip->getBeat(),
+        INT_MIN, INT_MAX, [&found](Note *note) { found.add(note); });
+
+    for (const auto *note : found)
+    {
+        if ((note->getBeat() + clip->getBeat()) >= startBeat &&
+            (note->getBeat() + clip->getBeat()) < endBeat)
         {
-            this->selectEvent(component, false);
+            if (auto *selectableNote = this->getOrCreateSelectableNote(*note))
+            {
+                this->selectEvent(selectableNote, false);
+            }
         }
     }
 }
 
-void PianoRoll::findLassoItemsInArea(Array<SelectableComponent *> &itemsFound, const Rectangle<int> &rectangle)
+void PianoRoll::findLassoItemsInArea(Array<SelectableItem *> &itemsFound, const Rectangle<int> &rectangle)
 {
-    forEachEventComponent(this->patternMap, e)
+    const auto *clip = findPatternClip(this->activeClip);
+    if (clip == nullptr)
+    {
+        return;
+    }
+
+    // the lasso selects the notes themselves, without creating any components
+    for (const auto *note : this->findNotesInArea(*clip, rectangle.toFloat()))
     {
-        auto *component = e.second.get();
-        if (rectangle.intersects(component->getBounds()) && component->isActive())
+        if (auto *selectableNote = this->getOrCreateSelectableNote(*note))
         {
-            jassert(!itemsFound.contains(component));
-            itemsFound.add(component);
+            jassert(!itemsFound.contains(selectableNote));
+            itemsFound.add(selectableNote);
         }
     }
 }
@@ -909,7 +955,29 @@ void PianoRoll::mouseDown(const MouseEvent &e)
     {
         return;
     }
-    
+
+    // the notes only have components while hovered, so the roll
+    // hit-tests the notes under the presses that come to it directly:
+    const bool canPressNotes = e.originalComponent == this &&
+        !this->isUsingSpaceDraggingMode() &&
+        this->project.getEditMode().shouldInteractWithChildren();
+
+    // (the right clicks in the default mode are for the roll anyway, see NoteComponent::mouseDown)
+    const bool isRollClick = e.mods.isRightButtonDown() &&
+        this->project.getEditMode().isMode(RollEditMode::defaultMode);
+
+    const auto *activeNote = canPressNotes ? this->findActiveNoteAt(e.position) : nullptr;
+    if (activeNote != nullptr && !isRollClick)
+    {
+        this->pressedNote = this->attachNoteComponent(*activeNote);
+        if (this->pressedNote != nullptr)
+        {
+            this->setInterceptsMouseClicks(true, false);
+            this->pressedNote->mouseDown(e.getEventRelativeTo(this->pressedNote));
+            return;
+        }
+    }
+
     if (! this->isUsingSpaceDraggingMode())
     {
         this->setInterceptsMouseClicks(true, false);
@@ -925,6 +993,36 @@ void PianoRoll::mouseDown(const MouseEvent &e)
     }
 
     RollBase::mouseDown(e);
+
+    // alt-click or right-click on the other clips' notes switches to them:
+    if (canPressNotes && activeNote == nullptr &&
+        (e.mods.isAltDown() || e.mods.isRightButtonDown()))
+    {
+        const Clip *clip = nullptr;
+        if (const auto *note = this->findInactiveNoteAt(e.position, clip))
+        {
+            const bool zoomToScope = e.mods.isAnyModifierKeyDown();
+            this->project.setEditableScope(note->getSequence()->getTrack(), *clip, zoomToScope);
+            if (zoomToScope)
+            {
+                this->zoomOutImpulse(0.5f);
+            }
+        }
+    }
+}
+
+void PianoRoll::mouseMove(const MouseEvent &e)
+{
+    // attaches a component to the hovered note, so that it can be edited
+    const auto *hoveredNote = this->project.getEditMode().shouldInteractWithChildren() ?
+        this->findActiveNoteAt(e.position) : nullptr;
+
+    this->detachIdleNoteComponents(hoveredNote);
+
+    if (hoveredNote != nullptr)
+    {
+        this->attachNoteComponent(*hoveredNote);
+    }
 }
 
 void PianoRoll::mouseDoubleClick(const MouseEvent &e)
@@ -945,9 +1043,15 @@ void PianoRoll::mouseDrag(const MouseEvent &e)
         return;
     }
 
+    if (this->pressedNote != nullptr)
+    {
+        this->pressedNote->mouseDrag(e.getEventRelativeTo(this->pressedNote));
+        return;
+    }
+
     if (this->newNoteDragging != nullptr)
     {
-        if (this->newNoteDragging->isInEditMode())
+        if (this->newNoteDragging->getSelectableNote().isInEditMode())
         {
             this->newNoteDragging->mouseDrag(e.getEventRelativeTo(this->newNoteDragging));
         }
@@ -972,13 +1076,24 @@ void PianoRoll::mouseUp(const MouseEvent &e)
     {
         return;
     }
-    
+
+    if (this->pressedNote != nullptr)
+    {
+        this->pressedNote->mouseUp(e.getEventRelativeTo(this->pressedNote));
+        this->pressedNote = nullptr;
+        this->setInterceptsMouseClicks(true, true);
+        // there might be no mouse moves to detach it later, e.g. on touch screens
+        this->detachIdleNoteComponents(nullptr);
+        return;
+    }
+
     // Dismiss newNoteDragging, if needed
     if (this->newNoteDragging != nullptr)
     {
         this->newNoteDragging->mouseUp(e.getEventRelativeTo(this->newNoteDragging));
         this->setMouseCursor(this->project.getEditMode().getCursor());
         this->newNoteDragging = nullptr;
+        this->detachIdleNoteComponents(nullptr);
     }
 
     this->endCuttingEventsIfNeeded();
@@ -1169,8 +1284,8 @@ void PianoRoll::handleCommandMessage(int commandId)
             Array<Note> selectedNotes;
             for (int i = 0; i < this->selection.getNumSelected(); ++i)
             {
-                const auto nc = static_cast<NoteComponent *>(this->selection.getSelectedItem(i));
-                selectedNotes.add(nc->getNote());
+                const auto *note = this->selection.getItemAs<SelectableNote>(i);
+                selectedNotes.add(note->getNote());
             }
 
             Note::Key contextKey = 0;
@@ -1312,10 +1427,9 @@ void PianoRoll::resized()
 
     ROLL_BATCH_REPAINT_START
 
-    forEachEventComponent(this->patternMap, e)
+    for (const auto &it : this->noteComponents)
     {
-        const auto component = e.second.get();
-        component->setFloatBounds(this->getEventBounds(component));
+        it.second->setFloatBounds(this->getEventBounds(it.second.get()));
     }
 
     for (const auto component : this->ghostNotes)
@@ -1390,6 +1504,7 @@ void PianoRoll::paint(Graphics &g)
         if (beatX >= paintEndX)
         {
             RollBase::paint(g);
+            this->paintNotes(g);
             return;
         }
 
@@ -1410,6 +1525,7 @@ void PianoRoll::paint(Graphics &g)
         }
 
         RollBase::paint(g);
+        this->paintNotes(g);
     }
 }
 
@@ -1440,16 +1556,26 @@ void PianoRoll::switchToClipInViewport() const
 
     FlatHashMap<Clip, int, ClipHash> visibilityWeights;
 
-    forEachEventComponent(this->patternMap, e)
+    for (const auto &it : this->notesIndex)
     {
-        auto *nc = e.second.get();
-        if (nc->getBounds().intersects(centreArea))
+        const auto *pattern = it.first->getPattern();
+        for (int i = 0; i < pattern->size(); ++i)
         {
-            visibilityWeights[nc->getClip()] += 4;
-        }
-        else if (nc->getBounds().intersects(fullArea))
-        {
-            visibilityWeights[nc->getClip()] += 1;
+            const auto &clip = *pattern->getUnchecked(i);
+            for (const auto *note : this->findNotesInArea(clip, fullArea.toFloat()))
+            {
+                const auto noteBounds = this->getEventBounds(note->getKey() + clip.getKey(),
+                    note->getBeat() + clip.getBeat(), note->getLength()).toNearestInt();
+
+                if (noteBounds.intersects(centreArea))
+                {
+                    visibilityWeights[clip] += 4;
+                }
+                else if (noteBounds.intersects(fullArea))
+                {
+                    visibilityWeights[clip] += 1;
+                }
+            }
         }
     }
 
@@ -1493,36 +1619,38 @@ void PianoRoll::continueCuttingEvents(const MouseEvent &event)
         this->knifeToolHelper->setEndPosition(event.position);
         this->knifeToolHelper->updateBounds();
 
-        bool addsPoint;
+        const auto *clip = findPatternClip(this->activeClip);
+        if (clip == nullptr)
+        {
+            return;
+        }
+
+        const auto &line = this->knifeToolHelper->getLine();
+        const Rectangle<float> lineArea(line.getStart(), line.getEnd());
+
+        Array<Note> cutNotes;
         Point<float> intersection;
-        forEachEventComponent(this->patternMap, e)
+        for (const auto *note : this->findNotesInArea(*clip, lineArea.expanded(1.f)))
         {
-            addsPoint = false;
-            auto *nc = e.second.get();
-            if (nc->isActive())
-            {
-                const int h2 = nc->getHeight() / 2;
-                const Line<float> noteLine(nc->getPosition().translated(0, h2).toFloat(),
-                    nc->getPosition().translated(nc->getWidth(), h2).toFloat());
+            const auto noteBounds = this->getEventBounds(note->getKey() + clip->getKey(),
+                note->getBeat() + clip->getBeat(), note->getLength());
+            const Line<float> noteLine(noteBounds.getX(), noteBounds.getCentreY(),
+                noteBounds.getRight(), noteBounds.getCentreY());
 
-                if (this->knifeToolHelper->getLine().intersects(noteLine, intersection))
-                {
-                    const float relativeCutBeat = this->getRoundBeatSnapByXPosition(int(intersection.getX()))
-                        - this->activeClip.getBeat() - nc->getBeat();
- 
-                    if (relativeCutBeat > 0.f && relativeCutBeat < nc->getLength())
-                    {
-                        addsPoint = true;
-                        this->knifeToolHelper->addOrUpdateCutPoint(nc, relativeCutBeat);
-                    }
-                }
+            if (line.intersects(noteLine, intersection))
+            {
+                const float relativeCutBeat = this->getRoundBeatSnapByXPosition(int(intersection.getX()))
+                    - this->activeClip.getBeat() - note->getBeat();
 
-                if (!addsPoint)
+                if (relativeCutBeat > 0.f && relativeCutBeat < note->getLength())
                 {
-                    this->knifeToolHelper->removeCutPointIfExists(nc->getNote());
+                    this->knifeToolHelper->addOrUpdateCutPoint(*note, *clip, relativeCutBeat);
+                    cutNotes.add(*note);
                 }
             }
         }
+
+        this->knifeToolHelper->removeCutPointsExcept(cutNotes);
     }
 }
 
@@ -1535,19 +1663,23 @@ void PianoRoll::endCuttingEventsIfNeeded()
         this->knifeToolHelper->getCutPoints(notes, beats);
         Array<Note> cutEventsToTheRight = SequencerOperations::cutEvents(notes, beats);
         // Now select all the new notes:
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, this->activeTrack)
+        const auto *sequence = this->activeTrack->getSequence();
+        for (const auto &note : cutEventsToTheRight)
         {
-            auto &sequenceMap = *c.second.get();
-            for (const auto &note : cutEventsToTheRight)
+            const int index = sequence->indexOfSorted(&note);
+            if (index < 0)
             {
-                if (auto *component = sequenceMap[note].get())
-                {
-                    this->selectEvent(component, false);
-                }
+                continue;
+            }
+
+            const auto &newNote = static_cast<const Note &>(*sequence->getUnchecked(index));
+            if (auto *selectableNote = this->getOrCreateSelectableNote(newNote))
+            {
+                this->selectEvent(selectableNote, false);
             }
         }
 
-        this->applyEditModeUpdates(); // update behaviour of newly created note components
+        this->applyEditModeUpdates(); // update behaviour of the attached note components
         this->knifeToolHelper = nullptr;
     }
 }
@@ -1558,6 +1690,13 @@ void PianoRoll::endCuttingEventsIfNeeded()
 
 void PianoRoll::handleAsyncUpdate()
 {
+    // the notes painted by the roll itself
+    if (!this->notesRepaintArea.isEmpty())
+    {
+        this->repaint(this->notesRepaintArea.getIntersection(this->viewport.getViewArea()));
+        this->notesRepaintArea = {};
+    }
+
 #if PIANOROLL_HAS_NOTE_RESIZERS
     // resizers for the mobile version
     if (this->selection.getNumSelected() > 0 &&
@@ -1651,6 +1790,331 @@ void PianoRoll::updateChildrenPositions()
     RollBase::updateChildrenPositions();
 }
 
+//===----------------------------------------------------------------------===//
+// Notes
+//===----------------------------------------------------------------------===//
+
+// The notes are only kept in the spatial index, and the roll paints them by itself,
+// so that the layout and painting costs depend on the viewport size, not on the project size;
+// the selection is made of the lightweight selectable notes, created for the active clip on demand,
+// and the components are only attached to the notes being hovered, pressed or edited.
+
+SelectableNote *PianoRoll::findSelectableNote(const Note &note) const
+{
+    const auto found = this->selectableNotes.find(&note);
+    return found != this->selectableNotes.end() ? found->second.get() : nullptr;
+}
+
+SelectableNote *PianoRoll::getOrCreateSelectableNote(const Note &note)
+{
+    if (auto *selectableNote = this->findSelectableNote(note))
+    {
+        return selectableNote;
+    }
+
+    jassert(note.getSequence()->getTrack() == this->activeTrack.get());
+    const auto *clip = findPatternClip(this->activeClip);
+    if (clip == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto *selectableNote = new SelectableNote(*this, note, *clip);
+    this->selectableNotes[&note] = UniquePointer<SelectableNote>(selectableNote);
+    return selectableNote;
+}
+
+void PianoRoll::removeSelectableNote(const Note &note)
+{
+    const auto found = this->selectableNotes.find(&note);
+    if (found == this->selectableNotes.end())
+    {
+        return;
+    }
+
+    this->detachNoteComponent(note);
+    this->selection.deselect(found->second.get());
+    this->selectableNotes.erase(found);
+}
+
+void PianoRoll::resetSelectableNotes()
+{
+    this->selection.deselectAll();
+    this->hideAllGhostNotes();
+    this->newNoteDragging = nullptr;
+    this->pressedNote = nullptr;
+    this->noteComponents.clear();
+    this->selectableNotes.clear();
+}
+
+void PianoRoll::updateNoteSelection(const SelectableNote &note)
+{
+    if (auto *component = this->findNoteComponent(note.getNote()))
+    {
+        component->updateColours();
+        this->triggerBatchRepaintFor(component);
+    }
+    else
+    {
+        this->triggerBatchRepaintForNote(note.getNote(), note.getClip());
+    }
+}
+
+NoteComponent *PianoRoll::findNoteComponent(const Note &note) const
+{
+    const auto found = this->noteComponents.find(&note);
+    return found != this->noteComponents.end() ? found->second.get() : nullptr;
+}
+
+NoteComponent *PianoRoll::attachNoteComponent(const Note &note)
+{
+    if (auto *component = this->findNoteComponent(note))
+    {
+        return component;
+    }
+
+    auto *selectableNote = this->getOrCreateSelectableNote(note);
+    if (selectableNote == nullptr)
+    {
+        jassertfalse;
+        return nullptr;
+    }
+
+    auto *component = new NoteComponent(*this, *selectableNote);
+    this->noteComponents[&note] = UniquePointer<NoteComponent>(component);
+    component->setActive(true, true);
+
+    // the same as in applyEditModeUpdates
+    const auto &editMode = this->project.getEditMode();
+    const bool interactsWithChildren = editMode.shouldInteractWithChildren();
+    component->setInterceptsMouseClicks(interactsWithChildren, interactsWithChildren);
+    component->setMouseCursor(interactsWithChildren ? MouseCursor::NormalCursor : editMode.getCursor());
+
+    component->setFloatBounds(this->getEventBounds(component));
+    this->addAndMakeVisible(component);
+    this->noteNameGuides->toFront(false);
+    return component;
+}
+
+void PianoRoll::detachNoteComponent(const Note &note)
+{
+    const auto found = this->noteComponents.find(&note);
+    if (found == this->noteComponents.end())
+    {
+        return;
+    }
+
+    auto *component = found->second.get();
+    if (component == this->newNoteDragging)
+    {
+        this->newNoteDragging = nullptr;
+    }
+
+    if (component == this->pressedNote)
+    {
+        this->pressedNote = nullptr;
+    }
+
+    this->repaint(component->getBounds());
+    this->noteComponents.erase(found);
+}
+
+void PianoRoll::detachIdleNoteComponents(const Note *noteToKeep)
+{
+    Array<const Note *> idleNotes;
+    for (const auto &it : this->noteComponents)
+    {
+        const auto *component = it.second.get();
+        if (it.first != noteToKeep &&
+            component != this->newNoteDragging &&
+            component != this->pressedNote &&
+            !component->getSelectableNote().isInEditMode())
+        {
+            idleNotes.add(it.first);
+        }
+    }
+
+    for (const auto *note : idleNotes)
+    {
+        this->detachNoteComponent(*note);
+    }
+}
+
+const Note *PianoRoll::findActiveNoteAt(const Point<float> &position) const
+{
+    const auto *clip = findPatternClip(this->activeClip);
+    if (clip == nullptr)
+    {
+        return nullptr;
+    }
+
+    // the last one is painted on top of the others
+    return this->findNotesInArea(*clip, { position.x, position.y, 1.f, 1.f }).getLast();
+}
+
+const Note *PianoRoll::findInactiveNoteAt(const Point<float> &position, const Clip *&outClip) const
+{
+    const Rectangle<float> area(position.x, position.y, 1.f, 1.f);
+    for (const auto &it : this->notesIndex)
+    {
+        const auto *pattern = it.first->getPattern();
+        for (int i = 0; i < pattern->size(); ++i)
+        {
+            const auto *clip = pattern->getUnchecked(i);
+            if (*clip == this->activeClip)
+            {
+                continue;
+            }
+
+            if (const auto *note = this->findNotesInArea(*clip, area).getLast())
+            {
+                outClip = clip;
+                return note;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void PianoRoll::paintNotes(Graphics &g) const
+{
+    const auto area = g.getClipBounds().toFloat();
+
+    // the other clips' notes go below the active ones, as the ghosts
+    for (const auto &it : this->notesIndex)
+    {
+        if (it.second->isEmpty())
+        {
+            continue;
+        }
+
+        const auto *pattern = it.first->getPattern();
+        const auto palette = NoteComponent::makePalette(it.first->getTrackColour(), true, false);
+        for (int i = 0; i < pattern->size(); ++i)
+        {
+            const auto &clip = *pattern->getUnchecked(i);
+            if (clip == this->activeClip)
+            {
+                continue;
+            }
+
+            for (const auto *note : this->findNotesInArea(clip, area))
+            {
+                NoteComponent::paintNote(g, this->getEventBounds(note->getKey() + clip.getKey(),
+                    note->getBeat() + clip.getBeat(), note->getLength()), *note, clip, palette);
+            }
+        }
+    }
+
+    const auto *clip = findPatternClip(this->activeClip);
+    if (clip == nullptr)
+    {
+        return;
+    }
+
+    const auto trackColour = this->activeTrack->getTrackColour();
+    const auto palette = NoteComponent::makePalette(trackColour, false, false);
+    const auto selectedPalette = NoteComponent::makePalette(trackColour, false, true);
+
+    // the selected notes go on top of the others,
+    // and the ones with components attached paint themselves
+    Array<const Note *> selectedNotes;
+    for (const auto *note : this->findNotesInArea(*clip, area))
+    {
+        if (this->noteComponents.contains(note))
+        {
+            continue;
+        }
+
+        const auto *selectableNote = this->findSelectableNote(*note);
+        if (selectableNote != nullptr && selectableNote->isSelected())
+        {
+            selectedNotes.add(note);
+            continue;
+        }
+
+        NoteComponent::paintNote(g, this->getEventBounds(note->getKey() + clip->getKey(),
+            note->getBeat() + clip->getBeat(), note->getLength()), *note, *clip, palette);
+    }
+
+    for (const auto *note : selectedNotes)
+    {
+        NoteComponent::paintNote(g, this->getEventBounds(note->getKey() + clip->getKey(),
+            note->getBeat() + clip->getBeat(), note->getLength()), *note, *clip, selectedPalette);
+    }
+}
+
+void PianoRoll::triggerBatchRepaintForNote(const Note &note, const Clip &clip)
+{
+    const auto bounds = this->getEventBounds(note.getKey() + clip.getKey(),
+        note.getBeat() + clip.getBeat(), note.getLength());
+
+    this->notesRepaintArea = this->notesRepaintArea.getUnion(bounds.getSmallestIntegerContainer().expanded(1));
+    this->triggerAsyncUpdate();
+}
+
+void PianoRoll::triggerBatchRepaintForNote(const Note &note)
+{
+    const auto *pattern = note.getSequence()->getTrack()->getPattern();
+    if (pattern == nullptr)
+    {
+        return;
+    }
+
+    for (int i = 0; i < pattern->size(); ++i)
+    {
+        this->triggerBatchRepaintForNote(note, *pattern->getUnchecked(i));
+    }
+}
+
+void PianoRoll::updateIndexFor(const Note &note)
+{
+    const auto index = this->notesIndex.find(note.getSequence()->getTrack());
+    if (index != this->notesIndex.end()) // the tracks not loaded yet are indexed in loadTrack
+    {
+        index->second->update(&note, note.getBeat(),
+            note.getBeat() + note.getLength(), note.getKey(), note.getKey());
+    }
+}
+
+void PianoRoll::removeFromIndex(const Note &note)
+{
+    const auto index = this->notesIndex.find(note.getSequence()->getTrack());
+    if (index != this->notesIndex.end())
+    {
+        index->second->remove(&note);
+    }
+}
+
+Array<const Note *> PianoRoll::findNotesInArea(const Clip &clip, const Rectangle<float> &area) const
+{
+    const auto index = this->notesIndex.find(clip.getPattern()->getTrack());
+    if (index == this->notesIndex.end())
+    {
+        return {};
+    }
+
+    const auto startBeat = area.getX() / this->beatWidth + this->firstBeat - clip.getBeat();
+    const auto endBeat = area.getRight() / this->beatWidth + this->firstBeat - clip.getBeat();
+    // the keys go bottom-up, see getYPositionByKey, and a key of margin is fine
+    const auto firstKey = int(floorf((this->getHeight() - area.getBottom()) / this->rowHeight)) - 1 - clip.getKey();
+    const auto lastKey = int(ceilf((this->getHeight() - area.getY()) / this->rowHeight)) + 1 - clip.getKey();
+
+    Array<const Note *> result;
+    index->second->forEachInRange(startBeat, endBeat, firstKey, lastKey,
+        [this, &clip, &area, &result](Note *note)
+        {
+            if (area.intersects(this->getEventBounds(note->getKey() + clip.getKey(),
+                note->getBeat() + clip.getBeat(), note->getLength())))
+            {
+                result.add(note);
+            }
+        });
+
+    return result;
+}
+
 //===----------------------------------------------------------------------===//
 // Command Palette
 //===----------------------------------------------------------------------===//
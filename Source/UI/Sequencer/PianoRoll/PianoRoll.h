@@ -19,6 +19,7 @@
 
 class MidiSequence;
 class NoteComponent;
+class SelectableNote;
 class PianoRollSelectionMenuManager;
 class CommandPaletteChordConstructor;
 class CommandPaletteMoveNotesMenu;
@@ -35,6 +36,7 @@ class Scale;
 #include "NoteResizerRight.h"
 #include "HighlightingScheme.h"
 #include "CommandPaletteModel.h"
+#include "RollSpatialIndex.h"
 #include "MidiTrack.h"
 
 class PianoRoll final : public RollBase, public CommandPaletteModel
@@ -57,7 +59,7 @@ public:
     // Ghost notes
     //===------------------------------------------------------------------===//
     
-    void showGhostNoteFor(NoteComponent *targetNoteComponent);
+    void showGhostNoteFor(SelectableNote &targetNote);
     void hideAllGhostNotes();
     
     //===------------------------------------------------------------------===//
@@ -101,6 +103,10 @@ public:
     void onAddMidiEvent(const MidiEvent &event) override;
     void onRemoveMidiEvent(const MidiEvent &event) override;
 
+    void onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents) override;
+    void onRemoveMidiEvents(const Array<const MidiEvent *> &events) override;
+
     void onAddClip(const Clip &clip) override;
     void onChangeClip(const Clip &oldClip, const Clip &newClip) override;
     void onRemoveClip(const Clip &clip) override;
@@ -109,6 +115,7 @@ public:
     void onRemoveTrack(MidiTrack *const track) override;
     void onChangeTrackProperties(MidiTrack *const track) override;
     void onChangeTrackBeatRange(MidiTrack *const track) override;
+    void onLoadTrackContent(MidiTrack *const track) override;
 
     void onChangeProjectInfo(const ProjectMetadata *info) override;
     void onReloadProjectContent(const Array<MidiTrack *> &tracks,
@@ -132,7 +139,7 @@ public:
     void selectEventsInRange(float startBeat,
         float endBeat, bool shouldClearAllOthers) override;
 
-    void findLassoItemsInArea(Array<SelectableComponent *> &itemsFound,
+    void findLassoItemsInArea(Array<SelectableItem *> &itemsFound,
         const Rectangle<int> &rectangle) override;
 
     float getLassoStartBeat() const;
@@ -142,6 +149,7 @@ public:
     // Component
     //===------------------------------------------------------------------===//
 
+    void mouseMove(const MouseEvent &e) override;
     void mouseDown(const MouseEvent &e) override;
     void mouseDoubleClick(const MouseEvent &e) override;
     void mouseUp(const MouseEvent &e) override;
@@ -193,6 +201,45 @@ private:
     void reloadRollContent();
     void loadTrack(const MidiTrack *const track);
 
+    // the roll paints all notes by itself, see paintNotes, and the selection
+    // is made of the selectable notes, which only exist for the active clip:
+    FlatHashMap<const Note *, UniquePointer<SelectableNote>> selectableNotes;
+    SelectableNote *findSelectableNote(const Note &note) const;
+    SelectableNote *getOrCreateSelectableNote(const Note &note);
+    void removeSelectableNote(const Note &note);
+    void resetSelectableNotes();
+
+    friend class SelectableNote;
+    void updateNoteSelection(const SelectableNote &note);
+
+    // the note components are only attached to the active clip's notes
+    // being hovered, pressed or edited, and are detached when idle:
+    FlatHashMap<const Note *, UniquePointer<NoteComponent>> noteComponents;
+    NoteComponent *findNoteComponent(const Note &note) const;
+    NoteComponent *attachNoteComponent(const Note &note);
+    void detachNoteComponent(const Note &note);
+    void detachIdleNoteComponents(const Note *noteToKeep);
+
+    const Note *findActiveNoteAt(const Point<float> &position) const;
+    const Note *findInactiveNoteAt(const Point<float> &position, const Clip *&outClip) const;
+
+    void paintNotes(Graphics &g) const;
+
+    // the area of the notes changed since the last repaint, see handleAsyncUpdate
+    Rectangle<int> notesRepaintArea;
+    void triggerBatchRepaintForNote(const Note &note, const Clip &clip);
+    void triggerBatchRepaintForNote(const Note &note); // in all clips
+
+    // all notes of the loaded tracks by beats and keys, relative to their clips,
+    // kept up to date from the project listener callbacks, used for the area queries:
+    FlatHashMap<const MidiTrack *, UniquePointer<RollSpatialIndex<Note>>> notesIndex;
+    void updateIndexFor(const Note &note);
+    void removeFromIndex(const Note &note);
+    Array<const Note *> findNotesInArea(const Clip &clip, const Rectangle<float> &area) const;
+
+    void updateNote(const Note &oldNote, const Note &newNote);
+    void removeNote(const Note &note);
+
     void updateSize();
     void updateChildrenBounds() override;
     void updateChildrenPositions() override;
@@ -208,6 +255,9 @@ private:
     void endCuttingEventsIfNeeded();
 
     NoteComponent *newNoteDragging = nullptr;
+    // the roll gets the presses on the notes without components,
+    // e.g. on touch screens, so it passes the events on to them:
+    NoteComponent *pressedNote = nullptr;
     bool addNewNoteMode = false;
     float newNoteVolume = Globals::Defaults::newNoteVelocity;
     float newNoteLength = Globals::Defaults::newNoteLength;
@@ -260,10 +310,6 @@ private:
     UniquePointer<CommandPaletteMoveNotesMenu> consoleMoveNotesMenu;
     UniquePointer<CommandPaletteChordConstructor> consoleChordConstructor;
 
-    using SequenceMap = FlatHashMap<Note, UniquePointer<NoteComponent>, MidiEventHash>;
-    using PatternMap = FlatHashMap<Clip, UniquePointer<SequenceMap>, ClipHash>;
-    PatternMap patternMap;
-
 private:
 
 #if PLATFORM_DESKTOP
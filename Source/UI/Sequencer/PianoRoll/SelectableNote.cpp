@@ -0,0 +1,407 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "SelectableNote.h"
+#include "PianoRoll.h"
+#include "MidiSequence.h"
+
+SelectableNote::SelectableNote(PianoRoll &roll, const Note &note, const Clip &clip) noexcept :
+    roll(roll),
+    note(note),
+    clip(clip) {}
+
+PianoRoll &SelectableNote::getRoll() const noexcept
+{
+    return this->roll;
+}
+
+bool SelectableNote::isResizingOrScaling() const noexcept
+{
+    return this->state == State::DraggingResizing ||
+        this->state == State::GroupScalingLeft ||
+        this->state == State::GroupScalingRight ||
+        this->state == State::ResizingLeft ||
+        this->state == State::ResizingRight;
+}
+
+int SelectableNote::compareElements(const SelectableNote *first, const SelectableNote *second) noexcept
+{
+    if (first == second) { return 0; }
+    const float diff = first->getBeat() - second->getBeat();
+    const int diffResult = (diff > 0.f) - (diff < 0.f);
+    return (diffResult != 0) ? diffResult : (first->note.getId() - second->note.getId());
+}
+
+//===----------------------------------------------------------------------===//
+// SelectableItem
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::setSelected(bool shouldBeSelected)
+{
+    if (this->selected != shouldBeSelected)
+    {
+        this->selected = shouldBeSelected;
+        this->roll.updateNoteSelection(*this);
+    }
+}
+
+bool SelectableNote::isSelected() const noexcept
+{
+    return this->selected;
+}
+
+const String &SelectableNote::getSelectionGroupId() const noexcept
+{
+    return this->note.getSequence()->getTrackId();
+}
+
+Rectangle<int> SelectableNote::getSelectionBounds() const noexcept
+{
+    return this->roll.getEventBounds(this->getKey() + this->clip.getKey(),
+        this->getBeat() + this->clip.getBeat(), this->getLength()).getSmallestIntegerContainer();
+}
+
+//===----------------------------------------------------------------------===//
+// Dragging
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::startDragging(const bool sendMidiMessage)
+{
+    this->firstChangeDone = false;
+    this->state = State::Dragging;
+    this->anchor = this->getNote();
+
+    if (sendMidiMessage)
+    {
+        this->sendNoteOn(this->getKey(), this->getVelocity());
+    }
+}
+
+bool SelectableNote::getDraggingDelta(int newKey, float newBeat, float &deltaBeat, int &deltaKey) const
+{
+    deltaKey = (newKey - this->anchor.getKey());
+    deltaBeat = (newBeat - this->anchor.getBeat());
+
+    const bool keyChanged = (this->getKey() != newKey);
+    const bool beatChanged = (this->getBeat() != newBeat);
+
+    return (keyChanged || beatChanged);
+}
+
+Note SelectableNote::continueDragging(float deltaBeat, int deltaKey, bool sendMidiMessage) const noexcept
+{
+    const int newKey = this->anchor.getKey() + deltaKey;
+    const float newBeat = this->anchor.getBeat() + deltaBeat;
+
+    if (sendMidiMessage)
+    {
+        this->sendNoteOn(newKey, this->getVelocity());
+    }
+
+    return this->getNote().withKeyBeat(newKey, newBeat);
+}
+
+void SelectableNote::endDragging(bool sendStopSoundMessage)
+{
+    if (sendStopSoundMessage)
+    {
+        this->stopSound();
+    }
+
+    this->state = State::None;
+}
+
+//===----------------------------------------------------------------------===//
+// Dragging + resizing (the default creating note mode)
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::startDraggingResizing(bool sendMidiMessage)
+{
+    this->firstChangeDone = false;
+    this->state = State::DraggingResizing;
+    this->anchor = this->getNote();
+
+    // always send midi in this mode:
+    if (sendMidiMessage)
+    {
+        this->sendNoteOn(this->getKey(), this->getVelocity());
+    }
+}
+
+bool SelectableNote::getDraggingResizingDelta(int newKey, float newBeat, float &deltaLength, int &deltaKey) const
+{
+    const float newLength = newBeat - this->getBeat();
+    deltaLength = newLength - this->anchor.getLength();
+    deltaKey = newKey - this->anchor.getKey();
+
+    const bool keyChanged = (this->getKey() != newKey);
+    const bool lengthChanged = (this->getLength() != newLength);
+    return (keyChanged || lengthChanged);
+}
+
+Note SelectableNote::continueDraggingResizing(float deltaLength, int deltaKey, bool sendMidi) const noexcept
+{
+    const int newKey = this->anchor.getKey() + deltaKey;
+
+    // the minimal length should depend on the current zoom level:
+    // when zoomed closer, we need to be able to edit shorter lengths,
+    // when zoomed away, the length snaps should be convenient == proportionally larger
+    const float minLength = this->roll.getMinVisibleBeatForCurrentZoomLevel();
+    const float newLength = jmax(this->anchor.getLength() + deltaLength, minLength);
+
+    if (sendMidi)
+    {
+        this->sendNoteOn(newKey, this->getVelocity());
+    }
+
+    return this->getNote().withKeyLength(newKey, newLength);
+}
+
+void SelectableNote::endDraggingResizing()
+{
+    this->stopSound();
+    this->state = State::None;
+}
+
+//===----------------------------------------------------------------------===//
+// Resizing Right
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::startResizingRight(bool sendMidiMessage)
+{
+    this->firstChangeDone = false;
+    this->state = State::ResizingRight;
+    this->anchor = this->getNote();
+
+    if (sendMidiMessage)
+    {
+        this->sendNoteOn(this->getKey(), this->getVelocity());
+    }
+}
+
+bool SelectableNote::getResizingRightDelta(float newBeat, float &deltaLength) const
+{
+    const float newLength = newBeat - this->getBeat();
+    deltaLength = newLength - this->anchor.getLength();
+
+    const bool lengthChanged = (this->getLength() != newLength);
+    return lengthChanged;
+}
+
+Note SelectableNote::continueResizingRight(float deltaLength) const noexcept
+{
+    // the minimal length should depend on the current zoom level:
+    const float minLength = this->roll.getMinVisibleBeatForCurrentZoomLevel();
+    const float newLength = jmax(this->anchor.getLength() + deltaLength, minLength);
+    return this->getNote().withLength(newLength);
+}
+
+void SelectableNote::endResizingRight()
+{
+    this->stopSound();
+    this->state = State::None;
+}
+
+//===----------------------------------------------------------------------===//
+// Resizing Left
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::startResizingLeft(bool sendMidiMessage)
+{
+    this->firstChangeDone = false;
+    this->state = State::ResizingLeft;
+    this->anchor = this->getNote();
+
+    if (sendMidiMessage)
+    {
+        this->sendNoteOn(this->getKey(), this->getVelocity());
+    }
+}
+
+bool SelectableNote::getResizingLeftDelta(float newBeat, float &deltaLength) const
+{
+    deltaLength = this->anchor.getBeat() - newBeat;
+    const bool lengthChanged = (this->getBeat() != newBeat);
+    return lengthChanged;
+}
+
+Note SelectableNote::continueResizingLeft(float deltaLength) const noexcept
+{
+    // the minimal length should depend on the current zoom level:
+    const float minLength = this->roll.getMinVisibleBeatForCurrentZoomLevel();
+    const float newLength = jmax(this->anchor.getLength() + deltaLength, minLength);
+    const float newBeat = this->anchor.getBeat() + this->anchor.getLength() - newLength;
+    return this->getNote().withBeat(newBeat).withLength(newLength);
+}
+
+void SelectableNote::endResizingLeft()
+{
+    this->stopSound();
+    this->state = State::None;
+}
+
+//===----------------------------------------------------------------------===//
+// Group Scaling Right
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::startGroupScalingRight(float groupStartBeat)
+{
+    this->firstChangeDone = false;
+    this->state = State::GroupScalingRight;
+    const float newLength = this->getLength() + (this->getBeat() - groupStartBeat);
+    this->anchor = this->getNote();
+    this->groupScalingAnchor = { groupStartBeat, newLength };
+}
+
+bool SelectableNote::getGroupScaleRightFactor(float newBeat, float &absScaleFactor) const
+{
+    const float minGroupLength = 1.f;
+    const float myEndBeat = this->getBeat() + this->getLength();
+    const float newGroupLength = jmax(minGroupLength, newBeat - this->groupScalingAnchor.getBeat());
+
+    absScaleFactor = newGroupLength / this->groupScalingAnchor.getLength();
+
+    const bool endBeatChanged = (newBeat != myEndBeat);
+    return endBeatChanged;
+}
+
+Note SelectableNote::continueGroupScalingRight(float absScaleFactor) const noexcept
+{
+    const float anchorBeatDelta = this->anchor.getBeat() - this->groupScalingAnchor.getBeat();
+    const float newLength = this->anchor.getLength() * absScaleFactor;
+    const float newBeat = this->groupScalingAnchor.getBeat() + (anchorBeatDelta * absScaleFactor);
+    return this->getNote().withBeat(newBeat).withLength(newLength);
+}
+
+void SelectableNote::endGroupScalingRight()
+{
+    this->state = State::None;
+}
+
+//===----------------------------------------------------------------------===//
+// Group Scaling Left
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::startGroupScalingLeft(float groupEndBeat)
+{
+    this->firstChangeDone = false;
+    this->state = State::GroupScalingLeft;
+    this->anchor = this->getNote();
+    const float newLength = groupEndBeat - this->getBeat();
+    this->groupScalingAnchor = { this->getNote().getBeat(), newLength };
+}
+
+bool SelectableNote::getGroupScaleLeftFactor(float newBeat, float &absScaleFactor) const
+{
+    const float minGroupLength = 1.f;
+    const float groupAnchorEndBeat = this->groupScalingAnchor.getBeat() + this->groupScalingAnchor.getLength();
+
+    const float newGroupLength = jmax(minGroupLength, (groupAnchorEndBeat - newBeat));
+    absScaleFactor = newGroupLength / this->groupScalingAnchor.getLength();
+
+    const bool endBeatChanged = (newBeat != this->getBeat());
+    return endBeatChanged;
+}
+
+Note SelectableNote::continueGroupScalingLeft(float absScaleFactor) const noexcept
+{
+    const float groupAnchorEndBeat = this->groupScalingAnchor.getBeat() + this->groupScalingAnchor.getLength();
+    const float anchorBeatDelta = groupAnchorEndBeat - this->anchor.getBeat();
+    const float newLength = this->anchor.getLength() * absScaleFactor;
+    const float newBeat = groupAnchorEndBeat - (anchorBeatDelta * absScaleFactor);
+    return this->getNote().withBeat(newBeat).withLength(newLength);
+}
+
+void SelectableNote::endGroupScalingLeft()
+{
+    this->state = State::None;
+}
+
+//===----------------------------------------------------------------------===//
+// Velocity
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::startTuning()
+{
+    this->firstChangeDone = false;
+    this->state = State::Tuning;
+    this->anchor = this->getNote();
+}
+
+Note SelectableNote::continueTuningLinear(float delta) const noexcept
+{
+    const float newVelocity = (this->anchor.getVelocity() - delta);
+    return this->getNote().withVelocity(newVelocity);
+}
+
+Note SelectableNote::continueTuningMultiplied(float factor) const noexcept
+{
+    // -1 .. 0   ->   0 .. anchor
+    // 0 .. 1    ->   anchor .. 1
+    const float av = this->anchor.getVelocity();
+    //const float newVelocity = (factor < 0) ? (av * (factor + 1.f)) : (av + ((1.f - av) * factor));
+    const float newVelocity = (factor < 0) ? (av * (factor + 1.f)) : (av + (av * factor * 2));
+    return this->getNote().withVelocity(newVelocity);
+}
+
+Note SelectableNote::continueTuningSine(float factor, float midline, float phase) const noexcept
+{
+    // -1 .. 0   ->   0 .. anchor
+    // 0 .. 1    ->   anchor .. 1
+    const float amplitude = jmin(midline, (1.f - midline));
+    const float sine = cosf(phase) * amplitude;
+    const float av = this->anchor.getVelocity();
+    const float f = (factor < 0) ? (factor + 1.f) : factor;
+    const float downscale = ((av * f) + (midline * (1.f - f)));
+    const float upscale = ((midline + sine) * f) + (av * (1.f - f));
+    const float newVelocity = (factor < 0) ? downscale : upscale;
+    return this->getNote().withVelocity(newVelocity);
+}
+
+void SelectableNote::endTuning()
+{
+    this->state = State::None;
+}
+
+//===----------------------------------------------------------------------===//
+// Shorthands
+//===----------------------------------------------------------------------===//
+
+void SelectableNote::checkpointIfNeeded()
+{
+    if (!this->firstChangeDone)
+    {
+        this->note.getSequence()->checkpoint();
+        this->firstChangeDone = true;
+    }
+}
+
+void SelectableNote::stopSound()
+{
+    const auto &trackId = this->getNote().getSequence()->getTrackId();
+    this->roll.getTransport().stopSound(trackId);
+}
+
+void SelectableNote::sendNoteOn(int noteKey, float velocity) const
+{
+    const auto &trackId = this->note.getSequence()->getTrackId();
+    this->roll.getTransport().previewKey(trackId,
+        noteKey + this->clip.getKey(),
+        velocity * this->clip.getVelocity(),
+        this->note.getLength());
+}
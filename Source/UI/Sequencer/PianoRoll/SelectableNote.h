@@ -0,0 +1,181 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+class PianoRoll;
+
+#include "SelectableItem.h"
+#include "Note.h"
+#include "Clip.h"
+
+// The piano roll only paints its notes, and creates the note components
+// just for the ones being hovered or edited, so the selection is made of these:
+// they keep the selected state and the editing anchors for the active clip's notes;
+// the editing methods take the key and the beat under the mouse cursor,
+// so that they can be used both by the note components and the resizers
+
+class SelectableNote final : public SelectableItem
+{
+public:
+
+    SelectableNote(PianoRoll &roll, const Note &note, const Clip &clip) noexcept;
+
+    // todo need clearer names for these mode and corresponding methods:
+    enum class State : uint8
+    {
+        None,
+        Dragging,           // changes beat & key
+        DraggingResizing,   // changes length & key
+        ResizingRight,      // changes length
+        ResizingLeft,       // changes beat & length
+        GroupScalingRight,
+        GroupScalingLeft,
+        Tuning
+    };
+
+    //===------------------------------------------------------------------===//
+    // Helpers
+    //===------------------------------------------------------------------===//
+
+    inline int getKey() const noexcept { return this->note.getKey(); }
+    inline float getBeat() const noexcept { return this->note.getBeat(); }
+    inline float getLength() const noexcept { return this->note.getLength(); }
+    inline float getVelocity() const noexcept { return this->note.getVelocity(); }
+    inline const Note &getNote() const noexcept { return this->note; }
+    inline const Clip &getClip() const noexcept { return this->clip; }
+
+    PianoRoll &getRoll() const noexcept;
+
+    inline State getState() const noexcept { return this->state; }
+    inline bool isInEditMode() const noexcept { return this->state != State::None; }
+    bool isResizingOrScaling() const noexcept;
+
+    static int compareElements(const SelectableNote *first, const SelectableNote *second) noexcept;
+
+    //===------------------------------------------------------------------===//
+    // SelectableItem
+    //===------------------------------------------------------------------===//
+
+    void setSelected(bool selected) override;
+    bool isSelected() const noexcept override;
+    const String &getSelectionGroupId() const noexcept override;
+    Rectangle<int> getSelectionBounds() const noexcept override;
+
+private:
+
+    PianoRoll &roll;
+
+    const Note &note;
+    const Clip &clip;
+
+    bool selected = false;
+
+private:
+
+    struct NoteEditAnchor final
+    {
+        NoteEditAnchor &operator= (const Note &note)
+        {
+            this->key = note.getKey();
+            this->beat = note.getBeat();
+            this->length = note.getLength();
+            this->velocity = note.getVelocity();
+            return *this;
+        }
+
+        inline int getKey() const noexcept { return this->key; }
+        inline float getBeat() const noexcept { return this->beat; }
+        inline float getLength() const noexcept { return this->length; }
+        inline float getVelocity() const noexcept { return this->velocity; }
+
+    private:
+        int key = 0;
+        float beat = 0.f;
+        float length = 0.f;
+        float velocity = 0.f;
+    };
+
+    struct GroupScaleAnchor final
+    {
+        GroupScaleAnchor() = default;
+        GroupScaleAnchor(float beat, float length) : beat(beat), length(length) {}
+        inline float getBeat() const noexcept { return this->beat; }
+        inline float getLength() const noexcept { return this->length; }
+    private:
+        float beat = 0.f;
+        float length = 0.f;
+    };
+
+    NoteEditAnchor anchor;
+    GroupScaleAnchor groupScalingAnchor;
+
+private:
+
+    void startDragging(bool sendMidiMessage);
+    bool getDraggingDelta(int newKey, float newBeat, float &deltaBeat, int &deltaKey) const;
+    Note continueDragging(float deltaBeat, int deltaKey, bool sendMidiMessage) const noexcept;
+    void endDragging(bool sendStopSoundMessage = true);
+
+    void startDraggingResizing(bool sendMidiMessage);
+    bool getDraggingResizingDelta(int newKey, float newBeat, float &deltaLength, int &deltaKey) const;
+    Note continueDraggingResizing(float deltaLength, int deltaKey, bool sendMidi) const noexcept;
+    void endDraggingResizing();
+
+    void startResizingRight(bool sendMidiMessage);
+    bool getResizingRightDelta(float newBeat, float &deltaLength) const;
+    Note continueResizingRight(float deltaLength) const noexcept;
+    void endResizingRight();
+
+    void startResizingLeft(bool sendMidiMessage);
+    bool getResizingLeftDelta(float newBeat, float &deltaLength) const;
+    Note continueResizingLeft(float deltaLength) const noexcept;
+    void endResizingLeft();
+
+    void startTuning();
+    Note continueTuningLinear(float delta) const noexcept;
+    Note continueTuningMultiplied(float factor) const noexcept;
+    Note continueTuningSine(float factor, float midline, float phase) const noexcept;
+    void endTuning();
+
+    void startGroupScalingRight(float groupStartBeat);
+    bool getGroupScaleRightFactor(float newBeat, float &absScaleFactor) const;
+    Note continueGroupScalingRight(float absScaleFactor) const noexcept;
+    void endGroupScalingRight();
+
+    void startGroupScalingLeft(float groupEndBeat);
+    bool getGroupScaleLeftFactor(float newBeat, float &absScaleFactor) const;
+    Note continueGroupScalingLeft(float absScaleFactor) const noexcept;
+    void endGroupScalingLeft();
+
+private:
+
+    State state = State::None;
+
+    friend class NoteComponent;
+    friend class NoteResizerLeft;
+    friend class NoteResizerRight;
+    friend struct SequencerOperations;
+
+    bool firstChangeDone = false;
+    void checkpointIfNeeded();
+
+    void stopSound();
+    void sendNoteOn(int noteKey, float velocity) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SelectableNote)
+};
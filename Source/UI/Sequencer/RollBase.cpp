@@ -39,7 +39,6 @@
 
 #include "Transport.h"
 #include "IconComponent.h"
-#include "PlayerThread.h"
 
 #include "ProjectMetadata.h"
 #include "ProjectTimeline.h"
@@ -843,7 +842,7 @@ Lasso &RollBase::getLassoSelection()
     return this->selection;
 }
 
-void RollBase::selectEvent(SelectableComponent *event, bool shouldClearAllOthers)
+void RollBase::selectEvent(SelectableItem *event, bool shouldClearAllOthers)
 {
     if (shouldClearAllOthers)
     {
@@ -856,7 +855,7 @@ void RollBase::selectEvent(SelectableComponent *event, bool shouldClearAllOthers
     }
 }
 
-void RollBase::deselectEvent(SelectableComponent *event)
+void RollBase::deselectEvent(SelectableItem *event)
 {
     this->selection.deselect(event);
 }
@@ -70,7 +70,7 @@ class RollBase :
     public SmoothZoomListener,
     public MultiTouchListener,
     public ProjectListener,
-    public LassoSource<SelectableComponent *>,
+    public LassoSource<SelectableItem *>,
     public Playhead::Listener, // for smooth scrolling to seek position
     protected UserInterfaceFlags::Listener, // global UI options
     protected ChangeListener, // listens to RollEditMode,
@@ -220,8 +220,8 @@ public:
         float endBeat, bool shouldClearAllOthers) = 0;
 
     Lasso &getLassoSelection() override;
-    void selectEvent(SelectableComponent *event, bool shouldClearAllOthers);
-    void deselectEvent(SelectableComponent *event);
+    void selectEvent(SelectableItem *event, bool shouldClearAllOthers);
+    void deselectEvent(SelectableItem *event);
     void deselectAll();
     
     SelectionComponent *getSelectionComponent() const noexcept;
@@ -17,12 +17,20 @@
 
 #pragma once
 
-class SelectableComponent : public virtual Component
+// Anything that can be put in the rolls' lasso selection:
+// the clip components in the pattern roll, and the notes in the piano roll,
+// which don't need to have components, see SelectableNote
+class SelectableItem
 {
 public:
 
+    virtual ~SelectableItem() = default;
+
     virtual void setSelected(bool selected) = 0;
     virtual bool isSelected() const noexcept = 0;
     virtual const String &getSelectionGroupId() const noexcept = 0;
 
+    // in the roll's coordinates, used to show the selection dragging helpers
+    virtual Rectangle<int> getSelectionBounds() const noexcept = 0;
+
 };
@@ -32,7 +32,7 @@ SelectionComponent::SelectionComponent() :
 }
 
 void SelectionComponent::beginLasso(const Point<float> &position,
-    LassoSource<SelectableComponent *> *lassoSource)
+    LassoSource<SelectableItem *> *lassoSource)
 {
     jassert(lassoSource != nullptr);
     jassert(this->getParentComponent() != nullptr);
@@ -17,7 +17,7 @@
 
 #pragma once
 
-#include "SelectableComponent.h"
+#include "SelectableItem.h"
 
 class SelectionComponent final : public Component, private Timer
 {
@@ -26,7 +26,7 @@ public:
     SelectionComponent();
 
     void beginLasso(const Point<float> &position,
-        LassoSource<SelectableComponent *> *lassoSource);
+        LassoSource<SelectableItem *> *lassoSource);
     void dragLasso(const MouseEvent &e);
     void endLasso();
     bool isDragging() const;
@@ -36,8 +36,8 @@ public:
 
 private:
 
-    Array<SelectableComponent *> originalSelection;
-    LassoSource<SelectableComponent *> *source = nullptr;
+    Array<SelectableItem *> originalSelection;
+    LassoSource<SelectableItem *> *source = nullptr;
 
     Point<double> startPosition { 0, 0 };
     Point<double> endPosition { 0, 0 };
@@ -63,7 +63,7 @@ private:
 
 private:
 
-    Array<SelectableComponent *> itemsInLasso;
+    Array<SelectableItem *> itemsInLasso;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SelectionComponent)
 };
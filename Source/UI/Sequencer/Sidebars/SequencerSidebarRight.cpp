@@ -25,7 +25,7 @@
 #include "TransportControlComponent.h"
 
 #include "ProjectNode.h"
-#include "PlayerThread.h"
+#include "Transport.h"
 #include "PianoRoll.h"
 #include "MenuItemComponent.h"
 #include "ProjectTimeline.h"